@@ -0,0 +1,43 @@
+/** @file Benchmark.h
+ * Generate synthetic IDP archives and map files, and measure how fast the tools process them. The synthetic files have the same structure as the game files, so the tools performance can be measured without the game files.
+ * @author Adrien RICCIARDI
+ */
+#ifndef H_BENCHMARK_H
+#define H_BENCHMARK_H
+
+//-------------------------------------------------------------------------------------------------
+// Functions
+//-------------------------------------------------------------------------------------------------
+/** Create an IDP archive filled with random data. The tags are spread over a few directories, and their sizes follow a logarithmic distribution like the game archive (many small scripts and a few large textures and sounds).
+ * @param Pointer_String_Output_File The IDP file to create.
+ * @param Tags_Count How many tags to create.
+ * @param Minimum_Tag_Size The smallest tag data size in bytes.
+ * @param Maximum_Tag_Size The largest tag data size in bytes.
+ * @param Seed The random generator seed, the same seed always generates the same archive.
+ * @return -1 if an error occurred,
+ * @return 0 on success.
+ */
+int BenchmarkGenerateIDPArchive(char *Pointer_String_Output_File, int Tags_Count, int Minimum_Tag_Size, int Maximum_Tag_Size, unsigned int Seed);
+
+/** Create a map file containing a map size record (type 1), a terrain record (type 2) and some unit group records (type 7).
+ * @param Pointer_String_Output_File The map file to create.
+ * @param Tiles_Per_Side The map width and height in tiles, it must be lower than 100.
+ * @param Unit_Groups_Count How many unit group records to create.
+ * @param Units_Per_Group_Count How many units each group contains.
+ * @param Seed The random generator seed, the same seed always generates the same map.
+ * @return -1 if an error occurred,
+ * @return 0 on success.
+ */
+int BenchmarkGenerateMap(char *Pointer_String_Output_File, int Tiles_Per_Side, int Unit_Groups_Count, int Units_Per_Group_Count, unsigned int Seed);
+
+/** Generate a synthetic archive and a synthetic map, then measure IDPArchiveRead(), the IDP extraction command and MapExtract(). The results are written in JSON format.
+ * @param Pointer_String_Program_File This program executable path, used to run the IDP extraction command like a user would do.
+ * @param Pointer_String_Work_Directory Where to create the synthetic files and the extracted data.
+ * @param Iterations_Count How many times each benchmark is run, the best and the mean times are reported.
+ * @param Pointer_String_Report_File The JSON report file to create. If NULL, the report is written to the standard output.
+ * @return -1 if an error occurred,
+ * @return 0 on success.
+ */
+int BenchmarkRun(char *Pointer_String_Program_File, char *Pointer_String_Work_Directory, int Iterations_Count, char *Pointer_String_Report_File);
+
+#endif
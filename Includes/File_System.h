@@ -0,0 +1,133 @@
+/** @file File_System.h
+ * Portable file and directory helpers. Archive paths use the '\' separator, they are converted to the native separator when needed.
+ * @author Adrien RICCIARDI
+ */
+#ifndef H_FILE_SYSTEM_H
+#define H_FILE_SYSTEM_H
+
+#include <stdio.h>
+
+//-------------------------------------------------------------------------------------------------
+// Types
+//-------------------------------------------------------------------------------------------------
+/** Remember the directories that have already been created, so each directory is created only once. */
+typedef struct
+{
+	char **Pointer_Pointer_Strings_Paths; //!< The hash set slots, a NULL slot is free.
+	unsigned int Slots_Count; //!< How many slots the hash set has, always a power of two.
+	unsigned int Paths_Count; //!< How many slots are used.
+} TFileSystemDirectoryCache;
+
+/** A file found by FileSystemListFiles(). */
+typedef struct
+{
+	char *Pointer_String_Path; //!< The file path relative to the listed directory, using the '\' separator. This string is dynamically allocated.
+	long long Size; //!< The file size in bytes.
+} TFileSystemFile;
+
+//-------------------------------------------------------------------------------------------------
+// Functions
+//-------------------------------------------------------------------------------------------------
+/** Create a single directory. It is not an error if the directory already exists.
+ * @param Pointer_String_Path The directory to create.
+ * @return -1 if an error occurred,
+ * @return 0 if the directory was created or already exists.
+ */
+int FileSystemCreateDirectory(const char *Pointer_String_Path);
+
+/** Set the current working directory.
+ * @param Pointer_String_Path The new working directory.
+ * @return -1 if an error occurred,
+ * @return 0 on success.
+ */
+int FileSystemChangeDirectory(const char *Pointer_String_Path);
+
+/** Tell whether a path is an existing directory.
+ * @param Pointer_String_Path The path to check.
+ * @return 1 if the path is a directory,
+ * @return 0 if the path is a file or does not exist.
+ */
+int FileSystemIsDirectory(const char *Pointer_String_Path);
+
+/** Open a file whose path can use both '\' and '/' separators.
+ * @param Pointer_String_Path The file path.
+ * @param Pointer_String_Opening_Mode The mode to provide to fopen().
+ * @return NULL if an error occurred,
+ * @return a non-NULL value on success.
+ */
+FILE *FileSystemOpenFile(const char *Pointer_String_Path, const char *Pointer_String_Opening_Mode);
+
+/** Read data from a file, like fread() with an elements size of 1. The call and the read bytes are counted in the statistics.
+ * @param Pointer_Buffer On output, contain the read data.
+ * @param Size How many bytes to read.
+ * @param Pointer_File The file to read from.
+ * @return How many bytes were read.
+ */
+size_t FileSystemReadFile(void *Pointer_Buffer, size_t Size, FILE *Pointer_File);
+
+/** Write data to a file, like fwrite() with an elements size of 1. The call and the written bytes are counted in the statistics.
+ * @param Pointer_Buffer The data to write.
+ * @param Size How many bytes to write.
+ * @param Pointer_File The file to write to.
+ * @return How many bytes were written.
+ */
+size_t FileSystemWriteFile(const void *Pointer_Buffer, size_t Size, FILE *Pointer_File);
+
+/** Write the buffered data of a file to the storage device, so they are not lost if the computer crashes or loses power.
+ * @param Pointer_File The file to synchronize.
+ * @return -1 if an error occurred, errno is then set,
+ * @return 0 on success.
+ */
+int FileSystemSynchronizeFile(FILE *Pointer_File);
+
+/** Initialize an empty directory cache.
+ * @param Pointer_Cache The cache to initialize.
+ */
+void FileSystemDirectoryCacheInitialize(TFileSystemDirectoryCache *Pointer_Cache);
+
+/** Release all memory allocated by a directory cache.
+ * @param Pointer_Cache The cache to release.
+ */
+void FileSystemDirectoryCacheFree(TFileSystemDirectoryCache *Pointer_Cache);
+
+/** Create all the directories leading to a file, like "mkdir -p" would do on the file parent directory. Directories already found in the cache are not created again.
+ * @param Pointer_Cache The cache of the already created directories.
+ * @param Pointer_String_File_Path The file path, it can use both '\' and '/' separators. A file with no directory in its path is allowed.
+ * @return -1 if an error occurred,
+ * @return 0 if all directories exist.
+ */
+int FileSystemCreateParentDirectories(TFileSystemDirectoryCache *Pointer_Cache, const char *Pointer_String_File_Path);
+
+/** Retrieve a file size and last modification time.
+ * @param Pointer_String_Path The file path.
+ * @param Pointer_Size On output, contain the file size in bytes.
+ * @param Pointer_Modification_Time On output, contain the file last modification time. The value unit depends on the operating system, it must only be compared to other values returned by this function.
+ * @return -1 if an error occurred,
+ * @return 0 on success.
+ */
+int FileSystemGetFileInformation(const char *Pointer_String_Path, long long *Pointer_Size, long long *Pointer_Modification_Time);
+
+/** Tell whether two paths designate the same file, even when the paths are written differently (relative and absolute paths, links...).
+ * @param Pointer_String_Path_1 The first file path.
+ * @param Pointer_String_Path_2 The second file path.
+ * @return 1 if both paths designate the same file,
+ * @return 0 if the files are different or if one of them does not exist.
+ */
+int FileSystemIsSameFile(const char *Pointer_String_Path_1, const char *Pointer_String_Path_2);
+
+/** List all files of a directory and of all its subdirectories.
+ * @param Pointer_String_Directory The directory to list.
+ * @param Pointer_Pointer_Files On output, contain the files sorted by path. Call FileSystemFreeFiles() to release the list when it is not used anymore.
+ * @param Pointer_Files_Count On output, tell how many files were found.
+ * @return -1 if an error occurred,
+ * @return 0 on success.
+ */
+int FileSystemListFiles(const char *Pointer_String_Directory, TFileSystemFile **Pointer_Pointer_Files, int *Pointer_Files_Count);
+
+/** Release a files list returned by FileSystemListFiles().
+ * @param Pointer_Files The list to release.
+ * @param Files_Count How many files the list contains.
+ */
+void FileSystemFreeFiles(TFileSystemFile *Pointer_Files, int Files_Count);
+
+#endif
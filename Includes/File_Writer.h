@@ -0,0 +1,72 @@
+/** @file File_Writer.h
+ * Write big files through a large memory buffer. The numbers are formatted without the C library, which is much slower because it handles the locale and all format options.
+ * @author Adrien RICCIARDI
+ */
+#ifndef H_FILE_WRITER_H
+#define H_FILE_WRITER_H
+
+#include <stdio.h>
+
+//-------------------------------------------------------------------------------------------------
+// Types
+//-------------------------------------------------------------------------------------------------
+/** A buffered output file. */
+typedef struct
+{
+	FILE *Pointer_File; //!< The output file.
+	unsigned char *Pointer_Buffer; //!< The pending data.
+	size_t Used_Size; //!< How many bytes of the buffer are used.
+	int Is_Error; //!< Set to 1 when a write failed, so the error is reported when the file is closed.
+} TFileWriter;
+
+//-------------------------------------------------------------------------------------------------
+// Functions
+//-------------------------------------------------------------------------------------------------
+/** Create a file to write to.
+ * @param Pointer_String_File The file to create.
+ * @param Pointer_String_Opening_Mode The mode to provide to fopen(), use "w" for text files so the line endings are the native ones.
+ * @param Pointer_Writer On output, contain the initialized writer.
+ * @return -1 if an error occurred,
+ * @return 0 on success.
+ */
+int FileWriterOpen(const char *Pointer_String_File, const char *Pointer_String_Opening_Mode, TFileWriter *Pointer_Writer);
+
+/** Append raw data to the file.
+ * @param Pointer_Writer The writer.
+ * @param Pointer_Data The data to write.
+ * @param Size The data size in bytes.
+ */
+void FileWriterWriteBuffer(TFileWriter *Pointer_Writer, const void *Pointer_Data, size_t Size);
+
+/** Append a string to the file.
+ * @param Pointer_Writer The writer.
+ * @param Pointer_String The string to write, the terminating zero is not written.
+ */
+void FileWriterWriteString(TFileWriter *Pointer_Writer, const char *Pointer_String);
+
+/** Append a single character to the file.
+ * @param Pointer_Writer The writer.
+ * @param Character The character to write.
+ */
+void FileWriterWriteCharacter(TFileWriter *Pointer_Writer, char Character);
+
+/** Append an integer to the file, exactly like printf("%d") does.
+ * @param Pointer_Writer The writer.
+ * @param Value The value to write.
+ */
+void FileWriterWriteInteger(TFileWriter *Pointer_Writer, int Value);
+
+/** Append a floating number to the file, exactly like printf("%f") does (6 decimal digits, the exact value is rounded to the nearest, ties to even).
+ * @param Pointer_Writer The writer.
+ * @param Value The value to write, it must not be infinite or NaN.
+ */
+void FileWriterWriteFloat(TFileWriter *Pointer_Writer, float Value);
+
+/** Write the pending data and close the file.
+ * @param Pointer_Writer The writer.
+ * @return -1 if any write failed,
+ * @return 0 if all data were written.
+ */
+int FileWriterClose(TFileWriter *Pointer_Writer);
+
+#endif
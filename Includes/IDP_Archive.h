@@ -5,18 +5,42 @@
 #ifndef H_IDP_ARCHIVE_H
 #define H_IDP_ARCHIVE_H
 
+#include <Mapped_File.h>
+#include <stdio.h>
+#include <Thread.h>
+
 //-------------------------------------------------------------------------------------------------
 // Types
 //-------------------------------------------------------------------------------------------------
 /** Useful data from a tag. All data present in the IDP but that can be easily computed are not present here. */
 typedef struct
 {
-	char *Pointer_String_Name; //!< The tag name, this string is dynamically allocated.
+	char *Pointer_String_Name; //!< The tag name, this string is dynamically allocated by IDPArchiveRead() or points into the mapped file when the archive is opened with IDPArchiveOpen().
 	int Data_Offset; //!< Offset of the tag data, starting from the data area. This field is used internally, do not modify it.
 	int Data_Size; //!< Data size in bytes.
-	void *Pointer_Data; //!< Data buffer, dynamically allocated.
+	unsigned char Unknown_Bytes[8]; //!< The 8 bytes following the data size, their meaning is unknown for now (maybe flags ?). They are kept to be written back as is.
+	void *Pointer_Data; //!< Data buffer, dynamically allocated by IDPArchiveRead() or pointing into the mapped file when the archive is opened with IDPArchiveOpen().
 } TIDPArchiveTag;
 
+/** How the archive tags data are accessed. */
+typedef enum
+{
+	IDP_ARCHIVE_ACCESS_MODE_MAPPED, //!< The whole archive is mapped in memory, the tag data are directly available through the tag Pointer_Data field.
+	IDP_ARCHIVE_ACCESS_MODE_STREAMED //!< Only the tags directory is loaded in memory, the tag data must be read with IDPArchiveReadTagData().
+} TIDPArchiveAccessMode;
+
+/** An opened IDP archive. */
+typedef struct
+{
+	TIDPArchiveTag *Pointer_Tags; //!< All archive tags. In mapped mode, the tag names and data point directly into the mapped file, so they are read-only. In streamed mode, the tag data pointers are NULL.
+	int Tags_Count; //!< How many tags the archive contains.
+	TIDPArchiveAccessMode Access_Mode; //!< How the tag data are accessed.
+	int Data_Area_Offset; //!< Offset of the data area from the archive beginning, used internally.
+	TMappedFile Mapped_File; //!< The archive file content in mapped mode, used internally.
+	FILE *Pointer_File; //!< The archive file in streamed mode, used internally.
+	TThreadMutex File_Mutex; //!< Serialize the archive file accesses in streamed mode, used internally.
+} TIDPArchive;
+
 //-------------------------------------------------------------------------------------------------
 // Functions
 //-------------------------------------------------------------------------------------------------
@@ -35,4 +59,79 @@ int IDPArchiveRead(char *Pointer_String_IDP_File, TIDPArchiveTag **Pointer_Point
  */
 void IDPArchiveFreeBuffer(TIDPArchiveTag *Pointer_Buffer, int Tags_Count);
 
+/** Open an IDP file and parse its tags directory.
+ * @param Pointer_String_IDP_File The IDP file to open.
+ * @param Access_Mode In mapped mode, the whole file is mapped in memory and the tag names and data are not copied. In streamed mode, only the tags directory is read and the tag data are read on demand.
+ * @param Pointer_Archive On output, contain the archive tags. Call IDPArchiveClose() to release the archive when it is not used anymore.
+ * @return 0 if the archive was successfully opened,
+ * @return -1 if an error occurred.
+ */
+int IDPArchiveOpen(char *Pointer_String_IDP_File, TIDPArchiveAccessMode Access_Mode, TIDPArchive *Pointer_Archive);
+
+/** Read a part of a tag data, whatever the archive access mode is.
+ * @param Pointer_Archive The archive the tag belongs to.
+ * @param Tag_Index The tag to read data from.
+ * @param Offset The offset from the tag data beginning.
+ * @param Pointer_Buffer On output, contain the read data.
+ * @param Size How many bytes to read. The requested area must be fully contained in the tag data.
+ * @note This function can be called from several threads at the same time.
+ * @return 0 if the data were successfully read,
+ * @return -1 if an error occurred.
+ */
+int IDPArchiveReadTagData(TIDPArchive *Pointer_Archive, int Tag_Index, int Offset, void *Pointer_Buffer, int Size);
+
+/** Release all resources allocated by IDPArchiveOpen(). All tag names and data pointers become invalid.
+ * @param Pointer_Archive The archive to close.
+ */
+void IDPArchiveClose(TIDPArchive *Pointer_Archive);
+
+/** Compare two tag names. The comparison ignores the letter case and considers the '\\' and '/' separators as equal.
+ * @param Pointer_String_Tag_Name_1 The first tag name.
+ * @param Pointer_String_Tag_Name_2 The second tag name.
+ * @return A negative value if the first name comes first,
+ * @return 0 if the names are equal,
+ * @return a positive value if the second name comes first.
+ */
+int IDPArchiveCompareTagNames(const char *Pointer_String_Tag_Name_1, const char *Pointer_String_Tag_Name_2);
+
+/** Find a tag by its name, the names are compared with IDPArchiveCompareTagNames().
+ * @param Pointer_Archive The archive to search in.
+ * @param Pointer_String_Tag_Name The tag name, like "app\\scripts\\ga3.txt".
+ * @return -1 if the archive contains no tag with this name,
+ * @return the tag index if the tag was found.
+ */
+int IDPArchiveFindTag(TIDPArchive *Pointer_Archive, const char *Pointer_String_Tag_Name);
+
+/** Compute the size of the archive header and tags directory, which is also the data area offset from the archive beginning.
+ * @param Pointer_Tags The tags to store in the archive. Only the tag names are used.
+ * @param Tags_Count How many tags there are.
+ * @return The header and tags directory size in bytes.
+ */
+long long IDPArchiveComputeDirectorySize(TIDPArchiveTag *Pointer_Tags, int Tags_Count);
+
+/** Write the archive header and the tags directory to the beginning of a file. The tag data are not written.
+ * @param Pointer_File The file to write to, the file position must be at the archive beginning. On output, the file position is at the data area beginning.
+ * @param Pointer_Tags The tags to store in the archive, the data offset and size must be set.
+ * @param Tags_Count How many tags there are.
+ * @return 0 if the directory was successfully written,
+ * @return -1 if an error occurred.
+ */
+int IDPArchiveWriteDirectory(FILE *Pointer_File, TIDPArchiveTag *Pointer_Tags, int Tags_Count);
+
+/** Compute a fast non-cryptographic 64-bit hash of some data, to find identical tag data without comparing them byte per byte. This is the xxHash64 algorithm with a zero seed, so the values match the ones of other xxHash64 tools on little-endian machines.
+ * @param Pointer_Data The data to hash.
+ * @param Size The data size in bytes.
+ * @return The data hash.
+ * @note This function can be called from several threads at the same time.
+ */
+unsigned long long IDPArchiveComputeDataHash(const void *Pointer_Data, int Size);
+
+/** Tell whether a tag name matches a wildcard pattern. The '*' character matches any sequence of characters, including separators, and the '?' character matches any single character. The comparison ignores the letter case and considers the '\\' and '/' separators as equal.
+ * @param Pointer_String_Pattern The pattern, like "app\\maps\\*" or "*.wav".
+ * @param Pointer_String_Tag_Name The tag name to test.
+ * @return 1 if the tag name matches the pattern,
+ * @return 0 if the tag name does not match the pattern.
+ */
+int IDPArchiveIsTagNameMatching(const char *Pointer_String_Pattern, const char *Pointer_String_Tag_Name);
+
 #endif
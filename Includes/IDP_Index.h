@@ -0,0 +1,54 @@
+/** @file IDP_Index.h
+ * Cache an IDP archive tags directory in a sidecar file (the archive path followed by ".idx"), sorted by tag name. The index file is loaded with a single read and the tags are found by binary search, so the archive tags directory does not need to be parsed again.
+ * The index file is tied to the archive size, last modification time and first bytes. It is built again automatically when the archive changes.
+ * @author Adrien RICCIARDI
+ */
+#ifndef H_IDP_INDEX_H
+#define H_IDP_INDEX_H
+
+//-------------------------------------------------------------------------------------------------
+// Types
+//-------------------------------------------------------------------------------------------------
+/** A tag location in the archive. */
+typedef struct
+{
+	int Name_Offset; //!< The tag name offset in the index names table.
+	int Tag_Index; //!< The tag index in the archive tags directory.
+	int Data_Offset; //!< The tag data offset from the archive beginning.
+	int Data_Size; //!< The tag data size in bytes.
+} TIDPIndexEntry;
+
+/** An archive index, all data are stored in a single buffer. */
+typedef struct
+{
+	unsigned char *Pointer_Buffer; //!< The whole index file content, used internally.
+	TIDPIndexEntry *Pointer_Entries; //!< The tags, sorted by name with IDPArchiveCompareTagNames().
+	int Entries_Count; //!< How many tags the archive contains.
+	char *Pointer_Names; //!< All tag names, each one is terminated by a zero.
+} TIDPIndex;
+
+//-------------------------------------------------------------------------------------------------
+// Functions
+//-------------------------------------------------------------------------------------------------
+/** Load an archive index. If the index file does not exist or does not match the archive anymore, the archive tags directory is parsed and the index file is created again.
+ * @param Pointer_String_IDP_File The IDP archive.
+ * @param Pointer_Index On output, contain the index. Call IDPIndexFree() to release it when it is not used anymore.
+ * @return -1 if an error occurred,
+ * @return 0 on success.
+ */
+int IDPIndexLoad(char *Pointer_String_IDP_File, TIDPIndex *Pointer_Index);
+
+/** Find a tag by its name using a binary search.
+ * @param Pointer_Index The index to search in.
+ * @param Pointer_String_Tag_Name The tag name, the letter case and the separators are irrelevant.
+ * @return NULL if the archive contains no tag with this name,
+ * @return the tag entry if the tag was found.
+ */
+TIDPIndexEntry *IDPIndexFind(TIDPIndex *Pointer_Index, const char *Pointer_String_Tag_Name);
+
+/** Release all memory allocated by IDPIndexLoad().
+ * @param Pointer_Index The index to release.
+ */
+void IDPIndexFree(TIDPIndex *Pointer_Index);
+
+#endif
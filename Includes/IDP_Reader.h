@@ -0,0 +1,75 @@
+/** @file IDP_Reader.h
+ * Read any tag of an IDP archive on demand, without loading all tags data. Only the tags directory is loaded when the archive is opened, the tag data are read from the file when they are needed and the most recently read ones are kept in a cache of bounded size.
+ * All functions but IDPReaderOpen() and IDPReaderClose() can be called from several threads at the same time.
+ * @author Adrien RICCIARDI
+ */
+#ifndef H_IDP_READER_H
+#define H_IDP_READER_H
+
+#include <IDP_Archive.h>
+#include <Thread.h>
+
+//-------------------------------------------------------------------------------------------------
+// Types
+//-------------------------------------------------------------------------------------------------
+/** A tag data kept in the cache. */
+typedef struct TIDPReaderCacheEntry
+{
+	int Tag_Index; //!< The cached tag.
+	unsigned char *Pointer_Data; //!< The whole tag data.
+	struct TIDPReaderCacheEntry *Pointer_Previous_Entry; //!< The entry used more recently than this one, or NULL if this entry is the most recently used one.
+	struct TIDPReaderCacheEntry *Pointer_Next_Entry; //!< The entry used less recently than this one, or NULL if this entry is the least recently used one.
+} TIDPReaderCacheEntry;
+
+/** An opened archive and its data cache. */
+typedef struct
+{
+	TIDPArchive Archive; //!< The archive opened in streamed mode. The tag names and sizes can be directly read from its tags, the tag data must be read with IDPReaderReadTag().
+	TIDPArchiveTag **Pointer_Pointer_Sorted_Tags; //!< The archive tags sorted by name with IDPArchiveCompareTagNames(), used internally.
+	TIDPReaderCacheEntry **Pointer_Pointer_Cache_Entries; //!< The cache entry of each tag, or NULL if the tag is not cached, used internally.
+	TIDPReaderCacheEntry *Pointer_Most_Recent_Entry; //!< The head of the cache entries list, sorted from the most recently used one to the least recently used one, used internally.
+	TIDPReaderCacheEntry *Pointer_Least_Recent_Entry; //!< The tail of the cache entries list, it is the first entry to be evicted, used internally.
+	long long Cache_Maximum_Size; //!< The cached tag data size can't exceed this amount of bytes.
+	long long Cache_Size; //!< How many tag data bytes are currently cached.
+	long long Cache_Hits_Count; //!< How many reads were served from the cache.
+	long long Cache_Misses_Count; //!< How many reads had to access the archive file.
+	TThreadMutex Cache_Mutex; //!< Protect the cache from concurrent accesses, used internally.
+} TIDPReader;
+
+//-------------------------------------------------------------------------------------------------
+// Functions
+//-------------------------------------------------------------------------------------------------
+/** Open an archive for on demand reading. Only the tags directory is read.
+ * @param Pointer_String_IDP_File The IDP file to open.
+ * @param Cache_Maximum_Size How many tag data bytes can be kept in memory. The tags larger than this size are never cached, set it to 0 to disable the cache.
+ * @param Pointer_Reader On output, contain the opened reader. Call IDPReaderClose() to release it when it is not used anymore.
+ * @return -1 if an error occurred,
+ * @return 0 on success.
+ */
+int IDPReaderOpen(char *Pointer_String_IDP_File, long long Cache_Maximum_Size, TIDPReader *Pointer_Reader);
+
+/** Find a tag by its name with a binary search, the names are compared with IDPArchiveCompareTagNames().
+ * @param Pointer_Reader The reader to search in.
+ * @param Pointer_String_Tag_Name The tag name, like "app\\scripts\\ga3.txt".
+ * @return -1 if the archive contains no tag with this name,
+ * @return the tag index in the archive tags if the tag was found.
+ */
+int IDPReaderFindTag(TIDPReader *Pointer_Reader, const char *Pointer_String_Tag_Name);
+
+/** Read a whole tag data or a part of it. The whole tag data are read from the archive and cached when the tag is not cached yet, so the next reads of the same tag do not access the file.
+ * @param Pointer_Reader The reader the tag belongs to.
+ * @param Tag_Index The tag to read data from.
+ * @param Offset The offset from the tag data beginning.
+ * @param Pointer_Buffer On output, contain the read data.
+ * @param Size How many bytes to read. The requested area must be fully contained in the tag data, use the tag Data_Size field to read the whole tag.
+ * @return -1 if an error occurred,
+ * @return 0 on success.
+ */
+int IDPReaderReadTag(TIDPReader *Pointer_Reader, int Tag_Index, int Offset, void *Pointer_Buffer, int Size);
+
+/** Release all resources allocated by IDPReaderOpen(), including the cached tag data.
+ * @param Pointer_Reader The reader to close.
+ */
+void IDPReaderClose(TIDPReader *Pointer_Reader);
+
+#endif
@@ -0,0 +1,84 @@
+/** @file Log.h
+ * Display the program messages according to the selected verbosity. All messages go to a single fully-buffered sink (the standard output or a log file), so displaying thousands of messages does not slow down the program.
+ * @author Adrien RICCIARDI
+ */
+#ifndef H_LOG_H
+#define H_LOG_H
+
+//-------------------------------------------------------------------------------------------------
+// Types
+//-------------------------------------------------------------------------------------------------
+/** All message levels, from the most important to the least important. */
+typedef enum
+{
+	LOG_LEVEL_ERROR, //!< The operation failed.
+	LOG_LEVEL_WARNING, //!< Something went wrong but the operation can continue.
+	LOG_LEVEL_INFORMATION, //!< A summary of what the program is doing.
+	LOG_LEVEL_DEBUG //!< Detailed messages, like one message per processed item.
+} TLogLevel;
+
+/** Track the progress of a long operation, to display its speed from time to time. */
+typedef struct
+{
+	const char *Pointer_String_Items_Name; //!< The name of the processed items, like "tags".
+	int Items_Count; //!< How many items the operation processes.
+	int Processed_Items_Count; //!< How many items have been processed.
+	long long Processed_Bytes_Count; //!< How many bytes have been processed.
+	long long Start_Time; //!< When the operation started, in milliseconds.
+	long long Last_Display_Time; //!< When the progress was displayed for the last time, in milliseconds.
+} TLogProgress;
+
+//-------------------------------------------------------------------------------------------------
+// Functions
+//-------------------------------------------------------------------------------------------------
+/** Initialize the logging layer, the messages go to the standard output with the LOG_LEVEL_INFORMATION level. This function must be called before any other log function. */
+void LogInitialize(void);
+
+/** Flush the pending messages and close the log file, if any. */
+void LogTerminate(void);
+
+/** Set the least important level of the displayed messages.
+ * @param Level The messages of this level and all more important levels are displayed, the other ones are discarded.
+ */
+void LogSetLevel(TLogLevel Level);
+
+/** Get the least important level of the displayed messages.
+ * @return The current level.
+ */
+TLogLevel LogGetLevel(void);
+
+/** Send all next messages to a file instead of the standard output.
+ * @param Pointer_String_File The log file, it is overwritten.
+ * @return -1 if the file could not be created,
+ * @return 0 on success.
+ */
+int LogSetFile(const char *Pointer_String_File);
+
+/** Display a message, the arguments are the same than printf() ones. The error messages are flushed immediately, so they are not lost if the program crashes.
+ * @param Level The message level.
+ * @param Pointer_String_Format The message format string.
+ * @note This function can be called from several threads at the same time.
+ */
+void LogPrint(TLogLevel Level, const char *Pointer_String_Format, ...);
+
+/** Start tracking the progress of an operation.
+ * @param Pointer_Progress The progress to initialize.
+ * @param Pointer_String_Items_Name The name of the processed items, like "tags". The string must stay valid until the operation is finished.
+ * @param Items_Count How many items the operation processes.
+ */
+void LogProgressInitialize(TLogProgress *Pointer_Progress, const char *Pointer_String_Items_Name, int Items_Count);
+
+/** Tell that some items have been processed. The progress and the speed are displayed at most a few times per second.
+ * @param Pointer_Progress The operation progress.
+ * @param Items_Count How many items have just been processed.
+ * @param Bytes_Count How many bytes have just been processed.
+ * @note This function can be called from several threads at the same time.
+ */
+void LogProgressUpdate(TLogProgress *Pointer_Progress, int Items_Count, long long Bytes_Count);
+
+/** Display the operation overall speed.
+ * @param Pointer_Progress The finished operation progress.
+ */
+void LogProgressTerminate(TLogProgress *Pointer_Progress);
+
+#endif
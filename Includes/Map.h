@@ -5,13 +5,154 @@
 #ifndef H_MAP_H
 #define H_MAP_H
 
+#include <Unit_Index.h>
+
+//-------------------------------------------------------------------------------------------------
+// Constants
+//-------------------------------------------------------------------------------------------------
+/** The maximum length of a unit group name, the names are stored in a fixed width field. */
+#define MAP_UNIT_GROUP_NAME_MAXIMUM_LENGTH 32
+/** The maximum length of a unit type, the types are stored in a fixed width field. */
+#define MAP_UNIT_TYPE_MAXIMUM_LENGTH 24
+
+/** The default number of unit coordinates between two terrain vertices. This scale is an assumption taken from the synthetic benchmark maps, it has not been checked against the game maps yet, so it can be changed with the Coordinates_Per_Terrain_Vertex field of TMapUnits. */
+#define MAP_UNIT_COORDINATES_PER_TERRAIN_VERTEX 64
+
+//-------------------------------------------------------------------------------------------------
+// Types
+//-------------------------------------------------------------------------------------------------
+/** All supported terrain file formats. */
+typedef enum
+{
+	MAP_TERRAIN_FORMAT_OBJ, //!< Wavefront OBJ text file with quad faces.
+	MAP_TERRAIN_FORMAT_GLB, //!< Binary glTF 2.0 file.
+	MAP_TERRAIN_FORMAT_PLY, //!< Binary little-endian PLY file.
+	MAP_TERRAIN_FORMAT_NONE //!< Do not write the terrain geometry, when only the heightmap is needed.
+} TMapTerrainFormat;
+
+/** All supported heightmap raster formats. The rasters store the original signed 16-bit heights, the height in map units is the stored value divided by 300. */
+typedef enum
+{
+	MAP_HEIGHTMAP_FORMAT_NONE, //!< Do not write a heightmap.
+	MAP_HEIGHTMAP_FORMAT_RAW16, //!< Headerless signed 16-bit little-endian samples.
+	MAP_HEIGHTMAP_FORMAT_PGM, //!< Binary 16-bit PGM file. The format only supports unsigned big-endian samples, so 32768 is added to the heights.
+	MAP_HEIGHTMAP_FORMAT_TIFF16 //!< Baseline little-endian TIFF file with signed 16-bit samples.
+} TMapHeightmapFormat;
+
+/** Tell how to extract a map. */
+typedef struct
+{
+	TMapTerrainFormat Terrain_Format; //!< The terrain file format.
+	int Is_Triangle_Strips_Enabled; //!< Set to 1 to store the binary terrain faces as triangle strips instead of a triangles list, it is ignored by the OBJ format and by the simplified terrain.
+	float Terrain_Maximum_Error; //!< The largest allowed height error of the simplified terrain, or a negative value to keep one vertex per height.
+	int Terrain_Levels_Of_Detail_Count; //!< How many simplified terrain files to write, each level allows twice the error of the previous one.
+	int Terrain_Chunk_Tiles_Count; //!< Set to 0 to write the terrain to a single file, or to how many tiles per side a terrain chunk has to write each chunk to its own file.
+	int Jobs_Count; //!< How many threads can write the terrain chunks at the same time.
+	TMapHeightmapFormat Heightmap_Format; //!< The heightmap raster format. The raster comes with a JSON file describing how to convert the samples to heights.
+} TMapExtractionOptions;
+
+/** Where a record is stored in a map file. */
+typedef struct
+{
+	int Identifier; //!< The record identifier.
+	long long Offset; //!< The record header offset from the file beginning.
+	int Payload_Size; //!< The record payload size in bytes, without the record header.
+} TMapRecordInformation;
+
+/** The fixed part of a units record, which is followed by the units list. */
+typedef struct
+{
+	char String_Name[MAP_UNIT_GROUP_NAME_MAXIMUM_LENGTH + 1]; //!< The group name, it matches with a name in the units section of the map script file.
+	unsigned int Record_Type; //!< The units record type (0, 1 or 2).
+	unsigned int Units_List_Indices[2]; //!< The indices in the units list some record types have.
+	int Units_List_Indices_Count; //!< How many units list indices are valid.
+	unsigned int Units_Count; //!< How many units are in the group.
+} TMapUnitGroupInformation;
+
+/** All units of a map, stored as one array per unit property so the coordinates can be scanned without loading the other properties. */
+typedef struct
+{
+	int Units_Count; //!< How many units the map has.
+	unsigned int *Pointer_Coordinates_X; //!< The X coordinate of each unit.
+	unsigned int *Pointer_Coordinates_Y; //!< The Y coordinate of each unit.
+	unsigned int *Pointer_Coordinates_Z; //!< The Z coordinate of each unit.
+	int *Pointer_Group_Indices; //!< The group of each unit, as an index in Pointer_Unit_Groups. The units of a group are stored one after the other.
+	char (*Pointer_Strings_Types)[MAP_UNIT_TYPE_MAXIMUM_LENGTH + 1]; //!< The type of each unit, it matches with a name declared in the app/units file.
+	TMapUnitGroupInformation *Pointer_Unit_Groups; //!< All units records in file order.
+	int Unit_Groups_Count; //!< How many units records were found.
+	int Vertices_Per_Side; //!< How many terrain vertices per map side, or -1 if the map has no size record.
+	float *Pointer_Terrain_Heights; //!< The terrain heightmap, made of Vertices_Per_Side rows of Vertices_Per_Side heights, or NULL if the map has no size record.
+	double Coordinates_Per_Terrain_Vertex; //!< How many unit coordinates there are between two terrain vertices, it is set to MAP_UNIT_COORDINATES_PER_TERRAIN_VERTEX by MapReadUnits() and can be changed before calling MapGetTerrainHeight().
+	TUnitIndex Index; //!< Find the units close to a point.
+} TMapUnits;
+
+/** A map content summary, built from the records headers and the beginning of a few records. */
+typedef struct
+{
+	TMapRecordInformation *Pointer_Records; //!< All records in file order, including the end-of-file one.
+	int Records_Count; //!< How many records were found.
+	int Width; //!< The map width in tiles, or -1 if the map has no size record.
+	int Height; //!< The map height in tiles, or -1 if the map has no size record.
+	TMapUnitGroupInformation *Pointer_Unit_Groups; //!< All units records in file order.
+	int Unit_Groups_Count; //!< How many units records were found.
+} TMapInformation;
+
 //-------------------------------------------------------------------------------------------------
 // Functions
 //-------------------------------------------------------------------------------------------------
+/** Set the default extraction options : OBJ terrain with one vertex per height and no heightmap.
+ * @param Pointer_Options On output, contain the default options.
+ */
+void MapInitializeExtractionOptions(TMapExtractionOptions *Pointer_Options);
+
 /** Extract map assets into usable files.
- * @param Pointer_String_Map_File_Name The map file to process.
+ * @param Pointer_String_Map_File_Name The map file to process. A map stored in an IDP archive is read without extracting the archive when the archive file is followed by ':' and the map tag name, like "SCom.idp:app\\maps\\ema1".
  * @param Pointer_String_Output_Path On output, generated files will be stored to this path.
+ * @param Pointer_Options How to extract the map.
+ */
+int MapExtract(char *Pointer_String_Map_File_Name, char *Pointer_String_Output_Path, TMapExtractionOptions *Pointer_Options);
+
+/** Read the units and the terrain of a map, then index the units coordinates. No file is written.
+ * @param Pointer_String_Map_File_Name The map file to read, or an IDP archive map tag (see MapExtract()).
+ * @param Pointer_Units On output, contain the map units. Call MapFreeUnits() to release them when they are not used anymore.
+ * @return -1 if an error occurred,
+ * @return 0 on success.
+ */
+int MapReadUnits(const char *Pointer_String_Map_File_Name, TMapUnits *Pointer_Units);
+
+/** Get the terrain height at any location, interpolated from the four closest terrain vertices. The unit coordinates are converted to terrain vertex coordinates with the Coordinates_Per_Terrain_Vertex field of the units.
+ * @param Pointer_Units The map units and terrain.
+ * @param X The location X coordinate, in unit coordinates.
+ * @param Y The location Y coordinate, in unit coordinates.
+ * @param Pointer_Height On output, contain the terrain height.
+ * @return -1 if the map has no terrain or if the location is outside of the terrain,
+ * @return 0 on success.
+ */
+int MapGetTerrainHeight(TMapUnits *Pointer_Units, double X, double Y, float *Pointer_Height);
+
+/** Release the memory allocated by MapReadUnits().
+ * @param Pointer_Units The units to release.
+ */
+void MapFreeUnits(TMapUnits *Pointer_Units);
+
+/** Tell whether a file is a supported map file, by reading its header only.
+ * @param Pointer_String_File_Name The file to check.
+ * @return 1 if the file is a map,
+ * @return 0 if the file can't be read or is not a map.
+ */
+int MapIsMapFile(const char *Pointer_String_File_Name);
+
+/** Build a map table of contents. Only the records headers and the beginning of the size and units records are read, the other payloads are skipped.
+ * @param Pointer_String_Map_File_Name The map file to read.
+ * @param Pointer_Information On output, contain the map summary. Call MapFreeInformation() to release it when it is not used anymore.
+ * @return -1 if an error occurred,
+ * @return 0 on success.
+ */
+int MapReadInformation(const char *Pointer_String_Map_File_Name, TMapInformation *Pointer_Information);
+
+/** Release the memory allocated by MapReadInformation().
+ * @param Pointer_Information The summary to release.
  */
-int MapExtract(char *Pointer_String_Map_File_Name, char *Pointer_String_Output_Path);
+void MapFreeInformation(TMapInformation *Pointer_Information);
 
 #endif
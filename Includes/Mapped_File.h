@@ -0,0 +1,42 @@
+/** @file Mapped_File.h
+ * Map a whole file into the process address space to access its content without copying it.
+ * @author Adrien RICCIARDI
+ */
+#ifndef H_MAPPED_FILE_H
+#define H_MAPPED_FILE_H
+
+#include <stddef.h>
+
+//-------------------------------------------------------------------------------------------------
+// Types
+//-------------------------------------------------------------------------------------------------
+/** A read-only file mapping. */
+typedef struct
+{
+	unsigned char *Pointer_Data; //!< The file content. The memory is read-only, writing to it will crash the program. This pointer is NULL when the file is empty.
+	size_t Size; //!< The file size in bytes.
+#ifdef _WIN32
+	void *File_Handle; //!< The file handle, used internally.
+	void *Mapping_Handle; //!< The file mapping object handle, used internally.
+#else
+	int File_Descriptor; //!< The file descriptor, used internally.
+#endif
+} TMappedFile;
+
+//-------------------------------------------------------------------------------------------------
+// Functions
+//-------------------------------------------------------------------------------------------------
+/** Map the whole content of a file in memory.
+ * @param Pointer_String_File_Name The file to map.
+ * @param Pointer_Mapped_File On output, contain the mapped file. Call MappedFileClose() to release it when it is not used anymore.
+ * @return 0 if the file was successfully mapped,
+ * @return -1 if an error occurred.
+ */
+int MappedFileOpen(const char *Pointer_String_File_Name, TMappedFile *Pointer_Mapped_File);
+
+/** Unmap a file and release all associated resources.
+ * @param Pointer_Mapped_File The file to release.
+ */
+void MappedFileClose(TMappedFile *Pointer_Mapped_File);
+
+#endif
@@ -0,0 +1,82 @@
+/** @file Statistics.h
+ * Measure where the time is spent and how much I/O is done by a command, then write a JSON report. Nothing is measured until the statistics are enabled, so the instrumentation costs almost nothing in normal use.
+ * @author Adrien RICCIARDI
+ */
+#ifndef H_STATISTICS_H
+#define H_STATISTICS_H
+
+//-------------------------------------------------------------------------------------------------
+// Types
+//-------------------------------------------------------------------------------------------------
+/** All measured phases. */
+typedef enum
+{
+	STATISTICS_PHASE_IDP_DIRECTORY_PARSE, //!< Reading the IDP archive header and tags directory.
+	STATISTICS_PHASE_IDP_PAYLOAD_READ, //!< Reading the tags data (from the archive or from the files to pack).
+	STATISTICS_PHASE_IDP_DIRECTORY_CREATION, //!< Creating the directories the tag files are extracted to.
+	STATISTICS_PHASE_IDP_FILE_WRITE, //!< Creating, writing and closing the tag files (or the archive).
+	STATISTICS_PHASE_IDP_PAYLOAD_HASH, //!< Hashing the tags data to find the identical ones.
+	STATISTICS_PHASE_MAP_RECORD_PARSE, //!< Reading the map records and handling all records but the terrain one.
+	STATISTICS_PHASE_MAP_TERRAIN_DECODE, //!< Decoding the terrain record heights.
+	STATISTICS_PHASE_MAP_TERRAIN_SIMPLIFICATION, //!< Computing the terrain errors and building the simplified terrain meshes.
+	STATISTICS_PHASE_MAP_OBJ_WRITE, //!< Writing the terrain OBJ file.
+	STATISTICS_PHASE_MAP_HEIGHTMAP_WRITE, //!< Converting the heights to raster samples and writing the heightmap files.
+	STATISTICS_PHASE_MAP_UNITS_QUERY, //!< Finding the units close to the queried locations and displaying them.
+	STATISTICS_PHASES_COUNT
+} TStatisticsPhase;
+
+/** All event counters. */
+typedef enum
+{
+	STATISTICS_COUNTER_READ_BYTES, //!< How many bytes were read from files.
+	STATISTICS_COUNTER_WRITTEN_BYTES, //!< How many bytes were written to files.
+	STATISTICS_COUNTER_READ_CALLS, //!< How many C library read calls were done (they are buffered, so there are usually less operating system calls).
+	STATISTICS_COUNTER_WRITE_CALLS, //!< How many C library raw write calls were done (they are buffered, so there are usually less operating system calls). The formatted text writes are only counted in the written bytes.
+	STATISTICS_COUNTER_FILE_OPENINGS, //!< How many files were opened or created.
+	STATISTICS_COUNTER_FILE_MAPPINGS, //!< How many files were mapped in memory.
+	STATISTICS_COUNTER_DIRECTORY_CREATIONS, //!< How many directory creation system calls were done.
+	STATISTICS_COUNTER_PROCESS_LAUNCHES, //!< How many child processes were started.
+	STATISTICS_COUNTERS_COUNT
+} TStatisticsCounter;
+
+//-------------------------------------------------------------------------------------------------
+// Functions
+//-------------------------------------------------------------------------------------------------
+/** Start measuring, the command total time starts now. */
+void StatisticsEnable(void);
+
+/** Get a high resolution monotonic time.
+ * @return The time in seconds, from an unspecified origin.
+ * @note This function works even if the statistics are not enabled.
+ */
+double StatisticsGetTime(void);
+
+/** Add the time elapsed since a phase started to the phase total time.
+ * @param Phase The phase.
+ * @param Start_Time When the phase started, returned by StatisticsGetTime().
+ * @note This function can be called from several threads at the same time, the phase total time is then the sum of the time spent by all threads.
+ */
+void StatisticsAddPhaseTime(TStatisticsPhase Phase, double Start_Time);
+
+/** Add a value to a counter.
+ * @param Counter The counter.
+ * @param Value The value to add.
+ * @note This function can be called from several threads at the same time.
+ */
+void StatisticsAddCounter(TStatisticsCounter Counter, long long Value);
+
+/** Tell that a map record has been found, to build the records identifier histogram.
+ * @param Record_Identifier The record identifier.
+ */
+void StatisticsAddMapRecord(int Record_Identifier);
+
+/** Write all measures to a JSON file. Nothing is done if the statistics are not enabled.
+ * @param Pointer_String_File The report file, it is overwritten.
+ * @param Pointer_String_Command The command that was run.
+ * @param Exit_Status The command exit status.
+ * @return -1 if the report could not be written,
+ * @return 0 on success.
+ */
+int StatisticsWriteReport(const char *Pointer_String_File, const char *Pointer_String_Command, int Exit_Status);
+
+#endif
@@ -0,0 +1,60 @@
+/** @file Terrain_Simplifier.h
+ * Build a terrain mesh with less triangles than the heightmap grid, while keeping the height error under a limit. The heightmap is covered by a hierarchy of right triangles (a right-triangulated irregular network), each triangle being split in two at its hypotenuse middle. A triangle is split only when the height of its hypotenuse middle vertex, or of any vertex removed inside it, is too far from the interpolated height. Neighbor triangles always share their vertices, so the mesh has no cracks.
+ * @author Adrien RICCIARDI
+ */
+#ifndef H_TERRAIN_SIMPLIFIER_H
+#define H_TERRAIN_SIMPLIFIER_H
+
+//-------------------------------------------------------------------------------------------------
+// Types
+//-------------------------------------------------------------------------------------------------
+/** The errors of a heightmap, computed once to build meshes with different error limits. */
+typedef struct
+{
+	const float *Pointer_Heights; //!< The heightmap, made of Vertices_Per_Side rows of Vertices_Per_Side heights.
+	int Vertices_Per_Side; //!< How many vertices per heightmap side.
+	int Grid_Size; //!< The triangles hierarchy covers a square of this size, it is the smallest power of two the heightmap fits in.
+	float *Pointer_Errors; //!< The error of each vertex of the (Grid_Size + 1) * (Grid_Size + 1) square, the vertices outside of the heightmap are never used.
+} TTerrainSimplifier;
+
+/** A simplified terrain mesh. */
+typedef struct
+{
+	unsigned int *Pointer_Vertices; //!< The heightmap index (Y * Vertices_Per_Side + X) of each mesh vertex.
+	int Vertices_Count; //!< How many vertices the mesh has.
+	unsigned int *Pointer_Indices; //!< Each triangle is made of 3 mesh vertex indices, with the same orientation as the full resolution faces.
+	int Triangles_Count; //!< How many triangles the mesh has.
+} TTerrainMesh;
+
+//-------------------------------------------------------------------------------------------------
+// Functions
+//-------------------------------------------------------------------------------------------------
+/** Compute the error of all heightmap vertices.
+ * @param Pointer_Simplifier The simplifier to initialize.
+ * @param Pointer_Heights The heightmap, it must stay valid until the simplifier is freed.
+ * @param Vertices_Per_Side How many vertices per heightmap side, it must be 2 or more.
+ * @return -1 if an error occurred,
+ * @return 0 on success.
+ */
+int TerrainSimplifierInitialize(TTerrainSimplifier *Pointer_Simplifier, const float *Pointer_Heights, int Vertices_Per_Side);
+
+/** Build the mesh with the less triangles that stays within an error limit.
+ * @param Pointer_Simplifier The initialized simplifier.
+ * @param Maximum_Error The largest allowed height difference between a removed vertex and the mesh. Use 0 to only remove the vertices that are exactly interpolated.
+ * @param Pointer_Mesh On output, contain the mesh. Call TerrainSimplifierFreeMesh() to release it when it is not used anymore.
+ * @return -1 if an error occurred,
+ * @return 0 on success.
+ */
+int TerrainSimplifierBuildMesh(TTerrainSimplifier *Pointer_Simplifier, float Maximum_Error, TTerrainMesh *Pointer_Mesh);
+
+/** Release the memory allocated by TerrainSimplifierBuildMesh().
+ * @param Pointer_Mesh The mesh to release.
+ */
+void TerrainSimplifierFreeMesh(TTerrainMesh *Pointer_Mesh);
+
+/** Release the memory allocated by TerrainSimplifierInitialize().
+ * @param Pointer_Simplifier The simplifier to release.
+ */
+void TerrainSimplifierFree(TTerrainSimplifier *Pointer_Simplifier);
+
+#endif
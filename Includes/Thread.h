@@ -0,0 +1,82 @@
+/** @file Thread.h
+ * Minimal portable threading primitives used to spread work over several processor cores.
+ * @author Adrien RICCIARDI
+ */
+#ifndef H_THREAD_H
+#define H_THREAD_H
+
+#ifdef _WIN32
+	#include <Windows.h>
+#else
+	#include <pthread.h>
+#endif
+
+//-------------------------------------------------------------------------------------------------
+// Constants
+//-------------------------------------------------------------------------------------------------
+/** The maximum amount of worker threads that can be requested. */
+#define THREAD_MAXIMUM_WORKERS_COUNT 64
+
+//-------------------------------------------------------------------------------------------------
+// Types
+//-------------------------------------------------------------------------------------------------
+/** A mutual exclusion lock. */
+typedef struct
+{
+#ifdef _WIN32
+	CRITICAL_SECTION Critical_Section; //!< The Windows lock, used internally.
+#else
+	pthread_mutex_t Mutex; //!< The POSIX lock, used internally.
+#endif
+} TThreadMutex;
+
+/** The function called for each item by ThreadParallelFor().
+ * @param Pointer_Context The context given to ThreadParallelFor().
+ * @param Item_Index The item to process.
+ * @param Worker_Index The index of the worker calling the function, starting from 0. It allows to use per-worker resources without locking.
+ * @return -1 if an error occurred, in this case no more item is started,
+ * @return 0 on success.
+ */
+typedef int (*TThreadParallelForFunction)(void *Pointer_Context, int Item_Index, int Worker_Index);
+
+//-------------------------------------------------------------------------------------------------
+// Functions
+//-------------------------------------------------------------------------------------------------
+/** Call a function for all items from 0 to Items_Count - 1 using several worker threads. Items are started in increasing index order, so the caller can order the items to improve the scheduling.
+ * @param Workers_Count How many worker threads to use. With a single worker, all items are processed by the calling thread.
+ * @param Items_Count How many items to process.
+ * @param Function The function to call for each item. It must be thread-safe.
+ * @param Pointer_Context A value passed as is to the function.
+ * @return -1 if a worker could not be started or if the function failed for an item,
+ * @return 0 if all items were successfully processed.
+ */
+int ThreadParallelFor(int Workers_Count, int Items_Count, TThreadParallelForFunction Function, void *Pointer_Context);
+
+/** Atomically add a value to an integer shared between threads.
+ * @param Pointer_Value The integer to modify.
+ * @param Increment The value to add.
+ * @return The integer value before the addition.
+ */
+int ThreadAtomicAdd(volatile int *Pointer_Value, int Increment);
+
+/** Initialize a mutex.
+ * @param Pointer_Mutex The mutex to initialize.
+ */
+void ThreadMutexInitialize(TThreadMutex *Pointer_Mutex);
+
+/** Wait until the mutex is available, then take it.
+ * @param Pointer_Mutex The mutex to take.
+ */
+void ThreadMutexLock(TThreadMutex *Pointer_Mutex);
+
+/** Release a mutex taken with ThreadMutexLock().
+ * @param Pointer_Mutex The mutex to release.
+ */
+void ThreadMutexUnlock(TThreadMutex *Pointer_Mutex);
+
+/** Release all resources allocated by ThreadMutexInitialize().
+ * @param Pointer_Mutex The mutex to destroy.
+ */
+void ThreadMutexDestroy(TThreadMutex *Pointer_Mutex);
+
+#endif
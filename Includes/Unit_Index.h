@@ -0,0 +1,61 @@
+/** @file Unit_Index.h
+ * Find the units close to a point without testing all units. The map plane is divided in a uniform grid of square cells, and the units are sorted by cell, so a query only tests the units of the cells the search circle overlaps.
+ * @author Adrien RICCIARDI
+ */
+#ifndef H_UNIT_INDEX_H
+#define H_UNIT_INDEX_H
+
+//-------------------------------------------------------------------------------------------------
+// Types
+//-------------------------------------------------------------------------------------------------
+/** A grid index over units coordinates. */
+typedef struct
+{
+	const unsigned int *Pointer_Coordinates_X; //!< The X coordinate of each unit, it must stay valid until the index is freed.
+	const unsigned int *Pointer_Coordinates_Y; //!< The Y coordinate of each unit, it must stay valid until the index is freed.
+	int Units_Count; //!< How many units are indexed.
+	unsigned int Minimum_X; //!< The grid left border, it is the smallest unit X coordinate.
+	unsigned int Minimum_Y; //!< The grid top border, it is the smallest unit Y coordinate.
+	unsigned int Cell_Size; //!< A cell side length in map coordinates.
+	int Columns_Count; //!< How many cells per grid row.
+	int Rows_Count; //!< How many cells per grid column.
+	int *Pointer_Cells_First_Indices; //!< Where the units of each cell start in Pointer_Units_Indices, followed by the units count (so the cell units end at the next cell first index).
+	int *Pointer_Units_Indices; //!< The unit indices, sorted by cell.
+} TUnitIndex;
+
+/** A unit found by a query. */
+typedef struct
+{
+	int Unit_Index; //!< The unit index in the indexed coordinates arrays.
+	double Distance; //!< The distance between the unit and the query center.
+} TUnitIndexResult;
+
+//-------------------------------------------------------------------------------------------------
+// Functions
+//-------------------------------------------------------------------------------------------------
+/** Build the grid index of a set of units.
+ * @param Pointer_Index The index to initialize.
+ * @param Pointer_Coordinates_X The X coordinate of each unit.
+ * @param Pointer_Coordinates_Y The Y coordinate of each unit.
+ * @param Units_Count How many units to index, it can be 0.
+ * @return -1 if an error occurred,
+ * @return 0 on success.
+ */
+int UnitIndexInitialize(TUnitIndex *Pointer_Index, const unsigned int *Pointer_Coordinates_X, const unsigned int *Pointer_Coordinates_Y, int Units_Count);
+
+/** Find all units whose horizontal distance to a point is lower than or equal to a radius.
+ * @param Pointer_Index The index to search.
+ * @param X The search circle center X coordinate.
+ * @param Y The search circle center Y coordinate.
+ * @param Radius The search circle radius.
+ * @param Pointer_Results On output, contain the found units sorted by increasing distance (the units at the same distance are sorted by index). The array must be able to store all indexed units.
+ * @return How many units were found.
+ */
+int UnitIndexFind(TUnitIndex *Pointer_Index, double X, double Y, double Radius, TUnitIndexResult *Pointer_Results);
+
+/** Release the memory allocated by UnitIndexInitialize().
+ * @param Pointer_Index The index to release.
+ */
+void UnitIndexFree(TUnitIndex *Pointer_Index);
+
+#endif
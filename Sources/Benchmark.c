@@ -0,0 +1,477 @@
+/** @file Benchmark.c
+ * See Benchmark.h for description.
+ * @author Adrien RICCIARDI
+ */
+#include <Benchmark.h>
+#include <errno.h>
+#include <File_System.h>
+#include <IDP_Archive.h>
+#include <IDP_Reader.h>
+#include <Log.h>
+#include <Map.h>
+#include <Statistics.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//-------------------------------------------------------------------------------------------------
+// Private constants
+//-------------------------------------------------------------------------------------------------
+/** How many tags the benchmark archive contains. */
+#define BENCHMARK_IDP_ARCHIVE_TAGS_COUNT 1000
+/** The benchmark archive smallest tag size in bytes. */
+#define BENCHMARK_IDP_ARCHIVE_MINIMUM_TAG_SIZE 16
+/** The benchmark archive largest tag size in bytes. */
+#define BENCHMARK_IDP_ARCHIVE_MAXIMUM_TAG_SIZE (1024 * 1024)
+/** The IDP reader cache size in bytes, it is smaller than the benchmark archive so the cache evicts tags. */
+#define BENCHMARK_IDP_READER_CACHE_SIZE (16 * 1024 * 1024)
+
+/** The benchmark map width and height in tiles. */
+#define BENCHMARK_MAP_TILES_PER_SIDE 64
+/** How many unit groups the benchmark map contains. */
+#define BENCHMARK_MAP_UNIT_GROUPS_COUNT 32
+/** How many units each benchmark map unit group contains. */
+#define BENCHMARK_MAP_UNITS_PER_GROUP_COUNT 8
+
+/** The seed used to generate all benchmark files, so all runs measure the same data. */
+#define BENCHMARK_SEED 1
+
+/** How many vertices per side of a map tile, it must match the Map module value. */
+#define BENCHMARK_MAP_VERTICES_PER_TILE_SIDE 16
+
+//-------------------------------------------------------------------------------------------------
+// Private types
+//-------------------------------------------------------------------------------------------------
+/** A function to measure.
+ * @param Pointer_Context The benchmark context.
+ * @return -1 if an error occurred,
+ * @return 0 on success.
+ */
+typedef int (*TBenchmarkFunction)(void *Pointer_Context);
+
+/** Everything the measured functions need. */
+typedef struct
+{
+	char *Pointer_String_Program_File; //!< This program executable.
+	char String_IDP_File[1024]; //!< The synthetic archive.
+	char String_IDP_Output_Directory[1024]; //!< Where to extract the synthetic archive.
+	char String_Map_File[1024]; //!< The synthetic map.
+	char String_Map_Output_Directory[1024]; //!< Where to extract the synthetic map.
+} TBenchmarkContext;
+
+//-------------------------------------------------------------------------------------------------
+// Private functions
+//-------------------------------------------------------------------------------------------------
+/** A small and fast pseudo-random generator (xorshift), so the generated files do not depend on the C library rand() implementation.
+ * @param Pointer_State The generator state, it must not be zero.
+ * @return A pseudo-random value.
+ */
+static unsigned int BenchmarkGetRandomNumber(unsigned int *Pointer_State)
+{
+	unsigned int State = *Pointer_State;
+
+	State ^= State << 13;
+	State ^= State >> 17;
+	State ^= State << 5;
+	*Pointer_State = State;
+	return State;
+}
+
+/** Write a 32-bit value to a file.
+ * @param Pointer_File The file to write to.
+ * @param Value The value to write.
+ * @return -1 if an error occurred,
+ * @return 0 on success.
+ */
+static int BenchmarkWriteDoubleWord(FILE *Pointer_File, int Value)
+{
+	if (fwrite(&Value, 1, 4, Pointer_File) != 4) return -1;
+	return 0;
+}
+
+/** Write a zero-padded string to a file.
+ * @param Pointer_File The file to write to.
+ * @param Pointer_String The string to write, it must be shorter than the field.
+ * @param Field_Size The field size in bytes.
+ * @return -1 if an error occurred,
+ * @return 0 on success.
+ */
+static int BenchmarkWriteStringField(FILE *Pointer_File, const char *Pointer_String, int Field_Size)
+{
+	char String_Field[64];
+
+	memset(String_Field, 0, sizeof(String_Field));
+	strncpy(String_Field, Pointer_String, Field_Size - 1);
+	if (fwrite(String_Field, 1, Field_Size, Pointer_File) != (size_t) Field_Size) return -1;
+	return 0;
+}
+
+/** Run the IDPArchiveRead() benchmark.
+ * @param Pointer_Context The benchmark context.
+ * @return -1 if an error occurred,
+ * @return 0 on success.
+ */
+static int BenchmarkIDPArchiveRead(void *Pointer_Context)
+{
+	TBenchmarkContext *Pointer_Benchmark_Context = Pointer_Context;
+	TIDPArchiveTag *Pointer_Tags;
+	int Tags_Count;
+
+	if (IDPArchiveRead(Pointer_Benchmark_Context->String_IDP_File, &Pointer_Tags, &Tags_Count) != 0) return -1;
+	IDPArchiveFreeBuffer(Pointer_Tags, Tags_Count);
+	return 0;
+}
+
+/** Run the IDP reader benchmark. Each tag is found by name and fully read, which misses the cache, then it is read again by quarters, which hits the cache.
+ * @param Pointer_Context The benchmark context.
+ * @return -1 if an error occurred,
+ * @return 0 on success.
+ */
+static int BenchmarkIDPReaderRead(void *Pointer_Context)
+{
+	TBenchmarkContext *Pointer_Benchmark_Context = Pointer_Context;
+	TIDPReader Reader;
+	unsigned char *Pointer_Buffer;
+	int i, j, Tag_Index, Quarter_Size, Return_Value = -1;
+
+	if (IDPReaderOpen(Pointer_Benchmark_Context->String_IDP_File, BENCHMARK_IDP_READER_CACHE_SIZE, &Reader) != 0) return -1;
+	Pointer_Buffer = malloc(BENCHMARK_IDP_ARCHIVE_MAXIMUM_TAG_SIZE);
+	if (Pointer_Buffer == NULL)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to allocate the IDP reader benchmark buffer (%s).\n", strerror(errno));
+		goto Exit;
+	}
+
+	for (i = 0; i < Reader.Archive.Tags_Count; i++)
+	{
+		Tag_Index = IDPReaderFindTag(&Reader, Reader.Archive.Pointer_Tags[i].Pointer_String_Name);
+		if (Tag_Index < 0) goto Exit;
+		if (IDPReaderReadTag(&Reader, Tag_Index, 0, Pointer_Buffer, Reader.Archive.Pointer_Tags[Tag_Index].Data_Size) != 0) goto Exit;
+
+		Quarter_Size = Reader.Archive.Pointer_Tags[Tag_Index].Data_Size / 4;
+		for (j = 0; j < 4; j++)
+		{
+			if (IDPReaderReadTag(&Reader, Tag_Index, j * Quarter_Size, Pointer_Buffer, Quarter_Size) != 0) goto Exit;
+		}
+	}
+	Return_Value = 0;
+
+Exit:
+	free(Pointer_Buffer);
+	IDPReaderClose(&Reader);
+	return Return_Value;
+}
+
+/** Run the IDP extraction command benchmark. The command is run in a new process, so the measured time is the time a user would wait for.
+ * @param Pointer_Context The benchmark context.
+ * @return -1 if an error occurred,
+ * @return 0 on success.
+ */
+static int BenchmarkIDPExtract(void *Pointer_Context)
+{
+	TBenchmarkContext *Pointer_Benchmark_Context = Pointer_Context;
+	char String_Command[4096];
+
+	// The Windows shell removes the first and the last quotes of the command, so surround the command with quotes
+#ifdef _WIN32
+	snprintf(String_Command, sizeof(String_Command), "\"\"%s\" --quiet -idp-extract \"%s\" \"%s\"\"", Pointer_Benchmark_Context->Pointer_String_Program_File, Pointer_Benchmark_Context->String_IDP_File, Pointer_Benchmark_Context->String_IDP_Output_Directory);
+#else
+	snprintf(String_Command, sizeof(String_Command), "\"%s\" --quiet -idp-extract \"%s\" \"%s\"", Pointer_Benchmark_Context->Pointer_String_Program_File, Pointer_Benchmark_Context->String_IDP_File, Pointer_Benchmark_Context->String_IDP_Output_Directory);
+#endif
+	StatisticsAddCounter(STATISTICS_COUNTER_PROCESS_LAUNCHES, 1);
+	if (system(String_Command) != 0)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : the IDP extraction command failed.\n");
+		return -1;
+	}
+	return 0;
+}
+
+/** Run the MapExtract() benchmark, it includes the terrain OBJ file generation.
+ * @param Pointer_Context The benchmark context.
+ * @return -1 if an error occurred,
+ * @return 0 on success.
+ */
+static int BenchmarkMapExtract(void *Pointer_Context)
+{
+	TBenchmarkContext *Pointer_Benchmark_Context = Pointer_Context;
+	TMapExtractionOptions Options;
+
+	MapInitializeExtractionOptions(&Options);
+	return MapExtract(Pointer_Benchmark_Context->String_Map_File, Pointer_Benchmark_Context->String_Map_Output_Directory, &Options);
+}
+
+/** Measure a function and write the result to the report.
+ * @param Pointer_File_Report The JSON report.
+ * @param Pointer_String_Name The benchmark name.
+ * @param Function The function to measure.
+ * @param Pointer_Context The function context.
+ * @param Iterations_Count How many times to run the function.
+ * @param Processed_Bytes_Count How many bytes the function processes, used to compute the throughput.
+ * @param Is_Last_Benchmark Set to 1 if this is the last benchmark of the report, so the JSON array is correctly terminated.
+ * @return -1 if an error occurred,
+ * @return 0 on success.
+ */
+static int BenchmarkMeasure(FILE *Pointer_File_Report, const char *Pointer_String_Name, TBenchmarkFunction Function, void *Pointer_Context, int Iterations_Count, long long Processed_Bytes_Count, int Is_Last_Benchmark)
+{
+	TLogLevel Log_Level;
+	double Start_Time, Time, Best_Time = 0, Total_Time = 0;
+	int i, Result = 0;
+
+	LogPrint(LOG_LEVEL_INFORMATION, "Running the %s benchmark %d times.\n", Pointer_String_Name, Iterations_Count);
+
+	// Do not measure the time needed to display the messages of the measured function
+	Log_Level = LogGetLevel();
+	LogSetLevel(LOG_LEVEL_WARNING);
+	for (i = 0; i < Iterations_Count; i++)
+	{
+		Start_Time = StatisticsGetTime();
+		Result = Function(Pointer_Context);
+		Time = StatisticsGetTime() - Start_Time;
+		if (Result != 0) break;
+
+		if ((i == 0) || (Time < Best_Time)) Best_Time = Time;
+		Total_Time += Time;
+	}
+	LogSetLevel(Log_Level);
+	if (Result != 0)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : the %s benchmark failed.\n", Pointer_String_Name);
+		return -1;
+	}
+	if (Best_Time <= 0) Best_Time = 0.000001; // Avoid a division by zero with a very coarse timer
+
+	LogPrint(LOG_LEVEL_INFORMATION, "Benchmark %s : best time %.3f s, mean time %.3f s, best throughput %.1f MB/s.\n", Pointer_String_Name, Best_Time, Total_Time / Iterations_Count, Processed_Bytes_Count / Best_Time / (1024.0 * 1024.0));
+	fprintf(Pointer_File_Report, "\t\t{\"name\": \"%s\", \"bytes\": %lld, \"best_seconds\": %.6f, \"mean_seconds\": %.6f, \"best_megabytes_per_second\": %.3f}%s\n", Pointer_String_Name, Processed_Bytes_Count, Best_Time, Total_Time / Iterations_Count, Processed_Bytes_Count / Best_Time / (1024.0 * 1024.0), Is_Last_Benchmark ? "" : ",");
+	return 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+// Public functions
+//-------------------------------------------------------------------------------------------------
+int BenchmarkGenerateIDPArchive(char *Pointer_String_Output_File, int Tags_Count, int Minimum_Tag_Size, int Maximum_Tag_Size, unsigned int Seed)
+{
+	static const char *Pointer_Strings_Directories[] = {"app", "app\\maps", "app\\scripts", "app\\sounds\\fx", "app\\textures\\units"};
+	static const char *Pointer_Strings_Extensions[] = {"txt", "wav", "tga", "bin"};
+	TIDPArchiveTag *Pointer_Tags = NULL;
+	FILE *Pointer_File = NULL;
+	unsigned int Random_State, Random_Number;
+	int i, Minimum_Bits_Count = 0, Maximum_Bits_Count = 0, Bits_Count, Size, Write_Size, Return_Value = -1;
+	long long Data_Size = 0;
+	char String_Tag_Name[128];
+	unsigned char Buffer[4096];
+
+	if ((Tags_Count < 0) || (Minimum_Tag_Size < 0) || (Maximum_Tag_Size < Minimum_Tag_Size))
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : invalid synthetic archive parameters.\n");
+		return -1;
+	}
+	Random_State = Seed != 0 ? Seed : 1; // The generator state must not be zero
+
+	// Compute the tags size range in powers of two
+	while ((1LL << Minimum_Bits_Count) < Minimum_Tag_Size) Minimum_Bits_Count++;
+	while ((1LL << Maximum_Bits_Count) < Maximum_Tag_Size) Maximum_Bits_Count++;
+
+	Pointer_Tags = calloc(Tags_Count + 1, sizeof(TIDPArchiveTag)); // Make sure to allocate something for empty archives
+	if (Pointer_Tags == NULL)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to allocate the tags list (%s).\n", strerror(errno));
+		return -1;
+	}
+
+	// Choose the tag names and sizes, the size order of magnitude is uniformly distributed
+	for (i = 0; i < Tags_Count; i++)
+	{
+		Random_Number = BenchmarkGetRandomNumber(&Random_State);
+		snprintf(String_Tag_Name, sizeof(String_Tag_Name), "%s\\file%d.%s", Pointer_Strings_Directories[Random_Number % 5], i, Pointer_Strings_Extensions[(Random_Number >> 8) % 4]);
+		Pointer_Tags[i].Pointer_String_Name = malloc(strlen(String_Tag_Name) + 1);
+		if (Pointer_Tags[i].Pointer_String_Name == NULL)
+		{
+			LogPrint(LOG_LEVEL_ERROR, "Error : failed to allocate tag %d name (%s).\n", i, strerror(errno));
+			goto Exit;
+		}
+		strcpy(Pointer_Tags[i].Pointer_String_Name, String_Tag_Name);
+
+		Bits_Count = Minimum_Bits_Count + (int) (BenchmarkGetRandomNumber(&Random_State) % (Maximum_Bits_Count - Minimum_Bits_Count + 1));
+		Size = (int) ((1LL << Bits_Count) / 2 + BenchmarkGetRandomNumber(&Random_State) % ((1LL << Bits_Count) / 2 + 1));
+		if (Size < Minimum_Tag_Size) Size = Minimum_Tag_Size;
+		if (Size > Maximum_Tag_Size) Size = Maximum_Tag_Size;
+
+		if (Data_Size + Size > 0x7FFFFFFF - 0x10000000) // Keep room for the tags directory
+		{
+			LogPrint(LOG_LEVEL_ERROR, "Error : the synthetic archive would be too large.\n");
+			goto Exit;
+		}
+		Pointer_Tags[i].Data_Offset = (int) Data_Size;
+		Pointer_Tags[i].Data_Size = Size;
+		Data_Size += Size;
+	}
+
+	// Write the archive
+	Pointer_File = fopen(Pointer_String_Output_File, "wb");
+	if (Pointer_File == NULL)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to create the IDP file '%s' (%s).\n", Pointer_String_Output_File, strerror(errno));
+		goto Exit;
+	}
+	if (IDPArchiveWriteDirectory(Pointer_File, Pointer_Tags, Tags_Count) != 0) goto Exit;
+	for (i = 0; i < Tags_Count; i++)
+	{
+		for (Size = 0; Size < Pointer_Tags[i].Data_Size; Size += (int) sizeof(Buffer))
+		{
+			// Use a different content for each buffer, so identical data can't be detected
+			Random_Number = BenchmarkGetRandomNumber(&Random_State);
+			memset(Buffer, Random_Number & 0xFF, sizeof(Buffer));
+			memcpy(Buffer, &Random_Number, sizeof(Random_Number));
+			Write_Size = Pointer_Tags[i].Data_Size - Size;
+			if (Write_Size > (int) sizeof(Buffer)) Write_Size = sizeof(Buffer);
+			if (fwrite(Buffer, 1, Write_Size, Pointer_File) != (size_t) Write_Size)
+			{
+				LogPrint(LOG_LEVEL_ERROR, "Error : failed to write tag %d data (%s).\n", i, strerror(errno));
+				goto Exit;
+			}
+		}
+	}
+	LogPrint(LOG_LEVEL_INFORMATION, "Generated an IDP archive of %d tags containing %lld bytes of data.\n", Tags_Count, Data_Size);
+	Return_Value = 0;
+
+Exit:
+	if ((Pointer_File != NULL) && (fclose(Pointer_File) != 0))
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to write the IDP file '%s' (%s).\n", Pointer_String_Output_File, strerror(errno));
+		Return_Value = -1;
+	}
+	for (i = 0; i < Tags_Count; i++)
+	{
+		if (Pointer_Tags[i].Pointer_String_Name != NULL) free(Pointer_Tags[i].Pointer_String_Name);
+	}
+	free(Pointer_Tags);
+	return Return_Value;
+}
+
+int BenchmarkGenerateMap(char *Pointer_String_Output_File, int Tiles_Per_Side, int Unit_Groups_Count, int Units_Per_Group_Count, unsigned int Seed)
+{
+	FILE *Pointer_File;
+	unsigned int Random_State;
+	int Vertices_Per_Side, Tile_Starting_Offset, Vertex_X, Vertex_Y, i, j, Return_Value = -1;
+	short Vertex[4] = {0, 0, 0, 0};
+	char String_Name[32];
+
+	if ((Tiles_Per_Side < 1) || (Tiles_Per_Side >= 100) || (Unit_Groups_Count < 0) || (Units_Per_Group_Count < 0))
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : invalid synthetic map parameters (the map size must be from 1 to 99 tiles).\n");
+		return -1;
+	}
+	Random_State = Seed != 0 ? Seed : 1; // The generator state must not be zero
+	Vertices_Per_Side = Tiles_Per_Side * BENCHMARK_MAP_VERTICES_PER_TILE_SIDE;
+
+	Pointer_File = fopen(Pointer_String_Output_File, "wb");
+	if (Pointer_File == NULL)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to create the map file '%s' (%s).\n", Pointer_String_Output_File, strerror(errno));
+		return -1;
+	}
+
+	// Header
+	if ((fwrite("IDWD", 1, 4, Pointer_File) != 4) || (BenchmarkWriteDoubleWord(Pointer_File, 0x66) != 0)) goto Exit;
+
+	// Map size record, the record size includes the identifier and size fields
+	if ((BenchmarkWriteDoubleWord(Pointer_File, 1) != 0) || (BenchmarkWriteDoubleWord(Pointer_File, 8 + 8) != 0) || (BenchmarkWriteDoubleWord(Pointer_File, Tiles_Per_Side) != 0) || (BenchmarkWriteDoubleWord(Pointer_File, Tiles_Per_Side) != 0)) goto Exit;
+
+	// Terrain record, stored tile column by tile column like the Map module expects, each vertex is 8 bytes long and starts with the height
+	if ((BenchmarkWriteDoubleWord(Pointer_File, 2) != 0) || (BenchmarkWriteDoubleWord(Pointer_File, 8 + 4 + Vertices_Per_Side * Vertices_Per_Side * 8) != 0) || (BenchmarkWriteDoubleWord(Pointer_File, 0) != 0)) goto Exit;
+	for (Tile_Starting_Offset = 0; Tile_Starting_Offset < Vertices_Per_Side; Tile_Starting_Offset += BENCHMARK_MAP_VERTICES_PER_TILE_SIDE)
+	{
+		for (Vertex_Y = 0; Vertex_Y < Vertices_Per_Side; Vertex_Y++)
+		{
+			for (Vertex_X = Tile_Starting_Offset; Vertex_X < Tile_Starting_Offset + BENCHMARK_MAP_VERTICES_PER_TILE_SIDE; Vertex_X++)
+			{
+				// Make gentle slopes with a little noise, so the heights have various float representations
+				Vertex[0] = (short) ((Vertex_X * 37 + Vertex_Y * 91) % 6000 - 3000 + (int) (BenchmarkGetRandomNumber(&Random_State) % 64));
+				if (fwrite(Vertex, 1, sizeof(Vertex), Pointer_File) != sizeof(Vertex)) goto Exit;
+			}
+		}
+	}
+
+	// Unit group records with the "record type 0" layout
+	for (i = 0; i < Unit_Groups_Count; i++)
+	{
+		if ((BenchmarkWriteDoubleWord(Pointer_File, 7) != 0) || (BenchmarkWriteDoubleWord(Pointer_File, 8 + 32 + 8 + 4 + Units_Per_Group_Count * (24 + 12 + 3 * 8)) != 0)) goto Exit;
+		snprintf(String_Name, sizeof(String_Name), "group%d", i);
+		if ((BenchmarkWriteStringField(Pointer_File, String_Name, 32) != 0) || (BenchmarkWriteDoubleWord(Pointer_File, 0) != 0) || (BenchmarkWriteDoubleWord(Pointer_File, 7) != 0) || (BenchmarkWriteDoubleWord(Pointer_File, Units_Per_Group_Count) != 0)) goto Exit;
+
+		for (j = 0; j < Units_Per_Group_Count; j++)
+		{
+			if ((BenchmarkWriteStringField(Pointer_File, (j % 2) == 0 ? "GADTank" : "Jeep", 24) != 0) || (BenchmarkWriteStringField(Pointer_File, "", 12) != 0)) goto Exit;
+			// Each coordinate is followed by 4 unknown bytes
+			if ((BenchmarkWriteDoubleWord(Pointer_File, (int) (BenchmarkGetRandomNumber(&Random_State) % (Vertices_Per_Side * MAP_UNIT_COORDINATES_PER_TERRAIN_VERTEX))) != 0) || (BenchmarkWriteDoubleWord(Pointer_File, 0) != 0)) goto Exit;
+			if ((BenchmarkWriteDoubleWord(Pointer_File, (int) (BenchmarkGetRandomNumber(&Random_State) % (Vertices_Per_Side * MAP_UNIT_COORDINATES_PER_TERRAIN_VERTEX))) != 0) || (BenchmarkWriteDoubleWord(Pointer_File, 0) != 0)) goto Exit;
+			if ((BenchmarkWriteDoubleWord(Pointer_File, (int) (BenchmarkGetRandomNumber(&Random_State) % 4096)) != 0) || (BenchmarkWriteDoubleWord(Pointer_File, 0) != 0)) goto Exit;
+		}
+	}
+
+	// End-of-file record
+	if ((BenchmarkWriteDoubleWord(Pointer_File, 4097) != 0) || (BenchmarkWriteDoubleWord(Pointer_File, 8) != 0)) goto Exit;
+
+	LogPrint(LOG_LEVEL_INFORMATION, "Generated a map of %dx%d tiles with %d unit groups.\n", Tiles_Per_Side, Tiles_Per_Side, Unit_Groups_Count);
+	Return_Value = 0;
+
+Exit:
+	if (fclose(Pointer_File) != 0) Return_Value = -1;
+	if (Return_Value != 0) LogPrint(LOG_LEVEL_ERROR, "Error : failed to write the map file '%s' (%s).\n", Pointer_String_Output_File, strerror(errno));
+	return Return_Value;
+}
+
+int BenchmarkRun(char *Pointer_String_Program_File, char *Pointer_String_Work_Directory, int Iterations_Count, char *Pointer_String_Report_File)
+{
+	TBenchmarkContext Context;
+	FILE *Pointer_File_Report = stdout;
+	long long IDP_File_Size, Map_File_Size, Modification_Time;
+	int Return_Value = -1;
+
+	// Generate the synthetic files
+	Context.Pointer_String_Program_File = Pointer_String_Program_File;
+	snprintf(Context.String_IDP_File, sizeof(Context.String_IDP_File), "%s/Benchmark.idp", Pointer_String_Work_Directory);
+	snprintf(Context.String_IDP_Output_Directory, sizeof(Context.String_IDP_Output_Directory), "%s/Benchmark_IDP", Pointer_String_Work_Directory);
+	snprintf(Context.String_Map_File, sizeof(Context.String_Map_File), "%s/Benchmark.map", Pointer_String_Work_Directory);
+	snprintf(Context.String_Map_Output_Directory, sizeof(Context.String_Map_Output_Directory), "%s/Benchmark_Map", Pointer_String_Work_Directory);
+	if ((FileSystemCreateDirectory(Pointer_String_Work_Directory) != 0) || (FileSystemCreateDirectory(Context.String_Map_Output_Directory) != 0))
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to create the benchmark directories (%s).\n", strerror(errno));
+		return -1;
+	}
+	if (BenchmarkGenerateIDPArchive(Context.String_IDP_File, BENCHMARK_IDP_ARCHIVE_TAGS_COUNT, BENCHMARK_IDP_ARCHIVE_MINIMUM_TAG_SIZE, BENCHMARK_IDP_ARCHIVE_MAXIMUM_TAG_SIZE, BENCHMARK_SEED) != 0) return -1;
+	if (BenchmarkGenerateMap(Context.String_Map_File, BENCHMARK_MAP_TILES_PER_SIDE, BENCHMARK_MAP_UNIT_GROUPS_COUNT, BENCHMARK_MAP_UNITS_PER_GROUP_COUNT, BENCHMARK_SEED) != 0) return -1;
+
+	// Retrieve the processed data sizes
+	if ((FileSystemGetFileInformation(Context.String_IDP_File, &IDP_File_Size, &Modification_Time) != 0) || (FileSystemGetFileInformation(Context.String_Map_File, &Map_File_Size, &Modification_Time) != 0)) return -1;
+
+	if (Pointer_String_Report_File != NULL)
+	{
+		Pointer_File_Report = fopen(Pointer_String_Report_File, "w");
+		if (Pointer_File_Report == NULL)
+		{
+			LogPrint(LOG_LEVEL_ERROR, "Error : failed to create the report file '%s' (%s).\n", Pointer_String_Report_File, strerror(errno));
+			return -1;
+		}
+	}
+
+	fprintf(Pointer_File_Report, "{\n\t\"iterations\": %d,\n\t\"benchmarks\":\n\t[\n", Iterations_Count);
+	if (BenchmarkMeasure(Pointer_File_Report, "idp_archive_read", BenchmarkIDPArchiveRead, &Context, Iterations_Count, IDP_File_Size, 0) != 0) goto Exit;
+	if (BenchmarkMeasure(Pointer_File_Report, "idp_reader_read", BenchmarkIDPReaderRead, &Context, Iterations_Count, 2 * IDP_File_Size, 0) != 0) goto Exit; // Each tag is read twice
+	if (BenchmarkMeasure(Pointer_File_Report, "idp_extract", BenchmarkIDPExtract, &Context, Iterations_Count, IDP_File_Size, 0) != 0) goto Exit;
+	if (BenchmarkMeasure(Pointer_File_Report, "map_extract", BenchmarkMapExtract, &Context, Iterations_Count, Map_File_Size, 1) != 0) goto Exit;
+	fprintf(Pointer_File_Report, "\t]\n}\n");
+	Return_Value = 0;
+
+Exit:
+	if (Pointer_File_Report != stdout)
+	{
+		if (fclose(Pointer_File_Report) != 0)
+		{
+			LogPrint(LOG_LEVEL_ERROR, "Error : failed to write the report file '%s' (%s).\n", Pointer_String_Report_File, strerror(errno));
+			Return_Value = -1;
+		}
+	}
+	return Return_Value;
+}
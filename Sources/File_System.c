@@ -0,0 +1,597 @@
+/** @file File_System.c
+ * See File_System.h for description.
+ * @author Adrien RICCIARDI
+ */
+#include <errno.h>
+#include <File_System.h>
+#include <Log.h>
+#include <Statistics.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef _WIN32
+	#include <direct.h>
+	#include <io.h>
+	#include <Windows.h>
+#else
+	#include <dirent.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+//-------------------------------------------------------------------------------------------------
+// Private constants
+//-------------------------------------------------------------------------------------------------
+/** The directory cache initial slots count, it must be a power of two. */
+#define FILE_SYSTEM_DIRECTORY_CACHE_INITIAL_SLOTS_COUNT 256
+
+/** The native path separator. */
+#ifdef _WIN32
+	#define FILE_SYSTEM_PATH_SEPARATOR '\\'
+#else
+	#define FILE_SYSTEM_PATH_SEPARATOR '/'
+#endif
+
+//-------------------------------------------------------------------------------------------------
+// Private types
+//-------------------------------------------------------------------------------------------------
+/** A growing list of files. */
+typedef struct
+{
+	TFileSystemFile *Pointer_Files; //!< The files.
+	int Files_Count; //!< How many files are in the list.
+	int Allocated_Files_Count; //!< How many files the list can contain without being reallocated.
+} TFileSystemFilesList;
+
+//-------------------------------------------------------------------------------------------------
+// Private functions
+//-------------------------------------------------------------------------------------------------
+/** Duplicate a path, converting all separators to the native one.
+ * @param Pointer_String_Path The path to convert.
+ * @param Length How many characters of the path to take.
+ * @return NULL if the memory could not be allocated,
+ * @return the dynamically allocated native path.
+ */
+static char *FileSystemConvertPath(const char *Pointer_String_Path, size_t Length)
+{
+	char *Pointer_String_Native_Path;
+	size_t i;
+
+	Pointer_String_Native_Path = malloc(Length + 1);
+	if (Pointer_String_Native_Path == NULL) return NULL;
+
+	for (i = 0; i < Length; i++)
+	{
+		if ((Pointer_String_Path[i] == '\\') || (Pointer_String_Path[i] == '/')) Pointer_String_Native_Path[i] = FILE_SYSTEM_PATH_SEPARATOR;
+		else Pointer_String_Native_Path[i] = Pointer_String_Path[i];
+	}
+	Pointer_String_Native_Path[Length] = 0;
+
+	return Pointer_String_Native_Path;
+}
+
+/** Compute a FNV-1a hash of a string.
+ * @param Pointer_String The string to hash.
+ * @return The string hash.
+ */
+static unsigned int FileSystemHashString(const char *Pointer_String)
+{
+	unsigned int Hash = 2166136261U;
+
+	while (*Pointer_String != 0)
+	{
+		Hash ^= (unsigned char) *Pointer_String;
+		Hash *= 16777619U;
+		Pointer_String++;
+	}
+
+	return Hash;
+}
+
+/** Find the slot of a path in the cache.
+ * @param Pointer_Cache The cache to search in.
+ * @param Pointer_String_Path The path to search for.
+ * @return The slot containing the path, or the free slot where the path must be inserted.
+ */
+static char **FileSystemDirectoryCacheFindSlot(TFileSystemDirectoryCache *Pointer_Cache, const char *Pointer_String_Path)
+{
+	unsigned int Mask = Pointer_Cache->Slots_Count - 1, Slot_Index;
+
+	// Use linear probing, the cache is never more than half full so a free slot is always found
+	Slot_Index = FileSystemHashString(Pointer_String_Path) & Mask;
+	while ((Pointer_Cache->Pointer_Pointer_Strings_Paths[Slot_Index] != NULL) && (strcmp(Pointer_Cache->Pointer_Pointer_Strings_Paths[Slot_Index], Pointer_String_Path) != 0)) Slot_Index = (Slot_Index + 1) & Mask;
+
+	return &Pointer_Cache->Pointer_Pointer_Strings_Paths[Slot_Index];
+}
+
+/** Add a path to the cache, growing it if needed.
+ * @param Pointer_Cache The cache to add the path to.
+ * @param Pointer_String_Path The path to add, it must not be already present in the cache.
+ * @return -1 if the memory could not be allocated,
+ * @return 0 on success.
+ */
+static int FileSystemDirectoryCacheAdd(TFileSystemDirectoryCache *Pointer_Cache, const char *Pointer_String_Path)
+{
+	TFileSystemDirectoryCache New_Cache;
+	char *Pointer_String_Path_Copy;
+	unsigned int i;
+
+	// Keep the cache at most half full to have short probing sequences
+	if ((Pointer_Cache->Paths_Count + 1) * 2 > Pointer_Cache->Slots_Count)
+	{
+		New_Cache.Slots_Count = Pointer_Cache->Slots_Count == 0 ? FILE_SYSTEM_DIRECTORY_CACHE_INITIAL_SLOTS_COUNT : Pointer_Cache->Slots_Count * 2;
+		New_Cache.Paths_Count = Pointer_Cache->Paths_Count;
+		New_Cache.Pointer_Pointer_Strings_Paths = calloc(New_Cache.Slots_Count, sizeof(char *));
+		if (New_Cache.Pointer_Pointer_Strings_Paths == NULL) return -1;
+
+		// Move all paths to the new slots
+		for (i = 0; i < Pointer_Cache->Slots_Count; i++)
+		{
+			if (Pointer_Cache->Pointer_Pointer_Strings_Paths[i] != NULL) *FileSystemDirectoryCacheFindSlot(&New_Cache, Pointer_Cache->Pointer_Pointer_Strings_Paths[i]) = Pointer_Cache->Pointer_Pointer_Strings_Paths[i];
+		}
+		if (Pointer_Cache->Pointer_Pointer_Strings_Paths != NULL) free(Pointer_Cache->Pointer_Pointer_Strings_Paths);
+		*Pointer_Cache = New_Cache;
+	}
+
+	Pointer_String_Path_Copy = malloc(strlen(Pointer_String_Path) + 1);
+	if (Pointer_String_Path_Copy == NULL) return -1;
+	strcpy(Pointer_String_Path_Copy, Pointer_String_Path);
+
+	*FileSystemDirectoryCacheFindSlot(Pointer_Cache, Pointer_String_Path_Copy) = Pointer_String_Path_Copy;
+	Pointer_Cache->Paths_Count++;
+	return 0;
+}
+
+/** Tell whether a path is in the cache.
+ * @param Pointer_Cache The cache to search in.
+ * @param Pointer_String_Path The path to search for.
+ * @return 1 if the path is in the cache,
+ * @return 0 if the path is not in the cache.
+ */
+static int FileSystemDirectoryCacheContains(TFileSystemDirectoryCache *Pointer_Cache, const char *Pointer_String_Path)
+{
+	if (Pointer_Cache->Slots_Count == 0) return 0;
+	return *FileSystemDirectoryCacheFindSlot(Pointer_Cache, Pointer_String_Path) != NULL;
+}
+
+/** Append a file to a files list.
+ * @param Pointer_List The list to append the file to.
+ * @param Pointer_String_Relative_Directory The file directory relative to the listed directory, it is empty for the listed directory itself.
+ * @param Pointer_String_File_Name The file name.
+ * @param Size The file size in bytes.
+ * @return -1 if the memory could not be allocated,
+ * @return 0 on success.
+ */
+static int FileSystemFilesListAppend(TFileSystemFilesList *Pointer_List, const char *Pointer_String_Relative_Directory, const char *Pointer_String_File_Name, long long Size)
+{
+	TFileSystemFile *Pointer_Files;
+	char *Pointer_String_Path;
+	size_t Directory_Length = strlen(Pointer_String_Relative_Directory);
+
+	// Grow the list when it is full
+	if (Pointer_List->Files_Count == Pointer_List->Allocated_Files_Count)
+	{
+		Pointer_List->Allocated_Files_Count = Pointer_List->Allocated_Files_Count == 0 ? 1024 : Pointer_List->Allocated_Files_Count * 2;
+		Pointer_Files = realloc(Pointer_List->Pointer_Files, sizeof(TFileSystemFile) * Pointer_List->Allocated_Files_Count);
+		if (Pointer_Files == NULL) return -1;
+		Pointer_List->Pointer_Files = Pointer_Files;
+	}
+
+	// Build the archive-style relative path
+	Pointer_String_Path = malloc(Directory_Length + 1 + strlen(Pointer_String_File_Name) + 1);
+	if (Pointer_String_Path == NULL) return -1;
+	if (Directory_Length > 0) sprintf(Pointer_String_Path, "%s\\%s", Pointer_String_Relative_Directory, Pointer_String_File_Name);
+	else strcpy(Pointer_String_Path, Pointer_String_File_Name);
+
+	Pointer_List->Pointer_Files[Pointer_List->Files_Count].Pointer_String_Path = Pointer_String_Path;
+	Pointer_List->Pointer_Files[Pointer_List->Files_Count].Size = Size;
+	Pointer_List->Files_Count++;
+	return 0;
+}
+
+/** Recursively add all files of a directory to a files list.
+ * @param Pointer_List The list to append the files to.
+ * @param Pointer_String_Root_Directory The listed directory.
+ * @param Pointer_String_Relative_Directory The directory to explore, relative to the listed directory and using the '\\' separator. It is empty for the listed directory itself.
+ * @return -1 if an error occurred,
+ * @return 0 on success.
+ */
+static int FileSystemListDirectoryFiles(TFileSystemFilesList *Pointer_List, const char *Pointer_String_Root_Directory, const char *Pointer_String_Relative_Directory)
+{
+	char *Pointer_String_Path, *Pointer_String_Native_Path = NULL, *Pointer_String_Child_Directory = NULL, *Pointer_String_Entry_Name;
+	size_t Length;
+	int Return_Value = -1, Is_Directory, Is_Error_Detected = 0;
+	long long Size;
+#ifdef _WIN32
+	HANDLE Find_Handle;
+	WIN32_FIND_DATAA Find_Data;
+#else
+	DIR *Pointer_Directory;
+	struct dirent *Pointer_Entry;
+	struct stat Entry_Status;
+	char *Pointer_String_Entry_Path;
+#endif
+
+	// Build the explored directory path
+	Length = strlen(Pointer_String_Root_Directory) + 1 + strlen(Pointer_String_Relative_Directory) + 3; // Make room for the "\\*" search pattern and the terminating zero
+	Pointer_String_Path = malloc(Length);
+	if (Pointer_String_Path == NULL)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to allocate the directory path (%s).\n", strerror(errno));
+		return -1;
+	}
+	if (Pointer_String_Relative_Directory[0] != 0) sprintf(Pointer_String_Path, "%s/%s", Pointer_String_Root_Directory, Pointer_String_Relative_Directory);
+	else strcpy(Pointer_String_Path, Pointer_String_Root_Directory);
+	Pointer_String_Native_Path = FileSystemConvertPath(Pointer_String_Path, strlen(Pointer_String_Path));
+	if (Pointer_String_Native_Path == NULL)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to allocate the directory path (%s).\n", strerror(errno));
+		goto Exit;
+	}
+
+#ifdef _WIN32
+	strcat(Pointer_String_Path, "\\*");
+	Find_Handle = FindFirstFileA(Pointer_String_Path, &Find_Data);
+	if (Find_Handle == INVALID_HANDLE_VALUE)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to list directory '%s' (Windows error %lu).\n", Pointer_String_Native_Path, GetLastError());
+		goto Exit;
+	}
+	do
+	{
+		Pointer_String_Entry_Name = Find_Data.cFileName;
+		Is_Directory = (Find_Data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+		Size = ((long long) Find_Data.nFileSizeHigh << 32) | Find_Data.nFileSizeLow;
+#else
+	Pointer_Directory = opendir(Pointer_String_Native_Path);
+	if (Pointer_Directory == NULL)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to list directory '%s' (%s).\n", Pointer_String_Native_Path, strerror(errno));
+		goto Exit;
+	}
+	while ((Pointer_Entry = readdir(Pointer_Directory)) != NULL)
+	{
+		Pointer_String_Entry_Name = Pointer_Entry->d_name;
+		if ((strcmp(Pointer_String_Entry_Name, ".") == 0) || (strcmp(Pointer_String_Entry_Name, "..") == 0)) continue;
+
+		// Retrieve the entry type and size
+		Pointer_String_Entry_Path = malloc(strlen(Pointer_String_Native_Path) + 1 + strlen(Pointer_String_Entry_Name) + 1);
+		if (Pointer_String_Entry_Path == NULL)
+		{
+			LogPrint(LOG_LEVEL_ERROR, "Error : failed to allocate the file path (%s).\n", strerror(errno));
+			closedir(Pointer_Directory);
+			goto Exit;
+		}
+		sprintf(Pointer_String_Entry_Path, "%s/%s", Pointer_String_Native_Path, Pointer_String_Entry_Name);
+		if (stat(Pointer_String_Entry_Path, &Entry_Status) != 0)
+		{
+			LogPrint(LOG_LEVEL_ERROR, "Error : failed to retrieve file '%s' information (%s).\n", Pointer_String_Entry_Path, strerror(errno));
+			free(Pointer_String_Entry_Path);
+			closedir(Pointer_Directory);
+			goto Exit;
+		}
+		free(Pointer_String_Entry_Path);
+		Is_Directory = S_ISDIR(Entry_Status.st_mode);
+		Size = (long long) Entry_Status.st_size;
+#endif
+
+		if ((strcmp(Pointer_String_Entry_Name, ".") != 0) && (strcmp(Pointer_String_Entry_Name, "..") != 0))
+		{
+			if (Is_Directory)
+			{
+				// Explore the subdirectory
+				Pointer_String_Child_Directory = malloc(strlen(Pointer_String_Relative_Directory) + 1 + strlen(Pointer_String_Entry_Name) + 1);
+				if (Pointer_String_Child_Directory == NULL)
+				{
+					LogPrint(LOG_LEVEL_ERROR, "Error : failed to allocate the directory path (%s).\n", strerror(errno));
+					Is_Error_Detected = 1;
+					break;
+				}
+				if (Pointer_String_Relative_Directory[0] != 0) sprintf(Pointer_String_Child_Directory, "%s\\%s", Pointer_String_Relative_Directory, Pointer_String_Entry_Name);
+				else strcpy(Pointer_String_Child_Directory, Pointer_String_Entry_Name);
+				Is_Error_Detected = FileSystemListDirectoryFiles(Pointer_List, Pointer_String_Root_Directory, Pointer_String_Child_Directory) != 0;
+				free(Pointer_String_Child_Directory);
+				if (Is_Error_Detected) break;
+			}
+			else if (FileSystemFilesListAppend(Pointer_List, Pointer_String_Relative_Directory, Pointer_String_Entry_Name, Size) != 0)
+			{
+				LogPrint(LOG_LEVEL_ERROR, "Error : failed to allocate the files list (%s).\n", strerror(errno));
+				Is_Error_Detected = 1;
+				break;
+			}
+		}
+#ifdef _WIN32
+	} while (FindNextFileA(Find_Handle, &Find_Data));
+	FindClose(Find_Handle);
+#else
+	}
+	closedir(Pointer_Directory);
+#endif
+
+	if (!Is_Error_Detected) Return_Value = 0;
+
+Exit:
+	free(Pointer_String_Path);
+	if (Pointer_String_Native_Path != NULL) free(Pointer_String_Native_Path);
+	return Return_Value;
+}
+
+/** Order files by path.
+ * @param Pointer_File_1 The first file to compare.
+ * @param Pointer_File_2 The second file to compare.
+ * @return A value like strcmp() one.
+ */
+static int FileSystemCompareFilePaths(const void *Pointer_File_1, const void *Pointer_File_2)
+{
+	return strcmp(((const TFileSystemFile *) Pointer_File_1)->Pointer_String_Path, ((const TFileSystemFile *) Pointer_File_2)->Pointer_String_Path);
+}
+
+//-------------------------------------------------------------------------------------------------
+// Public functions
+//-------------------------------------------------------------------------------------------------
+int FileSystemCreateDirectory(const char *Pointer_String_Path)
+{
+	StatisticsAddCounter(STATISTICS_COUNTER_DIRECTORY_CREATIONS, 1);
+
+#ifdef _WIN32
+	if (_mkdir(Pointer_String_Path) != 0)
+#else
+	if (mkdir(Pointer_String_Path, 0777) != 0)
+#endif
+	{
+		if (errno != EEXIST) return -1;
+	}
+
+	return 0;
+}
+
+int FileSystemChangeDirectory(const char *Pointer_String_Path)
+{
+#ifdef _WIN32
+	return _chdir(Pointer_String_Path) == 0 ? 0 : -1;
+#else
+	return chdir(Pointer_String_Path) == 0 ? 0 : -1;
+#endif
+}
+
+int FileSystemIsDirectory(const char *Pointer_String_Path)
+{
+#ifdef _WIN32
+	DWORD Attributes;
+
+	Attributes = GetFileAttributesA(Pointer_String_Path);
+	return (Attributes != INVALID_FILE_ATTRIBUTES) && (Attributes & FILE_ATTRIBUTE_DIRECTORY);
+#else
+	struct stat Status;
+
+	if (stat(Pointer_String_Path, &Status) != 0) return 0;
+	return S_ISDIR(Status.st_mode) ? 1 : 0;
+#endif
+}
+
+FILE *FileSystemOpenFile(const char *Pointer_String_Path, const char *Pointer_String_Opening_Mode)
+{
+	StatisticsAddCounter(STATISTICS_COUNTER_FILE_OPENINGS, 1);
+
+#ifdef _WIN32
+	// Windows understands both separators
+	return fopen(Pointer_String_Path, Pointer_String_Opening_Mode);
+#else
+	char *Pointer_String_Native_Path;
+	FILE *Pointer_File;
+
+	Pointer_String_Native_Path = FileSystemConvertPath(Pointer_String_Path, strlen(Pointer_String_Path));
+	if (Pointer_String_Native_Path == NULL) return NULL;
+
+	Pointer_File = fopen(Pointer_String_Native_Path, Pointer_String_Opening_Mode);
+
+	free(Pointer_String_Native_Path);
+	return Pointer_File;
+#endif
+}
+
+size_t FileSystemReadFile(void *Pointer_Buffer, size_t Size, FILE *Pointer_File)
+{
+	size_t Read_Bytes_Count;
+
+	Read_Bytes_Count = fread(Pointer_Buffer, 1, Size, Pointer_File);
+	StatisticsAddCounter(STATISTICS_COUNTER_READ_CALLS, 1);
+	StatisticsAddCounter(STATISTICS_COUNTER_READ_BYTES, (long long) Read_Bytes_Count);
+	return Read_Bytes_Count;
+}
+
+size_t FileSystemWriteFile(const void *Pointer_Buffer, size_t Size, FILE *Pointer_File)
+{
+	size_t Written_Bytes_Count;
+
+	Written_Bytes_Count = fwrite(Pointer_Buffer, 1, Size, Pointer_File);
+	StatisticsAddCounter(STATISTICS_COUNTER_WRITE_CALLS, 1);
+	StatisticsAddCounter(STATISTICS_COUNTER_WRITTEN_BYTES, (long long) Written_Bytes_Count);
+	return Written_Bytes_Count;
+}
+
+int FileSystemSynchronizeFile(FILE *Pointer_File)
+{
+	// Empty the C library buffer first, then ask the operating system to write its cache to the device
+	if (fflush(Pointer_File) != 0) return -1;
+#ifdef _WIN32
+	if (_commit(_fileno(Pointer_File)) != 0) return -1;
+#else
+	if (fsync(fileno(Pointer_File)) != 0) return -1;
+#endif
+	return 0;
+}
+
+void FileSystemDirectoryCacheInitialize(TFileSystemDirectoryCache *Pointer_Cache)
+{
+	Pointer_Cache->Pointer_Pointer_Strings_Paths = NULL;
+	Pointer_Cache->Slots_Count = 0;
+	Pointer_Cache->Paths_Count = 0;
+}
+
+void FileSystemDirectoryCacheFree(TFileSystemDirectoryCache *Pointer_Cache)
+{
+	unsigned int i;
+
+	if (Pointer_Cache->Pointer_Pointer_Strings_Paths != NULL)
+	{
+		for (i = 0; i < Pointer_Cache->Slots_Count; i++)
+		{
+			if (Pointer_Cache->Pointer_Pointer_Strings_Paths[i] != NULL) free(Pointer_Cache->Pointer_Pointer_Strings_Paths[i]);
+		}
+		free(Pointer_Cache->Pointer_Pointer_Strings_Paths);
+	}
+	FileSystemDirectoryCacheInitialize(Pointer_Cache);
+}
+
+int FileSystemCreateParentDirectories(TFileSystemDirectoryCache *Pointer_Cache, const char *Pointer_String_File_Path)
+{
+	const char *Pointer_String_Last_Separator;
+	char *Pointer_String_Directory_Path, Character;
+	size_t i, Length;
+	int Return_Value = -1;
+
+	// Find the parent directory, there is nothing to create if the file has no directory
+	Pointer_String_Last_Separator = NULL;
+	for (i = 0; Pointer_String_File_Path[i] != 0; i++)
+	{
+		if ((Pointer_String_File_Path[i] == '\\') || (Pointer_String_File_Path[i] == '/')) Pointer_String_Last_Separator = &Pointer_String_File_Path[i];
+	}
+	if (Pointer_String_Last_Separator == NULL) return 0;
+	Length = Pointer_String_Last_Separator - Pointer_String_File_Path;
+
+	Pointer_String_Directory_Path = FileSystemConvertPath(Pointer_String_File_Path, Length);
+	if (Pointer_String_Directory_Path == NULL)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to allocate the directory path (%s).\n", strerror(errno));
+		return -1;
+	}
+
+	// Most files share a few directories, so the whole path is usually already known
+	if (FileSystemDirectoryCacheContains(Pointer_Cache, Pointer_String_Directory_Path))
+	{
+		Return_Value = 0;
+		goto Exit;
+	}
+
+	// Create each directory of the path, from the outermost one
+	for (i = 1; i <= Length; i++)
+	{
+		if ((i < Length) && (Pointer_String_Directory_Path[i] != FILE_SYSTEM_PATH_SEPARATOR)) continue;
+
+		// Temporarily cut the path after the current directory
+		Character = Pointer_String_Directory_Path[i];
+		Pointer_String_Directory_Path[i] = 0;
+
+		// Do not try to create a drive letter like "C:"
+		if ((Pointer_String_Directory_Path[i - 1] != ':') && !FileSystemDirectoryCacheContains(Pointer_Cache, Pointer_String_Directory_Path))
+		{
+			if (FileSystemCreateDirectory(Pointer_String_Directory_Path) != 0)
+			{
+				LogPrint(LOG_LEVEL_ERROR, "Error : failed to create directory '%s' (%s).\n", Pointer_String_Directory_Path, strerror(errno));
+				goto Exit;
+			}
+			if (FileSystemDirectoryCacheAdd(Pointer_Cache, Pointer_String_Directory_Path) != 0)
+			{
+				LogPrint(LOG_LEVEL_ERROR, "Error : failed to add directory '%s' to the cache (%s).\n", Pointer_String_Directory_Path, strerror(errno));
+				goto Exit;
+			}
+		}
+
+		Pointer_String_Directory_Path[i] = Character;
+	}
+	Return_Value = 0;
+
+Exit:
+	free(Pointer_String_Directory_Path);
+	return Return_Value;
+}
+
+int FileSystemGetFileInformation(const char *Pointer_String_Path, long long *Pointer_Size, long long *Pointer_Modification_Time)
+{
+#ifdef _WIN32
+	WIN32_FILE_ATTRIBUTE_DATA Attributes;
+
+	if (!GetFileAttributesExA(Pointer_String_Path, GetFileExInfoStandard, &Attributes))
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to retrieve file '%s' information (Windows error %lu).\n", Pointer_String_Path, GetLastError());
+		return -1;
+	}
+	*Pointer_Size = ((long long) Attributes.nFileSizeHigh << 32) | Attributes.nFileSizeLow;
+	*Pointer_Modification_Time = ((long long) Attributes.ftLastWriteTime.dwHighDateTime << 32) | Attributes.ftLastWriteTime.dwLowDateTime;
+#else
+	struct stat Status;
+
+	if (stat(Pointer_String_Path, &Status) != 0)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to retrieve file '%s' information (%s).\n", Pointer_String_Path, strerror(errno));
+		return -1;
+	}
+	*Pointer_Size = (long long) Status.st_size;
+	// Use the nanoseconds when available, so a file modified twice in the same second is detected
+	#ifdef __APPLE__
+		*Pointer_Modification_Time = (long long) Status.st_mtimespec.tv_sec * 1000000000LL + Status.st_mtimespec.tv_nsec;
+	#else
+		*Pointer_Modification_Time = (long long) Status.st_mtim.tv_sec * 1000000000LL + Status.st_mtim.tv_nsec;
+	#endif
+#endif
+	return 0;
+}
+
+int FileSystemIsSameFile(const char *Pointer_String_Path_1, const char *Pointer_String_Path_2)
+{
+#ifdef _WIN32
+	HANDLE Handles[2] = {INVALID_HANDLE_VALUE, INVALID_HANDLE_VALUE};
+	BY_HANDLE_FILE_INFORMATION Information[2];
+	const char *Pointer_Strings_Paths[2] = {Pointer_String_Path_1, Pointer_String_Path_2};
+	int i, Is_Same_File = 0;
+
+	// The volume serial number and the file index identify a file, open the files without any access right only to retrieve them
+	for (i = 0; i < 2; i++)
+	{
+		Handles[i] = CreateFileA(Pointer_Strings_Paths[i], 0, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS, NULL);
+		if ((Handles[i] == INVALID_HANDLE_VALUE) || !GetFileInformationByHandle(Handles[i], &Information[i])) goto Exit;
+	}
+	Is_Same_File = (Information[0].dwVolumeSerialNumber == Information[1].dwVolumeSerialNumber) && (Information[0].nFileIndexHigh == Information[1].nFileIndexHigh) && (Information[0].nFileIndexLow == Information[1].nFileIndexLow);
+
+Exit:
+	for (i = 0; i < 2; i++)
+	{
+		if (Handles[i] != INVALID_HANDLE_VALUE) CloseHandle(Handles[i]);
+	}
+	return Is_Same_File;
+#else
+	struct stat Status_1, Status_2;
+
+	// The device and the inode identify a file, whatever the path used to reach it
+	if ((stat(Pointer_String_Path_1, &Status_1) != 0) || (stat(Pointer_String_Path_2, &Status_2) != 0)) return 0;
+	return (Status_1.st_dev == Status_2.st_dev) && (Status_1.st_ino == Status_2.st_ino);
+#endif
+}
+
+int FileSystemListFiles(const char *Pointer_String_Directory, TFileSystemFile **Pointer_Pointer_Files, int *Pointer_Files_Count)
+{
+	TFileSystemFilesList List = { NULL, 0, 0 };
+
+	if (FileSystemListDirectoryFiles(&List, Pointer_String_Directory, "") != 0)
+	{
+		FileSystemFreeFiles(List.Pointer_Files, List.Files_Count);
+		return -1;
+	}
+
+	// Always return the files in the same order, whatever the file system order is
+	if (List.Files_Count > 0) qsort(List.Pointer_Files, List.Files_Count, sizeof(TFileSystemFile), FileSystemCompareFilePaths);
+
+	*Pointer_Pointer_Files = List.Pointer_Files;
+	*Pointer_Files_Count = List.Files_Count;
+	return 0;
+}
+
+void FileSystemFreeFiles(TFileSystemFile *Pointer_Files, int Files_Count)
+{
+	int i;
+
+	if (Pointer_Files == NULL) return;
+
+	for (i = 0; i < Files_Count; i++) free(Pointer_Files[i].Pointer_String_Path);
+	free(Pointer_Files);
+}
@@ -0,0 +1,237 @@
+/** @file File_Writer.c
+ * See File_Writer.h for description.
+ * @author Adrien RICCIARDI
+ */
+#include <errno.h>
+#include <File_System.h>
+#include <File_Writer.h>
+#include <Log.h>
+#include <Statistics.h>
+#include <stdlib.h>
+#include <string.h>
+
+//-------------------------------------------------------------------------------------------------
+// Private constants
+//-------------------------------------------------------------------------------------------------
+/** The buffer size in bytes. */
+#define FILE_WRITER_BUFFER_SIZE (4 * 1024 * 1024)
+
+/** The longest text a number can be converted to, including the sign. */
+#define FILE_WRITER_MAXIMUM_NUMBER_LENGTH 64
+
+//-------------------------------------------------------------------------------------------------
+// Private functions
+//-------------------------------------------------------------------------------------------------
+/** Write the buffer content to the file.
+ * @param Pointer_Writer The writer.
+ */
+static void FileWriterFlush(TFileWriter *Pointer_Writer)
+{
+	if (Pointer_Writer->Used_Size == 0) return;
+
+	if (FileSystemWriteFile(Pointer_Writer->Pointer_Buffer, Pointer_Writer->Used_Size, Pointer_Writer->Pointer_File) != Pointer_Writer->Used_Size) Pointer_Writer->Is_Error = 1;
+	Pointer_Writer->Used_Size = 0;
+}
+
+/** Make sure the buffer has enough free room, flush it if needed.
+ * @param Pointer_Writer The writer.
+ * @param Size How many bytes will be appended, it must not be larger than the buffer size.
+ * @return Where to append the data.
+ */
+static inline unsigned char *FileWriterReserve(TFileWriter *Pointer_Writer, size_t Size)
+{
+	if (FILE_WRITER_BUFFER_SIZE - Pointer_Writer->Used_Size < Size) FileWriterFlush(Pointer_Writer);
+	return Pointer_Writer->Pointer_Buffer + Pointer_Writer->Used_Size;
+}
+
+/** Convert an unsigned number to decimal digits.
+ * @param Value The number to convert.
+ * @param Minimum_Digits_Count Add leading zeros if the number has less digits.
+ * @param Pointer_Digits On output, contain the digits. The buffer must be FILE_WRITER_MAXIMUM_NUMBER_LENGTH bytes long.
+ * @return How many digits were written.
+ */
+static int FileWriterConvertUnsignedNumber(unsigned long long Value, int Minimum_Digits_Count, unsigned char *Pointer_Digits)
+{
+	unsigned char Reversed_Digits[FILE_WRITER_MAXIMUM_NUMBER_LENGTH];
+	int Digits_Count = 0, i;
+
+	// Generate the digits from the least significant one
+	do
+	{
+		Reversed_Digits[Digits_Count] = (unsigned char) ('0' + Value % 10);
+		Value /= 10;
+		Digits_Count++;
+	} while (Value != 0);
+	while (Digits_Count < Minimum_Digits_Count)
+	{
+		Reversed_Digits[Digits_Count] = '0';
+		Digits_Count++;
+	}
+
+	for (i = 0; i < Digits_Count; i++) Pointer_Digits[i] = Reversed_Digits[Digits_Count - 1 - i];
+	return Digits_Count;
+}
+
+//-------------------------------------------------------------------------------------------------
+// Public functions
+//-------------------------------------------------------------------------------------------------
+int FileWriterOpen(const char *Pointer_String_File, const char *Pointer_String_Opening_Mode, TFileWriter *Pointer_Writer)
+{
+	memset(Pointer_Writer, 0, sizeof(TFileWriter));
+
+	Pointer_Writer->Pointer_Buffer = malloc(FILE_WRITER_BUFFER_SIZE);
+	if (Pointer_Writer->Pointer_Buffer == NULL)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to allocate the file '%s' write buffer (%s).\n", Pointer_String_File, strerror(errno));
+		return -1;
+	}
+
+	Pointer_Writer->Pointer_File = fopen(Pointer_String_File, Pointer_String_Opening_Mode);
+	if (Pointer_Writer->Pointer_File == NULL)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to create the file '%s' (%s).\n", Pointer_String_File, strerror(errno));
+		free(Pointer_Writer->Pointer_Buffer);
+		return -1;
+	}
+	StatisticsAddCounter(STATISTICS_COUNTER_FILE_OPENINGS, 1);
+	// The data are already buffered, so do not copy them again to the C library buffer
+	setvbuf(Pointer_Writer->Pointer_File, NULL, _IONBF, 0);
+
+	return 0;
+}
+
+void FileWriterWriteBuffer(TFileWriter *Pointer_Writer, const void *Pointer_Data, size_t Size)
+{
+	// Large data are directly written to the file
+	if (Size > FILE_WRITER_BUFFER_SIZE / 2)
+	{
+		FileWriterFlush(Pointer_Writer);
+		if (FileSystemWriteFile(Pointer_Data, Size, Pointer_Writer->Pointer_File) != Size) Pointer_Writer->Is_Error = 1;
+		return;
+	}
+
+	memcpy(FileWriterReserve(Pointer_Writer, Size), Pointer_Data, Size);
+	Pointer_Writer->Used_Size += Size;
+}
+
+void FileWriterWriteString(TFileWriter *Pointer_Writer, const char *Pointer_String)
+{
+	FileWriterWriteBuffer(Pointer_Writer, Pointer_String, strlen(Pointer_String));
+}
+
+void FileWriterWriteCharacter(TFileWriter *Pointer_Writer, char Character)
+{
+	*FileWriterReserve(Pointer_Writer, 1) = (unsigned char) Character;
+	Pointer_Writer->Used_Size++;
+}
+
+void FileWriterWriteInteger(TFileWriter *Pointer_Writer, int Value)
+{
+	unsigned char *Pointer_Output;
+	unsigned long long Absolute_Value;
+
+	Pointer_Output = FileWriterReserve(Pointer_Writer, FILE_WRITER_MAXIMUM_NUMBER_LENGTH);
+	if (Value < 0)
+	{
+		*Pointer_Output = '-';
+		Pointer_Output++;
+		Pointer_Writer->Used_Size++;
+		Absolute_Value = (unsigned long long) -(long long) Value; // Also works for the smallest integer
+	}
+	else Absolute_Value = (unsigned long long) Value;
+	Pointer_Writer->Used_Size += FileWriterConvertUnsignedNumber(Absolute_Value, 1, Pointer_Output);
+}
+
+void FileWriterWriteFloat(TFileWriter *Pointer_Writer, float Value)
+{
+	unsigned int Bits, Mantissa;
+	int Exponent, Shift;
+	unsigned long long Integer_Part, Fractional_Bits, Scaled_Fraction, Fractional_Part, Remainder, Half;
+	unsigned char *Pointer_Output;
+	char String_Number[FILE_WRITER_MAXIMUM_NUMBER_LENGTH * 2];
+
+	// Split the float in its exact mantissa and power of two, so the value is Mantissa * 2^Exponent
+	memcpy(&Bits, &Value, sizeof(Bits));
+	Mantissa = Bits & 0x7FFFFF;
+	Exponent = (Bits >> 23) & 0xFF;
+	if (Exponent == 0) Exponent = -149; // Denormalized number
+	else
+	{
+		Mantissa |= 0x800000;
+		Exponent -= 150;
+	}
+
+	// Very large numbers do not fit in 64 bits, let the C library handle them
+	if (Exponent > 39)
+	{
+		snprintf(String_Number, sizeof(String_Number), "%f", Value);
+		FileWriterWriteString(Pointer_Writer, String_Number);
+		return;
+	}
+
+	// Compute the integer part and the 6 decimal digits, rounding the exact value like printf() does
+	if (Exponent >= 0)
+	{
+		Integer_Part = (unsigned long long) Mantissa << Exponent;
+		Fractional_Part = 0;
+	}
+	else
+	{
+		Shift = -Exponent;
+		if (Shift >= 32)
+		{
+			Integer_Part = 0;
+			Fractional_Bits = Mantissa;
+		}
+		else
+		{
+			Integer_Part = Mantissa >> Shift;
+			Fractional_Bits = Mantissa & ((1U << Shift) - 1);
+		}
+
+		// The fraction is Fractional_Bits / 2^Shift, the mantissa has 24 bits so the scaled fraction fits in 44 bits
+		Scaled_Fraction = Fractional_Bits * 1000000;
+		if (Shift > 50) Fractional_Part = 0; // The scaled fraction is lower than half a unit, so it is rounded to zero
+		else
+		{
+			Fractional_Part = Scaled_Fraction >> Shift;
+			Remainder = Scaled_Fraction & ((1ULL << Shift) - 1);
+			Half = 1ULL << (Shift - 1);
+			// Round to the nearest, ties to the even digit
+			if ((Remainder > Half) || ((Remainder == Half) && (Fractional_Part & 1))) Fractional_Part++;
+			if (Fractional_Part == 1000000)
+			{
+				Integer_Part++;
+				Fractional_Part = 0;
+			}
+		}
+	}
+
+	Pointer_Output = FileWriterReserve(Pointer_Writer, FILE_WRITER_MAXIMUM_NUMBER_LENGTH);
+	// printf() displays the sign of the negative numbers even when they are rounded to zero
+	if (Bits & 0x80000000)
+	{
+		*Pointer_Output = '-';
+		Pointer_Output++;
+		Pointer_Writer->Used_Size++;
+	}
+	Shift = FileWriterConvertUnsignedNumber(Integer_Part, 1, Pointer_Output);
+	Pointer_Output[Shift] = '.';
+	Shift++;
+	Shift += FileWriterConvertUnsignedNumber(Fractional_Part, 6, Pointer_Output + Shift);
+	Pointer_Writer->Used_Size += Shift;
+}
+
+int FileWriterClose(TFileWriter *Pointer_Writer)
+{
+	FileWriterFlush(Pointer_Writer);
+	if (fclose(Pointer_Writer->Pointer_File) != 0) Pointer_Writer->Is_Error = 1;
+	free(Pointer_Writer->Pointer_Buffer);
+
+	if (Pointer_Writer->Is_Error)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to write a file (%s).\n", strerror(errno));
+		return -1;
+	}
+	return 0;
+}
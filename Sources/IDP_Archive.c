@@ -2,8 +2,12 @@
  * See IDP_Archive.h for description.
  * @author Adrien RICCIARDI
  */
+#include <ctype.h>
 #include <errno.h>
+#include <File_System.h>
 #include <IDP_Archive.h>
+#include <Log.h>
+#include <Statistics.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -14,65 +18,337 @@
 /** IDP header byte offset 4, called "version" in the Stealth Combat executable. */
 #define IDP_ARCHIVE_HEADER_VERSION 0x64
 
+/** The xxHash64 primes. */
+#define IDP_ARCHIVE_HASH_PRIME_1 0x9E3779B185EBCA87ULL
+#define IDP_ARCHIVE_HASH_PRIME_2 0xC2B2AE3D27D4EB4FULL
+#define IDP_ARCHIVE_HASH_PRIME_3 0x165667B19E3779F9ULL
+#define IDP_ARCHIVE_HASH_PRIME_4 0x85EBCA77C2B2AE63ULL
+#define IDP_ARCHIVE_HASH_PRIME_5 0x27D4EB2F165667C5ULL
+
+//-------------------------------------------------------------------------------------------------
+// Private functions
+//-------------------------------------------------------------------------------------------------
+/** Read a double word from a mapped archive, making sure it does not go past the file end.
+ * @param Pointer_Mapped_File The mapped archive.
+ * @param Pointer_Offset The offset to read from. On output, the offset is moved past the double word.
+ * @param Pointer_Double_Word On output, contain the read value.
+ * @return 0 if the double word was successfully read,
+ * @return -1 if the file is too short.
+ */
+static int IDPArchiveReadMappedDoubleWord(TMappedFile *Pointer_Mapped_File, size_t *Pointer_Offset, int *Pointer_Double_Word)
+{
+	if (Pointer_Mapped_File->Size - *Pointer_Offset < 4) return -1; // The offset is always checked against the file size, so it can't be greater than the size
+
+	memcpy(Pointer_Double_Word, Pointer_Mapped_File->Pointer_Data + *Pointer_Offset, 4);
+	*Pointer_Offset += 4;
+	return 0;
+}
+
+/** Rotate a 64-bit value to the left.
+ * @param Value The value to rotate.
+ * @param Bits_Count By how many bits to rotate, from 1 to 63.
+ * @return The rotated value.
+ */
+static inline unsigned long long IDPArchiveRotateLeft(unsigned long long Value, int Bits_Count)
+{
+	return (Value << Bits_Count) | (Value >> (64 - Bits_Count));
+}
+
+/** Mix 8 input bytes into a hash accumulator, this is the xxHash64 round.
+ * @param Accumulator The accumulator value.
+ * @param Input The 8 input bytes, read with the machine endianness.
+ * @return The new accumulator value.
+ */
+static inline unsigned long long IDPArchiveHashRound(unsigned long long Accumulator, unsigned long long Input)
+{
+	Accumulator += Input * IDP_ARCHIVE_HASH_PRIME_2;
+	Accumulator = IDPArchiveRotateLeft(Accumulator, 31);
+	return Accumulator * IDP_ARCHIVE_HASH_PRIME_1;
+}
+
+/** Merge a lane accumulator into the hash, this is the xxHash64 merge round.
+ * @param Hash The hash value.
+ * @param Accumulator The lane accumulator.
+ * @return The new hash value.
+ */
+static inline unsigned long long IDPArchiveHashMergeRound(unsigned long long Hash, unsigned long long Accumulator)
+{
+	Hash ^= IDPArchiveHashRound(0, Accumulator);
+	return Hash * IDP_ARCHIVE_HASH_PRIME_1 + IDP_ARCHIVE_HASH_PRIME_4;
+}
+
+/** Parse the header and the tags directory of a mapped archive. The tag names and data point into the mapped file.
+ * @param Pointer_Archive The archive, its file must already be mapped.
+ * @return 0 if the tags were successfully parsed,
+ * @return -1 if an error occurred.
+ */
+static int IDPArchiveParseMappedTags(TIDPArchive *Pointer_Archive)
+{
+	int Tags_Count, i, Temporary_Double_Word;
+	size_t Offset = 0;
+	TMappedFile *Pointer_Mapped_File = &Pointer_Archive->Mapped_File;
+	TIDPArchiveTag *Pointer_Tags, *Pointer_Tag;
+
+	// Check IDP header
+	if ((Pointer_Mapped_File->Size < 4) || (strncmp((char *) Pointer_Mapped_File->Pointer_Data, "IDPK", 4) != 0))
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : invalid IDP header. IDP file must start with \"IDPK\" header identifier.\n");
+		return -1;
+	}
+	Offset = 4;
+	LogPrint(LOG_LEVEL_DEBUG, "Found valid IDP header.\n");
+
+	// Check version
+	if (IDPArchiveReadMappedDoubleWord(Pointer_Mapped_File, &Offset, &Temporary_Double_Word) != 0)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to read IDP version (file is too short).\n");
+		return -1;
+	}
+	if (Temporary_Double_Word != IDP_ARCHIVE_HEADER_VERSION)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : bad archive version (read 0x%X, must be 0x%X).\n", Temporary_Double_Word, IDP_ARCHIVE_HEADER_VERSION);
+		return -1;
+	}
+	LogPrint(LOG_LEVEL_DEBUG, "Found valid version.\n");
+
+	// Read tags count
+	if (IDPArchiveReadMappedDoubleWord(Pointer_Mapped_File, &Offset, &Tags_Count) != 0)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to read tags count (file is too short).\n");
+		return -1;
+	}
+	if (Tags_Count < 0)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : invalid tags count %d.\n", Tags_Count);
+		return -1;
+	}
+	LogPrint(LOG_LEVEL_INFORMATION, "Found %d tags.\n", Tags_Count);
+
+	// Allocate the tags, only this small array is allocated as everything else is located in the mapped file
+	Pointer_Tags = calloc(Tags_Count + 1, sizeof(TIDPArchiveTag)); // Make sure to allocate at least one tag for empty archives, so the NULL pointer means an error
+	if (Pointer_Tags == NULL)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to allocate the tags buffer (%s).\n", strerror(errno));
+		return -1;
+	}
+	Pointer_Archive->Pointer_Tags = Pointer_Tags;
+	Pointer_Archive->Tags_Count = Tags_Count;
+
+	// Parse all tags
+	for (i = 0; i < Tags_Count; i++)
+	{
+		Pointer_Tag = &Pointer_Tags[i];
+
+		// Get tag name size
+		if (IDPArchiveReadMappedDoubleWord(Pointer_Mapped_File, &Offset, &Temporary_Double_Word) != 0)
+		{
+			LogPrint(LOG_LEVEL_ERROR, "Error : failed to read tag %d name size (file is too short).\n", i);
+			return -1;
+		}
+
+		// Point to the tag name, making sure it is a valid ASCIIZ string
+		if ((Temporary_Double_Word <= 0) || (Pointer_Mapped_File->Size - Offset < (size_t) Temporary_Double_Word) || (Pointer_Mapped_File->Pointer_Data[Offset + Temporary_Double_Word - 1] != 0))
+		{
+			LogPrint(LOG_LEVEL_ERROR, "Error : tag %d name string is invalid.\n", i);
+			return -1;
+		}
+		Pointer_Tag->Pointer_String_Name = (char *) Pointer_Mapped_File->Pointer_Data + Offset;
+		Offset += Temporary_Double_Word;
+
+		// Read data offset and size
+		if ((IDPArchiveReadMappedDoubleWord(Pointer_Mapped_File, &Offset, &Pointer_Tag->Data_Offset) != 0) || (IDPArchiveReadMappedDoubleWord(Pointer_Mapped_File, &Offset, &Pointer_Tag->Data_Size) != 0))
+		{
+			LogPrint(LOG_LEVEL_ERROR, "Error : failed to read tag %d data offset and size (file is too short).\n", i);
+			return -1;
+		}
+
+		// Keep following 8 bytes that are unknown for now (maybe flags ?)
+		if (Pointer_Mapped_File->Size - Offset < 8)
+		{
+			LogPrint(LOG_LEVEL_ERROR, "Error : failed to read tag %d unknown bytes (file is too short).\n", i);
+			return -1;
+		}
+		memcpy(Pointer_Tag->Unknown_Bytes, Pointer_Mapped_File->Pointer_Data + Offset, 8);
+		Offset += 8;
+
+		LogPrint(LOG_LEVEL_DEBUG, "Tag %d name : '%s', data offset : 0x%08X, data size : %d bytes.\n", i, Pointer_Tag->Pointer_String_Name, Pointer_Tag->Data_Offset, Pointer_Tag->Data_Size);
+	}
+
+	// The data area immediately follows the tags
+	Pointer_Archive->Data_Area_Offset = (int) Offset;
+	return 0;
+}
+
+/** Parse the header and the tags directory of an archive using small buffered reads, the tag data are not read.
+ * @param Pointer_Archive The archive, its file must already be opened.
+ * @return 0 if the tags were successfully parsed,
+ * @return -1 if an error occurred.
+ */
+static int IDPArchiveParseStreamedTags(TIDPArchive *Pointer_Archive)
+{
+	int Tags_Count, i, Temporary_Double_Word;
+	char String_Temporary[8];
+	FILE *Pointer_File = Pointer_Archive->Pointer_File;
+	TIDPArchiveTag *Pointer_Tags, *Pointer_Tag;
+
+	// Check IDP header
+	if ((FileSystemReadFile(String_Temporary, 4, Pointer_File) != 4) || (strncmp(String_Temporary, "IDPK", 4) != 0))
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : invalid IDP header. IDP file must start with \"IDPK\" header identifier.\n");
+		return -1;
+	}
+	LogPrint(LOG_LEVEL_DEBUG, "Found valid IDP header.\n");
+
+	// Check version
+	if (FileSystemReadFile(&Temporary_Double_Word, 4, Pointer_File) != 4)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to read IDP version (%s).\n", strerror(errno));
+		return -1;
+	}
+	if (Temporary_Double_Word != IDP_ARCHIVE_HEADER_VERSION)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : bad archive version (read 0x%X, must be 0x%X).\n", Temporary_Double_Word, IDP_ARCHIVE_HEADER_VERSION);
+		return -1;
+	}
+	LogPrint(LOG_LEVEL_DEBUG, "Found valid version.\n");
+
+	// Read tags count
+	if (FileSystemReadFile(&Tags_Count, 4, Pointer_File) != 4)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to read tags count (%s).\n", strerror(errno));
+		return -1;
+	}
+	if (Tags_Count < 0)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : invalid tags count %d.\n", Tags_Count);
+		return -1;
+	}
+	LogPrint(LOG_LEVEL_INFORMATION, "Found %d tags.\n", Tags_Count);
+
+	// Allocate the tags
+	Pointer_Tags = calloc(Tags_Count + 1, sizeof(TIDPArchiveTag)); // Make sure to allocate at least one tag for empty archives, so the NULL pointer means an error
+	if (Pointer_Tags == NULL)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to allocate the tags buffer (%s).\n", strerror(errno));
+		return -1;
+	}
+	Pointer_Archive->Pointer_Tags = Pointer_Tags;
+	Pointer_Archive->Tags_Count = Tags_Count;
+
+	// Parse all tags
+	for (i = 0; i < Tags_Count; i++)
+	{
+		Pointer_Tag = &Pointer_Tags[i];
+
+		// Get tag name size
+		if (FileSystemReadFile(&Temporary_Double_Word, 4, Pointer_File) != 4)
+		{
+			LogPrint(LOG_LEVEL_ERROR, "Error : failed to read tag %d name size (%s).\n", i, strerror(errno));
+			return -1;
+		}
+		if (Temporary_Double_Word <= 0)
+		{
+			LogPrint(LOG_LEVEL_ERROR, "Error : tag %d name size %d is invalid.\n", i, Temporary_Double_Word);
+			return -1;
+		}
+
+		// Allocate and read tag name
+		Pointer_Tag->Pointer_String_Name = malloc(Temporary_Double_Word);
+		if (Pointer_Tag->Pointer_String_Name == NULL)
+		{
+			LogPrint(LOG_LEVEL_ERROR, "Error : failed to allocate tag %d name buffer (%s).\n", i, strerror(errno));
+			return -1;
+		}
+		if (FileSystemReadFile(Pointer_Tag->Pointer_String_Name, Temporary_Double_Word, Pointer_File) != (size_t) Temporary_Double_Word)
+		{
+			LogPrint(LOG_LEVEL_ERROR, "Error : failed to read tag %d name string (%s).\n", i, strerror(errno));
+			return -1;
+		}
+		Pointer_Tag->Pointer_String_Name[Temporary_Double_Word - 1] = 0; // Make sure the string is terminated even if the file is corrupted
+
+		// Read data offset, data size and the following 8 unknown bytes
+		if ((FileSystemReadFile(&Pointer_Tag->Data_Offset, 4, Pointer_File) != 4) || (FileSystemReadFile(&Pointer_Tag->Data_Size, 4, Pointer_File) != 4) || (FileSystemReadFile(Pointer_Tag->Unknown_Bytes, 8, Pointer_File) != 8))
+		{
+			LogPrint(LOG_LEVEL_ERROR, "Error : failed to read tag %d data offset and size (%s).\n", i, strerror(errno));
+			return -1;
+		}
+
+		LogPrint(LOG_LEVEL_DEBUG, "Tag %d name : '%s', data offset : 0x%08X, data size : %d bytes.\n", i, Pointer_Tag->Pointer_String_Name, Pointer_Tag->Data_Offset, Pointer_Tag->Data_Size);
+	}
+
+	// The data area immediately follows the tags
+	Pointer_Archive->Data_Area_Offset = (int) ftell(Pointer_File);
+	return 0;
+}
+
 //-------------------------------------------------------------------------------------------------
 // Public functions
 //-------------------------------------------------------------------------------------------------
 int IDPArchiveRead(char *Pointer_String_IDP_File, TIDPArchiveTag **Pointer_Pointer_Output_Buffer, int *Pointer_Tags_Count)
 {
 	int Return_Value = -1, Tags_Count, i, Temporary_Double_Word;
+	long Data_Area_Offset;
 	FILE *Pointer_File_Archive;
 	char String_Temporary[16];
 	TIDPArchiveTag *Pointer_Output_Buffer;
+	double Start_Time;
 	
-	printf("Starting uncompressing '%s' archive.\n", Pointer_String_IDP_File);
+	LogPrint(LOG_LEVEL_DEBUG, "Starting uncompressing '%s' archive.\n", Pointer_String_IDP_File);
+	Start_Time = StatisticsGetTime();
 	
 	// Try to open the IDP file
 	Pointer_File_Archive = fopen(Pointer_String_IDP_File, "rb");
 	if (Pointer_File_Archive == NULL)
 	{
-		printf("Error : failed to open IDP file '%s' (%s).\n", Pointer_String_IDP_File, strerror(errno));
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to open IDP file '%s' (%s).\n", Pointer_String_IDP_File, strerror(errno));
 		goto Exit;
 	}
+	StatisticsAddCounter(STATISTICS_COUNTER_FILE_OPENINGS, 1);
 	
 	// Check IDP header
-	if (fread(String_Temporary, 1, 4, Pointer_File_Archive) != 4)
+	if (FileSystemReadFile(String_Temporary, 4, Pointer_File_Archive) != 4)
 	{
-		printf("Error : failed to read IDP header (%s).\n", strerror(errno));
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to read IDP header (%s).\n", strerror(errno));
 		goto Exit;
 	}
 	if (strncmp(String_Temporary, "IDPK", 4) != 0)
 	{
-		printf("Error : invalid IDP header. IDP file must start with \"IDPK\" header identifier.\n");
+		LogPrint(LOG_LEVEL_ERROR, "Error : invalid IDP header. IDP file must start with \"IDPK\" header identifier.\n");
 		goto Exit;
 	}
-	printf("Found valid IDP header.\n");
+	LogPrint(LOG_LEVEL_DEBUG, "Found valid IDP header.\n");
 	
 	// Check version
-	if (fread(&Tags_Count, 1, 4, Pointer_File_Archive) != 4) // Recycle Tags_Count variable
+	if (FileSystemReadFile(&Tags_Count, 4, Pointer_File_Archive) != 4) // Recycle Tags_Count variable
 	{
-		printf("Error : failed to read IDP version (%s).\n", strerror(errno));
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to read IDP version (%s).\n", strerror(errno));
 		goto Exit;
 	}
 	if (Tags_Count != IDP_ARCHIVE_HEADER_VERSION)
 	{
-		printf("Error : bad archive version (read 0x%X, must be 0x%X).\n", Tags_Count, IDP_ARCHIVE_HEADER_VERSION);
+		LogPrint(LOG_LEVEL_ERROR, "Error : bad archive version (read 0x%X, must be 0x%X).\n", Tags_Count, IDP_ARCHIVE_HEADER_VERSION);
 		goto Exit;
 	}
-	printf("Found valid version.\n");
+	LogPrint(LOG_LEVEL_DEBUG, "Found valid version.\n");
 	
 	// Read tags count
-	if (fread(&Tags_Count, 1, 4, Pointer_File_Archive) != 4)
+	if (FileSystemReadFile(&Tags_Count, 4, Pointer_File_Archive) != 4)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to read tags count (%s).\n", strerror(errno));
+		goto Exit;
+	}
+	if (Tags_Count < 0)
 	{
-		printf("Error : failed to read tags count (%s).\n", strerror(errno));
+		LogPrint(LOG_LEVEL_ERROR, "Error : the tags count is negative (%d).\n", Tags_Count);
 		goto Exit;
 	}
-	printf("Found %d tags.\n", Tags_Count);
+	LogPrint(LOG_LEVEL_INFORMATION, "Found %d tags.\n", Tags_Count);
 	
 	// Allocate the output buffer
 	Pointer_Output_Buffer = malloc(sizeof(TIDPArchiveTag) * Tags_Count);
 	if (Pointer_Output_Buffer == NULL)
 	{
-		printf("Error : failed to allocate the output buffer (%s).\n", strerror(errno));
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to allocate the output buffer (%s).\n", strerror(errno));
 		goto Exit;
 	}
 	// Reset buffer to make all pointers NULL
@@ -82,9 +358,14 @@ int IDPArchiveRead(char *Pointer_String_IDP_File, TIDPArchiveTag **Pointer_Point
 	for (i = 0; i < Tags_Count; i++)
 	{
 		// Get tag name size
-		if (fread(&Temporary_Double_Word, 1, 4, Pointer_File_Archive) != 4)
+		if (FileSystemReadFile(&Temporary_Double_Word, 4, Pointer_File_Archive) != 4)
+		{
+			LogPrint(LOG_LEVEL_ERROR, "Error : failed to read tag %d name size (%s).\n", i, strerror(errno));
+			goto Exit_Free_Buffer;
+		}
+		if (Temporary_Double_Word <= 0)
 		{
-			printf("Error : failed to read tag %d name size (%s).\n", i, strerror(errno));
+			LogPrint(LOG_LEVEL_ERROR, "Error : tag %d name size is invalid (%d bytes).\n", i, Temporary_Double_Word);
 			goto Exit_Free_Buffer;
 		}
 		
@@ -92,66 +373,84 @@ int IDPArchiveRead(char *Pointer_String_IDP_File, TIDPArchiveTag **Pointer_Point
 		Pointer_Output_Buffer[i].Pointer_String_Name = malloc(Temporary_Double_Word);
 		if (Pointer_Output_Buffer[i].Pointer_String_Name == NULL)
 		{
-			printf("Error : failed to allocate tag %d name buffer (%s).\n", i, strerror(errno));
+			LogPrint(LOG_LEVEL_ERROR, "Error : failed to allocate tag %d name buffer (%s).\n", i, strerror(errno));
 			goto Exit_Free_Buffer;
 		}
 		
 		// Read tag name
-		if (fread(Pointer_Output_Buffer[i].Pointer_String_Name, 1, Temporary_Double_Word, Pointer_File_Archive) != Temporary_Double_Word)
+		if (FileSystemReadFile(Pointer_Output_Buffer[i].Pointer_String_Name, Temporary_Double_Word, Pointer_File_Archive) != (size_t) Temporary_Double_Word)
 		{
-			printf("Error : failed to read tag %d name string (%s).\n", i, strerror(errno));
+			LogPrint(LOG_LEVEL_ERROR, "Error : failed to read tag %d name string (%s).\n", i, strerror(errno));
 			goto Exit_Free_Buffer;
 		}
 		
 		// Read data offset
-		if (fread(&Pointer_Output_Buffer[i].Data_Offset, 1, 4, Pointer_File_Archive) != 4)
+		if (FileSystemReadFile(&Pointer_Output_Buffer[i].Data_Offset, 4, Pointer_File_Archive) != 4)
 		{
-			printf("Error : failed to read tag %d data offset (%s).\n", i, strerror(errno));
+			LogPrint(LOG_LEVEL_ERROR, "Error : failed to read tag %d data offset (%s).\n", i, strerror(errno));
 			goto Exit_Free_Buffer;
 		}
 		
 		// Read data size
-		if (fread(&Pointer_Output_Buffer[i].Data_Size, 1, 4, Pointer_File_Archive) != 4)
+		if (FileSystemReadFile(&Pointer_Output_Buffer[i].Data_Size, 4, Pointer_File_Archive) != 4)
+		{
+			LogPrint(LOG_LEVEL_ERROR, "Error : failed to read tag %d data size (%s).\n", i, strerror(errno));
+			goto Exit_Free_Buffer;
+		}
+		if (Pointer_Output_Buffer[i].Data_Size < 0)
 		{
-			printf("Error : failed to read tag %d data size (%s).\n", i, strerror(errno));
+			LogPrint(LOG_LEVEL_ERROR, "Error : tag %d data size is negative (%d bytes).\n", i, Pointer_Output_Buffer[i].Data_Size);
 			goto Exit_Free_Buffer;
 		}
 		
-		// Bypass following 8 bytes that are unknown for now (maybe flags ?)
-		if (fread(String_Temporary, 1, 8, Pointer_File_Archive) != 8)
+		// Keep following 8 bytes that are unknown for now (maybe flags ?)
+		if (FileSystemReadFile(Pointer_Output_Buffer[i].Unknown_Bytes, 8, Pointer_File_Archive) != 8)
 		{
-			printf("Error : failed to read tag %d unknown bytes (%s).\n", i, strerror(errno));
+			LogPrint(LOG_LEVEL_ERROR, "Error : failed to read tag %d unknown bytes (%s).\n", i, strerror(errno));
 			goto Exit_Free_Buffer;
 		}
 		
-		printf("Tag %d name : '%s', data offset : 0x%08X, data size : %d bytes.\n", i, Pointer_Output_Buffer[i].Pointer_String_Name, Pointer_Output_Buffer[i].Data_Offset, Pointer_Output_Buffer[i].Data_Size);
+		LogPrint(LOG_LEVEL_DEBUG, "Tag %d name : '%s', data offset : 0x%08X, data size : %d bytes.\n", i, Pointer_Output_Buffer[i].Pointer_String_Name, Pointer_Output_Buffer[i].Data_Offset, Pointer_Output_Buffer[i].Data_Size);
 	}
 	
+	// The data area immediately follows the tags
+	Data_Area_Offset = ftell(Pointer_File_Archive);
+	StatisticsAddPhaseTime(STATISTICS_PHASE_IDP_DIRECTORY_PARSE, Start_Time);
+	Start_Time = StatisticsGetTime();
+	
 	// Read tags data
 	for (i = 0; i < Tags_Count; i++)
 	{
+		// Go to the tag data, they are not necessarily stored in the tags order
+		if ((Pointer_Output_Buffer[i].Data_Offset < 0) || (fseek(Pointer_File_Archive, Data_Area_Offset + Pointer_Output_Buffer[i].Data_Offset, SEEK_SET) != 0))
+		{
+			LogPrint(LOG_LEVEL_ERROR, "Error : failed to seek to tag %d data (%s).\n", i, strerror(errno));
+			goto Exit_Free_Buffer;
+		}
+		
 		// Allocate tag data
 		Pointer_Output_Buffer[i].Pointer_Data = malloc(Pointer_Output_Buffer[i].Data_Size);
 		if (Pointer_Output_Buffer[i].Pointer_Data == NULL)
 		{
-			printf("Error : failed to allocate %d tag data buffer (%s).\n", i, strerror(errno));
+			LogPrint(LOG_LEVEL_ERROR, "Error : failed to allocate %d tag data buffer (%s).\n", i, strerror(errno));
 			goto Exit_Free_Buffer;
 		}
 		
 		// Read tag data
-		if (fread(Pointer_Output_Buffer[i].Pointer_Data, 1, Pointer_Output_Buffer[i].Data_Size, Pointer_File_Archive) != Pointer_Output_Buffer[i].Data_Size)
+		if (FileSystemReadFile(Pointer_Output_Buffer[i].Pointer_Data, Pointer_Output_Buffer[i].Data_Size, Pointer_File_Archive) != (size_t) Pointer_Output_Buffer[i].Data_Size) // The size was checked to be positive when the tags directory was read
 		{
-			printf("Error : failed to read tag %d data (%s).\n", i, strerror(errno));
+			LogPrint(LOG_LEVEL_ERROR, "Error : failed to read tag %d data (%s).\n", i, strerror(errno));
 			goto Exit_Free_Buffer;
 		}
 		
-		printf("Read tag %d data.\n", i);
+		LogPrint(LOG_LEVEL_DEBUG, "Read tag %d data.\n", i);
 	}
+	StatisticsAddPhaseTime(STATISTICS_PHASE_IDP_PAYLOAD_READ, Start_Time);
 	
 	*Pointer_Pointer_Output_Buffer = Pointer_Output_Buffer;
 	*Pointer_Tags_Count = Tags_Count;
 	
-	printf("IDP archive successfully read.\n");
+	LogPrint(LOG_LEVEL_INFORMATION, "IDP archive successfully read.\n");
 	Return_Value = 0;
 	goto Exit; // Do not free the buffer now that it is successfully filled
 	
@@ -188,3 +487,322 @@ void IDPArchiveFreeBuffer(TIDPArchiveTag *Pointer_Buffer, int Tags_Count)
 	// Release buffer itself
 	free(Pointer_Buffer);
 }
+
+int IDPArchiveOpen(char *Pointer_String_IDP_File, TIDPArchiveAccessMode Access_Mode, TIDPArchive *Pointer_Archive)
+{
+	int i;
+	long long Archive_Size;
+	TIDPArchiveTag *Pointer_Tag;
+	double Start_Time;
+
+	LogPrint(LOG_LEVEL_DEBUG, "Starting opening '%s' archive.\n", Pointer_String_IDP_File);
+	Start_Time = StatisticsGetTime();
+
+	// Make the archive safe to close whatever happens
+	memset(Pointer_Archive, 0, sizeof(TIDPArchive));
+	Pointer_Archive->Access_Mode = Access_Mode;
+	ThreadMutexInitialize(&Pointer_Archive->File_Mutex);
+
+	if (Access_Mode == IDP_ARCHIVE_ACCESS_MODE_MAPPED)
+	{
+		// Try to map the IDP file
+		if (MappedFileOpen(Pointer_String_IDP_File, &Pointer_Archive->Mapped_File) != 0) goto Exit_Error;
+		if (IDPArchiveParseMappedTags(Pointer_Archive) != 0) goto Exit_Error;
+		Archive_Size = (long long) Pointer_Archive->Mapped_File.Size;
+	}
+	else
+	{
+		// Try to open the IDP file
+		Pointer_Archive->Pointer_File = fopen(Pointer_String_IDP_File, "rb");
+		if (Pointer_Archive->Pointer_File == NULL)
+		{
+			LogPrint(LOG_LEVEL_ERROR, "Error : failed to open IDP file '%s' (%s).\n", Pointer_String_IDP_File, strerror(errno));
+			goto Exit_Error;
+		}
+		StatisticsAddCounter(STATISTICS_COUNTER_FILE_OPENINGS, 1);
+		if (IDPArchiveParseStreamedTags(Pointer_Archive) != 0) goto Exit_Error;
+
+		// Retrieve the archive size to check the tags data location
+		if (fseek(Pointer_Archive->Pointer_File, 0, SEEK_END) != 0)
+		{
+			LogPrint(LOG_LEVEL_ERROR, "Error : failed to retrieve IDP file size (%s).\n", strerror(errno));
+			goto Exit_Error;
+		}
+		Archive_Size = ftell(Pointer_Archive->Pointer_File);
+	}
+
+	// Make sure all tags data are located in the archive, then point each tag to its data if they are available
+	for (i = 0; i < Pointer_Archive->Tags_Count; i++)
+	{
+		Pointer_Tag = &Pointer_Archive->Pointer_Tags[i];
+
+		if ((Pointer_Tag->Data_Offset < 0) || (Pointer_Tag->Data_Size < 0) || ((long long) Pointer_Archive->Data_Area_Offset + Pointer_Tag->Data_Offset + Pointer_Tag->Data_Size > Archive_Size))
+		{
+			LogPrint(LOG_LEVEL_ERROR, "Error : tag %d data are located outside of the archive.\n", i);
+			goto Exit_Error;
+		}
+		if (Access_Mode == IDP_ARCHIVE_ACCESS_MODE_MAPPED) Pointer_Tag->Pointer_Data = Pointer_Archive->Mapped_File.Pointer_Data + Pointer_Archive->Data_Area_Offset + Pointer_Tag->Data_Offset;
+	}
+
+	StatisticsAddPhaseTime(STATISTICS_PHASE_IDP_DIRECTORY_PARSE, Start_Time);
+	LogPrint(LOG_LEVEL_DEBUG, "IDP archive successfully opened.\n");
+	return 0;
+
+Exit_Error:
+	IDPArchiveClose(Pointer_Archive);
+	return -1;
+}
+
+int IDPArchiveReadTagData(TIDPArchive *Pointer_Archive, int Tag_Index, int Offset, void *Pointer_Buffer, int Size)
+{
+	TIDPArchiveTag *Pointer_Tag = &Pointer_Archive->Pointer_Tags[Tag_Index];
+	int Return_Value = -1;
+	double Start_Time;
+
+	// Make sure the requested area is located in the tag data
+	if ((Offset < 0) || (Size < 0) || (Offset > Pointer_Tag->Data_Size - Size))
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : the requested area (offset %d, size %d) is outside of tag %d data.\n", Offset, Size, Tag_Index);
+		return -1;
+	}
+
+	Start_Time = StatisticsGetTime();
+
+	// The data are already in memory
+	if (Pointer_Archive->Access_Mode == IDP_ARCHIVE_ACCESS_MODE_MAPPED)
+	{
+		memcpy(Pointer_Buffer, (unsigned char *) Pointer_Tag->Pointer_Data + Offset, Size);
+		StatisticsAddPhaseTime(STATISTICS_PHASE_IDP_PAYLOAD_READ, Start_Time);
+		return 0;
+	}
+
+	// Read the data from the file, the file position is shared so only one thread can access the file at a time
+	ThreadMutexLock(&Pointer_Archive->File_Mutex);
+	if (fseek(Pointer_Archive->Pointer_File, Pointer_Archive->Data_Area_Offset + Pointer_Tag->Data_Offset + Offset, SEEK_SET) != 0)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to seek to tag %d data (%s).\n", Tag_Index, strerror(errno));
+		goto Exit;
+	}
+	if (FileSystemReadFile(Pointer_Buffer, Size, Pointer_Archive->Pointer_File) != (size_t) Size)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to read tag %d data (%s).\n", Tag_Index, strerror(errno));
+		goto Exit;
+	}
+	Return_Value = 0;
+
+Exit:
+	ThreadMutexUnlock(&Pointer_Archive->File_Mutex);
+	StatisticsAddPhaseTime(STATISTICS_PHASE_IDP_PAYLOAD_READ, Start_Time);
+	return Return_Value;
+}
+
+void IDPArchiveClose(TIDPArchive *Pointer_Archive)
+{
+	int i;
+
+	// Release the tags
+	if (Pointer_Archive->Pointer_Tags != NULL)
+	{
+		// Tag names are allocated only in streamed mode
+		if (Pointer_Archive->Access_Mode == IDP_ARCHIVE_ACCESS_MODE_STREAMED)
+		{
+			for (i = 0; i < Pointer_Archive->Tags_Count; i++)
+			{
+				if (Pointer_Archive->Pointer_Tags[i].Pointer_String_Name != NULL) free(Pointer_Archive->Pointer_Tags[i].Pointer_String_Name);
+			}
+		}
+
+		free(Pointer_Archive->Pointer_Tags);
+		Pointer_Archive->Pointer_Tags = NULL;
+	}
+	Pointer_Archive->Tags_Count = 0;
+
+	// Release the file
+	if (Pointer_Archive->Access_Mode == IDP_ARCHIVE_ACCESS_MODE_MAPPED) MappedFileClose(&Pointer_Archive->Mapped_File);
+	else if (Pointer_Archive->Pointer_File != NULL)
+	{
+		fclose(Pointer_Archive->Pointer_File);
+		Pointer_Archive->Pointer_File = NULL;
+	}
+	ThreadMutexDestroy(&Pointer_Archive->File_Mutex);
+}
+
+int IDPArchiveCompareTagNames(const char *Pointer_String_Tag_Name_1, const char *Pointer_String_Tag_Name_2)
+{
+	unsigned char Character_1, Character_2;
+
+	// Make separators and letter case irrelevant
+	do
+	{
+		Character_1 = (unsigned char) *Pointer_String_Tag_Name_1;
+		if (Character_1 == '/') Character_1 = '\\';
+		Character_1 = (unsigned char) tolower(Character_1);
+		Character_2 = (unsigned char) *Pointer_String_Tag_Name_2;
+		if (Character_2 == '/') Character_2 = '\\';
+		Character_2 = (unsigned char) tolower(Character_2);
+		Pointer_String_Tag_Name_1++;
+		Pointer_String_Tag_Name_2++;
+	} while ((Character_1 == Character_2) && (Character_1 != 0));
+
+	return Character_1 - Character_2;
+}
+
+int IDPArchiveFindTag(TIDPArchive *Pointer_Archive, const char *Pointer_String_Tag_Name)
+{
+	int i;
+
+	for (i = 0; i < Pointer_Archive->Tags_Count; i++)
+	{
+		if (IDPArchiveCompareTagNames(Pointer_String_Tag_Name, Pointer_Archive->Pointer_Tags[i].Pointer_String_Name) == 0) return i;
+	}
+
+	return -1;
+}
+
+long long IDPArchiveComputeDirectorySize(TIDPArchiveTag *Pointer_Tags, int Tags_Count)
+{
+	long long Size = 12; // Header identifier, version and tags count
+	int i;
+
+	// Each tag has a name size, the name string with its terminating zero, the data offset, the data size and 8 unknown bytes
+	for (i = 0; i < Tags_Count; i++) Size += 4 + strlen(Pointer_Tags[i].Pointer_String_Name) + 1 + 4 + 4 + 8;
+
+	return Size;
+}
+
+int IDPArchiveWriteDirectory(FILE *Pointer_File, TIDPArchiveTag *Pointer_Tags, int Tags_Count)
+{
+	int i, Temporary_Double_Word;
+	TIDPArchiveTag *Pointer_Tag;
+
+	// Write the header
+	Temporary_Double_Word = IDP_ARCHIVE_HEADER_VERSION;
+	if ((FileSystemWriteFile("IDPK", 4, Pointer_File) != 4) || (FileSystemWriteFile(&Temporary_Double_Word, 4, Pointer_File) != 4) || (FileSystemWriteFile(&Tags_Count, 4, Pointer_File) != 4))
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to write IDP header (%s).\n", strerror(errno));
+		return -1;
+	}
+
+	// Write all tags
+	for (i = 0; i < Tags_Count; i++)
+	{
+		Pointer_Tag = &Pointer_Tags[i];
+		Temporary_Double_Word = (int) strlen(Pointer_Tag->Pointer_String_Name) + 1; // The terminating zero is included in the name size
+
+		if ((FileSystemWriteFile(&Temporary_Double_Word, 4, Pointer_File) != 4) || (FileSystemWriteFile(Pointer_Tag->Pointer_String_Name, Temporary_Double_Word, Pointer_File) != (size_t) Temporary_Double_Word) || (FileSystemWriteFile(&Pointer_Tag->Data_Offset, 4, Pointer_File) != 4) || (FileSystemWriteFile(&Pointer_Tag->Data_Size, 4, Pointer_File) != 4) || (FileSystemWriteFile(Pointer_Tag->Unknown_Bytes, 8, Pointer_File) != 8))
+		{
+			LogPrint(LOG_LEVEL_ERROR, "Error : failed to write tag %d (%s).\n", i, strerror(errno));
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+unsigned long long IDPArchiveComputeDataHash(const void *Pointer_Data, int Size)
+{
+	const unsigned char *Pointer_Bytes = Pointer_Data, *Pointer_End = Pointer_Bytes + Size;
+	unsigned long long Hash, Accumulators[4], Double_Word;
+	unsigned int Word;
+
+	// Consume 32 bytes at a time with four independent lanes, so the processor can compute them in parallel
+	if (Size >= 32)
+	{
+		Accumulators[0] = IDP_ARCHIVE_HASH_PRIME_1 + IDP_ARCHIVE_HASH_PRIME_2;
+		Accumulators[1] = IDP_ARCHIVE_HASH_PRIME_2;
+		Accumulators[2] = 0;
+		Accumulators[3] = 0 - IDP_ARCHIVE_HASH_PRIME_1;
+		while (Pointer_End - Pointer_Bytes >= 32)
+		{
+			// The data are not aligned, memcpy() lets the compiler use the fastest unaligned load
+			memcpy(&Double_Word, Pointer_Bytes, 8);
+			Accumulators[0] = IDPArchiveHashRound(Accumulators[0], Double_Word);
+			memcpy(&Double_Word, Pointer_Bytes + 8, 8);
+			Accumulators[1] = IDPArchiveHashRound(Accumulators[1], Double_Word);
+			memcpy(&Double_Word, Pointer_Bytes + 16, 8);
+			Accumulators[2] = IDPArchiveHashRound(Accumulators[2], Double_Word);
+			memcpy(&Double_Word, Pointer_Bytes + 24, 8);
+			Accumulators[3] = IDPArchiveHashRound(Accumulators[3], Double_Word);
+			Pointer_Bytes += 32;
+		}
+		Hash = IDPArchiveRotateLeft(Accumulators[0], 1) + IDPArchiveRotateLeft(Accumulators[1], 7) + IDPArchiveRotateLeft(Accumulators[2], 12) + IDPArchiveRotateLeft(Accumulators[3], 18);
+		Hash = IDPArchiveHashMergeRound(Hash, Accumulators[0]);
+		Hash = IDPArchiveHashMergeRound(Hash, Accumulators[1]);
+		Hash = IDPArchiveHashMergeRound(Hash, Accumulators[2]);
+		Hash = IDPArchiveHashMergeRound(Hash, Accumulators[3]);
+	}
+	else Hash = IDP_ARCHIVE_HASH_PRIME_5;
+	Hash += (unsigned long long) Size;
+
+	// Consume the remaining bytes
+	while (Pointer_End - Pointer_Bytes >= 8)
+	{
+		memcpy(&Double_Word, Pointer_Bytes, 8);
+		Hash ^= IDPArchiveHashRound(0, Double_Word);
+		Hash = IDPArchiveRotateLeft(Hash, 27) * IDP_ARCHIVE_HASH_PRIME_1 + IDP_ARCHIVE_HASH_PRIME_4;
+		Pointer_Bytes += 8;
+	}
+	if (Pointer_End - Pointer_Bytes >= 4)
+	{
+		memcpy(&Word, Pointer_Bytes, 4);
+		Hash ^= Word * IDP_ARCHIVE_HASH_PRIME_1;
+		Hash = IDPArchiveRotateLeft(Hash, 23) * IDP_ARCHIVE_HASH_PRIME_2 + IDP_ARCHIVE_HASH_PRIME_3;
+		Pointer_Bytes += 4;
+	}
+	while (Pointer_Bytes < Pointer_End)
+	{
+		Hash ^= *Pointer_Bytes * IDP_ARCHIVE_HASH_PRIME_5;
+		Hash = IDPArchiveRotateLeft(Hash, 11) * IDP_ARCHIVE_HASH_PRIME_1;
+		Pointer_Bytes++;
+	}
+
+	// Make all input bits affect all output bits
+	Hash ^= Hash >> 33;
+	Hash *= IDP_ARCHIVE_HASH_PRIME_2;
+	Hash ^= Hash >> 29;
+	Hash *= IDP_ARCHIVE_HASH_PRIME_3;
+	Hash ^= Hash >> 32;
+
+	return Hash;
+}
+
+int IDPArchiveIsTagNameMatching(const char *Pointer_String_Pattern, const char *Pointer_String_Tag_Name)
+{
+	const char *Pointer_String_Star_Pattern = NULL, *Pointer_String_Star_Name = NULL;
+	char Pattern_Character, Name_Character;
+
+	while (*Pointer_String_Tag_Name != 0)
+	{
+		// Make separators and letter case irrelevant
+		Pattern_Character = *Pointer_String_Pattern;
+		if (Pattern_Character == '/') Pattern_Character = '\\';
+		Pattern_Character = (char) tolower((unsigned char) Pattern_Character);
+		Name_Character = *Pointer_String_Tag_Name;
+		if (Name_Character == '/') Name_Character = '\\';
+		Name_Character = (char) tolower((unsigned char) Name_Character);
+
+		// Remember the star location, so the matching can be resumed from here with one more name character consumed by the star
+		if (Pattern_Character == '*')
+		{
+			Pointer_String_Star_Pattern = Pointer_String_Pattern;
+			Pointer_String_Star_Name = Pointer_String_Tag_Name;
+			Pointer_String_Pattern++;
+		}
+		else if ((Pattern_Character == '?') || ((Pattern_Character != 0) && (Pattern_Character == Name_Character)))
+		{
+			Pointer_String_Pattern++;
+			Pointer_String_Tag_Name++;
+		}
+		else if (Pointer_String_Star_Pattern != NULL)
+		{
+			Pointer_String_Pattern = Pointer_String_Star_Pattern + 1;
+			Pointer_String_Star_Name++;
+			Pointer_String_Tag_Name = Pointer_String_Star_Name;
+		}
+		else return 0;
+	}
+
+	// The remaining pattern characters can only be stars
+	while (*Pointer_String_Pattern == '*') Pointer_String_Pattern++;
+	return *Pointer_String_Pattern == 0;
+}
@@ -0,0 +1,287 @@
+/** @file IDP_Index.c
+ * See IDP_Index.h for description.
+ * @author Adrien RICCIARDI
+ */
+#include <errno.h>
+#include <File_System.h>
+#include <IDP_Archive.h>
+#include <IDP_Index.h>
+#include <Log.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//-------------------------------------------------------------------------------------------------
+// Private constants
+//-------------------------------------------------------------------------------------------------
+/** The index file format version, increment it each time the format changes. */
+#define IDP_INDEX_VERSION 1
+
+/** How many bytes from the archive beginning are hashed to detect an archive change. The header and the first tags are enough to catch an archive replaced by another one with the same size and date. */
+#define IDP_INDEX_HASHED_BYTES_COUNT 4096
+
+//-------------------------------------------------------------------------------------------------
+// Private types
+//-------------------------------------------------------------------------------------------------
+/** The index file header, followed by the entries then by the names table. All values are stored with the machine endianness, an index file is a local cache and is not meant to be shared. */
+typedef struct
+{
+	char Magic_Number[4]; //!< Always "IDPX".
+	int Version; //!< Always IDP_INDEX_VERSION.
+	long long Archive_Size; //!< The indexed archive size in bytes.
+	long long Archive_Modification_Time; //!< The indexed archive last modification time.
+	unsigned long long Archive_Hash; //!< The hash of the indexed archive first bytes.
+	int Entries_Count; //!< How many entries follow the header.
+	int Names_Size; //!< The names table size in bytes.
+} TIDPIndexHeader;
+
+//-------------------------------------------------------------------------------------------------
+// Private functions
+//-------------------------------------------------------------------------------------------------
+/** Compute the key telling whether an index file matches an archive.
+ * @param Pointer_String_IDP_File The archive.
+ * @param Pointer_Header On output, the archive size, modification time and hash are set.
+ * @return -1 if an error occurred,
+ * @return 0 on success.
+ */
+static int IDPIndexComputeArchiveKey(char *Pointer_String_IDP_File, TIDPIndexHeader *Pointer_Header)
+{
+	FILE *Pointer_File;
+	unsigned char Buffer[IDP_INDEX_HASHED_BYTES_COUNT];
+	size_t i, Size;
+	unsigned long long Hash = 0xCBF29CE484222325ULL; // 64-bit FNV-1a offset basis
+
+	if (FileSystemGetFileInformation(Pointer_String_IDP_File, &Pointer_Header->Archive_Size, &Pointer_Header->Archive_Modification_Time) != 0) return -1;
+
+	Pointer_File = fopen(Pointer_String_IDP_File, "rb");
+	if (Pointer_File == NULL)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to open IDP file '%s' (%s).\n", Pointer_String_IDP_File, strerror(errno));
+		return -1;
+	}
+	Size = FileSystemReadFile(Buffer, sizeof(Buffer), Pointer_File);
+	fclose(Pointer_File);
+
+	for (i = 0; i < Size; i++)
+	{
+		Hash ^= Buffer[i];
+		Hash *= 0x100000001B3ULL; // 64-bit FNV prime
+	}
+	Pointer_Header->Archive_Hash = Hash;
+
+	return 0;
+}
+
+/** Load an index file if it matches the archive.
+ * @param Pointer_String_Index_File The index file.
+ * @param Pointer_Expected_Header The archive key the index file must match.
+ * @param Pointer_Index On output, contain the index.
+ * @return -1 if the index file does not exist, is corrupted or does not match the archive,
+ * @return 0 on success.
+ */
+static int IDPIndexLoadFile(char *Pointer_String_Index_File, TIDPIndexHeader *Pointer_Expected_Header, TIDPIndex *Pointer_Index)
+{
+	FILE *Pointer_File;
+	long File_Size;
+	unsigned char *Pointer_Buffer = NULL;
+	TIDPIndexHeader *Pointer_Header;
+	int i;
+
+	Pointer_File = fopen(Pointer_String_Index_File, "rb");
+	if (Pointer_File == NULL) return -1;
+
+	// Load the whole file at once
+	if ((fseek(Pointer_File, 0, SEEK_END) != 0) || ((File_Size = ftell(Pointer_File)) < (long) sizeof(TIDPIndexHeader)) || (fseek(Pointer_File, 0, SEEK_SET) != 0)) goto Exit_Error;
+	Pointer_Buffer = malloc(File_Size);
+	if (Pointer_Buffer == NULL) goto Exit_Error;
+	if (FileSystemReadFile(Pointer_Buffer, File_Size, Pointer_File) != (size_t) File_Size) goto Exit_Error;
+	fclose(Pointer_File);
+	Pointer_File = NULL;
+
+	// Make sure the index matches the archive
+	Pointer_Header = (TIDPIndexHeader *) Pointer_Buffer;
+	if ((memcmp(Pointer_Header->Magic_Number, "IDPX", 4) != 0) || (Pointer_Header->Version != IDP_INDEX_VERSION)) goto Exit_Error;
+	if ((Pointer_Header->Archive_Size != Pointer_Expected_Header->Archive_Size) || (Pointer_Header->Archive_Modification_Time != Pointer_Expected_Header->Archive_Modification_Time) || (Pointer_Header->Archive_Hash != Pointer_Expected_Header->Archive_Hash)) goto Exit_Error;
+
+	// Make sure the content is consistent, so a truncated or corrupted file can't be used
+	if ((Pointer_Header->Entries_Count < 0) || (Pointer_Header->Names_Size < 1)) goto Exit_Error;
+	if ((long long) sizeof(TIDPIndexHeader) + (long long) Pointer_Header->Entries_Count * (long long) sizeof(TIDPIndexEntry) + Pointer_Header->Names_Size != File_Size) goto Exit_Error;
+	Pointer_Index->Pointer_Entries = (TIDPIndexEntry *) (Pointer_Buffer + sizeof(TIDPIndexHeader));
+	Pointer_Index->Entries_Count = Pointer_Header->Entries_Count;
+	Pointer_Index->Pointer_Names = (char *) (Pointer_Index->Pointer_Entries + Pointer_Index->Entries_Count);
+	if (Pointer_Index->Pointer_Names[Pointer_Header->Names_Size - 1] != 0) goto Exit_Error;
+	for (i = 0; i < Pointer_Index->Entries_Count; i++)
+	{
+		if ((Pointer_Index->Pointer_Entries[i].Name_Offset < 0) || (Pointer_Index->Pointer_Entries[i].Name_Offset >= Pointer_Header->Names_Size)) goto Exit_Error;
+	}
+
+	Pointer_Index->Pointer_Buffer = Pointer_Buffer;
+	return 0;
+
+Exit_Error:
+	if (Pointer_File != NULL) fclose(Pointer_File);
+	if (Pointer_Buffer != NULL) free(Pointer_Buffer);
+	memset(Pointer_Index, 0, sizeof(TIDPIndex));
+	return -1;
+}
+
+/** Order the tags by name.
+ * @param Pointer_Pointer_Tag_1 The first tag to compare.
+ * @param Pointer_Pointer_Tag_2 The second tag to compare.
+ * @return A negative value if the first tag comes first,
+ * @return 0 if both tags have the same name,
+ * @return a positive value if the second tag comes first.
+ */
+static int IDPIndexCompareTagNames(const void *Pointer_Pointer_Tag_1, const void *Pointer_Pointer_Tag_2)
+{
+	const TIDPArchiveTag *Pointer_Tag_1 = *(const TIDPArchiveTag **) Pointer_Pointer_Tag_1, *Pointer_Tag_2 = *(const TIDPArchiveTag **) Pointer_Pointer_Tag_2;
+
+	return IDPArchiveCompareTagNames(Pointer_Tag_1->Pointer_String_Name, Pointer_Tag_2->Pointer_String_Name);
+}
+
+/** Parse the archive tags directory to build the index, then try to store it to the index file.
+ * @param Pointer_String_IDP_File The archive.
+ * @param Pointer_String_Index_File The index file to create.
+ * @param Pointer_Header The archive key, it is stored in the index file.
+ * @param Pointer_Index On output, contain the index.
+ * @return -1 if an error occurred,
+ * @return 0 on success.
+ */
+static int IDPIndexBuild(char *Pointer_String_IDP_File, char *Pointer_String_Index_File, TIDPIndexHeader *Pointer_Header, TIDPIndex *Pointer_Index)
+{
+	TIDPArchive Archive;
+	TIDPArchiveTag **Pointer_Pointer_Sorted_Tags = NULL, *Pointer_Tag;
+	TIDPIndexEntry *Pointer_Entry;
+	size_t Names_Size = 0, Name_Size, File_Size;
+	int i, Return_Value = -1, Is_Write_Successful;
+	FILE *Pointer_File;
+
+	if (IDPArchiveOpen(Pointer_String_IDP_File, IDP_ARCHIVE_ACCESS_MODE_STREAMED, &Archive) != 0) return -1;
+
+	// Sort the tags by name
+	Pointer_Pointer_Sorted_Tags = malloc(sizeof(TIDPArchiveTag *) * (Archive.Tags_Count + 1)); // Make sure to allocate something for empty archives
+	if (Pointer_Pointer_Sorted_Tags == NULL)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to allocate the sorted tags list (%s).\n", strerror(errno));
+		goto Exit;
+	}
+	for (i = 0; i < Archive.Tags_Count; i++)
+	{
+		Pointer_Pointer_Sorted_Tags[i] = &Archive.Pointer_Tags[i];
+		Names_Size += strlen(Archive.Pointer_Tags[i].Pointer_String_Name) + 1;
+	}
+	qsort(Pointer_Pointer_Sorted_Tags, Archive.Tags_Count, sizeof(TIDPArchiveTag *), IDPIndexCompareTagNames);
+	Names_Size++; // Always end the names table with an empty string, so it is never empty
+
+	// Store everything in a single buffer, laid out like the index file
+	File_Size = sizeof(TIDPIndexHeader) + sizeof(TIDPIndexEntry) * Archive.Tags_Count + Names_Size;
+	Pointer_Index->Pointer_Buffer = malloc(File_Size);
+	if (Pointer_Index->Pointer_Buffer == NULL)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to allocate the index (%s).\n", strerror(errno));
+		goto Exit;
+	}
+	memcpy(Pointer_Header->Magic_Number, "IDPX", 4);
+	Pointer_Header->Version = IDP_INDEX_VERSION;
+	Pointer_Header->Entries_Count = Archive.Tags_Count;
+	Pointer_Header->Names_Size = (int) Names_Size;
+	memcpy(Pointer_Index->Pointer_Buffer, Pointer_Header, sizeof(TIDPIndexHeader));
+	Pointer_Index->Pointer_Entries = (TIDPIndexEntry *) (Pointer_Index->Pointer_Buffer + sizeof(TIDPIndexHeader));
+	Pointer_Index->Entries_Count = Archive.Tags_Count;
+	Pointer_Index->Pointer_Names = (char *) (Pointer_Index->Pointer_Entries + Archive.Tags_Count);
+
+	Names_Size = 0;
+	for (i = 0; i < Archive.Tags_Count; i++)
+	{
+		Pointer_Tag = Pointer_Pointer_Sorted_Tags[i];
+		Pointer_Entry = &Pointer_Index->Pointer_Entries[i];
+
+		Pointer_Entry->Name_Offset = (int) Names_Size;
+		Pointer_Entry->Tag_Index = (int) (Pointer_Tag - Archive.Pointer_Tags);
+		Pointer_Entry->Data_Offset = Archive.Data_Area_Offset + Pointer_Tag->Data_Offset; // IDPArchiveOpen() made sure that the data are located in the archive, which size is stored on 32 bits
+		Pointer_Entry->Data_Size = Pointer_Tag->Data_Size;
+
+		Name_Size = strlen(Pointer_Tag->Pointer_String_Name) + 1;
+		memcpy(Pointer_Index->Pointer_Names + Names_Size, Pointer_Tag->Pointer_String_Name, Name_Size);
+		Names_Size += Name_Size;
+	}
+	Pointer_Index->Pointer_Names[Names_Size] = 0;
+
+	// The index can be used even if it can't be stored, for instance when the archive directory is read-only
+	Pointer_File = fopen(Pointer_String_Index_File, "wb");
+	if (Pointer_File == NULL) LogPrint(LOG_LEVEL_WARNING, "Warning : failed to create the index file '%s' (%s).\n", Pointer_String_Index_File, strerror(errno));
+	else
+	{
+		// Always close the file, even if the writing failed
+		Is_Write_Successful = FileSystemWriteFile(Pointer_Index->Pointer_Buffer, File_Size, Pointer_File) == File_Size;
+		if (fclose(Pointer_File) != 0) Is_Write_Successful = 0;
+		if (!Is_Write_Successful)
+		{
+			LogPrint(LOG_LEVEL_WARNING, "Warning : failed to write the index file '%s' (%s).\n", Pointer_String_Index_File, strerror(errno));
+			remove(Pointer_String_Index_File);
+		}
+	}
+	Return_Value = 0;
+
+Exit:
+	if (Pointer_Pointer_Sorted_Tags != NULL) free(Pointer_Pointer_Sorted_Tags);
+	IDPArchiveClose(&Archive);
+	return Return_Value;
+}
+
+//-------------------------------------------------------------------------------------------------
+// Public functions
+//-------------------------------------------------------------------------------------------------
+int IDPIndexLoad(char *Pointer_String_IDP_File, TIDPIndex *Pointer_Index)
+{
+	TIDPIndexHeader Header;
+	char *Pointer_String_Index_File;
+	int Return_Value = -1;
+
+	memset(Pointer_Index, 0, sizeof(TIDPIndex));
+	memset(&Header, 0, sizeof(Header));
+	if (IDPIndexComputeArchiveKey(Pointer_String_IDP_File, &Header) != 0) return -1;
+
+	Pointer_String_Index_File = malloc(strlen(Pointer_String_IDP_File) + sizeof(".idx"));
+	if (Pointer_String_Index_File == NULL)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to allocate the index file path (%s).\n", strerror(errno));
+		return -1;
+	}
+	sprintf(Pointer_String_Index_File, "%s.idx", Pointer_String_IDP_File);
+
+	// Parse the archive only if the index file can't be used
+	if (IDPIndexLoadFile(Pointer_String_Index_File, &Header, Pointer_Index) == 0) Return_Value = 0;
+	else
+	{
+		LogPrint(LOG_LEVEL_INFORMATION, "The index file '%s' is missing or outdated, building it.\n", Pointer_String_Index_File);
+		Return_Value = IDPIndexBuild(Pointer_String_IDP_File, Pointer_String_Index_File, &Header, Pointer_Index);
+		if (Return_Value != 0) IDPIndexFree(Pointer_Index);
+	}
+
+	free(Pointer_String_Index_File);
+	return Return_Value;
+}
+
+TIDPIndexEntry *IDPIndexFind(TIDPIndex *Pointer_Index, const char *Pointer_String_Tag_Name)
+{
+	int Lowest_Index = 0, Highest_Index = Pointer_Index->Entries_Count - 1, Middle_Index, Result;
+
+	while (Lowest_Index <= Highest_Index)
+	{
+		Middle_Index = Lowest_Index + (Highest_Index - Lowest_Index) / 2;
+		Result = IDPArchiveCompareTagNames(Pointer_String_Tag_Name, Pointer_Index->Pointer_Names + Pointer_Index->Pointer_Entries[Middle_Index].Name_Offset);
+
+		if (Result == 0) return &Pointer_Index->Pointer_Entries[Middle_Index];
+		if (Result < 0) Highest_Index = Middle_Index - 1;
+		else Lowest_Index = Middle_Index + 1;
+	}
+
+	return NULL;
+}
+
+void IDPIndexFree(TIDPIndex *Pointer_Index)
+{
+	if (Pointer_Index->Pointer_Buffer != NULL) free(Pointer_Index->Pointer_Buffer);
+	memset(Pointer_Index, 0, sizeof(TIDPIndex));
+}
@@ -0,0 +1,223 @@
+/** @file IDP_Reader.c
+ * See IDP_Reader.h for description.
+ * @author Adrien RICCIARDI
+ */
+#include <errno.h>
+#include <IDP_Reader.h>
+#include <Log.h>
+#include <stdlib.h>
+#include <string.h>
+
+//-------------------------------------------------------------------------------------------------
+// Private functions
+//-------------------------------------------------------------------------------------------------
+/** Sort the tags by name.
+ * @param Pointer_Tag_1 A pointer on the first tag pointer.
+ * @param Pointer_Tag_2 A pointer on the second tag pointer.
+ * @return The IDPArchiveCompareTagNames() result.
+ */
+static int IDPReaderCompareTags(const void *Pointer_Tag_1, const void *Pointer_Tag_2)
+{
+	const TIDPArchiveTag *Pointer_Tag_A = *(TIDPArchiveTag * const *) Pointer_Tag_1, *Pointer_Tag_B = *(TIDPArchiveTag * const *) Pointer_Tag_2;
+
+	return IDPArchiveCompareTagNames(Pointer_Tag_A->Pointer_String_Name, Pointer_Tag_B->Pointer_String_Name);
+}
+
+/** Remove an entry from the cache entries list. The cache mutex must be taken.
+ * @param Pointer_Reader The reader owning the cache.
+ * @param Pointer_Entry The entry to remove.
+ */
+static void IDPReaderUnlinkEntry(TIDPReader *Pointer_Reader, TIDPReaderCacheEntry *Pointer_Entry)
+{
+	if (Pointer_Entry->Pointer_Previous_Entry == NULL) Pointer_Reader->Pointer_Most_Recent_Entry = Pointer_Entry->Pointer_Next_Entry;
+	else Pointer_Entry->Pointer_Previous_Entry->Pointer_Next_Entry = Pointer_Entry->Pointer_Next_Entry;
+	if (Pointer_Entry->Pointer_Next_Entry == NULL) Pointer_Reader->Pointer_Least_Recent_Entry = Pointer_Entry->Pointer_Previous_Entry;
+	else Pointer_Entry->Pointer_Next_Entry->Pointer_Previous_Entry = Pointer_Entry->Pointer_Previous_Entry;
+}
+
+/** Insert an entry at the cache entries list head, making it the most recently used one. The cache mutex must be taken.
+ * @param Pointer_Reader The reader owning the cache.
+ * @param Pointer_Entry The entry to insert.
+ */
+static void IDPReaderLinkEntry(TIDPReader *Pointer_Reader, TIDPReaderCacheEntry *Pointer_Entry)
+{
+	Pointer_Entry->Pointer_Previous_Entry = NULL;
+	Pointer_Entry->Pointer_Next_Entry = Pointer_Reader->Pointer_Most_Recent_Entry;
+	if (Pointer_Reader->Pointer_Most_Recent_Entry == NULL) Pointer_Reader->Pointer_Least_Recent_Entry = Pointer_Entry;
+	else Pointer_Reader->Pointer_Most_Recent_Entry->Pointer_Previous_Entry = Pointer_Entry;
+	Pointer_Reader->Pointer_Most_Recent_Entry = Pointer_Entry;
+}
+
+/** Release a cache entry and its data. The entry must not be in the cache entries list anymore.
+ * @param Pointer_Entry The entry to release.
+ */
+static void IDPReaderFreeEntry(TIDPReaderCacheEntry *Pointer_Entry)
+{
+	free(Pointer_Entry->Pointer_Data);
+	free(Pointer_Entry);
+}
+
+//-------------------------------------------------------------------------------------------------
+// Public functions
+//-------------------------------------------------------------------------------------------------
+int IDPReaderOpen(char *Pointer_String_IDP_File, long long Cache_Maximum_Size, TIDPReader *Pointer_Reader)
+{
+	int i;
+
+	memset(Pointer_Reader, 0, sizeof(TIDPReader));
+	if (IDPArchiveOpen(Pointer_String_IDP_File, IDP_ARCHIVE_ACCESS_MODE_STREAMED, &Pointer_Reader->Archive) != 0) return -1;
+
+	// Always allocate something, even for an empty archive
+	Pointer_Reader->Pointer_Pointer_Sorted_Tags = malloc((Pointer_Reader->Archive.Tags_Count + 1) * sizeof(TIDPArchiveTag *));
+	Pointer_Reader->Pointer_Pointer_Cache_Entries = calloc(Pointer_Reader->Archive.Tags_Count + 1, sizeof(TIDPReaderCacheEntry *));
+	if ((Pointer_Reader->Pointer_Pointer_Sorted_Tags == NULL) || (Pointer_Reader->Pointer_Pointer_Cache_Entries == NULL))
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to allocate the IDP reader tables (%s).\n", strerror(errno));
+		free(Pointer_Reader->Pointer_Pointer_Sorted_Tags);
+		free(Pointer_Reader->Pointer_Pointer_Cache_Entries);
+		IDPArchiveClose(&Pointer_Reader->Archive);
+		return -1;
+	}
+
+	// Sort the tags by name once, so each lookup is a binary search
+	for (i = 0; i < Pointer_Reader->Archive.Tags_Count; i++) Pointer_Reader->Pointer_Pointer_Sorted_Tags[i] = &Pointer_Reader->Archive.Pointer_Tags[i];
+	qsort(Pointer_Reader->Pointer_Pointer_Sorted_Tags, Pointer_Reader->Archive.Tags_Count, sizeof(TIDPArchiveTag *), IDPReaderCompareTags);
+
+	if (Cache_Maximum_Size < 0) Cache_Maximum_Size = 0;
+	Pointer_Reader->Cache_Maximum_Size = Cache_Maximum_Size;
+	ThreadMutexInitialize(&Pointer_Reader->Cache_Mutex);
+
+	LogPrint(LOG_LEVEL_DEBUG, "Opened IDP reader on '%s' with a cache of %lld bytes.\n", Pointer_String_IDP_File, Cache_Maximum_Size);
+	return 0;
+}
+
+int IDPReaderFindTag(TIDPReader *Pointer_Reader, const char *Pointer_String_Tag_Name)
+{
+	int First = 0, Last = Pointer_Reader->Archive.Tags_Count - 1, Middle, Result;
+
+	while (First <= Last)
+	{
+		Middle = First + (Last - First) / 2;
+		Result = IDPArchiveCompareTagNames(Pointer_String_Tag_Name, Pointer_Reader->Pointer_Pointer_Sorted_Tags[Middle]->Pointer_String_Name);
+		if (Result == 0) return (int) (Pointer_Reader->Pointer_Pointer_Sorted_Tags[Middle] - Pointer_Reader->Archive.Pointer_Tags);
+		if (Result < 0) Last = Middle - 1;
+		else First = Middle + 1;
+	}
+
+	return -1;
+}
+
+int IDPReaderReadTag(TIDPReader *Pointer_Reader, int Tag_Index, int Offset, void *Pointer_Buffer, int Size)
+{
+	TIDPArchiveTag *Pointer_Tag;
+	TIDPReaderCacheEntry *Pointer_Entry, *Pointer_Evicted_Entry;
+
+	if ((Tag_Index < 0) || (Tag_Index >= Pointer_Reader->Archive.Tags_Count))
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : tag %d does not exist.\n", Tag_Index);
+		return -1;
+	}
+	Pointer_Tag = &Pointer_Reader->Archive.Pointer_Tags[Tag_Index];
+
+	// Make sure the requested area is located in the tag data
+	if ((Offset < 0) || (Size < 0) || (Offset > Pointer_Tag->Data_Size - Size))
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : the requested area (offset %d, size %d) is outside of tag %d data.\n", Offset, Size, Tag_Index);
+		return -1;
+	}
+
+	// A tag that can't fit in the cache is always read from the file
+	if (Pointer_Tag->Data_Size > Pointer_Reader->Cache_Maximum_Size)
+	{
+		ThreadMutexLock(&Pointer_Reader->Cache_Mutex);
+		Pointer_Reader->Cache_Misses_Count++;
+		ThreadMutexUnlock(&Pointer_Reader->Cache_Mutex);
+		return IDPArchiveReadTagData(&Pointer_Reader->Archive, Tag_Index, Offset, Pointer_Buffer, Size);
+	}
+
+	// Serve the read from the cache when possible
+	ThreadMutexLock(&Pointer_Reader->Cache_Mutex);
+	Pointer_Entry = Pointer_Reader->Pointer_Pointer_Cache_Entries[Tag_Index];
+	if (Pointer_Entry != NULL)
+	{
+		IDPReaderUnlinkEntry(Pointer_Reader, Pointer_Entry);
+		IDPReaderLinkEntry(Pointer_Reader, Pointer_Entry);
+		memcpy(Pointer_Buffer, Pointer_Entry->Pointer_Data + Offset, Size);
+		Pointer_Reader->Cache_Hits_Count++;
+		ThreadMutexUnlock(&Pointer_Reader->Cache_Mutex);
+		return 0;
+	}
+	Pointer_Reader->Cache_Misses_Count++;
+	ThreadMutexUnlock(&Pointer_Reader->Cache_Mutex);
+
+	// Read the whole tag without holding the cache lock, so the other threads can still use the cache meanwhile
+	Pointer_Entry = malloc(sizeof(TIDPReaderCacheEntry));
+	if (Pointer_Entry == NULL)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to allocate a cache entry for tag %d (%s).\n", Tag_Index, strerror(errno));
+		return -1;
+	}
+	Pointer_Entry->Tag_Index = Tag_Index;
+	Pointer_Entry->Pointer_Data = malloc(Pointer_Tag->Data_Size + 1); // Always allocate something, even for an empty tag
+	if (Pointer_Entry->Pointer_Data == NULL)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to allocate %d bytes to cache tag %d (%s).\n", Pointer_Tag->Data_Size, Tag_Index, strerror(errno));
+		free(Pointer_Entry);
+		return -1;
+	}
+	if (IDPArchiveReadTagData(&Pointer_Reader->Archive, Tag_Index, 0, Pointer_Entry->Pointer_Data, Pointer_Tag->Data_Size) != 0)
+	{
+		IDPReaderFreeEntry(Pointer_Entry);
+		return -1;
+	}
+
+	ThreadMutexLock(&Pointer_Reader->Cache_Mutex);
+	// Another thread may have cached the same tag in the meantime, keep its entry
+	if (Pointer_Reader->Pointer_Pointer_Cache_Entries[Tag_Index] != NULL)
+	{
+		memcpy(Pointer_Buffer, Pointer_Entry->Pointer_Data + Offset, Size);
+		ThreadMutexUnlock(&Pointer_Reader->Cache_Mutex);
+		IDPReaderFreeEntry(Pointer_Entry);
+		return 0;
+	}
+
+	// Evict the least recently used tags until the new one fits
+	while (Pointer_Reader->Cache_Size + Pointer_Tag->Data_Size > Pointer_Reader->Cache_Maximum_Size)
+	{
+		Pointer_Evicted_Entry = Pointer_Reader->Pointer_Least_Recent_Entry;
+		IDPReaderUnlinkEntry(Pointer_Reader, Pointer_Evicted_Entry);
+		Pointer_Reader->Pointer_Pointer_Cache_Entries[Pointer_Evicted_Entry->Tag_Index] = NULL;
+		Pointer_Reader->Cache_Size -= Pointer_Reader->Archive.Pointer_Tags[Pointer_Evicted_Entry->Tag_Index].Data_Size;
+		IDPReaderFreeEntry(Pointer_Evicted_Entry);
+	}
+	IDPReaderLinkEntry(Pointer_Reader, Pointer_Entry);
+	Pointer_Reader->Pointer_Pointer_Cache_Entries[Tag_Index] = Pointer_Entry;
+	Pointer_Reader->Cache_Size += Pointer_Tag->Data_Size;
+	memcpy(Pointer_Buffer, Pointer_Entry->Pointer_Data + Offset, Size);
+	ThreadMutexUnlock(&Pointer_Reader->Cache_Mutex);
+	return 0;
+}
+
+void IDPReaderClose(TIDPReader *Pointer_Reader)
+{
+	TIDPReaderCacheEntry *Pointer_Entry, *Pointer_Next_Entry;
+
+	// Release all cached data
+	Pointer_Entry = Pointer_Reader->Pointer_Most_Recent_Entry;
+	while (Pointer_Entry != NULL)
+	{
+		Pointer_Next_Entry = Pointer_Entry->Pointer_Next_Entry;
+		IDPReaderFreeEntry(Pointer_Entry);
+		Pointer_Entry = Pointer_Next_Entry;
+	}
+	Pointer_Reader->Pointer_Most_Recent_Entry = NULL;
+	Pointer_Reader->Pointer_Least_Recent_Entry = NULL;
+	Pointer_Reader->Cache_Size = 0;
+
+	free(Pointer_Reader->Pointer_Pointer_Sorted_Tags);
+	Pointer_Reader->Pointer_Pointer_Sorted_Tags = NULL;
+	free(Pointer_Reader->Pointer_Pointer_Cache_Entries);
+	Pointer_Reader->Pointer_Pointer_Cache_Entries = NULL;
+	ThreadMutexDestroy(&Pointer_Reader->Cache_Mutex);
+	IDPArchiveClose(&Pointer_Reader->Archive);
+}
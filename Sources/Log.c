@@ -0,0 +1,165 @@
+/** @file Log.c
+ * See Log.h for description.
+ * @author Adrien RICCIARDI
+ */
+#include <errno.h>
+#include <Log.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <Thread.h>
+#ifndef _WIN32
+	#include <time.h>
+#endif
+
+//-------------------------------------------------------------------------------------------------
+// Private constants
+//-------------------------------------------------------------------------------------------------
+/** The sink buffer size in bytes. */
+#define LOG_BUFFER_SIZE (64 * 1024)
+
+/** The minimum time in milliseconds between two progress displays. */
+#define LOG_PROGRESS_DISPLAY_PERIOD 1000
+
+//-------------------------------------------------------------------------------------------------
+// Private variables
+//-------------------------------------------------------------------------------------------------
+/** Where the messages are written to. */
+static FILE *Pointer_Log_File;
+/** The least important displayed level. */
+static TLogLevel Log_Level = LOG_LEVEL_INFORMATION;
+/** Serialize the sink accesses. */
+static TThreadMutex Log_Mutex;
+
+//-------------------------------------------------------------------------------------------------
+// Private functions
+//-------------------------------------------------------------------------------------------------
+/** Get a monotonic time.
+ * @return The time in milliseconds, from an unspecified origin.
+ */
+static long long LogGetTime(void)
+{
+#ifdef _WIN32
+	return (long long) GetTickCount64();
+#else
+	struct timespec Time;
+
+	clock_gettime(CLOCK_MONOTONIC, &Time);
+	return (long long) Time.tv_sec * 1000 + Time.tv_nsec / 1000000;
+#endif
+}
+
+/** Display the progress and the speed of an operation. The log mutex must be taken.
+ * @param Pointer_Progress The operation progress.
+ * @param Current_Time The current time in milliseconds.
+ */
+static void LogProgressDisplay(TLogProgress *Pointer_Progress, long long Current_Time)
+{
+	double Elapsed_Seconds;
+
+	Elapsed_Seconds = (Current_Time - Pointer_Progress->Start_Time) / 1000.0;
+	if (Elapsed_Seconds <= 0) Elapsed_Seconds = 0.001; // Avoid a division by zero on very fast operations
+
+	fprintf(Pointer_Log_File, "Progress : %d/%d %s (%.1f %s/s, %.1f MB/s).\n", Pointer_Progress->Processed_Items_Count, Pointer_Progress->Items_Count, Pointer_Progress->Pointer_String_Items_Name, Pointer_Progress->Processed_Items_Count / Elapsed_Seconds, Pointer_Progress->Pointer_String_Items_Name, Pointer_Progress->Processed_Bytes_Count / Elapsed_Seconds / (1024.0 * 1024.0));
+	// Make sure the progress is displayed now, it is the only sign of life of a long operation
+	fflush(Pointer_Log_File);
+	Pointer_Progress->Last_Display_Time = Current_Time;
+}
+
+//-------------------------------------------------------------------------------------------------
+// Public functions
+//-------------------------------------------------------------------------------------------------
+void LogInitialize(void)
+{
+	ThreadMutexInitialize(&Log_Mutex);
+
+	// Buffer the standard output even when it is a console, each console write is very slow on Windows
+	setvbuf(stdout, NULL, _IOFBF, LOG_BUFFER_SIZE);
+	Pointer_Log_File = stdout;
+}
+
+void LogTerminate(void)
+{
+	fflush(Pointer_Log_File);
+	if (Pointer_Log_File != stdout)
+	{
+		fclose(Pointer_Log_File);
+		Pointer_Log_File = stdout;
+	}
+	ThreadMutexDestroy(&Log_Mutex);
+}
+
+void LogSetLevel(TLogLevel Level)
+{
+	Log_Level = Level;
+}
+
+TLogLevel LogGetLevel(void)
+{
+	return Log_Level;
+}
+
+int LogSetFile(const char *Pointer_String_File)
+{
+	FILE *Pointer_File;
+
+	Pointer_File = fopen(Pointer_String_File, "w");
+	if (Pointer_File == NULL)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to create the log file '%s' (%s).\n", Pointer_String_File, strerror(errno));
+		return -1;
+	}
+	setvbuf(Pointer_File, NULL, _IOFBF, LOG_BUFFER_SIZE);
+
+	fflush(Pointer_Log_File);
+	if (Pointer_Log_File != stdout) fclose(Pointer_Log_File);
+	Pointer_Log_File = Pointer_File;
+	return 0;
+}
+
+void LogPrint(TLogLevel Level, const char *Pointer_String_Format, ...)
+{
+	va_list Arguments_List;
+
+	if (Level > Log_Level) return;
+
+	ThreadMutexLock(&Log_Mutex);
+	va_start(Arguments_List, Pointer_String_Format);
+	vfprintf(Pointer_Log_File, Pointer_String_Format, Arguments_List);
+	va_end(Arguments_List);
+	if (Level == LOG_LEVEL_ERROR) fflush(Pointer_Log_File);
+	ThreadMutexUnlock(&Log_Mutex);
+}
+
+void LogProgressInitialize(TLogProgress *Pointer_Progress, const char *Pointer_String_Items_Name, int Items_Count)
+{
+	Pointer_Progress->Pointer_String_Items_Name = Pointer_String_Items_Name;
+	Pointer_Progress->Items_Count = Items_Count;
+	Pointer_Progress->Processed_Items_Count = 0;
+	Pointer_Progress->Processed_Bytes_Count = 0;
+	Pointer_Progress->Start_Time = LogGetTime();
+	Pointer_Progress->Last_Display_Time = Pointer_Progress->Start_Time;
+}
+
+void LogProgressUpdate(TLogProgress *Pointer_Progress, int Items_Count, long long Bytes_Count)
+{
+	long long Current_Time;
+
+	ThreadMutexLock(&Log_Mutex);
+	Pointer_Progress->Processed_Items_Count += Items_Count;
+	Pointer_Progress->Processed_Bytes_Count += Bytes_Count;
+
+	if (Log_Level >= LOG_LEVEL_INFORMATION)
+	{
+		Current_Time = LogGetTime();
+		if (Current_Time - Pointer_Progress->Last_Display_Time >= LOG_PROGRESS_DISPLAY_PERIOD) LogProgressDisplay(Pointer_Progress, Current_Time);
+	}
+	ThreadMutexUnlock(&Log_Mutex);
+}
+
+void LogProgressTerminate(TLogProgress *Pointer_Progress)
+{
+	ThreadMutexLock(&Log_Mutex);
+	if (Log_Level >= LOG_LEVEL_INFORMATION) LogProgressDisplay(Pointer_Progress, LogGetTime());
+	ThreadMutexUnlock(&Log_Mutex);
+}
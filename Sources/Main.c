@@ -2,22 +2,178 @@
  * Propose a collection of tools to mod Stealth Combat - Utimate War.
  * @author Adrien RICCIARDI
  */
-#include <direct.h>
+#include <Benchmark.h>
+#include <errno.h>
+#include <File_System.h>
 #include <IDP_Archive.h>
+#include <IDP_Index.h>
+#include <Log.h>
 #include <Map.h>
+#include <Statistics.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
-#include <Windows.h>
+#include <Thread.h>
+#include <Unit_Index.h>
 
 //-------------------------------------------------------------------------------------------------
 // Private constants
 //-------------------------------------------------------------------------------------------------
+/** The command string to measure the tools performance. */
+#define MAIN_COMMAND_STRING_BENCHMARK "-benchmark"
+/** The command string to generate a synthetic IDP file. */
+#define MAIN_COMMAND_STRING_BENCHMARK_GENERATE_IDP "-benchmark-generate-idp"
+/** The command string to generate a synthetic map file. */
+#define MAIN_COMMAND_STRING_BENCHMARK_GENERATE_MAP "-benchmark-generate-map"
 /** The command string to build an IDP file. */
 #define MAIN_COMMAND_STRING_IDP_BUILD "-idp-build"
+/** The command string to remove the unused data from an IDP file. */
+#define MAIN_COMMAND_STRING_IDP_COMPACT "-idp-compact"
+/** The command string to compare the tags of two IDP files. */
+#define MAIN_COMMAND_STRING_IDP_DIFF "-idp-diff"
+/** The command string to copy an IDP file, optionally storing the identical tags data only once. */
+#define MAIN_COMMAND_STRING_IDP_REPACK "-idp-repack"
 /** The command string to extract an IDP file content. */
 #define MAIN_COMMAND_STRING_IDP_EXTRACT "-idp-extract"
+/** The command string to display the location of some tags of an IDP file. */
+#define MAIN_COMMAND_STRING_IDP_FIND "-idp-find"
+/** The command string to display the tags of an IDP file. */
+#define MAIN_COMMAND_STRING_IDP_LIST "-idp-list"
+/** The command string to replace some tags data of an IDP file. */
+#define MAIN_COMMAND_STRING_IDP_PATCH "-idp-patch"
 /** The command string to extract a map file content. */
 #define MAIN_COMMAND_STRING_MAP_EXTRACT "-map-extract"
+/** The command string to extract all map files of a directory. */
+#define MAIN_COMMAND_STRING_MAP_EXTRACT_ALL "-map-extract-all"
+/** The command string to display a map file table of contents. */
+#define MAIN_COMMAND_STRING_MAP_INFORMATION "-map-info"
+/** The command string to find the units close to locations. */
+#define MAIN_COMMAND_STRING_MAP_QUERY_UNITS "-map-query-units"
+
+/** The size in bytes of the buffer used to copy a file to an IDP archive. */
+#define MAIN_IDP_COPY_BUFFER_SIZE (1024 * 1024)
+
+/** The option string to store the identical tags data only once. */
+#define MAIN_OPTION_STRING_DEDUPLICATE "--dedup"
+/** The option string to exclude the tags matching a pattern. */
+#define MAIN_OPTION_STRING_EXCLUDE "--exclude"
+/** The option string to process only the tags matching a pattern. */
+#define MAIN_OPTION_STRING_INCLUDE "--include"
+/** The option string to process only the tags matching the patterns listed in a file. */
+#define MAIN_OPTION_STRING_INCLUDE_LIST "--include-list"
+/** The option string to set the scale between the unit coordinates and the terrain vertices. */
+#define MAIN_OPTION_STRING_COORDINATES_PER_VERTEX "--coordinates-per-vertex"
+/** The option string to read the queries from a file. */
+#define MAIN_OPTION_STRING_QUERIES "--queries"
+/** The option string to display the results in JSON format. */
+#define MAIN_OPTION_STRING_JSON "--json"
+/** The option string to set how many times each benchmark is run. */
+#define MAIN_OPTION_STRING_ITERATIONS "--iterations"
+/** The option string to send the messages to a file. */
+#define MAIN_OPTION_STRING_LOG_FILE "--log-file"
+/** The option string to display only the errors and warnings. */
+#define MAIN_OPTION_STRING_QUIET "--quiet"
+/** The option string to write the benchmark results to a file. */
+#define MAIN_OPTION_STRING_REPORT "--report"
+/** The option string to write the terrain heights as a raster. */
+#define MAIN_OPTION_STRING_HEIGHTMAP "--heightmap"
+/** The option string to write the command statistics to a file. */
+#define MAIN_OPTION_STRING_STATISTICS "--stats"
+/** The option string to select the terrain file format. */
+#define MAIN_OPTION_STRING_TERRAIN_FORMAT "--terrain-format"
+/** The option string to write the terrain to one file per block of tiles. */
+#define MAIN_OPTION_STRING_TERRAIN_CHUNKS "--terrain-chunks"
+/** The option string to write how many simplified terrain levels of detail. */
+#define MAIN_OPTION_STRING_TERRAIN_LEVELS_OF_DETAIL "--terrain-lod-levels"
+/** The option string to simplify the terrain with a maximum height error. */
+#define MAIN_OPTION_STRING_TERRAIN_MAXIMUM_ERROR "--terrain-max-error"
+/** The option string to store the terrain faces as triangle strips. */
+#define MAIN_OPTION_STRING_TERRAIN_STRIPS "--terrain-strips"
+/** The option string to display detailed messages. */
+#define MAIN_OPTION_STRING_VERBOSE "--verbose"
+/** The option string to set how many worker threads to use. */
+#define MAIN_OPTION_STRING_JOBS "--jobs"
+/** The option string to limit the memory used to extract an IDP file. */
+#define MAIN_OPTION_STRING_MAXIMUM_MEMORY "--max-memory"
+
+/** The largest terrain levels of detail count, the error is doubled at each level. */
+#define MAIN_MAXIMUM_TERRAIN_LEVELS_OF_DETAIL_COUNT 16
+/** The largest terrain chunk side in tiles, a larger chunk is clamped to the map size anyway. */
+#define MAIN_MAXIMUM_TERRAIN_CHUNK_TILES_COUNT 4096
+
+//-------------------------------------------------------------------------------------------------
+// Private types
+//-------------------------------------------------------------------------------------------------
+/** Select the tags to process according to their names. */
+typedef struct
+{
+	char **Pointer_Pointer_Strings_Include_Patterns; //!< A tag must match one of these patterns to be selected. When there is no pattern, all tags are included.
+	int Include_Patterns_Count; //!< How many include patterns there are.
+	char **Pointer_Pointer_Strings_Exclude_Patterns; //!< A tag matching one of these patterns is never selected.
+	int Exclude_Patterns_Count; //!< How many exclude patterns there are.
+} TMainTagFilter;
+
+/** Everything the IDP extraction workers need. */
+typedef struct
+{
+	TIDPArchive *Pointer_Archive; //!< The archive to extract.
+	TIDPArchiveTag **Pointer_Pointer_Sorted_Tags; //!< The tags to write, the largest ones first.
+	unsigned char *Pointer_Buffers; //!< In streamed mode, one copy buffer per worker.
+	int Buffer_Size; //!< The size in bytes of a single worker copy buffer.
+	TLogProgress *Pointer_Progress; //!< The extraction progress.
+} TMainIDPExtractionContext;
+
+/** Everything the IDP build workers need. */
+typedef struct
+{
+	char *Pointer_String_Input_Directory; //!< The directory containing the files to store in the archive.
+	TIDPArchiveTag **Pointer_Pointer_Sorted_Tags; //!< The tags to write, the largest ones first.
+	FILE **Pointer_Pointer_Output_Files; //!< One archive file handle per worker, so the workers can seek without locking.
+	unsigned char *Pointer_Buffers; //!< One copy buffer of MAIN_IDP_COPY_BUFFER_SIZE bytes per worker.
+	long long Data_Area_Offset; //!< The archive data area offset from the archive beginning.
+	TLogProgress *Pointer_Progress; //!< The build progress.
+} TMainIDPBuildContext;
+
+/** How a tag differs between the two archives compared by the -idp-diff command. */
+typedef enum
+{
+	MAIN_IDP_DIFF_STATUS_ADDED, //!< The tag exists only in the new archive.
+	MAIN_IDP_DIFF_STATUS_REMOVED, //!< The tag exists only in the old archive.
+	MAIN_IDP_DIFF_STATUS_CHANGED, //!< The tag exists in both archives with different data.
+	MAIN_IDP_DIFF_STATUS_UNCHANGED //!< The tag exists in both archives with the same data.
+} TMainIDPDiffStatus;
+
+/** A tag compared by the -idp-diff command. */
+typedef struct
+{
+	TIDPArchiveTag *Pointer_Old_Tag; //!< The tag in the old archive, or NULL if the tag was added.
+	TIDPArchiveTag *Pointer_New_Tag; //!< The tag in the new archive, or NULL if the tag was removed.
+	TMainIDPDiffStatus Status; //!< How the tag differs.
+} TMainIDPDiffEntry;
+
+/** A tag hashed by the -idp-repack command. */
+typedef struct
+{
+	unsigned long long Hash; //!< The tag data hash.
+	TIDPArchiveTag *Pointer_Tag; //!< The tag.
+} TMainIDPRepackEntry;
+
+/** A map to extract with the -map-extract-all command. */
+typedef struct
+{
+	char *Pointer_String_Map_File; //!< The map file path.
+	char *Pointer_String_Output_Directory; //!< The directory to extract the map to.
+	long long Size; //!< The map file size in bytes.
+	int Is_Extraction_Failed; //!< Set to 1 when the map could not be extracted.
+} TMainMapBatchItem;
+
+/** Everything the map extraction workers need. */
+typedef struct
+{
+	TMainMapBatchItem *Pointer_Items; //!< The maps to extract, the largest ones first.
+	TMapExtractionOptions *Pointer_Options; //!< How to extract the maps.
+	TLogProgress *Pointer_Progress; //!< The extraction progress.
+} TMainMapExtractionContext;
 
 //-------------------------------------------------------------------------------------------------
 // Private functions
@@ -27,160 +183,2360 @@
  */
 static void MainDisplayProgramUsage(char *Pointer_String_Program_Name)
 {
-	printf("Usage : %s Command [Arguments]\n"
+	printf("Usage : %s [Global_Options] Command [Arguments]\n"
+		"Global options (they can be put anywhere on the command line) :\n"
+		"  " MAIN_OPTION_STRING_QUIET " : display only the errors and warnings.\n"
+		"  " MAIN_OPTION_STRING_VERBOSE " : display detailed messages, like one message per processed tag or map record.\n"
+		"  " MAIN_OPTION_STRING_LOG_FILE " File : write the messages to a file instead of the console.\n"
+		"  " MAIN_OPTION_STRING_STATISTICS "=File : write the time spent in each processing phase, the I/O counters, the peak memory and the found map records to a JSON file.\n"
 		"Command :\n"
-		"  " MAIN_COMMAND_STRING_IDP_BUILD " Input_Directory Output_IDP_File (not implemented) : generate an IDP file from a directory. Input_Directory is the path of the source directory. Output_IDP_File is the path of the IDP file to create.\n"
-		"  " MAIN_COMMAND_STRING_IDP_EXTRACT " Input_IDP_File Output_Directory : extract the content from an existing IDP file (like SCom.idp). Input_IDP_File is the path of the IDP file to extract. Output_Directory is a directory path where the data will be extracted.\n"
-		"  " MAIN_COMMAND_STRING_MAP_EXTRACT " Input_Map_File Output_Directory : extract as much content as possible from an existing map file. Input_Map_File is the path of the map file to extract. Output_Directory is a directory path where the data will be extracted.\n"
+		"  " MAIN_COMMAND_STRING_BENCHMARK " Work_Directory [Options] : generate a synthetic IDP file and a synthetic map file in Work_Directory, then measure how fast they are read and extracted. The results are written in JSON format.\n"
+		"    " MAIN_OPTION_STRING_ITERATIONS " Count : run each benchmark Count times (default is 3), the best and the mean times are reported.\n"
+		"    " MAIN_OPTION_STRING_REPORT " File : write the results to a file instead of the console.\n"
+		"  " MAIN_COMMAND_STRING_BENCHMARK_GENERATE_IDP " Output_IDP_File Tags_Count Minimum_Tag_Size Maximum_Tag_Size [Seed] : generate an IDP file filled with random data.\n"
+		"  " MAIN_COMMAND_STRING_BENCHMARK_GENERATE_MAP " Output_Map_File Tiles_Per_Side Unit_Groups_Count Units_Per_Group_Count [Seed] : generate a map file with a random terrain and random units.\n"
+		"  " MAIN_COMMAND_STRING_IDP_BUILD " Input_Directory Output_IDP_File [Options] : generate an IDP file from a directory. Input_Directory is the path of the source directory. Output_IDP_File is the path of the IDP file to create.\n"
+		"    " MAIN_OPTION_STRING_JOBS " Count : read the files using Count threads (default is 1).\n"
+		"  " MAIN_COMMAND_STRING_IDP_COMPACT " Input_IDP_File Output_IDP_File : create a copy of an IDP file without the data that are not used by any tag anymore, like the data replaced by " MAIN_COMMAND_STRING_IDP_PATCH ". Output_IDP_File must be different from Input_IDP_File.\n"
+		"  " MAIN_COMMAND_STRING_IDP_DIFF " Old_IDP_File New_IDP_File [Options] : display the tags added, removed or changed in New_IDP_File compared to Old_IDP_File. The tags are matched by name, and the data of the tags whose size did not change are compared with a 64-bit hash. The exit code is 0 if the archives have the same content, 1 if they differ.\n"
+		"    " MAIN_OPTION_STRING_JSON " : display the differences in JSON format.\n"
+		"    " MAIN_OPTION_STRING_JOBS " Count : hash the tags data using Count threads (default is 1).\n"
+		"  " MAIN_COMMAND_STRING_IDP_EXTRACT " Input_IDP_File Output_Directory [Options] : extract the content from an existing IDP file (like SCom.idp). Input_IDP_File is the path of the IDP file to extract. Output_Directory is a directory path where the data will be extracted.\n"
+		"    " MAIN_OPTION_STRING_INCLUDE " Pattern : extract only the tags whose name matches the pattern, like 'app\\maps\\*'. '*' matches any characters and '?' matches a single character. This option can be repeated.\n"
+		"    " MAIN_OPTION_STRING_INCLUDE_LIST " File : extract only the tags matching one of the patterns listed in the file (one pattern or tag name per line).\n"
+		"    " MAIN_OPTION_STRING_EXCLUDE " Pattern : do not extract the tags whose name matches the pattern, like '*.wav'. This option can be repeated.\n"
+		"    " MAIN_OPTION_STRING_JOBS " Count : write the tag files using Count threads (default is 1).\n"
+		"    " MAIN_OPTION_STRING_MAXIMUM_MEMORY " Size : do not load the archive in memory, stream each tag data through a buffer of Size bytes instead (K, M and G suffixes are allowed).\n"
+		"  " MAIN_COMMAND_STRING_IDP_FIND " IDP_File Tag_Name_1 [Tag_Name_2 ...] : display the index, data offset from the archive beginning and data size of each given tag.\n"
+		"  " MAIN_COMMAND_STRING_IDP_LIST " IDP_File [Pattern] : display the data size and name of all tags sorted by name, or only of the tags matching the pattern (see " MAIN_OPTION_STRING_INCLUDE ").\n"
+		"  " MAIN_COMMAND_STRING_IDP_PATCH " IDP_File File_1 [File_2 ...] : replace the data of existing tags by the content of the given files. Each file path is the tag name, so run the command from the directory the archive was extracted to (for instance 'app\\scripts\\ga3.txt'). The new data are appended to the archive end and the replaced data are left unused.\n"
+		"  " MAIN_COMMAND_STRING_IDP_REPACK " Input_IDP_File Output_IDP_File [Options] : like " MAIN_COMMAND_STRING_IDP_COMPACT ", and also display how much space was saved.\n"
+		"    " MAIN_OPTION_STRING_DEDUPLICATE " : store the identical tags data only once, all tags with the same data point to a single copy. The data are found by hash then compared byte per byte.\n"
+		"    " MAIN_OPTION_STRING_JOBS " Count : hash the tags data using Count threads (default is 1).\n"
+		"  " MAIN_COMMAND_STRING_MAP_EXTRACT " Input_Map_File Output_Directory [Options] : extract as much content as possible from an existing map file. Input_Map_File is the path of the map file to extract, or an IDP archive followed by ':' and the map tag name (like 'SCom.idp:app\\maps\\ema1') to read the map straight from the archive. Output_Directory is a directory path where the data will be extracted.\n"
+		"    " MAIN_OPTION_STRING_TERRAIN_FORMAT " obj|glb|ply|none : select the terrain file format (default is obj). The glb (binary glTF) and ply (binary PLY) files are much smaller and faster to load than the obj text file. Use none to skip the terrain geometry.\n"
+		"    " MAIN_OPTION_STRING_TERRAIN_STRIPS " : store the glb or ply terrain faces as triangle strips instead of a triangles list.\n"
+		"    " MAIN_OPTION_STRING_TERRAIN_MAXIMUM_ERROR " Units : merge the terrain triangles as long as no height moves by more than Units (a height unit is 300 map height steps). Flat areas get much less triangles.\n"
+		"    " MAIN_OPTION_STRING_HEIGHTMAP " raw16|pgm|tiff16 : also write the original 16-bit terrain heights as a raster, with a Terrain_Heightmap.json file telling how to convert the samples to heights.\n"
+		"    " MAIN_OPTION_STRING_TERRAIN_CHUNKS " Tiles : write the full resolution terrain to one file per square block of Tiles x Tiles tiles in the Terrain_Chunks directory, with an Index.json file listing each chunk bounds and heights range. Neighbor chunks share their edge vertices.\n"
+		"    " MAIN_OPTION_STRING_JOBS " Count : write the terrain chunks using Count threads (default is 1).\n"
+		"    " MAIN_OPTION_STRING_TERRAIN_LEVELS_OF_DETAIL " Count : with " MAIN_OPTION_STRING_TERRAIN_MAXIMUM_ERROR ", also write Count - 1 coarser terrains named Terrain_Geometry_LOD<Level>, each level allows twice the error of the previous one (default is 1).\n"
+		"  " MAIN_COMMAND_STRING_MAP_EXTRACT_ALL " Maps_Directory Output_Directory [Options] : extract all map files found in Maps_Directory and its subdirectories (like the extracted 'app/maps' directory). Each map is extracted to a directory of Output_Directory named like the map file.\n"
+		"    " MAIN_OPTION_STRING_JOBS " Count : extract Count maps at the same time (default is 1).\n"
+		"    " MAIN_OPTION_STRING_TERRAIN_FORMAT ", " MAIN_OPTION_STRING_TERRAIN_STRIPS ", " MAIN_OPTION_STRING_TERRAIN_MAXIMUM_ERROR ", " MAIN_OPTION_STRING_TERRAIN_LEVELS_OF_DETAIL ", " MAIN_OPTION_STRING_TERRAIN_CHUNKS " and " MAIN_OPTION_STRING_HEIGHTMAP " : see " MAIN_COMMAND_STRING_MAP_EXTRACT ".\n"
+		"  " MAIN_COMMAND_STRING_MAP_INFORMATION " Map_File_1 [Map_File_2 ...] [Options] : display the records (identifier, offset and payload size), the records count and size per identifier, the map size and the unit groups of each map without extracting them. A directory can be given instead of a map file, all map files it contains are then displayed.\n"
+		"    " MAIN_OPTION_STRING_JSON " : display the information in JSON format.\n"
+		"  " MAIN_COMMAND_STRING_MAP_QUERY_UNITS " Map_File X Y Radius [Options] : display the units whose horizontal distance to the location (X, Y) is lower than or equal to Radius, sorted by distance, with the terrain height below each unit. The coordinates are the ones of the units file. Map_File can also be an IDP archive map tag (see " MAIN_COMMAND_STRING_MAP_EXTRACT ").\n"
+		"    " MAIN_OPTION_STRING_COORDINATES_PER_VERTEX " Count : how many unit coordinates there are between two terrain vertices, used to find the terrain height below the units (default is 64). The default value comes from the synthetic benchmark maps and has not been checked against the game maps yet.\n"
+		"    " MAIN_OPTION_STRING_QUERIES " File : run all queries of the file instead of the X Y Radius query, the map is read only once. Each line contains the X, Y and Radius values of a query, empty lines and lines starting with '#' are ignored.\n"
+		"    " MAIN_OPTION_STRING_JSON " : display the results in JSON format.\n"
 		"\n"
 		"Notes :\n"
-		"  * The map files are stored in the SCom.idp archive, so it needs to be extracted first.\n",
+		"  * The map files are stored in the SCom.idp archive. Either extract the archive first, or give the map as 'SCom.idp:app\\maps\\<Map_Name>'.\n"
+		"  * The " MAIN_COMMAND_STRING_IDP_FIND " and " MAIN_COMMAND_STRING_IDP_LIST " commands store the archive tags directory in an index file named like the archive followed by '.idx', so the next calls do not need to parse the archive. The index file is automatically updated when the archive changes.\n",
 		Pointer_String_Program_Name);
 }
 
+/** Convert a size string like "65536", "512K", "64M" or "1G" to a bytes count.
+ * @param Pointer_String_Size The string to convert.
+ * @param Pointer_Size On output, contain the size in bytes.
+ * @return -1 if the string is not a valid size,
+ * @return 0 on success.
+ */
+static int MainParseSize(char *Pointer_String_Size, long long *Pointer_Size)
+{
+	char *Pointer_String_Suffix;
+	long long Size;
+
+	Size = strtoll(Pointer_String_Size, &Pointer_String_Suffix, 10);
+	if ((Pointer_String_Suffix == Pointer_String_Size) || (Size <= 0)) return -1;
+
+	// Apply the optional unit
+	switch (*Pointer_String_Suffix)
+	{
+		case 0:
+			break;
+		case 'k':
+		case 'K':
+			Size *= 1024;
+			Pointer_String_Suffix++;
+			break;
+		case 'm':
+		case 'M':
+			Size *= 1024 * 1024;
+			Pointer_String_Suffix++;
+			break;
+		case 'g':
+		case 'G':
+			Size *= 1024 * 1024 * 1024;
+			Pointer_String_Suffix++;
+			break;
+		default:
+			return -1;
+	}
+	if (*Pointer_String_Suffix != 0) return -1;
+
+	*Pointer_Size = Size;
+	return 0;
+}
+
+/** Add a pattern to a tag filter.
+ * @param Pointer_Filter The filter to add the pattern to.
+ * @param Is_Exclude_Pattern Set to 1 to add an exclude pattern, set to 0 to add an include pattern.
+ * @param Pointer_String_Pattern The pattern to add, it is copied.
+ * @return -1 if an error occurred,
+ * @return 0 on success.
+ */
+static int MainTagFilterAddPattern(TMainTagFilter *Pointer_Filter, int Is_Exclude_Pattern, const char *Pointer_String_Pattern)
+{
+	char ***Pointer_Pointer_Pointer_Strings_Patterns, **Pointer_Pointer_Strings_Patterns, *Pointer_String_Pattern_Copy;
+	int *Pointer_Patterns_Count;
+
+	if (Is_Exclude_Pattern)
+	{
+		Pointer_Pointer_Pointer_Strings_Patterns = &Pointer_Filter->Pointer_Pointer_Strings_Exclude_Patterns;
+		Pointer_Patterns_Count = &Pointer_Filter->Exclude_Patterns_Count;
+	}
+	else
+	{
+		Pointer_Pointer_Pointer_Strings_Patterns = &Pointer_Filter->Pointer_Pointer_Strings_Include_Patterns;
+		Pointer_Patterns_Count = &Pointer_Filter->Include_Patterns_Count;
+	}
+
+	// Make room for the new pattern
+	Pointer_Pointer_Strings_Patterns = realloc(*Pointer_Pointer_Pointer_Strings_Patterns, sizeof(char *) * (*Pointer_Patterns_Count + 1));
+	if (Pointer_Pointer_Strings_Patterns == NULL)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to allocate the patterns list (%s).\n", strerror(errno));
+		return -1;
+	}
+	*Pointer_Pointer_Pointer_Strings_Patterns = Pointer_Pointer_Strings_Patterns;
+
+	Pointer_String_Pattern_Copy = malloc(strlen(Pointer_String_Pattern) + 1);
+	if (Pointer_String_Pattern_Copy == NULL)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to allocate the pattern (%s).\n", strerror(errno));
+		return -1;
+	}
+	strcpy(Pointer_String_Pattern_Copy, Pointer_String_Pattern);
+	Pointer_Pointer_Strings_Patterns[*Pointer_Patterns_Count] = Pointer_String_Pattern_Copy;
+	(*Pointer_Patterns_Count)++;
+
+	return 0;
+}
+
+/** Add all patterns listed in a text file to the include patterns of a tag filter. Empty lines are ignored.
+ * @param Pointer_Filter The filter to add the patterns to.
+ * @param Pointer_String_List_File The file containing one pattern per line.
+ * @return -1 if an error occurred,
+ * @return 0 on success.
+ */
+static int MainTagFilterLoadListFile(TMainTagFilter *Pointer_Filter, const char *Pointer_String_List_File)
+{
+	FILE *Pointer_File;
+	char String_Line[1024];
+	size_t Length;
+	int Return_Value = -1;
+
+	Pointer_File = fopen(Pointer_String_List_File, "r");
+	if (Pointer_File == NULL)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to open the list file '%s' (%s).\n", Pointer_String_List_File, strerror(errno));
+		return -1;
+	}
+
+	while (fgets(String_Line, sizeof(String_Line), Pointer_File) != NULL)
+	{
+		// Remove the trailing new line characters, whatever the file line ending is
+		Length = strlen(String_Line);
+		while ((Length > 0) && ((String_Line[Length - 1] == '\n') || (String_Line[Length - 1] == '\r'))) Length--;
+		String_Line[Length] = 0;
+
+		if (Length == 0) continue;
+		if (MainTagFilterAddPattern(Pointer_Filter, 0, String_Line) != 0) goto Exit;
+	}
+	Return_Value = 0;
+
+Exit:
+	fclose(Pointer_File);
+	return Return_Value;
+}
+
+/** Handle the command-line options related to tag filtering.
+ * @param Pointer_Filter The filter to configure.
+ * @param Options_Count How many command-line options there are.
+ * @param Pointer_Strings_Options The command-line options.
+ * @param Pointer_Option_Index On input, the option to handle. On output, the last option used by the handled option.
+ * @return -1 if an error occurred,
+ * @return 0 if the option is not related to tag filtering,
+ * @return 1 if the option has been handled.
+ */
+static int MainTagFilterParseOption(TMainTagFilter *Pointer_Filter, int Options_Count, char *Pointer_Strings_Options[], int *Pointer_Option_Index)
+{
+	int i = *Pointer_Option_Index;
+	char *Pointer_String_Option = Pointer_Strings_Options[i];
+
+	if ((strcmp(Pointer_String_Option, MAIN_OPTION_STRING_INCLUDE) != 0) && (strcmp(Pointer_String_Option, MAIN_OPTION_STRING_EXCLUDE) != 0) && (strcmp(Pointer_String_Option, MAIN_OPTION_STRING_INCLUDE_LIST) != 0)) return 0;
+
+	// All filter options need a value
+	i++;
+	if (i >= Options_Count)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : the %s option needs a value.\n", Pointer_String_Option);
+		return -1;
+	}
+	*Pointer_Option_Index = i;
+
+	if (strcmp(Pointer_String_Option, MAIN_OPTION_STRING_INCLUDE_LIST) == 0)
+	{
+		if (MainTagFilterLoadListFile(Pointer_Filter, Pointer_Strings_Options[i]) != 0) return -1;
+	}
+	else if (MainTagFilterAddPattern(Pointer_Filter, strcmp(Pointer_String_Option, MAIN_OPTION_STRING_EXCLUDE) == 0, Pointer_Strings_Options[i]) != 0) return -1;
+
+	return 1;
+}
+
+/** Tell whether a tag is selected by a filter.
+ * @param Pointer_Filter The filter.
+ * @param Pointer_String_Tag_Name The tag name.
+ * @return 1 if the tag is selected,
+ * @return 0 if the tag is not selected.
+ */
+static int MainTagFilterIsTagSelected(TMainTagFilter *Pointer_Filter, const char *Pointer_String_Tag_Name)
+{
+	int i;
+
+	// The tag must match an include pattern, if any
+	if (Pointer_Filter->Include_Patterns_Count > 0)
+	{
+		for (i = 0; i < Pointer_Filter->Include_Patterns_Count; i++)
+		{
+			if (IDPArchiveIsTagNameMatching(Pointer_Filter->Pointer_Pointer_Strings_Include_Patterns[i], Pointer_String_Tag_Name)) break;
+		}
+		if (i == Pointer_Filter->Include_Patterns_Count) return 0;
+	}
+
+	// The tag must not match any exclude pattern
+	for (i = 0; i < Pointer_Filter->Exclude_Patterns_Count; i++)
+	{
+		if (IDPArchiveIsTagNameMatching(Pointer_Filter->Pointer_Pointer_Strings_Exclude_Patterns[i], Pointer_String_Tag_Name)) return 0;
+	}
+
+	return 1;
+}
+
+/** Release all memory allocated by a tag filter and make it empty.
+ * @param Pointer_Filter The filter to release.
+ */
+static void MainTagFilterFree(TMainTagFilter *Pointer_Filter)
+{
+	int i;
+
+	for (i = 0; i < Pointer_Filter->Include_Patterns_Count; i++) free(Pointer_Filter->Pointer_Pointer_Strings_Include_Patterns[i]);
+	if (Pointer_Filter->Pointer_Pointer_Strings_Include_Patterns != NULL) free(Pointer_Filter->Pointer_Pointer_Strings_Include_Patterns);
+	for (i = 0; i < Pointer_Filter->Exclude_Patterns_Count; i++) free(Pointer_Filter->Pointer_Pointer_Strings_Exclude_Patterns[i]);
+	if (Pointer_Filter->Pointer_Pointer_Strings_Exclude_Patterns != NULL) free(Pointer_Filter->Pointer_Pointer_Strings_Exclude_Patterns);
+	memset(Pointer_Filter, 0, sizeof(TMainTagFilter));
+}
+
+/** Write a single tag data to its file. The file name is the tag name.
+ * @param Pointer_Archive The archive the tag belongs to.
+ * @param Tag_Index The tag to write.
+ * @param Pointer_Buffer In streamed mode, the buffer used to copy the tag data from the archive to the file. It is not used in mapped mode.
+ * @param Buffer_Size The buffer size in bytes.
+ * @return -1 if an error occurred,
+ * @return 0 if the file was successfully written.
+ */
+static int MainIDPExtractTag(TIDPArchive *Pointer_Archive, int Tag_Index, void *Pointer_Buffer, int Buffer_Size)
+{
+	TIDPArchiveTag *Pointer_Tag = &Pointer_Archive->Pointer_Tags[Tag_Index];
+	FILE *Pointer_File_Data;
+	int Offset, Size, Return_Value = -1;
+	double Start_Time;
+
+	// Create data file
+	Start_Time = StatisticsGetTime();
+	Pointer_File_Data = FileSystemOpenFile(Pointer_Tag->Pointer_String_Name, "wb");
+	StatisticsAddPhaseTime(STATISTICS_PHASE_IDP_FILE_WRITE, Start_Time);
+	if (Pointer_File_Data == NULL)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to open tag %d data file (%s).\n", Tag_Index, strerror(errno));
+		return -1;
+	}
+
+	// Fill data file
+	if (Pointer_Archive->Access_Mode == IDP_ARCHIVE_ACCESS_MODE_MAPPED)
+	{
+		// The data are written straight from the mapped archive, so the archive is read while the file is written
+		Start_Time = StatisticsGetTime();
+		if (FileSystemWriteFile(Pointer_Tag->Pointer_Data, Pointer_Tag->Data_Size, Pointer_File_Data) != (size_t) Pointer_Tag->Data_Size)
+		{
+			LogPrint(LOG_LEVEL_ERROR, "Error : failed to write tag %d data file (%s).\n", Tag_Index, strerror(errno));
+			goto Exit;
+		}
+		StatisticsAddPhaseTime(STATISTICS_PHASE_IDP_FILE_WRITE, Start_Time);
+	}
+	else
+	{
+		// Copy the data through the fixed-size buffer
+		for (Offset = 0; Offset < Pointer_Tag->Data_Size; Offset += Size)
+		{
+			Size = Pointer_Tag->Data_Size - Offset;
+			if (Size > Buffer_Size) Size = Buffer_Size;
+
+			if (IDPArchiveReadTagData(Pointer_Archive, Tag_Index, Offset, Pointer_Buffer, Size) != 0) goto Exit;
+			Start_Time = StatisticsGetTime();
+			if (FileSystemWriteFile(Pointer_Buffer, Size, Pointer_File_Data) != (size_t) Size)
+			{
+				LogPrint(LOG_LEVEL_ERROR, "Error : failed to write tag %d data file (%s).\n", Tag_Index, strerror(errno));
+				goto Exit;
+			}
+			StatisticsAddPhaseTime(STATISTICS_PHASE_IDP_FILE_WRITE, Start_Time);
+		}
+	}
+	Return_Value = 0;
+
+Exit:
+	Start_Time = StatisticsGetTime();
+	fclose(Pointer_File_Data);
+	StatisticsAddPhaseTime(STATISTICS_PHASE_IDP_FILE_WRITE, Start_Time);
+	return Return_Value;
+}
+
+/** Order the tags by decreasing data size, so the largest tags are processed first and do not delay the end of a multithreaded operation.
+ * @param Pointer_Pointer_Tag_1 The first tag to compare.
+ * @param Pointer_Pointer_Tag_2 The second tag to compare.
+ * @return A negative value if the first tag must be written first,
+ * @return a positive value if the second tag must be written first.
+ */
+static int MainIDPCompareTagSizes(const void *Pointer_Pointer_Tag_1, const void *Pointer_Pointer_Tag_2)
+{
+	const TIDPArchiveTag *Pointer_Tag_1 = *(const TIDPArchiveTag **) Pointer_Pointer_Tag_1, *Pointer_Tag_2 = *(const TIDPArchiveTag **) Pointer_Pointer_Tag_2;
+
+	if (Pointer_Tag_1->Data_Size != Pointer_Tag_2->Data_Size) return Pointer_Tag_1->Data_Size > Pointer_Tag_2->Data_Size ? -1 : 1;
+	// Keep the archive order for tags of the same size, so the scheduling is always the same
+	return Pointer_Tag_1 < Pointer_Tag_2 ? -1 : 1;
+}
+
+/** Write a tag file from an extraction worker.
+ * @param Pointer_Context The extraction context.
+ * @param Item_Index The index of the tag in the sorted tags list.
+ * @param Worker_Index The worker index, used to select the worker copy buffer.
+ * @return -1 if an error occurred,
+ * @return 0 if the file was successfully written.
+ */
+static int MainIDPExtractWorker(void *Pointer_Context, int Item_Index, int Worker_Index)
+{
+	TMainIDPExtractionContext *Pointer_Extraction_Context = Pointer_Context;
+	int Tag_Index;
+
+	Tag_Index = (int) (Pointer_Extraction_Context->Pointer_Pointer_Sorted_Tags[Item_Index] - Pointer_Extraction_Context->Pointer_Archive->Pointer_Tags);
+	if (MainIDPExtractTag(Pointer_Extraction_Context->Pointer_Archive, Tag_Index, Pointer_Extraction_Context->Pointer_Buffers + (size_t) Worker_Index * Pointer_Extraction_Context->Buffer_Size, Pointer_Extraction_Context->Buffer_Size) != 0) return -1;
+
+	LogProgressUpdate(Pointer_Extraction_Context->Pointer_Progress, 1, Pointer_Extraction_Context->Pointer_Pointer_Sorted_Tags[Item_Index]->Data_Size);
+	return 0;
+}
+
 /** Extract the content of an IDP archive.
  * @param Pointer_String_Input_File The IDP file to extract.
  * @param Pointer_File_Output_Directory The directory to put the extracted data to.
+ * @param Options_Count How many command-line options follow the command arguments.
+ * @param Pointer_Strings_Options The command-line options.
  * @return -1 if an error occurred,
  * @return 0 if the archive was successfully extracted. 
  */
-static int MainIDPExtract(char *Pointer_String_Input_File, char *Pointer_File_Output_Directory)
+static int MainIDPExtract(char *Pointer_String_Input_File, char *Pointer_File_Output_Directory, int Options_Count, char *Pointer_Strings_Options[])
 {
-	TIDPArchiveTag *Pointer_IDP_Tags;
-	int Tags_Count, i, Return_Value = -1;
-	char *Pointer_String_File_Name, String_System_Command[256], String_File_Path[256]; // 256 characters should be enough
-	FILE *Pointer_File_Data;
-	size_t Length;
-	
-	// Try to uncompress the IDP archive
-	if (IDPArchiveRead(Pointer_String_Input_File, &Pointer_IDP_Tags, &Tags_Count) != 0)
+	TIDPArchive Archive;
+	TIDPArchiveTag *Pointer_IDP_Tags, **Pointer_Pointer_Selected_Tags = NULL, **Pointer_Pointer_Sorted_Tags = NULL;
+	int Tags_Count, Selected_Tags_Count = 0, i, Tag_Index, Result, Return_Value = -1, Buffer_Size = 0, Jobs_Count = 1;
+	long long Maximum_Memory_Size;
+	unsigned char *Pointer_Buffers = NULL;
+	TMainIDPExtractionContext Extraction_Context;
+	TFileSystemDirectoryCache Directory_Cache;
+	TLogProgress Progress;
+	TMainTagFilter Tag_Filter;
+	double Start_Time;
+
+	FileSystemDirectoryCacheInitialize(&Directory_Cache);
+	memset(&Tag_Filter, 0, sizeof(Tag_Filter));
+
+	// Parse the options
+	for (i = 0; i < Options_Count; i++)
 	{
-		printf("Error : failed to uncompress IDP archive.\n");
-		return -1;
+		Result = MainTagFilterParseOption(&Tag_Filter, Options_Count, Pointer_Strings_Options, &i);
+		if (Result < 0) goto Exit_Free_Filter;
+		if (Result > 0) continue;
+
+		if (strcmp(Pointer_Strings_Options[i], MAIN_OPTION_STRING_MAXIMUM_MEMORY) == 0)
+		{
+			i++;
+			if ((i >= Options_Count) || (MainParseSize(Pointer_Strings_Options[i], &Maximum_Memory_Size) != 0))
+			{
+				LogPrint(LOG_LEVEL_ERROR, "Error : the " MAIN_OPTION_STRING_MAXIMUM_MEMORY " option needs a valid size.\n");
+				goto Exit_Free_Filter;
+			}
+			// The tags data size is stored on 32 bits, so there is no need for a larger buffer
+			if (Maximum_Memory_Size > 0x7FFFFFFF) Maximum_Memory_Size = 0x7FFFFFFF;
+			Buffer_Size = (int) Maximum_Memory_Size;
+		}
+		else if (strcmp(Pointer_Strings_Options[i], MAIN_OPTION_STRING_JOBS) == 0)
+		{
+			i++;
+			if (i < Options_Count) Jobs_Count = atoi(Pointer_Strings_Options[i]);
+			if ((i >= Options_Count) || (Jobs_Count < 1) || (Jobs_Count > THREAD_MAXIMUM_WORKERS_COUNT))
+			{
+				LogPrint(LOG_LEVEL_ERROR, "Error : the " MAIN_OPTION_STRING_JOBS " option needs a threads count from 1 to %d.\n", THREAD_MAXIMUM_WORKERS_COUNT);
+				goto Exit_Free_Filter;
+			}
+		}
+		else
+		{
+			LogPrint(LOG_LEVEL_ERROR, "Error : unknown option '%s'.\n", Pointer_Strings_Options[i]);
+			goto Exit_Free_Filter;
+		}
 	}
-	
-	// Try to create the output directory
-	if (_mkdir(Pointer_File_Output_Directory) != 0)
+
+	// Without memory constraint, map the IDP archive in memory, the tag data will be directly written from the mapped file without being copied
+	if (Buffer_Size == 0)
+	{
+		if (IDPArchiveOpen(Pointer_String_Input_File, IDP_ARCHIVE_ACCESS_MODE_MAPPED, &Archive) != 0)
+		{
+			LogPrint(LOG_LEVEL_ERROR, "Error : failed to open IDP archive.\n");
+			goto Exit_Free_Filter;
+		}
+	}
+	// Otherwise read only the tags directory, the tag data will be copied through fixed-size buffers sharing the memory budget
+	else
 	{
-		if (errno != EEXIST)
+		if (IDPArchiveOpen(Pointer_String_Input_File, IDP_ARCHIVE_ACCESS_MODE_STREAMED, &Archive) != 0)
 		{
-			printf("Error : failed to create output directory (%s).\n", strerror(errno));
+			LogPrint(LOG_LEVEL_ERROR, "Error : failed to open IDP archive.\n");
+			goto Exit_Free_Filter;
+		}
+
+		Buffer_Size /= Jobs_Count;
+		if (Buffer_Size < 1) Buffer_Size = 1;
+		Pointer_Buffers = malloc((size_t) Buffer_Size * Jobs_Count);
+		if (Pointer_Buffers == NULL)
+		{
+			LogPrint(LOG_LEVEL_ERROR, "Error : failed to allocate the copy buffers (%s).\n", strerror(errno));
 			goto Exit;
 		}
+		LogPrint(LOG_LEVEL_INFORMATION, "Tag data will be copied through %d buffer(s) of %d bytes.\n", Jobs_Count, Buffer_Size);
+	}
+	Pointer_IDP_Tags = Archive.Pointer_Tags;
+	Tags_Count = Archive.Tags_Count;
+
+	// Select the tags to extract from the tags directory, only the selected tags data will be accessed
+	Pointer_Pointer_Selected_Tags = malloc(sizeof(TIDPArchiveTag *) * (Tags_Count + 1)); // Make sure to allocate something for empty archives
+	if (Pointer_Pointer_Selected_Tags == NULL)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to allocate the selected tags list (%s).\n", strerror(errno));
+		goto Exit;
+	}
+	for (i = 0; i < Tags_Count; i++)
+	{
+		if (MainTagFilterIsTagSelected(&Tag_Filter, Pointer_IDP_Tags[i].Pointer_String_Name))
+		{
+			Pointer_Pointer_Selected_Tags[Selected_Tags_Count] = &Pointer_IDP_Tags[i];
+			Selected_Tags_Count++;
+		}
+	}
+	LogPrint(LOG_LEVEL_INFORMATION, "Selected %d tags out of %d.\n", Selected_Tags_Count, Tags_Count);
+	
+	// Try to create the output directory
+	if (FileSystemCreateDirectory(Pointer_File_Output_Directory) != 0)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to create output directory (%s).\n", strerror(errno));
+		goto Exit;
 	}
 	
 	// Go to output directory to avoid prefixing all paths with the output directory one
-	if (_chdir(Pointer_File_Output_Directory) != 0)
+	if (FileSystemChangeDirectory(Pointer_File_Output_Directory) != 0)
 	{
-		printf("Error : failed to change to output directory (%s).\n", strerror(errno));
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to change to output directory (%s).\n", strerror(errno));
 		goto Exit;
 	}
 	
-	// Create all tag-related files
-	for (i = 0; i < Tags_Count; i++)
+	// Create all tag directories first, so the tag files can then be written in any order
+	Start_Time = StatisticsGetTime();
+	for (i = 0; i < Selected_Tags_Count; i++)
 	{
-		printf("Creating tag %d data file (name : '%s', size : %d bytes).\n", i, Pointer_IDP_Tags[i].Pointer_String_Name, Pointer_IDP_Tags[i].Data_Size);
-		
-		// Extract the file name and the directories path from the tag name
-		// Find the file name beginning
-		Pointer_String_File_Name = strrchr(Pointer_IDP_Tags[i].Pointer_String_Name, '\\');
-		if (Pointer_String_File_Name == NULL)
+		if (FileSystemCreateParentDirectories(&Directory_Cache, Pointer_Pointer_Selected_Tags[i]->Pointer_String_Name) != 0)
 		{
-			printf("Error : could not retrieve the last '\\' in the name string.\n");
+			LogPrint(LOG_LEVEL_ERROR, "Error : failed to create tag %d directories.\n", (int) (Pointer_Pointer_Selected_Tags[i] - Pointer_IDP_Tags));
 			goto Exit;
 		}
-		Pointer_String_File_Name++; // Bypass the last '\'
-		// Extract file path
-		Length = strlen(Pointer_IDP_Tags[i].Pointer_String_Name) - strlen(Pointer_String_File_Name) - 1;
-		strncpy(String_File_Path, Pointer_IDP_Tags[i].Pointer_String_Name, Length); // Copy up to the character before the '\' (-1 removes the last '\')
-		String_File_Path[Length] = 0; // Append terminating zero
-		
-		// Create target directories with no safety but no effort
-		sprintf(String_System_Command, "mkdir %s > NUL", String_File_Path);
-		system(String_System_Command);
-		
-		// Create data file
-		Pointer_File_Data = fopen(Pointer_IDP_Tags[i].Pointer_String_Name, "wb");
-		if (Pointer_File_Data == NULL)
-		{
-			printf("Error : failed to open tag %d data file (%s).\n", i, strerror(errno));
-			goto Exit;
+	}
+	StatisticsAddPhaseTime(STATISTICS_PHASE_IDP_DIRECTORY_CREATION, Start_Time);
+
+	// Create all tag-related files
+	LogProgressInitialize(&Progress, "tags", Selected_Tags_Count);
+	if (Jobs_Count == 1)
+	{
+		for (i = 0; i < Selected_Tags_Count; i++)
+		{
+			Tag_Index = (int) (Pointer_Pointer_Selected_Tags[i] - Pointer_IDP_Tags);
+			LogPrint(LOG_LEVEL_DEBUG, "Creating tag %d data file (name : '%s', size : %d bytes).\n", Tag_Index, Pointer_IDP_Tags[Tag_Index].Pointer_String_Name, Pointer_IDP_Tags[Tag_Index].Data_Size);
+			if (MainIDPExtractTag(&Archive, Tag_Index, Pointer_Buffers, Buffer_Size) != 0) goto Exit;
+			LogProgressUpdate(&Progress, 1, Pointer_IDP_Tags[Tag_Index].Data_Size);
 		}
-		// Fill data file
-		if (fwrite(Pointer_IDP_Tags[i].Pointer_Data, 1, Pointer_IDP_Tags[i].Data_Size, Pointer_File_Data) != Pointer_IDP_Tags[i].Data_Size)
+	}
+	else
+	{
+		// Start with the largest tags, so a few big files written at the end can't keep the other workers idle
+		Pointer_Pointer_Sorted_Tags = malloc(sizeof(TIDPArchiveTag *) * (Selected_Tags_Count + 1)); // Make sure to allocate something when no tag is selected
+		if (Pointer_Pointer_Sorted_Tags == NULL)
 		{
-			printf("Error : failed to write tag %d data file (%s).\n", i, strerror(errno));
+			LogPrint(LOG_LEVEL_ERROR, "Error : failed to allocate the sorted tags list (%s).\n", strerror(errno));
 			goto Exit;
 		}
-		fclose(Pointer_File_Data);
+		memcpy(Pointer_Pointer_Sorted_Tags, Pointer_Pointer_Selected_Tags, sizeof(TIDPArchiveTag *) * Selected_Tags_Count);
+		qsort(Pointer_Pointer_Sorted_Tags, Selected_Tags_Count, sizeof(TIDPArchiveTag *), MainIDPCompareTagSizes);
+
+		LogPrint(LOG_LEVEL_INFORMATION, "Creating %d tag data files using %d threads.\n", Selected_Tags_Count, Jobs_Count);
+		Extraction_Context.Pointer_Archive = &Archive;
+		Extraction_Context.Pointer_Pointer_Sorted_Tags = Pointer_Pointer_Sorted_Tags;
+		Extraction_Context.Pointer_Buffers = Pointer_Buffers;
+		Extraction_Context.Buffer_Size = Buffer_Size;
+		Extraction_Context.Pointer_Progress = &Progress;
+		if (ThreadParallelFor(Jobs_Count, Selected_Tags_Count, MainIDPExtractWorker, &Extraction_Context) != 0) goto Exit;
+
+		// Display the created files in the archive order, whatever order the workers wrote them in
+		for (i = 0; i < Selected_Tags_Count; i++)
+		{
+			Tag_Index = (int) (Pointer_Pointer_Selected_Tags[i] - Pointer_IDP_Tags);
+			LogPrint(LOG_LEVEL_DEBUG, "Created tag %d data file (name : '%s', size : %d bytes).\n", Tag_Index, Pointer_IDP_Tags[Tag_Index].Pointer_String_Name, Pointer_IDP_Tags[Tag_Index].Data_Size);
+		}
 	}
 	
-	printf("All files were successfully created.\n");
+	LogProgressTerminate(&Progress);
+	LogPrint(LOG_LEVEL_INFORMATION, "All files were successfully created.\n");
 	Return_Value = 0;
 	
 Exit:
-	IDPArchiveFreeBuffer(Pointer_IDP_Tags, Tags_Count);
+	if (Pointer_Pointer_Sorted_Tags != NULL) free(Pointer_Pointer_Sorted_Tags);
+	if (Pointer_Pointer_Selected_Tags != NULL) free(Pointer_Pointer_Selected_Tags);
+	if (Pointer_Buffers != NULL) free(Pointer_Buffers);
+	IDPArchiveClose(&Archive);
+
+Exit_Free_Filter:
+	FileSystemDirectoryCacheFree(&Directory_Cache);
+	MainTagFilterFree(&Tag_Filter);
 	return Return_Value;
 }
 
-/** Extract as much content as possible from a map file.
- * @param Pointer_String_Input_File The map file to extract.
- * @param Pointer_File_Output_Directory The directory to put the extracted data to.
+/** Copy a file to its tag data area in the archive being built.
+ * @param Pointer_Context The build context.
+ * @param Item_Index The index of the tag in the sorted tags list.
+ * @param Worker_Index The worker index, used to select the worker archive file handle and copy buffer.
  * @return -1 if an error occurred,
- * @return 0 if the map was successfully extracted.
+ * @return 0 if the file was successfully copied.
  */
-static int MainMapExtract(char* Pointer_String_Input_File, char* Pointer_File_Output_Directory)
+static int MainIDPBuildWorker(void *Pointer_Context, int Item_Index, int Worker_Index)
 {
-	// Try to create the output directory
-	if (_mkdir(Pointer_File_Output_Directory) != 0)
+	TMainIDPBuildContext *Pointer_Build_Context = Pointer_Context;
+	TIDPArchiveTag *Pointer_Tag = Pointer_Build_Context->Pointer_Pointer_Sorted_Tags[Item_Index];
+	FILE *Pointer_File_Input = NULL, *Pointer_File_Archive = Pointer_Build_Context->Pointer_Pointer_Output_Files[Worker_Index];
+	unsigned char *Pointer_Buffer = Pointer_Build_Context->Pointer_Buffers + (size_t) Worker_Index * MAIN_IDP_COPY_BUFFER_SIZE;
+	char *Pointer_String_Input_File;
+	int Offset, Size, Return_Value = -1;
+	double Start_Time;
+
+	// Build the file path from the tag name
+	Pointer_String_Input_File = malloc(strlen(Pointer_Build_Context->Pointer_String_Input_Directory) + strlen(Pointer_Tag->Pointer_String_Name) + 2);
+	if (Pointer_String_Input_File == NULL)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to allocate the file '%s' path (%s).\n", Pointer_Tag->Pointer_String_Name, strerror(errno));
+		return -1;
+	}
+	sprintf(Pointer_String_Input_File, "%s/%s", Pointer_Build_Context->Pointer_String_Input_Directory, Pointer_Tag->Pointer_String_Name);
+
+	Pointer_File_Input = FileSystemOpenFile(Pointer_String_Input_File, "rb");
+	if (Pointer_File_Input == NULL)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to open the file '%s' (%s).\n", Pointer_String_Input_File, strerror(errno));
+		goto Exit;
+	}
+
+	// The data area offset is below 2GB, so it fits in a long on all platforms
+	if (fseek(Pointer_File_Archive, (long) (Pointer_Build_Context->Data_Area_Offset + Pointer_Tag->Data_Offset), SEEK_SET) != 0)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to seek to the tag '%s' data (%s).\n", Pointer_Tag->Pointer_String_Name, strerror(errno));
+		goto Exit;
+	}
+
+	// Stream the file through the worker buffer, so the file is never fully loaded in memory
+	for (Offset = 0; Offset < Pointer_Tag->Data_Size; Offset += Size)
 	{
-		if (errno != EEXIST)
+		Size = Pointer_Tag->Data_Size - Offset;
+		if (Size > MAIN_IDP_COPY_BUFFER_SIZE) Size = MAIN_IDP_COPY_BUFFER_SIZE;
+
+		Start_Time = StatisticsGetTime();
+		if (FileSystemReadFile(Pointer_Buffer, Size, Pointer_File_Input) != (size_t) Size)
 		{
-			printf("Error : failed to create the output directory (%s).\n", strerror(errno));
-			return -1;
+			LogPrint(LOG_LEVEL_ERROR, "Error : failed to read the file '%s' (was it modified while the archive was built ?).\n", Pointer_String_Input_File);
+			goto Exit;
+		}
+		StatisticsAddPhaseTime(STATISTICS_PHASE_IDP_PAYLOAD_READ, Start_Time);
+
+		Start_Time = StatisticsGetTime();
+		if (FileSystemWriteFile(Pointer_Buffer, Size, Pointer_File_Archive) != (size_t) Size)
+		{
+			LogPrint(LOG_LEVEL_ERROR, "Error : failed to write the tag '%s' data (%s).\n", Pointer_Tag->Pointer_String_Name, strerror(errno));
+			goto Exit;
 		}
+		StatisticsAddPhaseTime(STATISTICS_PHASE_IDP_FILE_WRITE, Start_Time);
 	}
+	LogProgressUpdate(Pointer_Build_Context->Pointer_Progress, 1, Pointer_Tag->Data_Size);
+	Return_Value = 0;
 
-	// Retrieve the map content
-	return MapExtract(Pointer_String_Input_File, Pointer_File_Output_Directory);
+Exit:
+	if (Pointer_File_Input != NULL) fclose(Pointer_File_Input);
+	free(Pointer_String_Input_File);
+	return Return_Value;
 }
 
-//-------------------------------------------------------------------------------------------------
-// Entry point
-//-------------------------------------------------------------------------------------------------
-int main(int argc, char *argv[])
+/** Create an IDP archive containing all files of a directory. The tags directory is written first, then the files are copied to their precomputed data offsets.
+ * @param Pointer_String_Input_Directory The directory to store in the archive.
+ * @param Pointer_String_Output_File The IDP file to create.
+ * @param Options_Count How many command-line options follow the command arguments.
+ * @param Pointer_Strings_Options The command-line options.
+ * @return -1 if an error occurred,
+ * @return 0 if the archive was successfully created.
+ */
+static int MainIDPBuild(char *Pointer_String_Input_Directory, char *Pointer_String_Output_File, int Options_Count, char *Pointer_Strings_Options[])
 {
-	int Return_Value = EXIT_FAILURE;
+	TFileSystemFile *Pointer_Files = NULL;
+	TIDPArchiveTag *Pointer_Tags = NULL, **Pointer_Pointer_Sorted_Tags = NULL;
+	FILE *Pointer_File_Archive, *Pointer_Pointer_Output_Files[THREAD_MAXIMUM_WORKERS_COUNT];
+	int Files_Count = 0, i, Jobs_Count = 1, Opened_Files_Count = 0, Return_Value = -1;
+	long long Data_Size = 0, Data_Area_Offset;
+	unsigned char *Pointer_Buffers = NULL;
+	TMainIDPBuildContext Build_Context;
+	TLogProgress Progress;
 
-	// Check parameters
-	if (argc < 2)
+	// Parse the options
+	for (i = 0; i < Options_Count; i++)
 	{
-		MainDisplayProgramUsage(argv[0]);
-		return EXIT_FAILURE;
+		if (strcmp(Pointer_Strings_Options[i], MAIN_OPTION_STRING_JOBS) == 0)
+		{
+			i++;
+			if (i < Options_Count) Jobs_Count = atoi(Pointer_Strings_Options[i]);
+			if ((i >= Options_Count) || (Jobs_Count < 1) || (Jobs_Count > THREAD_MAXIMUM_WORKERS_COUNT))
+			{
+				LogPrint(LOG_LEVEL_ERROR, "Error : the " MAIN_OPTION_STRING_JOBS " option needs a threads count from 1 to %d.\n", THREAD_MAXIMUM_WORKERS_COUNT);
+				return -1;
+			}
+		}
+		else
+		{
+			LogPrint(LOG_LEVEL_ERROR, "Error : unknown option '%s'.\n", Pointer_Strings_Options[i]);
+			return -1;
+		}
 	}
-	
-	// Handle command
-	if (strcmp(argv[1], MAIN_COMMAND_STRING_IDP_BUILD) == 0)
+
+	// Each file becomes a tag named like the file path relative to the input directory
+	if (FileSystemListFiles(Pointer_String_Input_Directory, &Pointer_Files, &Files_Count) != 0)
 	{
-		if (argc == 4) printf("the IDP build command is not yet available.\n");
-		else MainDisplayProgramUsage(argv[0]);
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to list the input directory files.\n");
+		return -1;
 	}
-	else if (strcmp(argv[1], MAIN_COMMAND_STRING_IDP_EXTRACT) == 0)
+	LogPrint(LOG_LEVEL_INFORMATION, "Found %d files.\n", Files_Count);
+
+	Pointer_Tags = calloc(Files_Count + 1, sizeof(TIDPArchiveTag)); // Make sure to allocate something for empty directories
+	Pointer_Pointer_Sorted_Tags = malloc(sizeof(TIDPArchiveTag *) * (Files_Count + 1));
+	if ((Pointer_Tags == NULL) || (Pointer_Pointer_Sorted_Tags == NULL))
 	{
-		if (argc == 4) Return_Value = MainIDPExtract(argv[2], argv[3]);
-		else MainDisplayProgramUsage(argv[0]);
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to allocate the tags list (%s).\n", strerror(errno));
+		goto Exit;
 	}
-	else if (strcmp(argv[1], MAIN_COMMAND_STRING_MAP_EXTRACT) == 0)
+
+	// Store the data in the files order, the data offsets are known before any file is read
+	for (i = 0; i < Files_Count; i++)
 	{
-		if (argc == 4) Return_Value = MainMapExtract(argv[2], argv[3]);
-		else MainDisplayProgramUsage(argv[0]);
+		// Tag offsets and sizes are stored on 32 bits
+		if (Data_Size + Pointer_Files[i].Size > 0x7FFFFFFF)
+		{
+			LogPrint(LOG_LEVEL_ERROR, "Error : the files are too large to fit in an IDP archive (the limit is 2GB).\n");
+			goto Exit;
+		}
+		Pointer_Tags[i].Pointer_String_Name = Pointer_Files[i].Pointer_String_Path;
+		Pointer_Tags[i].Data_Offset = (int) Data_Size;
+		Pointer_Tags[i].Data_Size = (int) Pointer_Files[i].Size;
+		Data_Size += Pointer_Files[i].Size;
+		Pointer_Pointer_Sorted_Tags[i] = &Pointer_Tags[i];
 	}
-	else
+	Data_Area_Offset = IDPArchiveComputeDirectorySize(Pointer_Tags, Files_Count);
+	if (Data_Area_Offset + Data_Size > 0x7FFFFFFF)
 	{
-		printf("Error : unknown command.\n");
-		MainDisplayProgramUsage(argv[0]);
-		return EXIT_FAILURE;
+		LogPrint(LOG_LEVEL_ERROR, "Error : the files are too large to fit in an IDP archive (the limit is 2GB).\n");
+		goto Exit;
 	}
-	
+
+	// Write the tags directory, then give the archive its final size so the workers can write the data in any order
+	Pointer_File_Archive = fopen(Pointer_String_Output_File, "wb");
+	if (Pointer_File_Archive == NULL)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to create the IDP file '%s' (%s).\n", Pointer_String_Output_File, strerror(errno));
+		goto Exit;
+	}
+	if (IDPArchiveWriteDirectory(Pointer_File_Archive, Pointer_Tags, Files_Count) != 0)
+	{
+		fclose(Pointer_File_Archive);
+		goto Exit;
+	}
+	if ((Data_Size > 0) && ((fseek(Pointer_File_Archive, (long) (Data_Area_Offset + Data_Size - 1), SEEK_SET) != 0) || (fputc(0, Pointer_File_Archive) == EOF)))
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to set the IDP file size (%s).\n", strerror(errno));
+		fclose(Pointer_File_Archive);
+		goto Exit;
+	}
+	if (fclose(Pointer_File_Archive) != 0)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to write the IDP file tags directory (%s).\n", strerror(errno));
+		goto Exit;
+	}
+
+	// Each worker needs its own file position in the archive and its own copy buffer
+	if (Jobs_Count > Files_Count) Jobs_Count = Files_Count;
+	if (Jobs_Count < 1) Jobs_Count = 1;
+	for (Opened_Files_Count = 0; Opened_Files_Count < Jobs_Count; Opened_Files_Count++)
+	{
+		Pointer_Pointer_Output_Files[Opened_Files_Count] = fopen(Pointer_String_Output_File, "r+b");
+		if (Pointer_Pointer_Output_Files[Opened_Files_Count] == NULL)
+		{
+			LogPrint(LOG_LEVEL_ERROR, "Error : failed to open the IDP file '%s' (%s).\n", Pointer_String_Output_File, strerror(errno));
+			goto Exit;
+		}
+	}
+	Pointer_Buffers = malloc((size_t) MAIN_IDP_COPY_BUFFER_SIZE * Jobs_Count);
+	if (Pointer_Buffers == NULL)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to allocate the copy buffers (%s).\n", strerror(errno));
+		goto Exit;
+	}
+
+	Build_Context.Pointer_String_Input_Directory = Pointer_String_Input_Directory;
+	Build_Context.Pointer_Pointer_Sorted_Tags = Pointer_Pointer_Sorted_Tags;
+	Build_Context.Pointer_Pointer_Output_Files = Pointer_Pointer_Output_Files;
+	Build_Context.Pointer_Buffers = Pointer_Buffers;
+	Build_Context.Data_Area_Offset = Data_Area_Offset;
+	Build_Context.Pointer_Progress = &Progress;
+
+	// Copy all files
+	LogProgressInitialize(&Progress, "tags", Files_Count);
+	if (Jobs_Count == 1)
+	{
+		// A single worker writes the archive sequentially
+		for (i = 0; i < Files_Count; i++)
+		{
+			LogPrint(LOG_LEVEL_DEBUG, "Adding tag %d (name : '%s', size : %d bytes).\n", i, Pointer_Tags[i].Pointer_String_Name, Pointer_Tags[i].Data_Size);
+			if (MainIDPBuildWorker(&Build_Context, i, 0) != 0) goto Exit;
+		}
+	}
+	else
+	{
+		// Start with the largest files, so a few big files copied at the end can't keep the other workers idle
+		qsort(Pointer_Pointer_Sorted_Tags, Files_Count, sizeof(TIDPArchiveTag *), MainIDPCompareTagSizes);
+
+		LogPrint(LOG_LEVEL_INFORMATION, "Adding %d tags using %d threads.\n", Files_Count, Jobs_Count);
+		if (ThreadParallelFor(Jobs_Count, Files_Count, MainIDPBuildWorker, &Build_Context) != 0) goto Exit;
+
+		// Display the added tags in the archive order, whatever order the workers wrote them in
+		for (i = 0; i < Files_Count; i++) LogPrint(LOG_LEVEL_DEBUG, "Added tag %d (name : '%s', size : %d bytes).\n", i, Pointer_Tags[i].Pointer_String_Name, Pointer_Tags[i].Data_Size);
+	}
+
+	// Make sure all data reached the file
+	for (i = 0; i < Opened_Files_Count; i++)
+	{
+		if (fclose(Pointer_Pointer_Output_Files[i]) != 0)
+		{
+			LogPrint(LOG_LEVEL_ERROR, "Error : failed to write the IDP file data (%s).\n", strerror(errno));
+			Opened_Files_Count = 0;
+			goto Exit;
+		}
+	}
+	Opened_Files_Count = 0;
+
+	LogProgressTerminate(&Progress);
+	LogPrint(LOG_LEVEL_INFORMATION, "The IDP file was successfully created.\n");
+	Return_Value = 0;
+
+Exit:
+	for (i = 0; i < Opened_Files_Count; i++) fclose(Pointer_Pointer_Output_Files[i]);
+	if (Pointer_Buffers != NULL) free(Pointer_Buffers);
+	if (Pointer_Pointer_Sorted_Tags != NULL) free(Pointer_Pointer_Sorted_Tags);
+	if (Pointer_Tags != NULL) free(Pointer_Tags);
+	FileSystemFreeFiles(Pointer_Files, Files_Count);
+	return Return_Value;
+}
+
+/** Replace some tags data of an IDP archive without rewriting the whole archive. The new data are appended to the archive end, then the tags directory is rewritten to point to the new data. As the tag names do not change, the tags directory keeps the same size.
+ * @param Pointer_String_Archive_File The IDP file to modify.
+ * @param Files_Count How many files to store in the archive.
+ * @param Pointer_Strings_Files The files to store in the archive. Each file path is the name of the tag to replace.
+ * @return -1 if an error occurred,
+ * @return 0 if the archive was successfully patched.
+ */
+static int MainIDPPatch(char *Pointer_String_Archive_File, int Files_Count, char *Pointer_Strings_Files[])
+{
+	TIDPArchive Archive;
+	FILE *Pointer_File_Archive = NULL, *Pointer_File_Input = NULL;
+	int *Pointer_Tag_Indexes = NULL, i, j, Tag_Index, Size, Return_Value = -1;
+	char *Pointer_String_Tag_Name;
+	long long Archive_Size, Data_Size, Unused_Size = 0;
+	unsigned char *Pointer_Buffer = NULL;
+
+	// Only the tags directory is needed, the archive data are never read
+	if (IDPArchiveOpen(Pointer_String_Archive_File, IDP_ARCHIVE_ACCESS_MODE_STREAMED, &Archive) != 0)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to open IDP archive.\n");
+		return -1;
+	}
+
+	// Find all tags before modifying the archive, so the archive is left untouched if a file is not part of it
+	Pointer_Tag_Indexes = malloc(sizeof(int) * Files_Count);
+	Pointer_Buffer = malloc(MAIN_IDP_COPY_BUFFER_SIZE);
+	if ((Pointer_Tag_Indexes == NULL) || (Pointer_Buffer == NULL))
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to allocate the patch buffers (%s).\n", strerror(errno));
+		goto Exit;
+	}
+	for (i = 0; i < Files_Count; i++)
+	{
+		// Ignore the leading current directory, so paths completed by the shell can be used as is
+		Pointer_String_Tag_Name = Pointer_Strings_Files[i];
+		if ((Pointer_String_Tag_Name[0] == '.') && ((Pointer_String_Tag_Name[1] == '/') || (Pointer_String_Tag_Name[1] == '\\'))) Pointer_String_Tag_Name += 2;
+
+		Pointer_Tag_Indexes[i] = IDPArchiveFindTag(&Archive, Pointer_String_Tag_Name);
+		if (Pointer_Tag_Indexes[i] < 0)
+		{
+			LogPrint(LOG_LEVEL_ERROR, "Error : the archive contains no tag named '%s', adding tags needs the whole archive to be built again with " MAIN_COMMAND_STRING_IDP_BUILD ".\n", Pointer_String_Tag_Name);
+			goto Exit;
+		}
+
+		// The same tag data would be appended several times while only the last copy would be used
+		for (j = 0; j < i; j++)
+		{
+			if (Pointer_Tag_Indexes[j] == Pointer_Tag_Indexes[i])
+			{
+				LogPrint(LOG_LEVEL_ERROR, "Error : the tag '%s' is given more than once.\n", Archive.Pointer_Tags[Pointer_Tag_Indexes[i]].Pointer_String_Name);
+				goto Exit;
+			}
+		}
+	}
+
+	// Append the new data to the archive end
+	Pointer_File_Archive = fopen(Pointer_String_Archive_File, "r+b");
+	if (Pointer_File_Archive == NULL)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to open IDP file '%s' for writing (%s).\n", Pointer_String_Archive_File, strerror(errno));
+		goto Exit;
+	}
+	if (fseek(Pointer_File_Archive, 0, SEEK_END) != 0)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to seek to the IDP file end (%s).\n", strerror(errno));
+		goto Exit;
+	}
+	Archive_Size = ftell(Pointer_File_Archive);
+
+	for (i = 0; i < Files_Count; i++)
+	{
+		Tag_Index = Pointer_Tag_Indexes[i];
+		Pointer_File_Input = FileSystemOpenFile(Pointer_Strings_Files[i], "rb");
+		if (Pointer_File_Input == NULL)
+		{
+			LogPrint(LOG_LEVEL_ERROR, "Error : failed to open the file '%s' (%s).\n", Pointer_Strings_Files[i], strerror(errno));
+			goto Exit;
+		}
+
+		// Copy the file through the buffer, tag offsets and sizes are stored on 32 bits
+		Data_Size = 0;
+		do
+		{
+			Size = (int) FileSystemReadFile(Pointer_Buffer, MAIN_IDP_COPY_BUFFER_SIZE, Pointer_File_Input);
+			if (ferror(Pointer_File_Input))
+			{
+				LogPrint(LOG_LEVEL_ERROR, "Error : failed to read the file '%s' (%s).\n", Pointer_Strings_Files[i], strerror(errno));
+				goto Exit;
+			}
+			if (Archive_Size + Data_Size + Size > 0x7FFFFFFF)
+			{
+				LogPrint(LOG_LEVEL_ERROR, "Error : the IDP file would become too large (the limit is 2GB), use " MAIN_COMMAND_STRING_IDP_COMPACT " to remove the unused data first.\n");
+				goto Exit;
+			}
+			if (FileSystemWriteFile(Pointer_Buffer, Size, Pointer_File_Archive) != (size_t) Size)
+			{
+				LogPrint(LOG_LEVEL_ERROR, "Error : failed to write the tag '%s' data (%s).\n", Archive.Pointer_Tags[Tag_Index].Pointer_String_Name, strerror(errno));
+				goto Exit;
+			}
+			Data_Size += Size;
+		} while (Size == MAIN_IDP_COPY_BUFFER_SIZE);
+		fclose(Pointer_File_Input);
+		Pointer_File_Input = NULL;
+
+		LogPrint(LOG_LEVEL_INFORMATION, "Replacing tag %d data (name : '%s', old size : %d bytes, new size : %d bytes).\n", Tag_Index, Archive.Pointer_Tags[Tag_Index].Pointer_String_Name, Archive.Pointer_Tags[Tag_Index].Data_Size, (int) Data_Size);
+		Unused_Size += Archive.Pointer_Tags[Tag_Index].Data_Size;
+		Archive.Pointer_Tags[Tag_Index].Data_Offset = (int) (Archive_Size - Archive.Data_Area_Offset);
+		Archive.Pointer_Tags[Tag_Index].Data_Size = (int) Data_Size;
+		Archive_Size += Data_Size;
+	}
+
+	// Make sure the new data are stored on the device before the tags directory points to them, so an interrupted patch leaves a valid archive
+	if (FileSystemSynchronizeFile(Pointer_File_Archive) != 0)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to write the new tags data (%s).\n", strerror(errno));
+		goto Exit;
+	}
+	if (fseek(Pointer_File_Archive, 0, SEEK_SET) != 0)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to seek to the IDP file beginning (%s).\n", strerror(errno));
+		goto Exit;
+	}
+	if (IDPArchiveWriteDirectory(Pointer_File_Archive, Archive.Pointer_Tags, Archive.Tags_Count) != 0) goto Exit;
+	if (fclose(Pointer_File_Archive) != 0)
+	{
+		Pointer_File_Archive = NULL;
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to write the IDP file tags directory (%s).\n", strerror(errno));
+		goto Exit;
+	}
+	Pointer_File_Archive = NULL;
+
+	LogPrint(LOG_LEVEL_INFORMATION, "The IDP file was successfully patched (%lld bytes are not used anymore, use " MAIN_COMMAND_STRING_IDP_COMPACT " to remove them).\n", Unused_Size);
+	Return_Value = 0;
+
+Exit:
+	if (Pointer_File_Input != NULL) fclose(Pointer_File_Input);
+	if (Pointer_File_Archive != NULL) fclose(Pointer_File_Archive);
+	if (Pointer_Buffer != NULL) free(Pointer_Buffer);
+	if (Pointer_Tag_Indexes != NULL) free(Pointer_Tag_Indexes);
+	IDPArchiveClose(&Archive);
+	return Return_Value;
+}
+
+/** Order the tags by increasing data offset, then by increasing data size.
+ * @param Pointer_Pointer_Tag_1 The first tag to compare.
+ * @param Pointer_Pointer_Tag_2 The second tag to compare.
+ * @return A negative value if the first tag data are located first,
+ * @return a positive value if the second tag data are located first,
+ * @return 0 if both tags use the same data.
+ */
+static int MainIDPCompareTagOffsets(const void *Pointer_Pointer_Tag_1, const void *Pointer_Pointer_Tag_2)
+{
+	const TIDPArchiveTag *Pointer_Tag_1 = *(const TIDPArchiveTag **) Pointer_Pointer_Tag_1, *Pointer_Tag_2 = *(const TIDPArchiveTag **) Pointer_Pointer_Tag_2;
+
+	if (Pointer_Tag_1->Data_Offset != Pointer_Tag_2->Data_Offset) return Pointer_Tag_1->Data_Offset < Pointer_Tag_2->Data_Offset ? -1 : 1;
+	if (Pointer_Tag_1->Data_Size != Pointer_Tag_2->Data_Size) return Pointer_Tag_1->Data_Size < Pointer_Tag_2->Data_Size ? -1 : 1;
+	return 0;
+}
+
+/** Order the repacked tags by increasing hash, then by increasing data size, then by increasing data offset, so identical data are next to each other and the first one is stored first in the archive.
+ * @param Pointer_Entry_1 The first entry to compare.
+ * @param Pointer_Entry_2 The second entry to compare.
+ * @return A negative value if the first entry comes first,
+ * @return a positive value if the second entry comes first,
+ * @return 0 if both entries use the same data.
+ */
+static int MainIDPRepackCompareEntryHashes(const void *Pointer_Entry_1, const void *Pointer_Entry_2)
+{
+	const TMainIDPRepackEntry *Pointer_Entry_A = Pointer_Entry_1, *Pointer_Entry_B = Pointer_Entry_2;
+
+	if (Pointer_Entry_A->Hash != Pointer_Entry_B->Hash) return Pointer_Entry_A->Hash < Pointer_Entry_B->Hash ? -1 : 1;
+	return MainIDPCompareTagOffsets(&Pointer_Entry_A->Pointer_Tag, &Pointer_Entry_B->Pointer_Tag);
+}
+
+/** Order the repacked tags by decreasing data size, so the largest tags are hashed first and do not delay the end of the hashing.
+ * @param Pointer_Entry_1 The first entry to compare.
+ * @param Pointer_Entry_2 The second entry to compare.
+ * @return A negative value if the first entry must be hashed first,
+ * @return a positive value if the second entry must be hashed first.
+ */
+static int MainIDPRepackCompareEntrySizes(const void *Pointer_Entry_1, const void *Pointer_Entry_2)
+{
+	const TMainIDPRepackEntry *Pointer_Entry_A = Pointer_Entry_1, *Pointer_Entry_B = Pointer_Entry_2;
+
+	return MainIDPCompareTagSizes(&Pointer_Entry_A->Pointer_Tag, &Pointer_Entry_B->Pointer_Tag);
+}
+
+/** Hash a tag data from a repack worker.
+ * @param Pointer_Context The repacked tags, sorted by decreasing size.
+ * @param Item_Index The tag to hash.
+ * @param Worker_Index Not used.
+ * @return 0, hashing mapped data can't fail.
+ */
+static int MainIDPRepackWorker(void *Pointer_Context, int Item_Index, int Worker_Index)
+{
+	TMainIDPRepackEntry *Pointer_Entry = &((TMainIDPRepackEntry *) Pointer_Context)[Item_Index];
+
+	(void) Worker_Index;
+
+	Pointer_Entry->Hash = IDPArchiveComputeDataHash(Pointer_Entry->Pointer_Tag->Pointer_Data, Pointer_Entry->Pointer_Tag->Data_Size);
+	return 0;
+}
+
+/** Make the tags with identical data use the same data, the first data in the archive are kept.
+ * @param Pointer_Tags The tags, they must point to the mapped archive data. On output, the data offset and the data pointer of the duplicate tags are the ones of the kept data.
+ * @param Tags_Count How many tags there are.
+ * @param Jobs_Count How many threads can hash the data at the same time.
+ * @param Pointer_Duplicate_Tags_Count On output, contain how many tags were redirected to identical data.
+ * @param Pointer_Deduplicated_Size On output, contain how many data bytes do not need to be stored anymore.
+ * @return -1 if an error occurred,
+ * @return 0 on success.
+ */
+static int MainIDPRepackDeduplicate(TIDPArchiveTag *Pointer_Tags, int Tags_Count, int Jobs_Count, int *Pointer_Duplicate_Tags_Count, long long *Pointer_Deduplicated_Size)
+{
+	TMainIDPRepackEntry *Pointer_Entries, *Pointer_Kept_Entry = NULL;
+	TIDPArchiveTag *Pointer_Tag;
+	void *Pointer_Previous_Original_Data = NULL;
+	int i, Duplicate_Tags_Count = 0, Return_Value = -1;
+	long long Deduplicated_Size = 0;
+	double Start_Time;
+
+	Pointer_Entries = malloc(sizeof(TMainIDPRepackEntry) * (Tags_Count + 1)); // Make sure to allocate something for empty archives
+	if (Pointer_Entries == NULL)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to allocate the tags hashes (%s).\n", strerror(errno));
+		return -1;
+	}
+	for (i = 0; i < Tags_Count; i++) Pointer_Entries[i].Pointer_Tag = &Pointer_Tags[i];
+
+	// Hash all tags data
+	LogPrint(LOG_LEVEL_DEBUG, "Hashing the data of %d tags with %d threads.\n", Tags_Count, Jobs_Count);
+	qsort(Pointer_Entries, Tags_Count, sizeof(TMainIDPRepackEntry), MainIDPRepackCompareEntrySizes);
+	Start_Time = StatisticsGetTime(); // Time the whole pass, adding the time of each worker would count the parallel time several times
+	if (ThreadParallelFor(Jobs_Count, Tags_Count, MainIDPRepackWorker, Pointer_Entries) != 0) goto Exit;
+	StatisticsAddPhaseTime(STATISTICS_PHASE_IDP_PAYLOAD_HASH, Start_Time);
+
+	// Group the identical data, the data are compared byte per byte to make sure that a hash collision can't corrupt the archive
+	qsort(Pointer_Entries, Tags_Count, sizeof(TMainIDPRepackEntry), MainIDPRepackCompareEntryHashes);
+	for (i = 0; i < Tags_Count; i++)
+	{
+		Pointer_Tag = Pointer_Entries[i].Pointer_Tag;
+		if ((Pointer_Kept_Entry != NULL) && (Pointer_Kept_Entry->Hash == Pointer_Entries[i].Hash) && (Pointer_Kept_Entry->Pointer_Tag->Data_Size == Pointer_Tag->Data_Size))
+		{
+			// The tags already sharing the same data do not need to be compared
+			if (Pointer_Kept_Entry->Pointer_Tag->Pointer_Data == Pointer_Tag->Pointer_Data) continue;
+			if (memcmp(Pointer_Kept_Entry->Pointer_Tag->Pointer_Data, Pointer_Tag->Pointer_Data, Pointer_Tag->Data_Size) == 0)
+			{
+				LogPrint(LOG_LEVEL_DEBUG, "The tag '%s' has the same data as the tag '%s'.\n", Pointer_Tag->Pointer_String_Name, Pointer_Kept_Entry->Pointer_Tag->Pointer_String_Name);
+				// Several tags may already share the removed data, they are next to each other because they have the same offset
+				if (Pointer_Tag->Pointer_Data != Pointer_Previous_Original_Data) Deduplicated_Size += Pointer_Tag->Data_Size;
+				Pointer_Previous_Original_Data = Pointer_Tag->Pointer_Data;
+				Pointer_Tag->Data_Offset = Pointer_Kept_Entry->Pointer_Tag->Data_Offset;
+				Pointer_Tag->Pointer_Data = Pointer_Kept_Entry->Pointer_Tag->Pointer_Data;
+				Duplicate_Tags_Count++;
+				continue;
+			}
+			// This is a hash collision, these data are kept as is (it is so unlikely that the other data with the same hash are not compared to these ones)
+			LogPrint(LOG_LEVEL_DEBUG, "The tags '%s' and '%s' have the same hash but different data.\n", Pointer_Tag->Pointer_String_Name, Pointer_Kept_Entry->Pointer_Tag->Pointer_String_Name);
+			continue;
+		}
+		Pointer_Kept_Entry = &Pointer_Entries[i];
+	}
+	*Pointer_Duplicate_Tags_Count = Duplicate_Tags_Count;
+	*Pointer_Deduplicated_Size = Deduplicated_Size;
+	Return_Value = 0;
+
+Exit:
+	free(Pointer_Entries);
+	return Return_Value;
+}
+
+/** Copy an IDP archive keeping only the data used by the tags. The data keep their order, and tags sharing the same data still share them in the copy. With the deduplication option, the tags with identical data also share them in the copy.
+ * @param Pointer_String_Input_File The IDP file to repack.
+ * @param Pointer_String_Output_File The repacked IDP file to create.
+ * @param Options_Count How many command-line options follow the command arguments.
+ * @param Pointer_Strings_Options The command-line options.
+ * @param Is_Compact_Command Set to 1 when the function runs the -idp-compact command, which has no option and keeps its own messages.
+ * @return -1 if an error occurred,
+ * @return 0 if the archive was successfully repacked.
+ */
+static int MainIDPRepack(char *Pointer_String_Input_File, char *Pointer_String_Output_File, int Options_Count, char *Pointer_Strings_Options[], int Is_Compact_Command)
+{
+	TIDPArchive Archive;
+	TIDPArchiveTag *Pointer_Tags = NULL, **Pointer_Pointer_Sorted_Tags = NULL, *Pointer_Tag, *Pointer_Previous_Tag = NULL;
+	FILE *Pointer_File_Output = NULL;
+	int i, Is_Deduplication_Enabled = 0, Jobs_Count = 1, Duplicate_Tags_Count = 0, Return_Value = -1;
+	long long Data_Size = 0, Data_Area_Offset, Deduplicated_Size = 0;
+
+	// Parse the options
+	for (i = 0; i < Options_Count; i++)
+	{
+		if (strcmp(Pointer_Strings_Options[i], MAIN_OPTION_STRING_DEDUPLICATE) == 0) Is_Deduplication_Enabled = 1;
+		else if (strcmp(Pointer_Strings_Options[i], MAIN_OPTION_STRING_JOBS) == 0)
+		{
+			i++;
+			if (i < Options_Count) Jobs_Count = atoi(Pointer_Strings_Options[i]);
+			if ((i >= Options_Count) || (Jobs_Count < 1) || (Jobs_Count > THREAD_MAXIMUM_WORKERS_COUNT))
+			{
+				LogPrint(LOG_LEVEL_ERROR, "Error : the " MAIN_OPTION_STRING_JOBS " option needs a threads count from 1 to %d.\n", THREAD_MAXIMUM_WORKERS_COUNT);
+				return -1;
+			}
+		}
+		else
+		{
+			LogPrint(LOG_LEVEL_ERROR, "Error : unknown option '%s'.\n", Pointer_Strings_Options[i]);
+			return -1;
+		}
+	}
+
+	// The input archive is mapped, so it can't be overwritten while it is read, compare the files themselves as the paths can be written differently
+	if ((strcmp(Pointer_String_Input_File, Pointer_String_Output_File) == 0) || FileSystemIsSameFile(Pointer_String_Input_File, Pointer_String_Output_File))
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : the output IDP file must be different from the input one.\n");
+		return -1;
+	}
+
+	if (IDPArchiveOpen(Pointer_String_Input_File, IDP_ARCHIVE_ACCESS_MODE_MAPPED, &Archive) != 0)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to open IDP archive.\n");
+		return -1;
+	}
+
+	// Work on a copy of the tags, so the original data locations are still available
+	Pointer_Tags = malloc(sizeof(TIDPArchiveTag) * (Archive.Tags_Count + 1)); // Make sure to allocate something for empty archives
+	Pointer_Pointer_Sorted_Tags = malloc(sizeof(TIDPArchiveTag *) * (Archive.Tags_Count + 1));
+	if ((Pointer_Tags == NULL) || (Pointer_Pointer_Sorted_Tags == NULL))
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to allocate the tags list (%s).\n", strerror(errno));
+		goto Exit;
+	}
+	memcpy(Pointer_Tags, Archive.Pointer_Tags, sizeof(TIDPArchiveTag) * Archive.Tags_Count);
+
+	// Make the duplicate tags use the same data, so the data are written only once like the data already shared by several tags
+	if (Is_Deduplication_Enabled && (MainIDPRepackDeduplicate(Pointer_Tags, Archive.Tags_Count, Jobs_Count, &Duplicate_Tags_Count, &Deduplicated_Size) != 0)) goto Exit;
+
+	for (i = 0; i < Archive.Tags_Count; i++) Pointer_Pointer_Sorted_Tags[i] = &Pointer_Tags[i];
+	qsort(Pointer_Pointer_Sorted_Tags, Archive.Tags_Count, sizeof(TIDPArchiveTag *), MainIDPCompareTagOffsets);
+
+	// Store the data contiguously in their original order, the tag data pointers still point to the original data
+	for (i = 0; i < Archive.Tags_Count; i++)
+	{
+		Pointer_Tag = Pointer_Pointer_Sorted_Tags[i];
+		if ((Pointer_Previous_Tag != NULL) && (Pointer_Previous_Tag->Pointer_Data == Pointer_Tag->Pointer_Data) && (Pointer_Previous_Tag->Data_Size == Pointer_Tag->Data_Size)) Pointer_Tag->Data_Offset = Pointer_Previous_Tag->Data_Offset;
+		else
+		{
+			Pointer_Tag->Data_Offset = (int) Data_Size;
+			Data_Size += Pointer_Tag->Data_Size;
+		}
+		Pointer_Previous_Tag = Pointer_Tag;
+	}
+	Data_Area_Offset = IDPArchiveComputeDirectorySize(Pointer_Tags, Archive.Tags_Count);
+
+	// Write the tags directory then the data
+	Pointer_File_Output = fopen(Pointer_String_Output_File, "wb");
+	if (Pointer_File_Output == NULL)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to create the IDP file '%s' (%s).\n", Pointer_String_Output_File, strerror(errno));
+		goto Exit;
+	}
+	if (IDPArchiveWriteDirectory(Pointer_File_Output, Pointer_Tags, Archive.Tags_Count) != 0) goto Exit;
+	Pointer_Previous_Tag = NULL;
+	for (i = 0; i < Archive.Tags_Count; i++)
+	{
+		Pointer_Tag = Pointer_Pointer_Sorted_Tags[i];
+		if ((Pointer_Previous_Tag == NULL) || (Pointer_Previous_Tag->Pointer_Data != Pointer_Tag->Pointer_Data) || (Pointer_Previous_Tag->Data_Size != Pointer_Tag->Data_Size))
+		{
+			if (FileSystemWriteFile(Pointer_Tag->Pointer_Data, Pointer_Tag->Data_Size, Pointer_File_Output) != (size_t) Pointer_Tag->Data_Size)
+			{
+				LogPrint(LOG_LEVEL_ERROR, "Error : failed to write the tag '%s' data (%s).\n", Pointer_Tag->Pointer_String_Name, strerror(errno));
+				goto Exit;
+			}
+		}
+		Pointer_Previous_Tag = Pointer_Tag;
+	}
+	if (fclose(Pointer_File_Output) != 0)
+	{
+		Pointer_File_Output = NULL;
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to write the IDP file '%s' (%s).\n", Pointer_String_Output_File, strerror(errno));
+		goto Exit;
+	}
+	Pointer_File_Output = NULL;
+
+	if (Is_Deduplication_Enabled) LogPrint(LOG_LEVEL_INFORMATION, "%d tags had the same data as another tag, storing their data only once saved %lld bytes.\n", Duplicate_Tags_Count, Deduplicated_Size);
+	if (Is_Compact_Command) LogPrint(LOG_LEVEL_INFORMATION, "The IDP file was successfully compacted (%lld bytes were removed).\n", (long long) Archive.Mapped_File.Size - Data_Area_Offset - Data_Size);
+	else LogPrint(LOG_LEVEL_INFORMATION, "The IDP file was successfully repacked (%lld bytes were removed, the archive size went from %lld to %lld bytes).\n", (long long) Archive.Mapped_File.Size - Data_Area_Offset - Data_Size, (long long) Archive.Mapped_File.Size, Data_Area_Offset + Data_Size);
+	Return_Value = 0;
+
+Exit:
+	if (Pointer_File_Output != NULL) fclose(Pointer_File_Output);
+	if (Pointer_Pointer_Sorted_Tags != NULL) free(Pointer_Pointer_Sorted_Tags);
+	if (Pointer_Tags != NULL) free(Pointer_Tags);
+	IDPArchiveClose(&Archive);
+	return Return_Value;
+}
+
+/** Display the tags of an IDP archive, sorted by name.
+ * @param Pointer_String_Archive_File The IDP file.
+ * @param Pointer_String_Pattern If not NULL, display only the tags matching this pattern.
+ * @return -1 if an error occurred,
+ * @return 0 on success.
+ */
+static int MainIDPList(char *Pointer_String_Archive_File, char *Pointer_String_Pattern)
+{
+	TIDPIndex Index;
+	int i;
+	char *Pointer_String_Tag_Name;
+
+	if (IDPIndexLoad(Pointer_String_Archive_File, &Index) != 0)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to load IDP archive index.\n");
+		return -1;
+	}
+
+	for (i = 0; i < Index.Entries_Count; i++)
+	{
+		Pointer_String_Tag_Name = Index.Pointer_Names + Index.Pointer_Entries[i].Name_Offset;
+		if ((Pointer_String_Pattern == NULL) || IDPArchiveIsTagNameMatching(Pointer_String_Pattern, Pointer_String_Tag_Name)) printf("%10d %s\n", Index.Pointer_Entries[i].Data_Size, Pointer_String_Tag_Name);
+	}
+
+	IDPIndexFree(&Index);
+	return 0;
+}
+
+/** Display the location of some tags of an IDP archive.
+ * @param Pointer_String_Archive_File The IDP file.
+ * @param Tag_Names_Count How many tags to find.
+ * @param Pointer_Strings_Tag_Names The names of the tags to find.
+ * @return -1 if an error occurred or if a tag was not found,
+ * @return 0 if all tags were found.
+ */
+static int MainIDPFind(char *Pointer_String_Archive_File, int Tag_Names_Count, char *Pointer_Strings_Tag_Names[])
+{
+	TIDPIndex Index;
+	TIDPIndexEntry *Pointer_Entry;
+	int i, Return_Value = 0;
+
+	if (IDPIndexLoad(Pointer_String_Archive_File, &Index) != 0)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to load IDP archive index.\n");
+		return -1;
+	}
+
+	for (i = 0; i < Tag_Names_Count; i++)
+	{
+		Pointer_Entry = IDPIndexFind(&Index, Pointer_Strings_Tag_Names[i]);
+		if (Pointer_Entry == NULL)
+		{
+			LogPrint(LOG_LEVEL_ERROR, "Error : the archive contains no tag named '%s'.\n", Pointer_Strings_Tag_Names[i]);
+			Return_Value = -1;
+		}
+		else printf("Tag %d (name : '%s', data offset : 0x%08X, data size : %d bytes).\n", Pointer_Entry->Tag_Index, Index.Pointer_Names + Pointer_Entry->Name_Offset, Pointer_Entry->Data_Offset, Pointer_Entry->Data_Size);
+	}
+
+	IDPIndexFree(&Index);
+	return Return_Value;
+}
+
+/** Display a string as a JSON string, escaping the characters JSON does not allow.
+ * @param Pointer_String The string to display.
+ */
+static void MainPrintJSONString(const char *Pointer_String)
+{
+	putchar('"');
+	while (*Pointer_String != 0)
+	{
+		if ((*Pointer_String == '"') || (*Pointer_String == '\\')) printf("\\%c", *Pointer_String);
+		else if ((unsigned char) *Pointer_String < 0x20) printf("\\u%04X", (unsigned char) *Pointer_String);
+		else putchar(*Pointer_String);
+		Pointer_String++;
+	}
+	putchar('"');
+}
+
+/** Order the tags by name.
+ * @param Pointer_Pointer_Tag_1 The first tag to compare.
+ * @param Pointer_Pointer_Tag_2 The second tag to compare.
+ * @return The IDPArchiveCompareTagNames() result, or the archive order for tags with the same name.
+ */
+static int MainIDPCompareTagNames(const void *Pointer_Pointer_Tag_1, const void *Pointer_Pointer_Tag_2)
+{
+	const TIDPArchiveTag *Pointer_Tag_1 = *(const TIDPArchiveTag **) Pointer_Pointer_Tag_1, *Pointer_Tag_2 = *(const TIDPArchiveTag **) Pointer_Pointer_Tag_2;
+	int Result;
+
+	Result = IDPArchiveCompareTagNames(Pointer_Tag_1->Pointer_String_Name, Pointer_Tag_2->Pointer_String_Name);
+	if (Result != 0) return Result;
+	return Pointer_Tag_1 < Pointer_Tag_2 ? -1 : 1;
+}
+
+/** Order the compared tags by decreasing data size, so the largest tags are hashed first and do not delay the end of the comparison.
+ * @param Pointer_Pointer_Entry_1 The first entry to compare.
+ * @param Pointer_Pointer_Entry_2 The second entry to compare.
+ * @return A negative value if the first entry must be hashed first,
+ * @return a positive value if the second entry must be hashed first.
+ */
+static int MainIDPDiffCompareEntrySizes(const void *Pointer_Pointer_Entry_1, const void *Pointer_Pointer_Entry_2)
+{
+	const TMainIDPDiffEntry *Pointer_Entry_1 = *(const TMainIDPDiffEntry **) Pointer_Pointer_Entry_1, *Pointer_Entry_2 = *(const TMainIDPDiffEntry **) Pointer_Pointer_Entry_2;
+
+	if (Pointer_Entry_1->Pointer_New_Tag->Data_Size != Pointer_Entry_2->Pointer_New_Tag->Data_Size) return Pointer_Entry_1->Pointer_New_Tag->Data_Size > Pointer_Entry_2->Pointer_New_Tag->Data_Size ? -1 : 1;
+	return Pointer_Entry_1 < Pointer_Entry_2 ? -1 : 1;
+}
+
+/** Compare the data of a tag present in both archives with the same size.
+ * @param Pointer_Context The entries to hash, sorted by decreasing size.
+ * @param Item_Index The entry to hash.
+ * @param Worker_Index Not used.
+ * @return 0, comparing mapped data can't fail.
+ */
+static int MainIDPDiffWorker(void *Pointer_Context, int Item_Index, int Worker_Index)
+{
+	TMainIDPDiffEntry *Pointer_Entry = ((TMainIDPDiffEntry **) Pointer_Context)[Item_Index];
+	unsigned long long Old_Hash, New_Hash;
+
+	(void) Worker_Index;
+
+	Old_Hash = IDPArchiveComputeDataHash(Pointer_Entry->Pointer_Old_Tag->Pointer_Data, Pointer_Entry->Pointer_Old_Tag->Data_Size);
+	New_Hash = IDPArchiveComputeDataHash(Pointer_Entry->Pointer_New_Tag->Pointer_Data, Pointer_Entry->Pointer_New_Tag->Data_Size);
+	Pointer_Entry->Status = Old_Hash == New_Hash ? MAIN_IDP_DIFF_STATUS_UNCHANGED : MAIN_IDP_DIFF_STATUS_CHANGED;
+	return 0;
+}
+
+/** Display the compared tags with a given status.
+ * @param Pointer_Entries The compared tags, sorted by name.
+ * @param Entries_Count How many entries there are.
+ * @param Status Display only the entries with this status.
+ * @param Is_JSON_Output_Enabled Set to 1 to display the entries as JSON array items, or to 0 to display a text for humans.
+ */
+static void MainIDPDiffPrintEntries(TMainIDPDiffEntry *Pointer_Entries, int Entries_Count, TMainIDPDiffStatus Status, int Is_JSON_Output_Enabled)
+{
+	static const char *Pointer_Strings_Status_Names[] = {"Added", "Removed", "Changed"};
+	TMainIDPDiffEntry *Pointer_Entry;
+	int i, Is_First_Entry = 1;
+
+	for (i = 0; i < Entries_Count; i++)
+	{
+		Pointer_Entry = &Pointer_Entries[i];
+		if (Pointer_Entry->Status != Status) continue;
+
+		if (Is_JSON_Output_Enabled)
+		{
+			printf("%s\t\t{\"name\": ", Is_First_Entry ? "" : ",\n");
+			MainPrintJSONString(Pointer_Entry->Pointer_New_Tag != NULL ? Pointer_Entry->Pointer_New_Tag->Pointer_String_Name : Pointer_Entry->Pointer_Old_Tag->Pointer_String_Name);
+			if (Pointer_Entry->Pointer_Old_Tag != NULL) printf(", \"old_size\": %d", Pointer_Entry->Pointer_Old_Tag->Data_Size);
+			if (Pointer_Entry->Pointer_New_Tag != NULL) printf(", \"new_size\": %d", Pointer_Entry->Pointer_New_Tag->Data_Size);
+			printf("}");
+		}
+		else
+		{
+			if (Status == MAIN_IDP_DIFF_STATUS_ADDED) printf("%-7s : %s (%d bytes).\n", Pointer_Strings_Status_Names[Status], Pointer_Entry->Pointer_New_Tag->Pointer_String_Name, Pointer_Entry->Pointer_New_Tag->Data_Size);
+			else if (Status == MAIN_IDP_DIFF_STATUS_REMOVED) printf("%-7s : %s (%d bytes).\n", Pointer_Strings_Status_Names[Status], Pointer_Entry->Pointer_Old_Tag->Pointer_String_Name, Pointer_Entry->Pointer_Old_Tag->Data_Size);
+			else printf("%-7s : %s (%d bytes, previously %d bytes).\n", Pointer_Strings_Status_Names[Status], Pointer_Entry->Pointer_New_Tag->Pointer_String_Name, Pointer_Entry->Pointer_New_Tag->Data_Size, Pointer_Entry->Pointer_Old_Tag->Data_Size);
+		}
+		Is_First_Entry = 0;
+	}
+	if (Is_JSON_Output_Enabled && !Is_First_Entry) printf("\n");
+}
+
+/** Tell which tags were added, removed or changed between two IDP archives. The tags are matched by name, and only the data of the tags whose size did not change are hashed.
+ * @param Pointer_String_Old_File The reference IDP file.
+ * @param Pointer_String_New_File The IDP file to compare to the reference one.
+ * @param Options_Count How many command-line options follow the command arguments.
+ * @param Pointer_Strings_Options The command-line options.
+ * @return -1 if an error occurred,
+ * @return 0 if both archives contain the same tags with the same data,
+ * @return 1 if the archives differ.
+ */
+static int MainIDPDiff(char *Pointer_String_Old_File, char *Pointer_String_New_File, int Options_Count, char *Pointer_Strings_Options[])
+{
+	TIDPArchive Old_Archive, New_Archive;
+	TIDPArchiveTag **Pointer_Pointer_Old_Sorted_Tags = NULL, **Pointer_Pointer_New_Sorted_Tags = NULL;
+	TMainIDPDiffEntry *Pointer_Entries = NULL, **Pointer_Pointer_Hashed_Entries = NULL;
+	double Start_Time;
+	int i, Old_Index = 0, New_Index = 0, Result, Entries_Count = 0, Hashed_Entries_Count = 0, Jobs_Count = 1, Is_JSON_Output_Enabled = 0, Return_Value = -1, Status_Counts[4] = {0};
+	TLogLevel Log_Level;
+
+	// Parse the options
+	for (i = 0; i < Options_Count; i++)
+	{
+		if (strcmp(Pointer_Strings_Options[i], MAIN_OPTION_STRING_JSON) == 0) Is_JSON_Output_Enabled = 1;
+		else if (strcmp(Pointer_Strings_Options[i], MAIN_OPTION_STRING_JOBS) == 0)
+		{
+			i++;
+			if (i < Options_Count) Jobs_Count = atoi(Pointer_Strings_Options[i]);
+			if ((i >= Options_Count) || (Jobs_Count < 1) || (Jobs_Count > THREAD_MAXIMUM_WORKERS_COUNT))
+			{
+				LogPrint(LOG_LEVEL_ERROR, "Error : the " MAIN_OPTION_STRING_JOBS " option needs a threads count from 1 to %d.\n", THREAD_MAXIMUM_WORKERS_COUNT);
+				return -1;
+			}
+		}
+		else
+		{
+			LogPrint(LOG_LEVEL_ERROR, "Error : unknown option '%s'.\n", Pointer_Strings_Options[i]);
+			return -1;
+		}
+	}
+
+	// The messages are displayed on the console too, keep only the errors and warnings so the JSON output can be parsed
+	Log_Level = LogGetLevel();
+	if (Is_JSON_Output_Enabled && (Log_Level > LOG_LEVEL_WARNING)) LogSetLevel(LOG_LEVEL_WARNING);
+
+	// Map both archives, so the data can be hashed without copying them
+	if (IDPArchiveOpen(Pointer_String_Old_File, IDP_ARCHIVE_ACCESS_MODE_MAPPED, &Old_Archive) != 0)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to open IDP archive '%s'.\n", Pointer_String_Old_File);
+		goto Exit_Restore_Log_Level;
+	}
+	if (IDPArchiveOpen(Pointer_String_New_File, IDP_ARCHIVE_ACCESS_MODE_MAPPED, &New_Archive) != 0)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to open IDP archive '%s'.\n", Pointer_String_New_File);
+		goto Exit_Close_Old_Archive;
+	}
+
+	// Sort both tags directories by name, so they can be joined in a single pass
+	Pointer_Pointer_Old_Sorted_Tags = malloc(sizeof(TIDPArchiveTag *) * (Old_Archive.Tags_Count + 1)); // Make sure to allocate something for empty archives
+	Pointer_Pointer_New_Sorted_Tags = malloc(sizeof(TIDPArchiveTag *) * (New_Archive.Tags_Count + 1));
+	Pointer_Entries = malloc(sizeof(TMainIDPDiffEntry) * (Old_Archive.Tags_Count + New_Archive.Tags_Count + 1));
+	Pointer_Pointer_Hashed_Entries = malloc(sizeof(TMainIDPDiffEntry *) * (Old_Archive.Tags_Count + 1));
+	if ((Pointer_Pointer_Old_Sorted_Tags == NULL) || (Pointer_Pointer_New_Sorted_Tags == NULL) || (Pointer_Entries == NULL) || (Pointer_Pointer_Hashed_Entries == NULL))
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to allocate the tags lists (%s).\n", strerror(errno));
+		goto Exit;
+	}
+	for (i = 0; i < Old_Archive.Tags_Count; i++) Pointer_Pointer_Old_Sorted_Tags[i] = &Old_Archive.Pointer_Tags[i];
+	qsort(Pointer_Pointer_Old_Sorted_Tags, Old_Archive.Tags_Count, sizeof(TIDPArchiveTag *), MainIDPCompareTagNames);
+	for (i = 0; i < New_Archive.Tags_Count; i++) Pointer_Pointer_New_Sorted_Tags[i] = &New_Archive.Pointer_Tags[i];
+	qsort(Pointer_Pointer_New_Sorted_Tags, New_Archive.Tags_Count, sizeof(TIDPArchiveTag *), MainIDPCompareTagNames);
+
+	// Join the tags by name, the tags with a different size are changed without looking at their data
+	while ((Old_Index < Old_Archive.Tags_Count) || (New_Index < New_Archive.Tags_Count))
+	{
+		if (Old_Index >= Old_Archive.Tags_Count) Result = 1;
+		else if (New_Index >= New_Archive.Tags_Count) Result = -1;
+		else Result = IDPArchiveCompareTagNames(Pointer_Pointer_Old_Sorted_Tags[Old_Index]->Pointer_String_Name, Pointer_Pointer_New_Sorted_Tags[New_Index]->Pointer_String_Name);
+
+		if (Result < 0)
+		{
+			Pointer_Entries[Entries_Count].Pointer_Old_Tag = Pointer_Pointer_Old_Sorted_Tags[Old_Index];
+			Pointer_Entries[Entries_Count].Pointer_New_Tag = NULL;
+			Pointer_Entries[Entries_Count].Status = MAIN_IDP_DIFF_STATUS_REMOVED;
+			Old_Index++;
+		}
+		else if (Result > 0)
+		{
+			Pointer_Entries[Entries_Count].Pointer_Old_Tag = NULL;
+			Pointer_Entries[Entries_Count].Pointer_New_Tag = Pointer_Pointer_New_Sorted_Tags[New_Index];
+			Pointer_Entries[Entries_Count].Status = MAIN_IDP_DIFF_STATUS_ADDED;
+			New_Index++;
+		}
+		else
+		{
+			Pointer_Entries[Entries_Count].Pointer_Old_Tag = Pointer_Pointer_Old_Sorted_Tags[Old_Index];
+			Pointer_Entries[Entries_Count].Pointer_New_Tag = Pointer_Pointer_New_Sorted_Tags[New_Index];
+			if (Pointer_Entries[Entries_Count].Pointer_Old_Tag->Data_Size != Pointer_Entries[Entries_Count].Pointer_New_Tag->Data_Size) Pointer_Entries[Entries_Count].Status = MAIN_IDP_DIFF_STATUS_CHANGED;
+			else
+			{
+				Pointer_Entries[Entries_Count].Status = MAIN_IDP_DIFF_STATUS_UNCHANGED;
+				Pointer_Pointer_Hashed_Entries[Hashed_Entries_Count] = &Pointer_Entries[Entries_Count];
+				Hashed_Entries_Count++;
+			}
+			Old_Index++;
+			New_Index++;
+		}
+		Entries_Count++;
+	}
+
+	// Hash the data of the tags that may be unchanged
+	LogPrint(LOG_LEVEL_DEBUG, "Hashing the data of %d tags with %d threads.\n", Hashed_Entries_Count, Jobs_Count);
+	qsort(Pointer_Pointer_Hashed_Entries, Hashed_Entries_Count, sizeof(TMainIDPDiffEntry *), MainIDPDiffCompareEntrySizes);
+	Start_Time = StatisticsGetTime(); // Time the whole pass, adding the time of each worker would count the parallel time several times
+	if (ThreadParallelFor(Jobs_Count, Hashed_Entries_Count, MainIDPDiffWorker, Pointer_Pointer_Hashed_Entries) != 0) goto Exit;
+	StatisticsAddPhaseTime(STATISTICS_PHASE_IDP_PAYLOAD_HASH, Start_Time);
+	for (i = 0; i < Entries_Count; i++) Status_Counts[Pointer_Entries[i].Status]++;
+
+	if (Is_JSON_Output_Enabled)
+	{
+		printf("{\n\t\"added\":\n\t[\n");
+		MainIDPDiffPrintEntries(Pointer_Entries, Entries_Count, MAIN_IDP_DIFF_STATUS_ADDED, 1);
+		printf("\t],\n\t\"removed\":\n\t[\n");
+		MainIDPDiffPrintEntries(Pointer_Entries, Entries_Count, MAIN_IDP_DIFF_STATUS_REMOVED, 1);
+		printf("\t],\n\t\"changed\":\n\t[\n");
+		MainIDPDiffPrintEntries(Pointer_Entries, Entries_Count, MAIN_IDP_DIFF_STATUS_CHANGED, 1);
+		printf("\t],\n\t\"unchanged_count\": %d\n}\n", Status_Counts[MAIN_IDP_DIFF_STATUS_UNCHANGED]);
+	}
+	else
+	{
+		MainIDPDiffPrintEntries(Pointer_Entries, Entries_Count, MAIN_IDP_DIFF_STATUS_ADDED, 0);
+		MainIDPDiffPrintEntries(Pointer_Entries, Entries_Count, MAIN_IDP_DIFF_STATUS_REMOVED, 0);
+		MainIDPDiffPrintEntries(Pointer_Entries, Entries_Count, MAIN_IDP_DIFF_STATUS_CHANGED, 0);
+		LogPrint(LOG_LEVEL_INFORMATION, "%d tags added, %d tags removed, %d tags changed, %d tags unchanged.\n", Status_Counts[MAIN_IDP_DIFF_STATUS_ADDED], Status_Counts[MAIN_IDP_DIFF_STATUS_REMOVED], Status_Counts[MAIN_IDP_DIFF_STATUS_CHANGED], Status_Counts[MAIN_IDP_DIFF_STATUS_UNCHANGED]);
+	}
+	Return_Value = Status_Counts[MAIN_IDP_DIFF_STATUS_UNCHANGED] == Entries_Count ? 0 : 1;
+
+Exit:
+	free(Pointer_Pointer_Old_Sorted_Tags);
+	free(Pointer_Pointer_New_Sorted_Tags);
+	free(Pointer_Entries);
+	free(Pointer_Pointer_Hashed_Entries);
+	IDPArchiveClose(&New_Archive);
+Exit_Close_Old_Archive:
+	IDPArchiveClose(&Old_Archive);
+Exit_Restore_Log_Level:
+	LogSetLevel(Log_Level);
+	return Return_Value;
+}
+
+/** Handle the options that can be used with all commands and remove them from the command line, so the commands never see them.
+ * @param Pointer_Arguments_Count On input, how many command-line arguments there are. On output, how many arguments remain.
+ * @param Pointer_Strings_Arguments The command-line arguments, they are modified in place.
+ * @param Pointer_Pointer_String_Statistics_File On output, contain the statistics file name, or NULL if no statistics are requested.
+ * @return -1 if an error occurred,
+ * @return 0 on success.
+ */
+static int MainParseGlobalOptions(int *Pointer_Arguments_Count, char *Pointer_Strings_Arguments[], char **Pointer_Pointer_String_Statistics_File)
+{
+	int i, Kept_Arguments_Count = 1; // Always keep the program name
+	size_t Option_Length = strlen(MAIN_OPTION_STRING_STATISTICS);
+
+	*Pointer_Pointer_String_Statistics_File = NULL;
+
+	for (i = 1; i < *Pointer_Arguments_Count; i++)
+	{
+		if (strcmp(Pointer_Strings_Arguments[i], MAIN_OPTION_STRING_QUIET) == 0) LogSetLevel(LOG_LEVEL_WARNING);
+		else if (strcmp(Pointer_Strings_Arguments[i], MAIN_OPTION_STRING_VERBOSE) == 0) LogSetLevel(LOG_LEVEL_DEBUG);
+		else if (strcmp(Pointer_Strings_Arguments[i], MAIN_OPTION_STRING_LOG_FILE) == 0)
+		{
+			i++;
+			if (i >= *Pointer_Arguments_Count)
+			{
+				LogPrint(LOG_LEVEL_ERROR, "Error : the " MAIN_OPTION_STRING_LOG_FILE " option needs a file name.\n");
+				return -1;
+			}
+			if (LogSetFile(Pointer_Strings_Arguments[i]) != 0) return -1;
+		}
+		// The file name is attached to the option ("--stats=File"), so a missing file name can't be confused with the command
+		else if ((strncmp(Pointer_Strings_Arguments[i], MAIN_OPTION_STRING_STATISTICS, Option_Length) == 0) && ((Pointer_Strings_Arguments[i][Option_Length] == '=') || (Pointer_Strings_Arguments[i][Option_Length] == 0)))
+		{
+			if ((Pointer_Strings_Arguments[i][Option_Length] != '=') || (Pointer_Strings_Arguments[i][Option_Length + 1] == 0))
+			{
+				LogPrint(LOG_LEVEL_ERROR, "Error : the " MAIN_OPTION_STRING_STATISTICS " option needs a file name, like " MAIN_OPTION_STRING_STATISTICS "=Statistics.json.\n");
+				return -1;
+			}
+			*Pointer_Pointer_String_Statistics_File = &Pointer_Strings_Arguments[i][Option_Length + 1];
+			StatisticsEnable();
+		}
+		else
+		{
+			Pointer_Strings_Arguments[Kept_Arguments_Count] = Pointer_Strings_Arguments[i];
+			Kept_Arguments_Count++;
+		}
+	}
+
+	*Pointer_Arguments_Count = Kept_Arguments_Count;
+	Pointer_Strings_Arguments[Kept_Arguments_Count] = NULL; // Keep the arguments list terminated like the original one
+	return 0;
+}
+
+/** Build a file path from a directory and a path relative to it, like the ones returned by FileSystemListFiles(). The '\\' separators are converted to '/', which all systems understand.
+ * @param Pointer_String_Directory The directory.
+ * @param Pointer_String_Relative_Path The path relative to the directory.
+ * @return NULL if the path could not be allocated (an error message is displayed),
+ * @return the path on success, it must be freed with free().
+ */
+static char *MainBuildPath(const char *Pointer_String_Directory, const char *Pointer_String_Relative_Path)
+{
+	char *Pointer_String_Path, *Pointer_Character;
+
+	Pointer_String_Path = malloc(strlen(Pointer_String_Directory) + 1 + strlen(Pointer_String_Relative_Path) + 1);
+	if (Pointer_String_Path == NULL)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to allocate a file path (%s).\n", strerror(errno));
+		return NULL;
+	}
+	sprintf(Pointer_String_Path, "%s/%s", Pointer_String_Directory, Pointer_String_Relative_Path);
+
+	for (Pointer_Character = Pointer_String_Path; *Pointer_Character != 0; Pointer_Character++)
+	{
+		if (*Pointer_Character == '\\') *Pointer_Character = '/';
+	}
+	return Pointer_String_Path;
+}
+
+/** Parse a map extraction option if the current option is one of them.
+ * @param Pointer_Options The extraction options to update.
+ * @param Options_Count How many options there are.
+ * @param Pointer_Strings_Options The command options.
+ * @param Pointer_Option_Index On input, the index of the option to parse. On output, the index of the last option argument that was used.
+ * @return -1 if the option is a map extraction option but it is invalid,
+ * @return 0 if the option is not a map extraction option,
+ * @return 1 if the option was successfully parsed.
+ */
+static int MainMapParseExtractionOption(TMapExtractionOptions *Pointer_Options, int Options_Count, char *Pointer_Strings_Options[], int *Pointer_Option_Index)
+{
+	int i = *Pointer_Option_Index;
+	double Maximum_Error = -1;
+	char *Pointer_String_End = "";
+
+	if (strcmp(Pointer_Strings_Options[i], MAIN_OPTION_STRING_TERRAIN_FORMAT) == 0)
+	{
+		i++;
+		if (i >= Options_Count)
+		{
+			LogPrint(LOG_LEVEL_ERROR, "Error : the " MAIN_OPTION_STRING_TERRAIN_FORMAT " option needs a format.\n");
+			return -1;
+		}
+		if (strcmp(Pointer_Strings_Options[i], "obj") == 0) Pointer_Options->Terrain_Format = MAP_TERRAIN_FORMAT_OBJ;
+		else if (strcmp(Pointer_Strings_Options[i], "glb") == 0) Pointer_Options->Terrain_Format = MAP_TERRAIN_FORMAT_GLB;
+		else if (strcmp(Pointer_Strings_Options[i], "ply") == 0) Pointer_Options->Terrain_Format = MAP_TERRAIN_FORMAT_PLY;
+		else if (strcmp(Pointer_Strings_Options[i], "none") == 0) Pointer_Options->Terrain_Format = MAP_TERRAIN_FORMAT_NONE;
+		else
+		{
+			LogPrint(LOG_LEVEL_ERROR, "Error : unknown terrain format '%s', it must be obj, glb, ply or none.\n", Pointer_Strings_Options[i]);
+			return -1;
+		}
+	}
+	else if (strcmp(Pointer_Strings_Options[i], MAIN_OPTION_STRING_HEIGHTMAP) == 0)
+	{
+		i++;
+		if (i >= Options_Count)
+		{
+			LogPrint(LOG_LEVEL_ERROR, "Error : the " MAIN_OPTION_STRING_HEIGHTMAP " option needs a format.\n");
+			return -1;
+		}
+		if (strcmp(Pointer_Strings_Options[i], "raw16") == 0) Pointer_Options->Heightmap_Format = MAP_HEIGHTMAP_FORMAT_RAW16;
+		else if (strcmp(Pointer_Strings_Options[i], "pgm") == 0) Pointer_Options->Heightmap_Format = MAP_HEIGHTMAP_FORMAT_PGM;
+		else if (strcmp(Pointer_Strings_Options[i], "tiff16") == 0) Pointer_Options->Heightmap_Format = MAP_HEIGHTMAP_FORMAT_TIFF16;
+		else
+		{
+			LogPrint(LOG_LEVEL_ERROR, "Error : unknown heightmap format '%s', it must be raw16, pgm or tiff16.\n", Pointer_Strings_Options[i]);
+			return -1;
+		}
+	}
+	else if (strcmp(Pointer_Strings_Options[i], MAIN_OPTION_STRING_TERRAIN_STRIPS) == 0) Pointer_Options->Is_Triangle_Strips_Enabled = 1;
+	else if (strcmp(Pointer_Strings_Options[i], MAIN_OPTION_STRING_TERRAIN_MAXIMUM_ERROR) == 0)
+	{
+		i++;
+		if (i < Options_Count) Maximum_Error = strtod(Pointer_Strings_Options[i], &Pointer_String_End);
+		if ((i >= Options_Count) || (*Pointer_String_End != 0) || !(Maximum_Error >= 0) || (Maximum_Error > 1e6))
+		{
+			LogPrint(LOG_LEVEL_ERROR, "Error : the " MAIN_OPTION_STRING_TERRAIN_MAXIMUM_ERROR " option needs a positive height error.\n");
+			return -1;
+		}
+		Pointer_Options->Terrain_Maximum_Error = (float) Maximum_Error;
+	}
+	else if (strcmp(Pointer_Strings_Options[i], MAIN_OPTION_STRING_TERRAIN_LEVELS_OF_DETAIL) == 0)
+	{
+		i++;
+		if (i < Options_Count) Pointer_Options->Terrain_Levels_Of_Detail_Count = atoi(Pointer_Strings_Options[i]);
+		if ((i >= Options_Count) || (Pointer_Options->Terrain_Levels_Of_Detail_Count < 1) || (Pointer_Options->Terrain_Levels_Of_Detail_Count > MAIN_MAXIMUM_TERRAIN_LEVELS_OF_DETAIL_COUNT))
+		{
+			LogPrint(LOG_LEVEL_ERROR, "Error : the " MAIN_OPTION_STRING_TERRAIN_LEVELS_OF_DETAIL " option needs a levels count from 1 to %d.\n", MAIN_MAXIMUM_TERRAIN_LEVELS_OF_DETAIL_COUNT);
+			return -1;
+		}
+	}
+	else if (strcmp(Pointer_Strings_Options[i], MAIN_OPTION_STRING_TERRAIN_CHUNKS) == 0)
+	{
+		i++;
+		if (i < Options_Count) Pointer_Options->Terrain_Chunk_Tiles_Count = atoi(Pointer_Strings_Options[i]);
+		if ((i >= Options_Count) || (Pointer_Options->Terrain_Chunk_Tiles_Count < 1) || (Pointer_Options->Terrain_Chunk_Tiles_Count > MAIN_MAXIMUM_TERRAIN_CHUNK_TILES_COUNT))
+		{
+			LogPrint(LOG_LEVEL_ERROR, "Error : the " MAIN_OPTION_STRING_TERRAIN_CHUNKS " option needs a tiles count from 1 to %d.\n", MAIN_MAXIMUM_TERRAIN_CHUNK_TILES_COUNT);
+			return -1;
+		}
+	}
+	else return 0;
+
+	*Pointer_Option_Index = i;
+	return 1;
+}
+
+/** Extract as much content as possible from a map file.
+ * @param Pointer_String_Input_File The map file to extract.
+ * @param Pointer_File_Output_Directory The directory to put the extracted data to.
+ * @param Options_Count How many options there are.
+ * @param Pointer_Strings_Options The command options.
+ * @return -1 if an error occurred,
+ * @return 0 if the map was successfully extracted.
+ */
+static int MainMapExtract(char* Pointer_String_Input_File, char* Pointer_File_Output_Directory, int Options_Count, char *Pointer_Strings_Options[])
+{
+	TMapExtractionOptions Options;
+	int i, Result;
+
+	// Parse the options
+	MapInitializeExtractionOptions(&Options);
+	for (i = 0; i < Options_Count; i++)
+	{
+		Result = MainMapParseExtractionOption(&Options, Options_Count, Pointer_Strings_Options, &i);
+		if (Result < 0) return -1;
+		if (Result > 0) continue;
+
+		if (strcmp(Pointer_Strings_Options[i], MAIN_OPTION_STRING_JOBS) == 0)
+		{
+			i++;
+			if (i < Options_Count) Options.Jobs_Count = atoi(Pointer_Strings_Options[i]);
+			if ((i >= Options_Count) || (Options.Jobs_Count < 1) || (Options.Jobs_Count > THREAD_MAXIMUM_WORKERS_COUNT))
+			{
+				LogPrint(LOG_LEVEL_ERROR, "Error : the " MAIN_OPTION_STRING_JOBS " option needs a threads count from 1 to %d.\n", THREAD_MAXIMUM_WORKERS_COUNT);
+				return -1;
+			}
+		}
+		else
+		{
+			LogPrint(LOG_LEVEL_ERROR, "Error : unknown option '%s'.\n", Pointer_Strings_Options[i]);
+			return -1;
+		}
+	}
+
+	// Try to create the output directory
+	if (FileSystemCreateDirectory(Pointer_File_Output_Directory) != 0)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to create the output directory (%s).\n", strerror(errno));
+		return -1;
+	}
+
+	// Retrieve the map content
+	return MapExtract(Pointer_String_Input_File, Pointer_File_Output_Directory, &Options);
+}
+
+/** Sort the maps to extract by decreasing size, then by path for the maps of the same size.
+ * @param Pointer_Item_1 The first map.
+ * @param Pointer_Item_2 The second map.
+ * @return A negative value if the first map must be extracted first, a positive value otherwise.
+ */
+static int MainMapCompareBatchItems(const void *Pointer_Item_1, const void *Pointer_Item_2)
+{
+	const TMainMapBatchItem *Pointer_Map_1 = Pointer_Item_1, *Pointer_Map_2 = Pointer_Item_2;
+
+	if (Pointer_Map_1->Size > Pointer_Map_2->Size) return -1;
+	if (Pointer_Map_1->Size < Pointer_Map_2->Size) return 1;
+	return strcmp(Pointer_Map_1->Pointer_String_Map_File, Pointer_Map_2->Pointer_String_Map_File);
+}
+
+/** Extract a map from an extraction worker. A failed map does not stop the other maps extraction.
+ * @param Pointer_Context The extraction context.
+ * @param Item_Index The index of the map in the sorted maps list.
+ * @param Worker_Index The worker index, it is not used.
+ * @return Always 0.
+ */
+static int MainMapExtractWorker(void *Pointer_Context, int Item_Index, int Worker_Index)
+{
+	TMainMapExtractionContext *Pointer_Extraction_Context = Pointer_Context;
+	TMainMapBatchItem *Pointer_Item = &Pointer_Extraction_Context->Pointer_Items[Item_Index];
+
+	(void) Worker_Index;
+
+	if (MapExtract(Pointer_Item->Pointer_String_Map_File, Pointer_Item->Pointer_String_Output_Directory, Pointer_Extraction_Context->Pointer_Options) != 0)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to extract map \"%s\".\n", Pointer_Item->Pointer_String_Map_File);
+		Pointer_Item->Is_Extraction_Failed = 1;
+	}
+
+	LogProgressUpdate(Pointer_Extraction_Context->Pointer_Progress, 1, Pointer_Item->Size);
+	return 0;
+}
+
+/** Extract all maps found in a directory.
+ * @param Pointer_String_Maps_Directory The directory containing the map files, it is explored recursively.
+ * @param Pointer_String_Output_Directory The directory to extract the maps to, each map is extracted to a subdirectory with the map file name.
+ * @param Options_Count How many options there are.
+ * @param Pointer_Strings_Options The command options.
+ * @return -1 if an error occurred or if any map could not be extracted,
+ * @return 0 if all maps were successfully extracted.
+ */
+static int MainMapExtractAll(char *Pointer_String_Maps_Directory, char *Pointer_String_Output_Directory, int Options_Count, char *Pointer_Strings_Options[])
+{
+	TMapExtractionOptions Options;
+	TFileSystemFile *Pointer_Files = NULL;
+	TMainMapBatchItem *Pointer_Items = NULL, *Pointer_Item;
+	TMainMapExtractionContext Extraction_Context;
+	TFileSystemDirectoryCache Directory_Cache;
+	TLogProgress Progress;
+	int i, Result, Return_Value = -1, Jobs_Count = 1, Files_Count = 0, Items_Count = 0, Failed_Maps_Count = 0;
+	char *Pointer_String_Map_File;
+
+	FileSystemDirectoryCacheInitialize(&Directory_Cache);
+
+	// Parse the options
+	MapInitializeExtractionOptions(&Options);
+	for (i = 0; i < Options_Count; i++)
+	{
+		Result = MainMapParseExtractionOption(&Options, Options_Count, Pointer_Strings_Options, &i);
+		if (Result < 0) goto Exit;
+		if (Result > 0) continue;
+
+		if (strcmp(Pointer_Strings_Options[i], MAIN_OPTION_STRING_JOBS) == 0)
+		{
+			i++;
+			if (i < Options_Count) Jobs_Count = atoi(Pointer_Strings_Options[i]);
+			if ((i >= Options_Count) || (Jobs_Count < 1) || (Jobs_Count > THREAD_MAXIMUM_WORKERS_COUNT))
+			{
+				LogPrint(LOG_LEVEL_ERROR, "Error : the " MAIN_OPTION_STRING_JOBS " option needs a threads count from 1 to %d.\n", THREAD_MAXIMUM_WORKERS_COUNT);
+				goto Exit;
+			}
+		}
+		else
+		{
+			LogPrint(LOG_LEVEL_ERROR, "Error : unknown option '%s'.\n", Pointer_Strings_Options[i]);
+			goto Exit;
+		}
+	}
+
+	// Find the map files, the other files of the directory are ignored
+	if (FileSystemListFiles(Pointer_String_Maps_Directory, &Pointer_Files, &Files_Count) != 0) goto Exit;
+	Pointer_Items = malloc(sizeof(TMainMapBatchItem) * (Files_Count + 1)); // Make sure to allocate something for an empty directory
+	if (Pointer_Items == NULL)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to allocate the maps list (%s).\n", strerror(errno));
+		goto Exit;
+	}
+	for (i = 0; i < Files_Count; i++)
+	{
+		Pointer_String_Map_File = MainBuildPath(Pointer_String_Maps_Directory, Pointer_Files[i].Pointer_String_Path);
+		if (Pointer_String_Map_File == NULL) goto Exit;
+		if (!MapIsMapFile(Pointer_String_Map_File))
+		{
+			LogPrint(LOG_LEVEL_DEBUG, "Ignoring file \"%s\" which is not a map.\n", Pointer_String_Map_File);
+			free(Pointer_String_Map_File);
+			continue;
+		}
+
+		Pointer_Item = &Pointer_Items[Items_Count];
+		Pointer_Item->Pointer_String_Map_File = Pointer_String_Map_File;
+		Pointer_Item->Pointer_String_Output_Directory = MainBuildPath(Pointer_String_Output_Directory, Pointer_Files[i].Pointer_String_Path);
+		Pointer_Item->Size = Pointer_Files[i].Size;
+		Pointer_Item->Is_Extraction_Failed = 0;
+		Items_Count++;
+		if (Pointer_Item->Pointer_String_Output_Directory == NULL) goto Exit;
+	}
+	LogPrint(LOG_LEVEL_INFORMATION, "Found %d maps in \"%s\".\n", Items_Count, Pointer_String_Maps_Directory);
+
+	// Create all output directories first, the directory cache can't be shared by the workers
+	if (FileSystemCreateDirectory(Pointer_String_Output_Directory) != 0)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to create the output directory (%s).\n", strerror(errno));
+		goto Exit;
+	}
+	for (i = 0; i < Items_Count; i++)
+	{
+		if ((FileSystemCreateParentDirectories(&Directory_Cache, Pointer_Items[i].Pointer_String_Output_Directory) != 0) || (FileSystemCreateDirectory(Pointer_Items[i].Pointer_String_Output_Directory) != 0))
+		{
+			LogPrint(LOG_LEVEL_ERROR, "Error : failed to create the output directory \"%s\".\n", Pointer_Items[i].Pointer_String_Output_Directory);
+			goto Exit;
+		}
+	}
+
+	// Start with the largest maps, so a big map extracted at the end can't keep the other workers idle
+	if (Items_Count > 0) qsort(Pointer_Items, Items_Count, sizeof(TMainMapBatchItem), MainMapCompareBatchItems);
+
+	LogProgressInitialize(&Progress, "maps", Items_Count);
+	Extraction_Context.Pointer_Items = Pointer_Items;
+	Extraction_Context.Pointer_Options = &Options;
+	Extraction_Context.Pointer_Progress = &Progress;
+	if (ThreadParallelFor(Jobs_Count, Items_Count, MainMapExtractWorker, &Extraction_Context) != 0) goto Exit;
+	LogProgressTerminate(&Progress);
+
+	for (i = 0; i < Items_Count; i++)
+	{
+		if (Pointer_Items[i].Is_Extraction_Failed) Failed_Maps_Count++;
+	}
+	if (Failed_Maps_Count > 0)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : %d maps out of %d could not be extracted.\n", Failed_Maps_Count, Items_Count);
+		goto Exit;
+	}
+	LogPrint(LOG_LEVEL_INFORMATION, "All %d maps were successfully extracted.\n", Items_Count);
+	Return_Value = 0;
+
+Exit:
+	if (Pointer_Items != NULL)
+	{
+		for (i = 0; i < Items_Count; i++)
+		{
+			free(Pointer_Items[i].Pointer_String_Map_File);
+			free(Pointer_Items[i].Pointer_String_Output_Directory);
+		}
+		free(Pointer_Items);
+	}
+	FileSystemFreeFiles(Pointer_Files, Files_Count);
+	FileSystemDirectoryCacheFree(&Directory_Cache);
+	return Return_Value;
+}
+
+/** Display a map table of contents.
+ * @param Pointer_String_Map_File The map file the information comes from.
+ * @param Pointer_Information The map information.
+ * @param Is_JSON_Output_Enabled Set to 1 to display a JSON object, or to 0 to display a text for humans.
+ */
+static void MainMapPrintInformation(const char *Pointer_String_Map_File, TMapInformation *Pointer_Information, int Is_JSON_Output_Enabled)
+{
+	int i, j, Records_Count, Units_Count = 0;
+	long long Payloads_Size;
+	TMapRecordInformation *Pointer_Record;
+	TMapUnitGroupInformation *Pointer_Unit_Group;
+
+	for (i = 0; i < Pointer_Information->Unit_Groups_Count; i++) Units_Count += Pointer_Information->Pointer_Unit_Groups[i].Units_Count;
+
+	if (Is_JSON_Output_Enabled)
+	{
+		printf("\t{\n\t\t\"file\": ");
+		MainPrintJSONString(Pointer_String_Map_File);
+		if (Pointer_Information->Width >= 0) printf(",\n\t\t\"width\": %d,\n\t\t\"height\": %d,\n", Pointer_Information->Width, Pointer_Information->Height);
+		else printf(",\n\t\t\"width\": null,\n\t\t\"height\": null,\n");
+		printf("\t\t\"units_count\": %d,\n\t\t\"records\":\n\t\t[\n", Units_Count);
+		for (i = 0; i < Pointer_Information->Records_Count; i++)
+		{
+			Pointer_Record = &Pointer_Information->Pointer_Records[i];
+			printf("\t\t\t{\"id\": %d, \"offset\": %lld, \"payload_size\": %d}%s\n", Pointer_Record->Identifier, Pointer_Record->Offset, Pointer_Record->Payload_Size, i < Pointer_Information->Records_Count - 1 ? "," : "");
+		}
+		printf("\t\t],\n\t\t\"record_types\":\n\t\t[");
+	}
+	else
+	{
+		printf("Map \"%s\" :\n", Pointer_String_Map_File);
+		if (Pointer_Information->Width >= 0) printf("  Size : %dx%d tiles.\n", Pointer_Information->Width, Pointer_Information->Height);
+		else printf("  Size : unknown (no size record).\n");
+		printf("  Records (identifier, offset, payload size) :\n");
+		for (i = 0; i < Pointer_Information->Records_Count; i++)
+		{
+			Pointer_Record = &Pointer_Information->Pointer_Records[i];
+			printf("    %5d 0x%08llX %10d\n", Pointer_Record->Identifier, Pointer_Record->Offset, Pointer_Record->Payload_Size);
+		}
+		printf("  Records per identifier (identifier, records count, payloads size) :\n");
+	}
+
+	// Summarize each record identifier, in order of first appearance
+	for (i = 0; i < Pointer_Information->Records_Count; i++)
+	{
+		// Skip the identifiers that have already been summarized
+		for (j = 0; j < i; j++)
+		{
+			if (Pointer_Information->Pointer_Records[j].Identifier == Pointer_Information->Pointer_Records[i].Identifier) break;
+		}
+		if (j < i) continue;
+
+		Records_Count = 0;
+		Payloads_Size = 0;
+		for (j = i; j < Pointer_Information->Records_Count; j++)
+		{
+			if (Pointer_Information->Pointer_Records[j].Identifier == Pointer_Information->Pointer_Records[i].Identifier)
+			{
+				Records_Count++;
+				Payloads_Size += Pointer_Information->Pointer_Records[j].Payload_Size;
+			}
+		}
+		if (Is_JSON_Output_Enabled) printf("%s\n\t\t\t{\"id\": %d, \"count\": %d, \"payload_bytes\": %lld}", i > 0 ? "," : "", Pointer_Information->Pointer_Records[i].Identifier, Records_Count, Payloads_Size);
+		else printf("    %5d %6d %12lld\n", Pointer_Information->Pointer_Records[i].Identifier, Records_Count, Payloads_Size);
+	}
+
+	if (Is_JSON_Output_Enabled) printf("\n\t\t],\n\t\t\"unit_groups\":\n\t\t[");
+	else printf("  Unit groups (%d groups, %d units) :\n", Pointer_Information->Unit_Groups_Count, Units_Count);
+	for (i = 0; i < Pointer_Information->Unit_Groups_Count; i++)
+	{
+		Pointer_Unit_Group = &Pointer_Information->Pointer_Unit_Groups[i];
+		if (Is_JSON_Output_Enabled)
+		{
+			printf("%s\n\t\t\t{\"name\": ", i > 0 ? "," : "");
+			MainPrintJSONString(Pointer_Unit_Group->String_Name);
+			printf(", \"record_type\": %u, \"units_count\": %u}", Pointer_Unit_Group->Record_Type, Pointer_Unit_Group->Units_Count);
+		}
+		else printf("    %-32s %5u units (record type %u)\n", Pointer_Unit_Group->String_Name, Pointer_Unit_Group->Units_Count, Pointer_Unit_Group->Record_Type);
+	}
+	if (Is_JSON_Output_Enabled) printf("\n\t\t]\n\t}");
+}
+
+/** Display the table of contents of some map files.
+ * @param Arguments_Count How many map files, directories and options there are.
+ * @param Pointer_Strings_Arguments The map files, the directories to look for map files in and the options.
+ * @return -1 if an error occurred with any map,
+ * @return 0 if all maps were successfully read.
+ */
+static int MainMapInformation(int Arguments_Count, char *Pointer_Strings_Arguments[])
+{
+	int i, j, Is_JSON_Output_Enabled = 0, Return_Value = 0, Files_Count, Displayed_Maps_Count = 0;
+	TMapInformation Information;
+	TFileSystemFile *Pointer_Files;
+	char *Pointer_String_Path;
+
+	// Parse the options first, because the output format must be known before displaying the first map
+	for (i = 0; i < Arguments_Count; i++)
+	{
+		if (strcmp(Pointer_Strings_Arguments[i], MAIN_OPTION_STRING_JSON) == 0) Is_JSON_Output_Enabled = 1;
+	}
+
+	if (Is_JSON_Output_Enabled) printf("[\n");
+	for (i = 0; i < Arguments_Count; i++)
+	{
+		if (strcmp(Pointer_Strings_Arguments[i], MAIN_OPTION_STRING_JSON) == 0) continue;
+
+		// A directory is replaced by the map files it contains
+		if (FileSystemIsDirectory(Pointer_Strings_Arguments[i]))
+		{
+			if (FileSystemListFiles(Pointer_Strings_Arguments[i], &Pointer_Files, &Files_Count) != 0)
+			{
+				Return_Value = -1;
+				continue;
+			}
+		}
+		else
+		{
+			Pointer_Files = NULL;
+			Files_Count = 1;
+		}
+
+		for (j = 0; j < Files_Count; j++)
+		{
+			if (Pointer_Files == NULL) Pointer_String_Path = Pointer_Strings_Arguments[i];
+			else
+			{
+				Pointer_String_Path = MainBuildPath(Pointer_Strings_Arguments[i], Pointer_Files[j].Pointer_String_Path);
+				if (Pointer_String_Path == NULL)
+				{
+					Return_Value = -1;
+					break;
+				}
+			}
+
+			// The other files of a directory are silently ignored, but a file given on the command line must be a map
+			if ((Pointer_Files != NULL) && !MapIsMapFile(Pointer_String_Path)) LogPrint(LOG_LEVEL_DEBUG, "Ignoring file \"%s\" which is not a map.\n", Pointer_String_Path);
+			else if (MapReadInformation(Pointer_String_Path, &Information) != 0) Return_Value = -1;
+			else
+			{
+				if (Is_JSON_Output_Enabled && (Displayed_Maps_Count > 0)) printf(",\n");
+				MainMapPrintInformation(Pointer_String_Path, &Information, Is_JSON_Output_Enabled);
+				MapFreeInformation(&Information);
+				Displayed_Maps_Count++;
+			}
+			if (Pointer_Files != NULL) free(Pointer_String_Path);
+		}
+		FileSystemFreeFiles(Pointer_Files, Files_Count);
+	}
+	if (Is_JSON_Output_Enabled) printf("%s]\n", Displayed_Maps_Count > 0 ? "\n" : "");
+
+	return Return_Value;
+}
+
+/** Parse a map query number.
+ * @param Pointer_String_Number The string to convert.
+ * @param Pointer_Number On output, contain the number.
+ * @return -1 if the string is not a finite number,
+ * @return 0 on success.
+ */
+static int MainParseQueryNumber(char *Pointer_String_Number, double *Pointer_Number)
+{
+	char *Pointer_String_End;
+
+	*Pointer_Number = strtod(Pointer_String_Number, &Pointer_String_End);
+	if ((Pointer_String_End == Pointer_String_Number) || (*Pointer_String_End != 0) || !(*Pointer_Number >= -1e15) || !(*Pointer_Number <= 1e15)) return -1;
+	return 0;
+}
+
+/** Find and display the units close to a location.
+ * @param Pointer_Units The map units.
+ * @param Pointer_Results A buffer able to store all map units.
+ * @param Query_Index The query number, used to separate the JSON objects.
+ * @param X The location X coordinate.
+ * @param Y The location Y coordinate.
+ * @param Radius The search radius.
+ * @param Is_JSON_Output_Enabled Set to 1 to display a JSON object, or to 0 to display a text for humans.
+ */
+static void MainMapQueryUnitsRun(TMapUnits *Pointer_Units, TUnitIndexResult *Pointer_Results, int Query_Index, double X, double Y, double Radius, int Is_JSON_Output_Enabled)
+{
+	int Results_Count, i, Unit_Index;
+	float Terrain_Height;
+	double Start_Time;
+	char String_Terrain_Height[32];
+
+	Start_Time = StatisticsGetTime();
+	Results_Count = UnitIndexFind(&Pointer_Units->Index, X, Y, Radius, Pointer_Results);
+
+	if (Is_JSON_Output_Enabled) printf("%s\t{\n\t\t\"x\": %.9g,\n\t\t\"y\": %.9g,\n\t\t\"radius\": %.9g,\n\t\t\"units\":\n\t\t[", Query_Index > 0 ? ",\n" : "", X, Y, Radius);
+	else printf("Query %d (X %.9g, Y %.9g, radius %.9g) : %d unit(s).\n", Query_Index + 1, X, Y, Radius, Results_Count);
+
+	for (i = 0; i < Results_Count; i++)
+	{
+		Unit_Index = Pointer_Results[i].Unit_Index;
+		if (MapGetTerrainHeight(Pointer_Units, Pointer_Units->Pointer_Coordinates_X[Unit_Index], Pointer_Units->Pointer_Coordinates_Y[Unit_Index], &Terrain_Height) == 0) snprintf(String_Terrain_Height, sizeof(String_Terrain_Height), "%.9g", Terrain_Height);
+		else strcpy(String_Terrain_Height, Is_JSON_Output_Enabled ? "null" : "unknown");
+
+		if (Is_JSON_Output_Enabled)
+		{
+			printf("%s\n\t\t\t{\"index\": %d, \"distance\": %.9g, \"group\": ", i > 0 ? "," : "", Unit_Index, Pointer_Results[i].Distance);
+			MainPrintJSONString(Pointer_Units->Pointer_Unit_Groups[Pointer_Units->Pointer_Group_Indices[Unit_Index]].String_Name);
+			printf(", \"type\": ");
+			MainPrintJSONString(Pointer_Units->Pointer_Strings_Types[Unit_Index]);
+			printf(", \"x\": %u, \"y\": %u, \"z\": %u, \"terrain_height\": %s}", Pointer_Units->Pointer_Coordinates_X[Unit_Index], Pointer_Units->Pointer_Coordinates_Y[Unit_Index], Pointer_Units->Pointer_Coordinates_Z[Unit_Index], String_Terrain_Height);
+		}
+		else printf("  %6d %12.3f %-32s %-24s %10u %10u %10u %s\n", Unit_Index, Pointer_Results[i].Distance, Pointer_Units->Pointer_Unit_Groups[Pointer_Units->Pointer_Group_Indices[Unit_Index]].String_Name, Pointer_Units->Pointer_Strings_Types[Unit_Index],
+			Pointer_Units->Pointer_Coordinates_X[Unit_Index], Pointer_Units->Pointer_Coordinates_Y[Unit_Index], Pointer_Units->Pointer_Coordinates_Z[Unit_Index], String_Terrain_Height);
+	}
+	if (Is_JSON_Output_Enabled) printf("%s]\n\t}", Results_Count > 0 ? "\n\t\t" : "");
+	StatisticsAddPhaseTime(STATISTICS_PHASE_MAP_UNITS_QUERY, Start_Time);
+}
+
+/** Find the units close to one or many locations, the map units are indexed once for all queries.
+ * @param Pointer_String_Map_File The map file.
+ * @param Arguments_Count How many arguments follow the map file.
+ * @param Pointer_Strings_Arguments The query values and the command options.
+ * @return -1 if an error occurred,
+ * @return 0 on success.
+ */
+static int MainMapQueryUnits(char *Pointer_String_Map_File, int Arguments_Count, char *Pointer_Strings_Arguments[])
+{
+	int i, Is_JSON_Output_Enabled = 0, Values_Count = 0, Queries_Count = 0, Line_Number = 0, Return_Value = -1;
+	char *Pointer_String_Queries_File = NULL, String_Line[1024], String_Extra[2];
+	double Values[3], Coordinates_Per_Terrain_Vertex = MAP_UNIT_COORDINATES_PER_TERRAIN_VERTEX;
+	FILE *Pointer_File = NULL;
+	TMapUnits Units;
+	TUnitIndexResult *Pointer_Results = NULL;
+	TLogLevel Log_Level;
+
+	// Parse the arguments, the query values are the arguments that are not options
+	for (i = 0; i < Arguments_Count; i++)
+	{
+		if (strcmp(Pointer_Strings_Arguments[i], MAIN_OPTION_STRING_JSON) == 0) Is_JSON_Output_Enabled = 1;
+		else if (strcmp(Pointer_Strings_Arguments[i], MAIN_OPTION_STRING_QUERIES) == 0)
+		{
+			i++;
+			if (i >= Arguments_Count)
+			{
+				LogPrint(LOG_LEVEL_ERROR, "Error : the " MAIN_OPTION_STRING_QUERIES " option needs a file name.\n");
+				return -1;
+			}
+			Pointer_String_Queries_File = Pointer_Strings_Arguments[i];
+		}
+		else if (strcmp(Pointer_Strings_Arguments[i], MAIN_OPTION_STRING_COORDINATES_PER_VERTEX) == 0)
+		{
+			i++;
+			if ((i >= Arguments_Count) || (MainParseQueryNumber(Pointer_Strings_Arguments[i], &Coordinates_Per_Terrain_Vertex) != 0) || !(Coordinates_Per_Terrain_Vertex > 0))
+			{
+				LogPrint(LOG_LEVEL_ERROR, "Error : the " MAIN_OPTION_STRING_COORDINATES_PER_VERTEX " option needs a positive number.\n");
+				return -1;
+			}
+		}
+		else if ((Values_Count < 3) && (MainParseQueryNumber(Pointer_Strings_Arguments[i], &Values[Values_Count]) == 0)) Values_Count++;
+		else
+		{
+			LogPrint(LOG_LEVEL_ERROR, "Error : unknown option '%s'.\n", Pointer_Strings_Arguments[i]);
+			return -1;
+		}
+	}
+	if (((Pointer_String_Queries_File == NULL) && (Values_Count != 3)) || ((Pointer_String_Queries_File != NULL) && (Values_Count != 0)))
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : give either the X, Y and Radius values or the " MAIN_OPTION_STRING_QUERIES " option.\n");
+		return -1;
+	}
+	if ((Values_Count == 3) && (Values[2] < 0))
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : the query radius can't be negative.\n");
+		return -1;
+	}
+
+	// The messages are displayed on the console too, keep only the errors and warnings so the JSON output can be parsed (opening an archive map tag displays the archive tags count)
+	Log_Level = LogGetLevel();
+	if (Is_JSON_Output_Enabled && (Log_Level > LOG_LEVEL_WARNING)) LogSetLevel(LOG_LEVEL_WARNING);
+
+	if (Pointer_String_Queries_File != NULL)
+	{
+		Pointer_File = FileSystemOpenFile(Pointer_String_Queries_File, "r");
+		if (Pointer_File == NULL)
+		{
+			LogPrint(LOG_LEVEL_ERROR, "Error : failed to open the queries file \"%s\" (%s).\n", Pointer_String_Queries_File, strerror(errno));
+			goto Exit;
+		}
+	}
+
+	if (MapReadUnits(Pointer_String_Map_File, &Units) != 0) goto Exit;
+	Units.Coordinates_Per_Terrain_Vertex = Coordinates_Per_Terrain_Vertex;
+	LogPrint(LOG_LEVEL_DEBUG, "The map has %d units in %d groups.\n", Units.Units_Count, Units.Unit_Groups_Count);
+	Pointer_Results = malloc((Units.Units_Count + 1) * sizeof(TUnitIndexResult));
+	if (Pointer_Results == NULL)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to allocate the query results (%s).\n", strerror(errno));
+		goto Exit_Free_Units;
+	}
+
+	if (Is_JSON_Output_Enabled) printf("[\n");
+	if (Pointer_File == NULL)
+	{
+		MainMapQueryUnitsRun(&Units, Pointer_Results, 0, Values[0], Values[1], Values[2], Is_JSON_Output_Enabled);
+		Queries_Count = 1;
+	}
+	else
+	{
+		while (fgets(String_Line, sizeof(String_Line), Pointer_File) != NULL)
+		{
+			Line_Number++;
+
+			// Skip the empty lines and the comments
+			for (i = 0; (String_Line[i] == ' ') || (String_Line[i] == '\t'); i++);
+			if ((String_Line[i] == '#') || (String_Line[i] == '\r') || (String_Line[i] == '\n') || (String_Line[i] == 0)) continue;
+
+			if ((sscanf(String_Line, "%lf %lf %lf %1s", &Values[0], &Values[1], &Values[2], String_Extra) != 3) || !(Values[2] >= 0))
+			{
+				if (Is_JSON_Output_Enabled) printf("%s]\n", Queries_Count > 0 ? "\n" : "");
+				LogPrint(LOG_LEVEL_ERROR, "Error : line %d of the queries file is not a valid \"X Y Radius\" query.\n", Line_Number);
+				goto Exit_Free_Results;
+			}
+			MainMapQueryUnitsRun(&Units, Pointer_Results, Queries_Count, Values[0], Values[1], Values[2], Is_JSON_Output_Enabled);
+			Queries_Count++;
+		}
+	}
+	if (Is_JSON_Output_Enabled) printf("%s]\n", Queries_Count > 0 ? "\n" : "");
+	Return_Value = 0;
+
+Exit_Free_Results:
+	free(Pointer_Results);
+Exit_Free_Units:
+	MapFreeUnits(&Units);
+Exit:
+	if (Pointer_File != NULL) fclose(Pointer_File);
+	LogSetLevel(Log_Level);
+	return Return_Value;
+}
+
+/** Measure the tools performance on synthetic files.
+ * @param Pointer_String_Program_File This program executable path.
+ * @param Pointer_String_Work_Directory Where to create the synthetic files.
+ * @param Options_Count How many options there are.
+ * @param Pointer_Strings_Options The command options.
+ * @return -1 if an error occurred,
+ * @return 0 on success.
+ */
+static int MainBenchmark(char *Pointer_String_Program_File, char *Pointer_String_Work_Directory, int Options_Count, char *Pointer_Strings_Options[])
+{
+	int i, Iterations_Count = 3;
+	char *Pointer_String_Report_File = NULL;
+
+	// Parse the options
+	for (i = 0; i < Options_Count; i++)
+	{
+		if (strcmp(Pointer_Strings_Options[i], MAIN_OPTION_STRING_ITERATIONS) == 0)
+		{
+			i++;
+			if (i < Options_Count) Iterations_Count = atoi(Pointer_Strings_Options[i]);
+			if ((i >= Options_Count) || (Iterations_Count < 1))
+			{
+				LogPrint(LOG_LEVEL_ERROR, "Error : the " MAIN_OPTION_STRING_ITERATIONS " option needs a count greater than zero.\n");
+				return -1;
+			}
+		}
+		else if (strcmp(Pointer_Strings_Options[i], MAIN_OPTION_STRING_REPORT) == 0)
+		{
+			i++;
+			if (i >= Options_Count)
+			{
+				LogPrint(LOG_LEVEL_ERROR, "Error : the " MAIN_OPTION_STRING_REPORT " option needs a file name.\n");
+				return -1;
+			}
+			Pointer_String_Report_File = Pointer_Strings_Options[i];
+		}
+		else
+		{
+			LogPrint(LOG_LEVEL_ERROR, "Error : unknown option '%s'.\n", Pointer_Strings_Options[i]);
+			return -1;
+		}
+	}
+
+	return BenchmarkRun(Pointer_String_Program_File, Pointer_String_Work_Directory, Iterations_Count, Pointer_String_Report_File);
+}
+
+//-------------------------------------------------------------------------------------------------
+// Entry point
+//-------------------------------------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+	int Return_Value = EXIT_FAILURE;
+	char *Pointer_String_Statistics_File = NULL;
+
+	LogInitialize();
+	if (MainParseGlobalOptions(&argc, argv, &Pointer_String_Statistics_File) != 0) goto Exit;
+
+	// Check parameters
+	if (argc < 2)
+	{
+		MainDisplayProgramUsage(argv[0]);
+		goto Exit;
+	}
+	
+	// Handle command
+	if (strcmp(argv[1], MAIN_COMMAND_STRING_BENCHMARK) == 0)
+	{
+		if (argc >= 3) Return_Value = MainBenchmark(argv[0], argv[2], argc - 3, &argv[3]);
+		else MainDisplayProgramUsage(argv[0]);
+	}
+	else if (strcmp(argv[1], MAIN_COMMAND_STRING_BENCHMARK_GENERATE_IDP) == 0)
+	{
+		if ((argc == 6) || (argc == 7)) Return_Value = BenchmarkGenerateIDPArchive(argv[2], atoi(argv[3]), atoi(argv[4]), atoi(argv[5]), argc == 7 ? (unsigned int) strtoul(argv[6], NULL, 10) : 1);
+		else MainDisplayProgramUsage(argv[0]);
+	}
+	else if (strcmp(argv[1], MAIN_COMMAND_STRING_BENCHMARK_GENERATE_MAP) == 0)
+	{
+		if ((argc == 6) || (argc == 7)) Return_Value = BenchmarkGenerateMap(argv[2], atoi(argv[3]), atoi(argv[4]), atoi(argv[5]), argc == 7 ? (unsigned int) strtoul(argv[6], NULL, 10) : 1);
+		else MainDisplayProgramUsage(argv[0]);
+	}
+	else if (strcmp(argv[1], MAIN_COMMAND_STRING_IDP_BUILD) == 0)
+	{
+		if (argc >= 4) Return_Value = MainIDPBuild(argv[2], argv[3], argc - 4, &argv[4]);
+		else MainDisplayProgramUsage(argv[0]);
+	}
+	else if (strcmp(argv[1], MAIN_COMMAND_STRING_IDP_COMPACT) == 0)
+	{
+		if (argc == 4) Return_Value = MainIDPRepack(argv[2], argv[3], 0, NULL, 1);
+		else MainDisplayProgramUsage(argv[0]);
+	}
+	else if (strcmp(argv[1], MAIN_COMMAND_STRING_IDP_DIFF) == 0)
+	{
+		if (argc >= 4) Return_Value = MainIDPDiff(argv[2], argv[3], argc - 4, &argv[4]);
+		else MainDisplayProgramUsage(argv[0]);
+	}
+	else if (strcmp(argv[1], MAIN_COMMAND_STRING_IDP_EXTRACT) == 0)
+	{
+		if (argc >= 4) Return_Value = MainIDPExtract(argv[2], argv[3], argc - 4, &argv[4]);
+		else MainDisplayProgramUsage(argv[0]);
+	}
+	else if (strcmp(argv[1], MAIN_COMMAND_STRING_IDP_FIND) == 0)
+	{
+		if (argc >= 4) Return_Value = MainIDPFind(argv[2], argc - 3, &argv[3]);
+		else MainDisplayProgramUsage(argv[0]);
+	}
+	else if (strcmp(argv[1], MAIN_COMMAND_STRING_IDP_LIST) == 0)
+	{
+		if (argc == 3) Return_Value = MainIDPList(argv[2], NULL);
+		else if (argc == 4) Return_Value = MainIDPList(argv[2], argv[3]);
+		else MainDisplayProgramUsage(argv[0]);
+	}
+	else if (strcmp(argv[1], MAIN_COMMAND_STRING_IDP_PATCH) == 0)
+	{
+		if (argc >= 4) Return_Value = MainIDPPatch(argv[2], argc - 3, &argv[3]);
+		else MainDisplayProgramUsage(argv[0]);
+	}
+	else if (strcmp(argv[1], MAIN_COMMAND_STRING_IDP_REPACK) == 0)
+	{
+		if (argc >= 4) Return_Value = MainIDPRepack(argv[2], argv[3], argc - 4, &argv[4], 0);
+		else MainDisplayProgramUsage(argv[0]);
+	}
+	else if (strcmp(argv[1], MAIN_COMMAND_STRING_MAP_EXTRACT) == 0)
+	{
+		if (argc >= 4) Return_Value = MainMapExtract(argv[2], argv[3], argc - 4, &argv[4]);
+		else MainDisplayProgramUsage(argv[0]);
+	}
+	else if (strcmp(argv[1], MAIN_COMMAND_STRING_MAP_EXTRACT_ALL) == 0)
+	{
+		if (argc >= 4) Return_Value = MainMapExtractAll(argv[2], argv[3], argc - 4, &argv[4]);
+		else MainDisplayProgramUsage(argv[0]);
+	}
+	else if (strcmp(argv[1], MAIN_COMMAND_STRING_MAP_INFORMATION) == 0)
+	{
+		if (argc >= 3) Return_Value = MainMapInformation(argc - 2, &argv[2]);
+		else MainDisplayProgramUsage(argv[0]);
+	}
+	else if (strcmp(argv[1], MAIN_COMMAND_STRING_MAP_QUERY_UNITS) == 0)
+	{
+		if (argc >= 4) Return_Value = MainMapQueryUnits(argv[2], argc - 3, &argv[3]);
+		else MainDisplayProgramUsage(argv[0]);
+	}
+	else
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : unknown command.\n");
+		MainDisplayProgramUsage(argv[0]);
+	}
+
+	if ((Pointer_String_Statistics_File != NULL) && (StatisticsWriteReport(Pointer_String_Statistics_File, argv[1], Return_Value) != 0)) Return_Value = EXIT_FAILURE;
+
+Exit:
+	LogTerminate();
 	return Return_Value;
 }
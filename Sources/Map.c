@@ -3,15 +3,46 @@
  * @author Adrien RICCIARDI
  */
 #include <errno.h>
+#include <File_System.h>
+#include <File_Writer.h>
+#include <IDP_Archive.h>
+#include <Log.h>
 #include <Map.h>
+#include <Mapped_File.h>
+#include <Statistics.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <Terrain_Simplifier.h>
+#include <Thread.h>
+// Use the widest vector instructions the compiler is allowed to generate, all x86-64 processors have SSE2
+#if defined(__AVX2__)
+	#define MAP_IS_AVX2_ENABLED 1
+	#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+	#define MAP_IS_SSE2_ENABLED 1
+	#include <emmintrin.h>
+#endif
 
 //-------------------------------------------------------------------------------------------------
 // Private constants
 //-------------------------------------------------------------------------------------------------
 /** The maximum supported record identifier. */
 #define MAP_MAXIMUM_RECORD_IDENTIFIER 19
+/** The last record identifier. */
+#define MAP_RECORD_IDENTIFIER_END_OF_FILE 4097
+
+/** The only supported map file version. */
+#define MAP_FILE_VERSION 0x66
+
+/** Separate the archive file from the tag name when a map is read from an IDP archive, like "SCom.idp:app\\maps\\ema1". */
+#define MAP_SOURCE_ARCHIVE_SEPARATOR ':'
+
+/** The size in bytes of a unit in a units record : type, unknown fields and three coordinates each followed by unknown bytes. */
+#define MAP_UNIT_SIZE (MAP_UNIT_TYPE_MAXIMUM_LENGTH + 12 + 3 * 8)
+
+/** The largest size of the units record fixed part : group name, record type, unknown value, two units list indices and units count. */
+#define MAP_UNIT_GROUP_HEADER_MAXIMUM_SIZE (MAP_UNIT_GROUP_NAME_MAXIMUM_LENGTH + 5 * 4)
 
 /** How many tiles per side of the map (i.e. the map width or the map height in tile units). Map is square. */
 #define MAP_TERRAIN_GEOMETRY_MAXIMUM_TILES_PER_SIDE 100
@@ -19,31 +50,99 @@
 /** How many vertices per side of a tile (i.e. a tile width or a tile height in vertex units). A tile is square. */
 #define MAP_TERRAIN_GEOMETRY_VERTICES_PER_TILE_SIDE 16
 
+/** The size in bytes of a terrain vertex in the terrain geometry record, the height is stored in the first 2 bytes. */
+#define MAP_TERRAIN_GEOMETRY_VERTEX_SIZE 8
+/** The terrain heights are stored in 1/300 of unit. */
+#define MAP_TERRAIN_GEOMETRY_HEIGHT_SCALE 300.f
+
+/** The beginning of the binary terrain PLY file header, it needs the vertices count. */
+#define MAP_PLY_HEADER_VERTICES "ply\nformat binary_little_endian 1.0\ncomment Generated by Stealth Combat Tools\nelement vertex %d\nproperty float x\nproperty float y\nproperty float z\n"
+/** The end of the PLY file header for a triangles list, it needs the triangles count. */
+#define MAP_PLY_HEADER_TRIANGLES "element face %d\nproperty list uchar uint vertex_indices\nend_header\n"
+
+/** The value added to the heights stored in a PGM file, which only supports unsigned samples. */
+#define MAP_HEIGHTMAP_PGM_SAMPLE_OFFSET 32768
+/** How many entries the heightmap TIFF file directory has. */
+#define MAP_HEIGHTMAP_TIFF_ENTRIES_COUNT 14
+
+/** The name of the file that tells how to convert the heightmap samples to heights. */
+#define MAP_FILE_NAME_HEIGHTMAP_METADATA "Terrain_Heightmap.json"
+/** The directory the terrain chunks are written to. */
+#define MAP_DIRECTORY_NAME_TERRAIN_CHUNKS "Terrain_Chunks"
+/** The name of the file that lists the terrain chunks. */
+#define MAP_FILE_NAME_TERRAIN_CHUNKS_INDEX "Index.json"
+
 /** The name of the file that stores the units information. */
 #define MAP_FILE_NAME_UNITS "Units.ini"
 
 //-------------------------------------------------------------------------------------------------
 // Private types
 //-------------------------------------------------------------------------------------------------
+/** A read-only view of a record payload that stays in the mapped map file. All reads are checked against the payload end, so a malformed record can't make a handler read past it. */
+typedef struct
+{
+	const unsigned char *Pointer_Data; //!< The payload first byte.
+	int Size; //!< The payload size in bytes.
+	int Offset; //!< The next byte to read, relative to the payload beginning.
+} TMapPayloadView;
+
+/** The map file content, read from a map file or from an IDP archive tag. */
+typedef struct
+{
+	const unsigned char *Pointer_Data; //!< The map file content, it is read-only.
+	size_t Size; //!< The map file size in bytes.
+	int Is_Archive_Tag; //!< Set to 1 when the map is a tag of the archive, or to 0 when the map is a file.
+	TMappedFile Mapped_File; //!< The mapped map file, used when the map is a file.
+	TIDPArchive Archive; //!< The mapped archive, used when the map is an archive tag.
+} TMapSource;
+
+/** Everything a map extraction needs, so several maps can be extracted at the same time by different threads. */
+typedef struct
+{
+	char *Pointer_String_Output_Path; //!< The generated files are stored to this location.
+	TMapExtractionOptions *Pointer_Options; //!< How to extract the map.
+	TLogLevel Progress_Log_Level; //!< The level of the messages telling which map parts have been parsed, the units queries do not display them.
+	int Tiles_Per_Side; //!< How many tiles per side of the map (i.e. the map width or the map height in tile units), or -1 if the map size has not been found yet. Map is always square.
+	int Vertices_Per_Side; //!< How many vertices per map side (i.e. the map width or the map height in vertex units), or -1 if the map size has not been found yet.
+	float *Pointer_Terrain_Heights; //!< The terrain heightmap, made of Vertices_Per_Side rows of Vertices_Per_Side heights.
+	unsigned char *Pointer_Row_Buffer; //!< Hold a row of vertices or faces while a binary terrain file is written.
+	TMapUnits Units; //!< The units found in the units records, the terrain and the index are not used.
+	int Allocated_Units_Count; //!< How many units the units arrays can store.
+	int Allocated_Unit_Groups_Count; //!< How many groups the unit groups array can store.
+} TMapContext;
+
+/** A rectangle of heightmap vertices. */
+typedef struct
+{
+	int First_X; //!< The left column.
+	int First_Y; //!< The top row.
+	int Width; //!< How many vertices per row.
+	int Height; //!< How many rows.
+} TMapTerrainArea;
+
+/** A part of the terrain written to its own file. */
+typedef struct
+{
+	TMapTerrainArea Area; //!< The chunk vertices, the last row and column are shared with the next chunks.
+	float Minimum_Height; //!< The chunk lowest height.
+	float Maximum_Height; //!< The chunk highest height.
+} TMapTerrainChunk;
+
+/** Everything the terrain chunk writing workers need. */
+typedef struct
+{
+	TMapContext *Pointer_Worker_Contexts; //!< A copy of the extraction context per worker, each with its own row buffer.
+	TMapTerrainChunk *Pointer_Chunks; //!< All chunks, row after row.
+	int Chunks_Per_Side; //!< How many chunks per terrain side.
+} TMapTerrainChunksContext;
+
 /** A record handler function.
+ * @param Pointer_Context The extraction context.
  * @param Pointer_Payload The record payload.
- * @param Payload_Size The payload size in bytes.
- * @param Pointer_String_Output_Path On output, generated files will be stored to this location.
  * @return -1 if an error occurred,
  * @return 0 on success.
  */
-typedef int (*MapRecordHandler)(unsigned char *Pointer_Payload, int Payload_Size, char *Pointer_String_Output_Path);
-
-//-------------------------------------------------------------------------------------------------
-// Private variables
-//-------------------------------------------------------------------------------------------------
-/** Hold the terrain heightmap. */
-static float Map_Terrain_Heights[MAP_TERRAIN_GEOMETRY_MAXIMUM_TILES_PER_SIDE * MAP_TERRAIN_GEOMETRY_VERTICES_PER_TILE_SIDE][MAP_TERRAIN_GEOMETRY_MAXIMUM_TILES_PER_SIDE * MAP_TERRAIN_GEOMETRY_VERTICES_PER_TILE_SIDE];
-
-/** How many tiles per side of the map (i.e. the map width or the map height in tile units). Map is always square. */
-static int Map_Tiles_Per_Side = -1;
-/** How many vertices per map side (i.e. the map width or the map height in vertex units). See Map_Tiles_Per_Side for more details. */
-static int Map_Vertices_Per_Side = -1;
+typedef int (*MapRecordHandler)(TMapContext *Pointer_Context, TMapPayloadView *Pointer_Payload);
 
 //-------------------------------------------------------------------------------------------------
 // Private functions
@@ -57,646 +156,2011 @@ static int Map_Vertices_Per_Side = -1;
  */
 static FILE *MapOpenFileWithPrefixPath(const char *Pointer_String_Prefix_Path, const char *Pointer_String_File_Name, const char *Pointer_String_Opening_Mode)
 {
-	static char String_File_Path[1024]; // Should be enough for all files; the variable is allocated statically because the function can't be called in a reentrant way
+	char String_File_Path[1024]; // Should be enough for all files
 	FILE *Pointer_File;
 
 	// Concatenate the path and the file name
 	if (snprintf(String_File_Path, sizeof(String_File_Path), "%s/%s", Pointer_String_Prefix_Path, Pointer_String_File_Name) >= sizeof(String_File_Path))
 	{
-		printf("Error when trying to open the file \"%s\", the file path is too long.\n", Pointer_String_File_Name);
+		LogPrint(LOG_LEVEL_ERROR, "Error when trying to open the file \"%s\", the file path is too long.\n", Pointer_String_File_Name);
 		return NULL;
 	}
 
 	// Try to open the file
 	Pointer_File = fopen(String_File_Path, Pointer_String_Opening_Mode);
+	if (Pointer_File != NULL) StatisticsAddCounter(STATISTICS_COUNTER_FILE_OPENINGS, 1);
 
 	return Pointer_File;
 }
 
+/** Take the next bytes of a record payload.
+ * @param Pointer_Payload The payload view, its offset is moved past the taken bytes on success.
+ * @param Size How many bytes to take.
+ * @return NULL if the payload is too short (an error message is displayed),
+ * @return a pointer on the bytes on success.
+ */
+static const unsigned char *MapPayloadViewTake(TMapPayloadView *Pointer_Payload, int Size)
+{
+	const unsigned char *Pointer_Data;
+
+	if ((Size < 0) || (Pointer_Payload->Size - Pointer_Payload->Offset < Size))
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : the record payload is truncated (%d bytes needed at offset %d, but the payload is %d bytes long).\n", Size, Pointer_Payload->Offset, Pointer_Payload->Size);
+		return NULL;
+	}
+
+	Pointer_Data = Pointer_Payload->Pointer_Data + Pointer_Payload->Offset;
+	Pointer_Payload->Offset += Size;
+	return Pointer_Data;
+}
+
+/** Read the next double word of a record payload. The payload is not aligned in the mapped file, so the value is copied byte per byte.
+ * @param Pointer_Payload The payload view, its offset is moved past the double word on success.
+ * @param Pointer_Double_Word On output, contain the read value.
+ * @return -1 if the payload is too short,
+ * @return 0 on success.
+ */
+static int MapPayloadViewReadDoubleWord(TMapPayloadView *Pointer_Payload, unsigned int *Pointer_Double_Word)
+{
+	const unsigned char *Pointer_Data;
+
+	Pointer_Data = MapPayloadViewTake(Pointer_Payload, 4);
+	if (Pointer_Data == NULL) return -1;
+
+	memcpy(Pointer_Double_Word, Pointer_Data, 4);
+	return 0;
+}
+
+/** Read a fixed width string from a record payload.
+ * @param Pointer_Payload The payload view, its offset is moved past the whole field on success.
+ * @param Field_Size The field size in bytes.
+ * @param Pointer_String On output, contain the string, which is always terminated. The buffer must be at least Field_Size + 1 bytes long.
+ * @return -1 if the payload is too short,
+ * @return 0 on success.
+ */
+static int MapPayloadViewReadString(TMapPayloadView *Pointer_Payload, int Field_Size, char *Pointer_String)
+{
+	const unsigned char *Pointer_Data;
+
+	Pointer_Data = MapPayloadViewTake(Pointer_Payload, Field_Size);
+	if (Pointer_Data == NULL) return -1;
+
+	memcpy(Pointer_String, Pointer_Data, Field_Size);
+	Pointer_String[Field_Size] = 0;
+	return 0;
+}
+
+/** Read the fixed part of a units record.
+ * @param Pointer_Payload The units record payload view, its offset is moved to the first unit on success.
+ * @param Pointer_Unit_Group On output, contain the group information.
+ * @return -1 if the record is malformed,
+ * @return 0 on success.
+ */
+static int MapReadUnitGroupHeader(TMapPayloadView *Pointer_Payload, TMapUnitGroupInformation *Pointer_Unit_Group)
+{
+	// The record starts with the group name
+	if (MapPayloadViewReadString(Pointer_Payload, MAP_UNIT_GROUP_NAME_MAXIMUM_LENGTH, Pointer_Unit_Group->String_Name) != 0) return -1; // There seems to be a 32-byte fixed width for this string
+
+	// The name is followed by what has been called "record type"
+	if (MapPayloadViewReadDoubleWord(Pointer_Payload, &Pointer_Unit_Group->Record_Type) != 0) return -1;
+	if (MapPayloadViewTake(Pointer_Payload, 4) == NULL) return -1; // Also bypass the following 0x00000007, it does not seem to be used (setting it to 0 seems to have no effect)
+	// Only some record types 0, 1 and 2 are supported for now
+	if (Pointer_Unit_Group->Record_Type > 2)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : unknown record type %u following the unit name in the map file, aborting.\n", Pointer_Unit_Group->Record_Type);
+		return -1;
+	}
+
+	// Extract additional information according to the record type
+	Pointer_Unit_Group->Units_List_Indices_Count = 0;
+	if (((Pointer_Unit_Group->Record_Type == 1) || (Pointer_Unit_Group->Record_Type == 2)) && (strcmp(Pointer_Unit_Group->String_Name, "trains") != 0)) // The trais issue is in the ema11 map
+	{
+		// The formats are :
+		//     0x00000001 0x00000007 0x<index in units list> 0x<index in units list 2>
+		//     0x00000002 0x00000007 0x<index in units list>
+		// The value 0x00000007 does not seem to be used, setting it to 0 seems to have no effect
+		// The indices in the units list seem to be multiplied by 4
+		if (MapPayloadViewReadDoubleWord(Pointer_Payload, &Pointer_Unit_Group->Units_List_Indices[0]) != 0) return -1;
+		Pointer_Unit_Group->Units_List_Indices_Count = 1;
+
+		// Extract the second index in the units list
+		if ((Pointer_Unit_Group->Record_Type == 1) && (strcmp(Pointer_Unit_Group->String_Name, "transheli") != 0)) // The transheli issue is in the ga2 map
+		{
+			if (MapPayloadViewReadDoubleWord(Pointer_Payload, &Pointer_Unit_Group->Units_List_Indices[1]) != 0) return -1;
+			Pointer_Unit_Group->Units_List_Indices_Count = 2;
+		}
+	}
+
+	// Retrieve the amount of units in the group
+	return MapPayloadViewReadDoubleWord(Pointer_Payload, &Pointer_Unit_Group->Units_Count);
+}
+
 /** Handle type 0 records.
+ * @param Pointer_Context The extraction context.
  * @param Pointer_Payload The record payload.
- * @param Payload_Size The payload size in bytes.
- * @param Pointer_String_Output_Path On output, generated files will be stored to this location.
  * @return -1 if an error occurred,
  * @return 0 on success.
  */
-static int MapRecordHandlerIdentifier0(unsigned char *Pointer_Payload, int Payload_Size, char *Pointer_String_Output_Path)
+static int MapRecordHandlerIdentifier0(TMapContext *Pointer_Context, TMapPayloadView *Pointer_Payload)
 {
-	printf("Found a tile clone record. It is currently not supported.\n");
+	LogPrint(LOG_LEVEL_DEBUG, "Found a tile clone record. It is currently not supported.\n");
 
 	return 0;
 }
 
 /** Handle type 1 records.
+ * @param Pointer_Context The extraction context.
  * @param Pointer_Payload The record payload.
- * @param Payload_Size The payload size in bytes.
- * @param Pointer_String_Output_Path On output, generated files will be stored to this location.
  * @return -1 if an error occurred,
  * @return 0 on success.
  */
-static int MapRecordHandlerIdentifier1(unsigned char *Pointer_Payload, int Payload_Size, char *Pointer_String_Output_Path)
+static int MapRecordHandlerIdentifier1(TMapContext *Pointer_Context, TMapPayloadView *Pointer_Payload)
 {
-	int *Pointer_Double_Word = (int *) Pointer_Payload, Width, Height;
+	int Width, Height;
 
-	printf("Found a matrix tile field (i.e. map size and texture coordinates) record. It is currently not supported.\n");
+	LogPrint(LOG_LEVEL_DEBUG, "Found a matrix tile field (i.e. map size and texture coordinates) record. It is currently not supported.\n");
 
 	// Retrieve terrain width and height in tile unit
-	Width = *Pointer_Double_Word;
-	Pointer_Double_Word++;
-	Height = *Pointer_Double_Word;
+	if (MapPayloadViewReadDoubleWord(Pointer_Payload, (unsigned int *) &Width) != 0) return -1;
+	if (MapPayloadViewReadDoubleWord(Pointer_Payload, (unsigned int *) &Height) != 0) return -1;
 
 	// Make sure the values are coherent
 	// Is the width in the allowed limits ?
 	if (Width < 0)
 	{
-		printf("Error : map width %d is invalid.\n", Width);
+		LogPrint(LOG_LEVEL_ERROR, "Error : map width %d is invalid.\n", Width);
 		return -1;
 	}
 	if (Width >= MAP_TERRAIN_GEOMETRY_MAXIMUM_TILES_PER_SIDE)
 	{
-		printf("Error : map width %d is too large.\n", Width);
+		LogPrint(LOG_LEVEL_ERROR, "Error : map width %d is too large.\n", Width);
 		return -1;
 	}
 	// Is the height in the allowed limits ?
 	if (Height < 0)
 	{
-		printf("Error : map height %d is invalid.\n", Height);
+		LogPrint(LOG_LEVEL_ERROR, "Error : map height %d is invalid.\n", Height);
 		return -1;
 	}
 	if (Height >= MAP_TERRAIN_GEOMETRY_MAXIMUM_TILES_PER_SIDE)
 	{
-		printf("Error : map height %d is too large.\n", Height);
+		LogPrint(LOG_LEVEL_ERROR, "Error : map height %d is too large.\n", Height);
 		return -1;
 	}
 
 	// Only square maps are supported
 	if (Width != Height)
 	{
-		printf("Error : map width (%d) and height (%d) are different, but only square maps are supported.\n", Width, Height);
+		LogPrint(LOG_LEVEL_ERROR, "Error : map width (%d) and height (%d) are different, but only square maps are supported.\n", Width, Height);
 		return -1;
 	}
 
-	// Make terrain size globally available
-	Map_Tiles_Per_Side = Width; // Width and height are equal, so use any of them
-	Map_Vertices_Per_Side = Map_Tiles_Per_Side * MAP_TERRAIN_GEOMETRY_VERTICES_PER_TILE_SIDE;
-	printf("Extracted map size : %dx%d tiles.\n", Map_Tiles_Per_Side, Map_Tiles_Per_Side);
+	// Make terrain size available to the other records
+	Pointer_Context->Tiles_Per_Side = Width; // Width and height are equal, so use any of them
+	Pointer_Context->Vertices_Per_Side = Pointer_Context->Tiles_Per_Side * MAP_TERRAIN_GEOMETRY_VERTICES_PER_TILE_SIDE;
+
+	// Allocate the heightmap for this map size
+	free(Pointer_Context->Pointer_Terrain_Heights);
+	Pointer_Context->Pointer_Terrain_Heights = calloc((size_t) Pointer_Context->Vertices_Per_Side * Pointer_Context->Vertices_Per_Side + 1, sizeof(float)); // Always allocate something, even for an empty map
+	if (Pointer_Context->Pointer_Terrain_Heights == NULL)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to allocate the terrain heightmap (%s).\n", strerror(errno));
+		return -1;
+	}
+	LogPrint(Pointer_Context->Progress_Log_Level, "Extracted map size : %dx%d tiles.\n", Pointer_Context->Tiles_Per_Side, Pointer_Context->Tiles_Per_Side);
 
 	// TODO extract texture coordinates
 
 	return 0;
 }
 
+/** Decode consecutive vertices heights one by one, this works on all processors.
+ * @param Pointer_Vertices The first vertex.
+ * @param Vertices_Count How many vertices to decode. Only the 2 height bytes of the last vertex are read.
+ * @param Pointer_Heights On output, contain the decoded heights.
+ */
+static void MapDecodeTerrainHeightsScalar(const unsigned char *Pointer_Vertices, int Vertices_Count, float *Pointer_Heights)
+{
+	int i;
+	short Height;
+
+	for (i = 0; i < Vertices_Count; i++)
+	{
+		memcpy(&Height, Pointer_Vertices, sizeof(Height));
+		Pointer_Heights[i] = Height / MAP_TERRAIN_GEOMETRY_HEIGHT_SCALE;
+		Pointer_Vertices += MAP_TERRAIN_GEOMETRY_VERTEX_SIZE;
+	}
+}
+
+/** Decode consecutive vertices heights with the processor vector instructions. The heights are divided (not multiplied by the inverse scale), so the result is exactly the same as MapDecodeTerrainHeightsScalar() one.
+ * @param Pointer_Vertices The first vertex.
+ * @param Vertices_Count How many vertices to decode. All bytes of all vertices are read.
+ * @param Pointer_Heights On output, contain the decoded heights.
+ */
+static void MapDecodeTerrainHeights(const unsigned char *Pointer_Vertices, int Vertices_Count, float *Pointer_Heights)
+{
+	int i = 0;
+
+#if defined(MAP_IS_AVX2_ENABLED)
+	__m256i Vertices_1, Vertices_2, Heights, Gather_Indices = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+	__m256 Scale = _mm256_set1_ps(MAP_TERRAIN_GEOMETRY_HEIGHT_SCALE);
+
+	// Decode 8 vertices at a time, a 32-byte register holds 4 vertices and a height is the low word of every other double word
+	for (; i + 8 <= Vertices_Count; i += 8)
+	{
+		Vertices_1 = _mm256_loadu_si256((const __m256i *) Pointer_Vertices);
+		Vertices_2 = _mm256_loadu_si256((const __m256i *) (Pointer_Vertices + 4 * MAP_TERRAIN_GEOMETRY_VERTEX_SIZE));
+		// Move the double words holding the heights to the low lane of each register, then join both low lanes
+		Vertices_1 = _mm256_permutevar8x32_epi32(Vertices_1, Gather_Indices);
+		Vertices_2 = _mm256_permutevar8x32_epi32(Vertices_2, Gather_Indices);
+		Heights = _mm256_permute2x128_si256(Vertices_1, Vertices_2, 0x20);
+		// Sign-extend the heights words to double words
+		Heights = _mm256_srai_epi32(_mm256_slli_epi32(Heights, 16), 16);
+		_mm256_storeu_ps(Pointer_Heights + i, _mm256_div_ps(_mm256_cvtepi32_ps(Heights), Scale));
+		Pointer_Vertices += 8 * MAP_TERRAIN_GEOMETRY_VERTEX_SIZE;
+	}
+#elif defined(MAP_IS_SSE2_ENABLED)
+	__m128i Vertices_1, Vertices_2, Heights;
+	__m128 Scale = _mm_set1_ps(MAP_TERRAIN_GEOMETRY_HEIGHT_SCALE);
+
+	// Decode 4 vertices at a time, a 16-byte register holds 2 vertices and a height is the low word of every other double word
+	for (; i + 4 <= Vertices_Count; i += 4)
+	{
+		Vertices_1 = _mm_loadu_si128((const __m128i *) Pointer_Vertices);
+		Vertices_2 = _mm_loadu_si128((const __m128i *) (Pointer_Vertices + 2 * MAP_TERRAIN_GEOMETRY_VERTEX_SIZE));
+		// Move the double words holding the heights to the low half of each register, then join both low halves
+		Vertices_1 = _mm_shuffle_epi32(Vertices_1, _MM_SHUFFLE(3, 1, 2, 0));
+		Vertices_2 = _mm_shuffle_epi32(Vertices_2, _MM_SHUFFLE(3, 1, 2, 0));
+		Heights = _mm_unpacklo_epi64(Vertices_1, Vertices_2);
+		// Sign-extend the heights words to double words
+		Heights = _mm_srai_epi32(_mm_slli_epi32(Heights, 16), 16);
+		_mm_storeu_ps(Pointer_Heights + i, _mm_div_ps(_mm_cvtepi32_ps(Heights), Scale));
+		Pointer_Vertices += 4 * MAP_TERRAIN_GEOMETRY_VERTEX_SIZE;
+	}
+#endif
+
+	// Decode the remaining vertices
+	MapDecodeTerrainHeightsScalar(Pointer_Vertices, Vertices_Count - i, Pointer_Heights + i);
+}
+
 /** Handle type 2 records.
+ * @param Pointer_Context The extraction context.
  * @param Pointer_Payload The record payload.
- * @param Payload_Size The payload size in bytes.
- * @param Pointer_String_Output_Path On output, generated files will be stored to this location.
  * @return -1 if an error occurred,
  * @return 0 on success.
  */
-static int MapRecordHandlerIdentifier2(unsigned char *Pointer_Payload, int Payload_Size, char *Pointer_String_Output_Path)
+static int MapRecordHandlerIdentifier2(TMapContext *Pointer_Context, TMapPayloadView *Pointer_Payload)
 {
-	int Tile_Starting_Offset, Vertex_X, Vertex_Y;
-	short *Pointer_Word;
+	int Tile_Starting_Offset, Vertex_Y, Readable_Size, Row_Offset = 0, Row_Size = MAP_TERRAIN_GEOMETRY_VERTICES_PER_TILE_SIDE * MAP_TERRAIN_GEOMETRY_VERTEX_SIZE;
+	const unsigned char *Pointer_Vertices;
+	float *Pointer_Heights;
 
-	printf("Found a tile def pool (i.e. terrain geometry) record.\n");
+	LogPrint(LOG_LEVEL_DEBUG, "Found a tile def pool (i.e. terrain geometry) record.\n");
 
-	// Make sure needed global variables are available
-	if ((Map_Tiles_Per_Side == -1) || (Map_Vertices_Per_Side == -1))
+	// Make sure the map size is known
+	if ((Pointer_Context->Tiles_Per_Side == -1) || (Pointer_Context->Vertices_Per_Side == -1))
 	{
-		printf("Error : map coordinates have not been found. The map file is malformed and is missing a record of type 1 at the file beginning.\n");
+		LogPrint(LOG_LEVEL_ERROR, "Error : map coordinates have not been found. The map file is malformed and is missing a record of type 1 at the file beginning.\n");
 		return -1;
 	}
 
 	// Bypass the first 4 bytes (their value is currently unknown)
-	Pointer_Payload += 4;
-	Pointer_Word = (short *) Pointer_Payload;
-
-	// Process all vertices
-	for (Tile_Starting_Offset = 0; Tile_Starting_Offset < Map_Vertices_Per_Side; Tile_Starting_Offset += MAP_TERRAIN_GEOMETRY_VERTICES_PER_TILE_SIDE)
+	if (MapPayloadViewTake(Pointer_Payload, 4) == NULL) return -1;
+	// Each vertex uses 8 bytes, the height is stored in the first 2 ones
+	Readable_Size = Pointer_Payload->Size - Pointer_Payload->Offset;
+	Pointer_Vertices = MapPayloadViewTake(Pointer_Payload, Pointer_Context->Vertices_Per_Side > 0 ? (Pointer_Context->Vertices_Per_Side * Pointer_Context->Vertices_Per_Side - 1) * MAP_TERRAIN_GEOMETRY_VERTEX_SIZE + 2 : 0);
+	if (Pointer_Vertices == NULL) return -1;
+
+	// The vertices are stored by columns of tiles, each tile row is made of consecutive vertices that are stored consecutively in the heightmap too
+	for (Tile_Starting_Offset = 0; Tile_Starting_Offset < Pointer_Context->Vertices_Per_Side; Tile_Starting_Offset += MAP_TERRAIN_GEOMETRY_VERTICES_PER_TILE_SIDE)
 	{
-		for (Vertex_Y = 0; Vertex_Y < Map_Vertices_Per_Side; Vertex_Y++)
+		for (Vertex_Y = 0; Vertex_Y < Pointer_Context->Vertices_Per_Side; Vertex_Y++)
 		{
-			for (Vertex_X = 0; Vertex_X < MAP_TERRAIN_GEOMETRY_VERTICES_PER_TILE_SIDE; Vertex_X++)
-			{
-				Map_Terrain_Heights[Vertex_Y][Tile_Starting_Offset + Vertex_X] = *Pointer_Word / 300.f;
-				Pointer_Word += 4;
-			}
+			Pointer_Heights = &Pointer_Context->Pointer_Terrain_Heights[Vertex_Y * Pointer_Context->Vertices_Per_Side + Tile_Starting_Offset];
+			// The vector decoder reads whole vertices, which the record may not contain for the last one
+			if (Row_Offset + Row_Size <= Readable_Size) MapDecodeTerrainHeights(Pointer_Vertices + Row_Offset, MAP_TERRAIN_GEOMETRY_VERTICES_PER_TILE_SIDE, Pointer_Heights);
+			else MapDecodeTerrainHeightsScalar(Pointer_Vertices + Row_Offset, MAP_TERRAIN_GEOMETRY_VERTICES_PER_TILE_SIDE, Pointer_Heights);
+			Row_Offset += Row_Size;
 		}
 	}
-	printf("Terrain geometry has been extracted.\n");
+	LogPrint(Pointer_Context->Progress_Log_Level, "Terrain geometry has been extracted.\n");
 	
 	return 0;
 }
 
 /** Handle type 3 records.
+ * @param Pointer_Context The extraction context.
  * @param Pointer_Payload The record payload.
- * @param Payload_Size The payload size in bytes.
- * @param Pointer_String_Output_Path On output, generated files will be stored to this location.
  * @return -1 if an error occurred,
  * @return 0 on success.
  */
-static int MapRecordHandlerIdentifier3(unsigned char *Pointer_Payload, int Payload_Size, char *Pointer_String_Output_Path)
+static int MapRecordHandlerIdentifier3(TMapContext *Pointer_Context, TMapPayloadView *Pointer_Payload)
 {
-	printf("Found a type 3 record. It is currently not supported.\n");
+	LogPrint(LOG_LEVEL_DEBUG, "Found a type 3 record. It is currently not supported.\n");
 
 	return 0;
 }
 
 /** Handle type 4 records.
+ * @param Pointer_Context The extraction context.
  * @param Pointer_Payload The record payload.
- * @param Payload_Size The payload size in bytes.
- * @param Pointer_String_Output_Path On output, generated files will be stored to this location.
  * @return -1 if an error occurred,
  * @return 0 on success.
  */
-static int MapRecordHandlerIdentifier4(unsigned char *Pointer_Payload, int Payload_Size, char *Pointer_String_Output_Path)
+static int MapRecordHandlerIdentifier4(TMapContext *Pointer_Context, TMapPayloadView *Pointer_Payload)
 {
-	printf("Found a texture 2 record. It is currently not supported.\n");
+	LogPrint(LOG_LEVEL_DEBUG, "Found a texture 2 record. It is currently not supported.\n");
 
 	return 0;
 }
 
 /** Handle type 5 records.
+ * @param Pointer_Context The extraction context.
  * @param Pointer_Payload The record payload.
- * @param Payload_Size The payload size in bytes.
- * @param Pointer_String_Output_Path On output, generated files will be stored to this location.
  * @return -1 if an error occurred,
  * @return 0 on success.
  */
-static int MapRecordHandlerIdentifier5(unsigned char *Pointer_Payload, int Payload_Size, char *Pointer_String_Output_Path)
+static int MapRecordHandlerIdentifier5(TMapContext *Pointer_Context, TMapPayloadView *Pointer_Payload)
 {
-	printf("Found a sky record. It is currently not supported.\n");
+	LogPrint(LOG_LEVEL_DEBUG, "Found a sky record. It is currently not supported.\n");
 
 	return 0;
 }
 
 /** Handle type 6 records.
+ * @param Pointer_Context The extraction context.
  * @param Pointer_Payload The record payload.
- * @param Payload_Size The payload size in bytes.
- * @param Pointer_String_Output_Path On output, generated files will be stored to this location.
  * @return -1 if an error occurred,
  * @return 0 on success.
  */
-static int MapRecordHandlerIdentifier6(unsigned char *Pointer_Payload, int Payload_Size, char *Pointer_String_Output_Path)
+static int MapRecordHandlerIdentifier6(TMapContext *Pointer_Context, TMapPayloadView *Pointer_Payload)
 {
-	printf("Found a type 6 record. It is currently not supported.\n");
+	LogPrint(LOG_LEVEL_DEBUG, "Found a type 6 record. It is currently not supported.\n");
 
 	return 0;
 }
 
-/** Handle type 7 records.
- * @param Pointer_Payload The record payload.
- * @param Payload_Size The payload size in bytes.
- * @param Pointer_String_Output_Path On output, generated files will be stored to this location.
+/** Make sure the units arrays can store more units.
+ * @param Pointer_Context The extraction context.
+ * @param Units_Count How many units will be added.
  * @return -1 if an error occurred,
  * @return 0 on success.
  */
-static int MapRecordHandlerIdentifier7(unsigned char *Pointer_Payload, int Payload_Size, char *Pointer_String_Output_Path)
+static int MapReserveUnits(TMapContext *Pointer_Context, int Units_Count)
 {
-	FILE *Pointer_File;
-	int Return_Value = -1;
-	unsigned int *Pointer_Double_Word, Units_Count, i, Record_Type;
-	char *Pointer_String_Group_Name;
-
-	printf("Found a units record. It is currently partially supported.\n");
+	TMapUnits *Pointer_Units = &Pointer_Context->Units;
+	int Allocated_Units_Count;
+	void *Pointer_New_Array;
+
+	if (Pointer_Units->Units_Count + Units_Count <= Pointer_Context->Allocated_Units_Count) return 0;
+
+	Allocated_Units_Count = Pointer_Context->Allocated_Units_Count == 0 ? 256 : Pointer_Context->Allocated_Units_Count * 2;
+	if (Allocated_Units_Count < Pointer_Units->Units_Count + Units_Count) Allocated_Units_Count = Pointer_Units->Units_Count + Units_Count;
+
+	// Each array is stored as soon as it is enlarged, so it is always freed even if the next allocation fails
+	if ((Pointer_New_Array = realloc(Pointer_Units->Pointer_Coordinates_X, Allocated_Units_Count * sizeof(unsigned int))) == NULL) goto Exit_Error;
+	Pointer_Units->Pointer_Coordinates_X = Pointer_New_Array;
+	if ((Pointer_New_Array = realloc(Pointer_Units->Pointer_Coordinates_Y, Allocated_Units_Count * sizeof(unsigned int))) == NULL) goto Exit_Error;
+	Pointer_Units->Pointer_Coordinates_Y = Pointer_New_Array;
+	if ((Pointer_New_Array = realloc(Pointer_Units->Pointer_Coordinates_Z, Allocated_Units_Count * sizeof(unsigned int))) == NULL) goto Exit_Error;
+	Pointer_Units->Pointer_Coordinates_Z = Pointer_New_Array;
+	if ((Pointer_New_Array = realloc(Pointer_Units->Pointer_Group_Indices, Allocated_Units_Count * sizeof(int))) == NULL) goto Exit_Error;
+	Pointer_Units->Pointer_Group_Indices = Pointer_New_Array;
+	if ((Pointer_New_Array = realloc(Pointer_Units->Pointer_Strings_Types, Allocated_Units_Count * sizeof(Pointer_Units->Pointer_Strings_Types[0]))) == NULL) goto Exit_Error;
+	Pointer_Units->Pointer_Strings_Types = Pointer_New_Array;
+
+	Pointer_Context->Allocated_Units_Count = Allocated_Units_Count;
+	return 0;
 
-	// Append the data to the dedicated file
-	Pointer_File = MapOpenFileWithPrefixPath(Pointer_String_Output_Path, MAP_FILE_NAME_UNITS, "a");
-	if (Pointer_File == NULL)
-	{
-		printf("Error : failed to open the units file (%s).", strerror(errno));
-		return -1;
-	}
+Exit_Error:
+	LogPrint(LOG_LEVEL_ERROR, "Error : failed to allocate the units list (%s).\n", strerror(errno));
+	return -1;
+}
 
-	// The section name is the unit group name
-	Pointer_String_Group_Name = Pointer_Payload;
-	printf("Unit group name : \"%s\".\n", Pointer_String_Group_Name);
-	fprintf(Pointer_File, "; The section name matches with a single name in the units section of the map script file\n[%s]\n", Pointer_String_Group_Name);
-	Pointer_Payload += 32; // There seems to be a 32-byte fixed width for this string
+/** Handle type 7 records.
+ * @param Pointer_Context The extraction context.
+ * @param Pointer_Payload The record payload.
+ * @return -1 if an error occurred,
+ * @return 0 on success.
+ */
+static int MapRecordHandlerIdentifier7(TMapContext *Pointer_Context, TMapPayloadView *Pointer_Payload)
+{
+	TMapUnits *Pointer_Units = &Pointer_Context->Units;
+	TMapUnitGroupInformation *Pointer_Unit_Group;
+	unsigned int i, Reserved_Units_Count;
+	int Unit_Index;
+	void *Pointer_New_Array;
 
-	// The name is followed by what has been called "record type"
-	Pointer_Double_Word = (unsigned int *) Pointer_Payload;
-	Record_Type = *Pointer_Double_Word;
-	Pointer_Payload += 8; // Also bypass the following 0x00000007, it does not seem to be used (setting it to 0 seems to have no effect)
-	// Only some record types 0, 1 and 2 are supported for now
-	if (Record_Type > 2)
-	{
-		printf("Error : unknown record type %u following the unit name in the map file, aborting.\n", Record_Type);
-		goto Exit;
-	}
-	fprintf(Pointer_File, "RecordType=%u\n", Record_Type);
+	LogPrint(LOG_LEVEL_DEBUG, "Found a units record. It is currently partially supported.\n");
 
-	// Extract additional information according to the record type
-	if (((Record_Type == 1) || (Record_Type == 2)) && (strcmp(Pointer_String_Group_Name, "trains") != 0)) // The trais issue is in the ema11 map
+	// Keep the group in memory, the units file is written when all records have been parsed
+	if (Pointer_Units->Unit_Groups_Count == Pointer_Context->Allocated_Unit_Groups_Count)
 	{
-		// The formats are :
-		//     0x00000001 0x00000007 0x<index in units list> 0x<index in units list 2>
-		//     0x00000002 0x00000007 0x<index in units list>
-		// The value 0x00000007 does not seem to be used, setting it to 0 seems to have no effect
-		// The indices in the units list seem to be multiplied by 4
-		Pointer_Double_Word = (unsigned int *) Pointer_Payload;
-		fprintf(Pointer_File, "UnitsListIndex=%u\n", *Pointer_Double_Word);
-		Pointer_Payload += 4;
-
-		// Extract the second index in the units list
-		if ((Record_Type == 1) && (strcmp(Pointer_String_Group_Name, "transheli") != 0)) // The transheli issue is in the ga2 map
+		Pointer_Context->Allocated_Unit_Groups_Count = Pointer_Context->Allocated_Unit_Groups_Count == 0 ? 32 : Pointer_Context->Allocated_Unit_Groups_Count * 2;
+		Pointer_New_Array = realloc(Pointer_Units->Pointer_Unit_Groups, Pointer_Context->Allocated_Unit_Groups_Count * sizeof(TMapUnitGroupInformation));
+		if (Pointer_New_Array == NULL)
 		{
-			Pointer_Double_Word = (unsigned int *) Pointer_Payload;
-			fprintf(Pointer_File, "UnitsListIndex2=%u\n", *Pointer_Double_Word);
-			Pointer_Payload += 4;
+			LogPrint(LOG_LEVEL_ERROR, "Error : failed to allocate the unit groups list (%s).\n", strerror(errno));
+			return -1;
 		}
+		Pointer_Units->Pointer_Unit_Groups = Pointer_New_Array;
 	}
+	Pointer_Unit_Group = &Pointer_Units->Pointer_Unit_Groups[Pointer_Units->Unit_Groups_Count];
 
-	// Retrieve the amount of units in the group
-	Pointer_Double_Word = (unsigned int *) Pointer_Payload;
-	Units_Count = *Pointer_Double_Word;
-	Pointer_Payload += 4;
-	fprintf(Pointer_File, "UnitsCount=%u\n", Units_Count);
+	// The section name is the unit group name
+	if (MapReadUnitGroupHeader(Pointer_Payload, Pointer_Unit_Group) != 0) return -1;
+	Pointer_Units->Unit_Groups_Count++;
+	LogPrint(LOG_LEVEL_DEBUG, "Unit group name : \"%s\".\n", Pointer_Unit_Group->String_Name);
+
+	// A malformed units count can't make a huge allocation, because the units must fit in the payload
+	Reserved_Units_Count = (unsigned int) (Pointer_Payload->Size - Pointer_Payload->Offset) / MAP_UNIT_SIZE;
+	if (Pointer_Unit_Group->Units_Count < Reserved_Units_Count) Reserved_Units_Count = Pointer_Unit_Group->Units_Count;
+	if (MapReserveUnits(Pointer_Context, (int) Reserved_Units_Count) != 0) return -1;
 
 	// Extract each single unit from the group
-	for (i = 0; i < Units_Count; i++)
+	for (i = 0; i < Pointer_Unit_Group->Units_Count; i++)
 	{
+		Unit_Index = Pointer_Units->Units_Count;
+
 		// Extract the unit type
-		fprintf(Pointer_File, "; This type is declared in the app/units file\nUnit%uType=\"%s\"\n", i, Pointer_Payload);
-		Pointer_Payload += 24; // There seems to be a 24-byte fixed width for this string
+		if (MapPayloadViewReadString(Pointer_Payload, MAP_UNIT_TYPE_MAXIMUM_LENGTH, Pointer_Units->Pointer_Strings_Types[Unit_Index]) != 0) return -1; // There seems to be a 24-byte fixed width for this string
 
 		// Bypass unknown fields (flags ?)
-		Pointer_Payload += 12;
-
-		// Extract the unit coordinates in the world
-		// X
-		Pointer_Double_Word = (unsigned int*) Pointer_Payload;
-		fprintf(Pointer_File, "Unit%uCoordinateX=%u\n", i, *Pointer_Double_Word);
-		Pointer_Payload += 8;
-		// Y
-		Pointer_Double_Word = (unsigned int*) Pointer_Payload;
-		fprintf(Pointer_File, "Unit%uCoordinateY=%u\n", i, *Pointer_Double_Word);
-		Pointer_Payload += 8;
-		// Z
-		Pointer_Double_Word = (unsigned int*) Pointer_Payload;
-		fprintf(Pointer_File, "Unit%uCoordinateZ=%u\n", i, *Pointer_Double_Word);
-		Pointer_Payload += 8;
+		if (MapPayloadViewTake(Pointer_Payload, 12) == NULL) return -1;
+
+		// Extract the unit coordinates in the world, each one is followed by 4 unknown bytes
+		if (MapPayloadViewReadDoubleWord(Pointer_Payload, &Pointer_Units->Pointer_Coordinates_X[Unit_Index]) != 0) return -1;
+		if (MapPayloadViewTake(Pointer_Payload, 4) == NULL) return -1;
+		if (MapPayloadViewReadDoubleWord(Pointer_Payload, &Pointer_Units->Pointer_Coordinates_Y[Unit_Index]) != 0) return -1;
+		if (MapPayloadViewTake(Pointer_Payload, 4) == NULL) return -1;
+		if (MapPayloadViewReadDoubleWord(Pointer_Payload, &Pointer_Units->Pointer_Coordinates_Z[Unit_Index]) != 0) return -1;
+		if (MapPayloadViewTake(Pointer_Payload, 4) == NULL) return -1;
+		Pointer_Units->Pointer_Group_Indices[Unit_Index] = Pointer_Units->Unit_Groups_Count - 1;
+		Pointer_Units->Units_Count++;
 	}
 
 	// TODO
 
-	// Everything went well
-	Return_Value = 0;
-
-Exit:
-	// Separate each section by an empty line
-	fprintf(Pointer_File, "\n");
-	fclose(Pointer_File);
-
-	return Return_Value;
+	return 0;
 }
 
 /** Handle type 8 records.
+ * @param Pointer_Context The extraction context.
  * @param Pointer_Payload The record payload.
- * @param Payload_Size The payload size in bytes.
- * @param Pointer_String_Output_Path On output, generated files will be stored to this location.
  * @return -1 if an error occurred,
  * @return 0 on success.
  */
-static int MapRecordHandlerIdentifier8(unsigned char *Pointer_Payload, int Payload_Size, char *Pointer_String_Output_Path)
+static int MapRecordHandlerIdentifier8(TMapContext *Pointer_Context, TMapPayloadView *Pointer_Payload)
 {
-	printf("Found a units list record. It is currently not supported.\n");
+	LogPrint(LOG_LEVEL_DEBUG, "Found a units list record. It is currently not supported.\n");
 
 	return 0;
 }
 
 /** Handle type 9 records.
+ * @param Pointer_Context The extraction context.
  * @param Pointer_Payload The record payload.
- * @param Payload_Size The payload size in bytes.
- * @param Pointer_String_Output_Path On output, generated files will be stored to this location.
  * @return -1 if an error occurred,
  * @return 0 on success.
  */
-static int MapRecordHandlerIdentifier9(unsigned char *Pointer_Payload, int Payload_Size, char *Pointer_String_Output_Path)
+static int MapRecordHandlerIdentifier9(TMapContext *Pointer_Context, TMapPayloadView *Pointer_Payload)
 {
-	printf("Found a type 9 record. It is currently not supported.\n");
+	LogPrint(LOG_LEVEL_DEBUG, "Found a type 9 record. It is currently not supported.\n");
 
 	return 0;
 }
 
 /** Handle type 10 records.
+ * @param Pointer_Context The extraction context.
  * @param Pointer_Payload The record payload.
- * @param Payload_Size The payload size in bytes.
- * @param Pointer_String_Output_Path On output, generated files will be stored to this location.
  * @return -1 if an error occurred,
  * @return 0 on success.
  */
-static int MapRecordHandlerIdentifier10(unsigned char *Pointer_Payload, int Payload_Size, char *Pointer_String_Output_Path)
+static int MapRecordHandlerIdentifier10(TMapContext *Pointer_Context, TMapPayloadView *Pointer_Payload)
 {
-	printf("Found a type 10 record. It is currently not supported.\n");
+	LogPrint(LOG_LEVEL_DEBUG, "Found a type 10 record. It is currently not supported.\n");
 
 	return 0;
 }
 
 /** Handle type 11 records.
+ * @param Pointer_Context The extraction context.
  * @param Pointer_Payload The record payload.
- * @param Payload_Size The payload size in bytes.
- * @param Pointer_String_Output_Path On output, generated files will be stored to this location.
  * @return -1 if an error occurred,
  * @return 0 on success.
  */
-static int MapRecordHandlerIdentifier11(unsigned char *Pointer_Payload, int Payload_Size, char *Pointer_String_Output_Path)
+static int MapRecordHandlerIdentifier11(TMapContext *Pointer_Context, TMapPayloadView *Pointer_Payload)
 {
-	printf("Found a type 11 record. It is currently not supported.\n");
+	LogPrint(LOG_LEVEL_DEBUG, "Found a type 11 record. It is currently not supported.\n");
 
 	return 0;
 }
 
 /** Handle type 12 records.
+ * @param Pointer_Context The extraction context.
  * @param Pointer_Payload The record payload.
- * @param Payload_Size The payload size in bytes.
- * @param Pointer_String_Output_Path On output, generated files will be stored to this location.
  * @return -1 if an error occurred,
  * @return 0 on success.
  */
-static int MapRecordHandlerIdentifier12(unsigned char *Pointer_Payload, int Payload_Size, char *Pointer_String_Output_Path)
+static int MapRecordHandlerIdentifier12(TMapContext *Pointer_Context, TMapPayloadView *Pointer_Payload)
 {
-	printf("Found a saved AU record. It is currently not supported.\n");
+	LogPrint(LOG_LEVEL_DEBUG, "Found a saved AU record. It is currently not supported.\n");
 
 	return 0;
 }
 
 /** Handle type 13 records.
+ * @param Pointer_Context The extraction context.
  * @param Pointer_Payload The record payload.
- * @param Payload_Size The payload size in bytes.
- * @param Pointer_String_Output_Path On output, generated files will be stored to this location.
  * @return -1 if an error occurred,
  * @return 0 on success.
  */
-static int MapRecordHandlerIdentifier13(unsigned char *Pointer_Payload, int Payload_Size, char *Pointer_String_Output_Path)
+static int MapRecordHandlerIdentifier13(TMapContext *Pointer_Context, TMapPayloadView *Pointer_Payload)
 {
-	printf("Found a saved shared pool record. It is currently not supported.\n");
+	LogPrint(LOG_LEVEL_DEBUG, "Found a saved shared pool record. It is currently not supported.\n");
 
 	return 0;
 }
 
 /** Handle type 14 records.
+ * @param Pointer_Context The extraction context.
  * @param Pointer_Payload The record payload.
- * @param Payload_Size The payload size in bytes.
- * @param Pointer_String_Output_Path On output, generated files will be stored to this location.
  * @return -1 if an error occurred,
  * @return 0 on success.
  */
-static int MapRecordHandlerIdentifier14(unsigned char *Pointer_Payload, int Payload_Size, char *Pointer_String_Output_Path)
+static int MapRecordHandlerIdentifier14(TMapContext *Pointer_Context, TMapPayloadView *Pointer_Payload)
 {
-	printf("Found a saved dead body record. It is currently not supported.\n");
+	LogPrint(LOG_LEVEL_DEBUG, "Found a saved dead body record. It is currently not supported.\n");
 
 	return 0;
 }
 
 /** Handle type 15 records.
+ * @param Pointer_Context The extraction context.
  * @param Pointer_Payload The record payload.
- * @param Payload_Size The payload size in bytes.
- * @param Pointer_String_Output_Path On output, generated files will be stored to this location.
  * @return -1 if an error occurred,
  * @return 0 on success.
  */
-static int MapRecordHandlerIdentifier15(unsigned char *Pointer_Payload, int Payload_Size, char *Pointer_String_Output_Path)
+static int MapRecordHandlerIdentifier15(TMapContext *Pointer_Context, TMapPayloadView *Pointer_Payload)
 {
-	printf("Found a type 15 record. It is currently not supported.\n");
+	LogPrint(LOG_LEVEL_DEBUG, "Found a type 15 record. It is currently not supported.\n");
 
 	return 0;
 }
 
 /** Handle type 16 records.
+ * @param Pointer_Context The extraction context.
  * @param Pointer_Payload The record payload.
- * @param Payload_Size The payload size in bytes.
- * @param Pointer_String_Output_Path On output, generated files will be stored to this location.
  * @return -1 if an error occurred,
  * @return 0 on success.
  */
-static int MapRecordHandlerIdentifier16(unsigned char *Pointer_Payload, int Payload_Size, char *Pointer_String_Output_Path)
+static int MapRecordHandlerIdentifier16(TMapContext *Pointer_Context, TMapPayloadView *Pointer_Payload)
 {
-	printf("Found a saved clan record. It is currently not supported.\n");
+	LogPrint(LOG_LEVEL_DEBUG, "Found a saved clan record. It is currently not supported.\n");
 
 	return 0;
 }
 
 /** Handle type 17 records.
+ * @param Pointer_Context The extraction context.
  * @param Pointer_Payload The record payload.
- * @param Payload_Size The payload size in bytes.
- * @param Pointer_String_Output_Path On output, generated files will be stored to this location.
  * @return -1 if an error occurred,
  * @return 0 on success.
  */
-static int MapRecordHandlerIdentifier17(unsigned char *Pointer_Payload, int Payload_Size, char *Pointer_String_Output_Path)
+static int MapRecordHandlerIdentifier17(TMapContext *Pointer_Context, TMapPayloadView *Pointer_Payload)
 {
-	printf("Found a saved tile field record. It is currently not supported.\n");
+	LogPrint(LOG_LEVEL_DEBUG, "Found a saved tile field record. It is currently not supported.\n");
 
 	return 0;
 }
 
 /** Handle type 18 records.
+ * @param Pointer_Context The extraction context.
  * @param Pointer_Payload The record payload.
- * @param Payload_Size The payload size in bytes.
- * @param Pointer_String_Output_Path On output, generated files will be stored to this location.
  * @return -1 if an error occurred,
  * @return 0 on success.
  */
-static int MapRecordHandlerIdentifier18(unsigned char *Pointer_Payload, int Payload_Size, char *Pointer_String_Output_Path)
+static int MapRecordHandlerIdentifier18(TMapContext *Pointer_Context, TMapPayloadView *Pointer_Payload)
 {
-	printf("Found a saved HL clan record. It is currently not supported.\n");
+	LogPrint(LOG_LEVEL_DEBUG, "Found a saved HL clan record. It is currently not supported.\n");
 
 	return 0;
 }
 
-/** Use the data extracted from various records to create a Wavefront OBJ file containing the terrain geometry.
- * @param Pointer_String_Output_Path On output, generated files will be stored to this location.
- * @return -1 if an error occurred,
- * @return 0 on success.
+/** Write the terrain geometry as a Wavefront OBJ file made of quads.
+ * @param Pointer_Context The extraction context.
+ * @param Pointer_Area The terrain part to write.
+ * @param Pointer_Writer The output file.
  */
-static int MapGenerateTerrain(char *Pointer_String_Output_Path)
+static void MapWriteTerrainOBJ(TMapContext *Pointer_Context, TMapTerrainArea *Pointer_Area, TFileWriter *Pointer_Writer)
 {
-	FILE *Pointer_File;
-	char String_Output_File_Name[2048];
 	int Vertex_X, Vertex_Y, Face_Vertices_Offset, Tile_Row, Tiles_Count;
-	
-	// Make sure needed global variables are available
-	if ((Map_Tiles_Per_Side == -1) || (Map_Vertices_Per_Side == -1))
-	{
-		printf("Error : map coordinates have not been found. The map file is malformed and is missing a record of type 1 at the file beginning.\n");
-		return -1;
-	}
-	
-	// Generate the output file name
-	snprintf(String_Output_File_Name, sizeof(String_Output_File_Name), "%s/Terrain_Geometry.obj", Pointer_String_Output_Path);
-	printf("Saving terrain geometry to \"%s\" file.\n", String_Output_File_Name);
-	
-	// Try to open output file
-	Pointer_File = fopen(String_Output_File_Name, "w");
-	if (Pointer_File == NULL)
-	{
-		printf("Error : could not open output file (%s).\n", strerror(errno));
-		return -1;
-	}
 
 	// Create OBJ file header
-	fprintf(Pointer_File, "o terrain_geometry\n\n");
+	FileWriterWriteString(Pointer_Writer, "o terrain_geometry\n\n");
 	
-	// Append vertices to file
-	printf("Adding vertices...\n");
-	for (Vertex_Y = 0; Vertex_Y < Map_Vertices_Per_Side; Vertex_Y++)
+	// Append vertices to file (same as "v %d %d %f\n"), the numbers are formatted by the writer because fprintf() is too slow for millions of vertices
+	LogPrint(LOG_LEVEL_DEBUG, "Adding vertices...\n");
+	for (Vertex_Y = Pointer_Area->First_Y; Vertex_Y < Pointer_Area->First_Y + Pointer_Area->Height; Vertex_Y++)
 	{
-		for (Vertex_X = 0; Vertex_X < Map_Vertices_Per_Side; Vertex_X++) fprintf(Pointer_File, "v %d %d %f\n", Vertex_X, Vertex_Y, Map_Terrain_Heights[Vertex_Y][Vertex_X]);
+		for (Vertex_X = Pointer_Area->First_X; Vertex_X < Pointer_Area->First_X + Pointer_Area->Width; Vertex_X++)
+		{
+			FileWriterWriteString(Pointer_Writer, "v ");
+			FileWriterWriteInteger(Pointer_Writer, Vertex_X);
+			FileWriterWriteCharacter(Pointer_Writer, ' ');
+			FileWriterWriteInteger(Pointer_Writer, Vertex_Y);
+			FileWriterWriteCharacter(Pointer_Writer, ' ');
+			FileWriterWriteFloat(Pointer_Writer, Pointer_Context->Pointer_Terrain_Heights[Vertex_Y * Pointer_Context->Vertices_Per_Side + Vertex_X]);
+			FileWriterWriteCharacter(Pointer_Writer, '\n');
+		}
 	}
 	
-	// Generate quad faces from the vertices
-	printf("Adding faces...\n");
-	Tiles_Count = Map_Vertices_Per_Side * (Map_Vertices_Per_Side - 1); // Do not take last row into account because it is the bottom part of the last quads
-	for (Tile_Row = 0; Tile_Row < Tiles_Count; Tile_Row += Map_Vertices_Per_Side)
+	// Generate quad faces from the vertices (same as "f %d %d %d %d\n")
+	LogPrint(LOG_LEVEL_DEBUG, "Adding faces...\n");
+	Tiles_Count = Pointer_Area->Width * (Pointer_Area->Height - 1); // Do not take last row into account because it is the bottom part of the last quads
+	for (Tile_Row = 0; Tile_Row < Tiles_Count; Tile_Row += Pointer_Area->Width)
 	{
-		for (Vertex_X = 1; Vertex_X < Map_Vertices_Per_Side; Vertex_X++)
+		for (Vertex_X = 1; Vertex_X < Pointer_Area->Width; Vertex_X++)
 		{
 			Face_Vertices_Offset = Vertex_X + Tile_Row;
-			fprintf(Pointer_File, "f %d %d %d %d\n", Face_Vertices_Offset, Face_Vertices_Offset + 1, Face_Vertices_Offset + Map_Vertices_Per_Side + 1, Face_Vertices_Offset + Map_Vertices_Per_Side);
+			FileWriterWriteString(Pointer_Writer, "f ");
+			FileWriterWriteInteger(Pointer_Writer, Face_Vertices_Offset);
+			FileWriterWriteCharacter(Pointer_Writer, ' ');
+			FileWriterWriteInteger(Pointer_Writer, Face_Vertices_Offset + 1);
+			FileWriterWriteCharacter(Pointer_Writer, ' ');
+			FileWriterWriteInteger(Pointer_Writer, Face_Vertices_Offset + Pointer_Area->Width + 1);
+			FileWriterWriteCharacter(Pointer_Writer, ' ');
+			FileWriterWriteInteger(Pointer_Writer, Face_Vertices_Offset + Pointer_Area->Width);
+			FileWriterWriteCharacter(Pointer_Writer, '\n');
 		}
 	}
-	
-	printf("Terrain was successfully generated.\n");
-	fclose(Pointer_File);
-	
-	return 0;
 }
 
-//-------------------------------------------------------------------------------------------------
-// Public functions
-//-------------------------------------------------------------------------------------------------
-int MapExtract(char *Pointer_String_Map_File_Name, char *Pointer_String_Output_Path)
+/** Compute how many indices are needed to describe the terrain faces.
+ * @param Pointer_Area The terrain part to describe.
+ * @param Is_Triangle_Strips_Enabled Set to 1 to count the triangle strip indices, set to 0 to count the triangles list indices.
+ * @return The indices count.
+ */
+static int MapComputeTerrainIndicesCount(TMapTerrainArea *Pointer_Area, int Is_Triangle_Strips_Enabled)
 {
-	static unsigned char Payload_Buffer[20 * 1024 * 1024]; // 20 MB is enough for all existing maps
-	FILE *Pointer_File_Map = NULL, *Pointer_File;
-	int Return_Value = -1, Temporary_Integer, Record_Identifier, Records_Count = 1, Record_Payload_Size, Record_Offset;
-	char String_Temporary[5];
-	MapRecordHandler Record_Handler_Functions[] =
-	{
-		MapRecordHandlerIdentifier0,
-		MapRecordHandlerIdentifier1,
-		MapRecordHandlerIdentifier2,
-		MapRecordHandlerIdentifier3,
-		MapRecordHandlerIdentifier4,
-		MapRecordHandlerIdentifier5,
-		MapRecordHandlerIdentifier6,
-		MapRecordHandlerIdentifier7,
-		MapRecordHandlerIdentifier8,
-		MapRecordHandlerIdentifier9,
-		MapRecordHandlerIdentifier10,
-		MapRecordHandlerIdentifier11,
-		MapRecordHandlerIdentifier12,
-		MapRecordHandlerIdentifier13,
-		MapRecordHandlerIdentifier14,
-		MapRecordHandlerIdentifier15,
-		MapRecordHandlerIdentifier16,
-		MapRecordHandlerIdentifier17,
-		MapRecordHandlerIdentifier18
-	};
-
-	// Try to open the map file
-	Pointer_File_Map = fopen(Pointer_String_Map_File_Name, "rb");
-	if (Pointer_File_Map == NULL)
-	{
-		printf("Error : failed to open map file \"%s\" (%s).\n", Pointer_String_Map_File_Name, strerror(errno));
-		return -1;
-	}
+	int Rows_Count = Pointer_Area->Height - 1;
 
-	// Check file signature
-	if (fread(String_Temporary, 1, 4, Pointer_File_Map) != 4)
-	{
-		printf("Error : failed to read map file signature (%s).\n", strerror(errno));
-		goto Exit;
-	}
-	if (strncmp(String_Temporary, "IDWD", 4) != 0)
-	{
-		printf("Error : invalid map file signature. File must start with \"IDWD\" header identifier.\n");
-		goto Exit;
-	}
+	// Each row of quads is a strip of 2 vertices per column, the rows are joined by 2 degenerate triangles
+	if (Is_Triangle_Strips_Enabled) return Rows_Count * 2 * Pointer_Area->Width + (Rows_Count - 1) * 2;
+	// Each quad is made of 2 triangles
+	return Rows_Count * (Pointer_Area->Width - 1) * 6;
+}
 
-	// Check file version
-	if (fread(&Temporary_Integer, 1, 4, Pointer_File_Map) != 4)
-	{
-		printf("Error : failed to read map file version (%s).\n", strerror(errno));
-		goto Exit;
-	}
-	if (Temporary_Integer != 0x66)
-	{
-		printf("Error : invalid map file version. Supported version is 0x66.\n");
-		goto Exit;
-	}
-	
-	// Take the two above tags into account
-	Record_Offset = 8;
+/** Write the binary terrain vertices, with the same coordinates as the OBJ file.
+ * @param Pointer_Context The extraction context.
+ * @param Pointer_Area The terrain part to write.
+ * @param Pointer_Writer The output file.
+ */
+static void MapWriteTerrainPositions(TMapContext *Pointer_Context, TMapTerrainArea *Pointer_Area, TFileWriter *Pointer_Writer)
+{
+	float *Row_Positions = (float *) Pointer_Context->Pointer_Row_Buffer;
+	int Column, Vertex_Y;
 
-	// Reset or remove some files from the output directory (if any), so a new map extraction data can't mix with an old one
-	// Remove the units file previous content
-	Pointer_File = MapOpenFileWithPrefixPath(Pointer_String_Output_Path, MAP_FILE_NAME_UNITS, "w");
-	if (Pointer_File != NULL) fclose(Pointer_File);
-	
-	// Parse all file records
-	while (1)
+	for (Vertex_Y = Pointer_Area->First_Y; Vertex_Y < Pointer_Area->First_Y + Pointer_Area->Height; Vertex_Y++)
 	{
-		// Read record identifer
-		if (fread(&Record_Identifier, 1, 4, Pointer_File_Map) != 4)
-		{
-			printf("Error : failed to read record %d identifier (%s).\n", Records_Count, strerror(errno));
-			break;
-		}
-
-		// Read record size
-		if (fread(&Record_Payload_Size, 1, 4, Pointer_File_Map) != 4)
+		for (Column = 0; Column < Pointer_Area->Width; Column++)
 		{
-			printf("Error : failed to read record %d size (%s).\n", Records_Count, strerror(errno));
-			break;
+			Row_Positions[Column * 3] = (float) (Pointer_Area->First_X + Column);
+			Row_Positions[Column * 3 + 1] = (float) Vertex_Y;
+			Row_Positions[Column * 3 + 2] = Pointer_Context->Pointer_Terrain_Heights[Vertex_Y * Pointer_Context->Vertices_Per_Side + Pointer_Area->First_X + Column];
 		}
-		// Adjust size to take only payload into account
-		Record_Payload_Size -= 8; // Record identifier and size tags are included into the record size field value
+		FileWriterWriteBuffer(Pointer_Writer, Row_Positions, sizeof(float) * 3 * Pointer_Area->Width);
+	}
+}
 
-		// Read record payload
-		if (fread(Payload_Buffer, 1, Record_Payload_Size, Pointer_File_Map) != (size_t) Record_Payload_Size)
-		{
-			printf("Error : failed to read record %d payload (%s).\n", Records_Count, strerror(errno));
-			break;
-		}
+/** Write the binary terrain faces as 32-bit vertex indices. The faces have the same orientation as the OBJ quads.
+ * @param Pointer_Context The extraction context.
+ * @param Pointer_Area The terrain part to write, the indices are relative to its first vertex.
+ * @param Pointer_Writer The output file.
+ * @param Is_Triangle_Strips_Enabled Set to 1 to write triangle strips, set to 0 to write a triangles list.
+ */
+static void MapWriteTerrainIndices(TMapContext *Pointer_Context, TMapTerrainArea *Pointer_Area, TFileWriter *Pointer_Writer, int Is_Triangle_Strips_Enabled)
+{
+	unsigned int *Row_Indices = (unsigned int *) Pointer_Context->Pointer_Row_Buffer;
+	int Vertex_X, Vertex_Y, Indices_Count, Width = Pointer_Area->Width;
+	unsigned int Index;
 
-		// Call the corresponding record handler if the record is valid
-		printf("Found record %d at offset 0x%08X. ID : %d, payload size : %d.\n", Records_Count, Record_Offset, Record_Identifier, Record_Payload_Size);
-		// Exit when the last record is detected
-		if (Record_Identifier == 4097)
+	for (Vertex_Y = 0; Vertex_Y < Pointer_Area->Height - 1; Vertex_Y++)
+	{
+		Indices_Count = 0;
+		if (Is_Triangle_Strips_Enabled)
 		{
-			printf("End-of-file record has been found, exiting.\n\n");
-			Return_Value = 0;
-			break;
+			// Repeat the first vertex of the row to join it to the previous row with degenerate triangles
+			if (Vertex_Y > 0)
+			{
+				Row_Indices[Indices_Count] = (Vertex_Y + 1) * Width;
+				Indices_Count++;
+			}
+			for (Vertex_X = 0; Vertex_X < Width; Vertex_X++)
+			{
+				Row_Indices[Indices_Count] = (Vertex_Y + 1) * Width + Vertex_X;
+				Row_Indices[Indices_Count + 1] = Vertex_Y * Width + Vertex_X;
+				Indices_Count += 2;
+			}
+			// Repeat the last vertex of the row
+			if (Vertex_Y < Pointer_Area->Height - 2)
+			{
+				Row_Indices[Indices_Count] = Row_Indices[Indices_Count - 1];
+				Indices_Count++;
+			}
 		}
-		// Make sure the record identifier is valid
-		if ((Record_Identifier < 0) || (Record_Identifier >= MAP_MAXIMUM_RECORD_IDENTIFIER)) printf("This record is not supported, bypassing it.\n");
 		else
 		{
-			// Try to extract the record content
-			if (Record_Handler_Functions[Record_Identifier](Payload_Buffer, Record_Payload_Size, Pointer_String_Output_Path) != 0)
+			for (Vertex_X = 0; Vertex_X < Width - 1; Vertex_X++)
 			{
-				printf("Error : failed to handle a record payload, aborting program.\n");
-				break;
+				Index = Vertex_Y * Width + Vertex_X;
+				Row_Indices[Indices_Count] = Index;
+				Row_Indices[Indices_Count + 1] = Index + 1;
+				Row_Indices[Indices_Count + 2] = Index + Width + 1;
+				Row_Indices[Indices_Count + 3] = Index;
+				Row_Indices[Indices_Count + 4] = Index + Width + 1;
+				Row_Indices[Indices_Count + 5] = Index + Width;
+				Indices_Count += 6;
 			}
 		}
-		
-		// Adjust offset to next record beginning
-		Record_Offset += 4 + 4 + Record_Payload_Size; // Take into account record ID field, record size field and record payload field
-
-		putchar('\n');
-		Records_Count++;
+		FileWriterWriteBuffer(Pointer_Writer, Row_Indices, sizeof(unsigned int) * Indices_Count);
 	}
-	
-	// All relevant data have been extracted to be able to generate the terrain
-	if (MapGenerateTerrain(Pointer_String_Output_Path) != 0)
+}
+
+/** Write a binary glTF 2.0 file beginning : the file header, a JSON chunk describing the terrain mesh and the binary chunk header. The binary chunk must then be filled with the vertices followed by the indices.
+ * @param Pointer_Area The terrain part the mesh covers, for the mesh bounding box.
+ * @param Pointer_Writer The output file.
+ * @param Is_Triangle_Strips_Enabled Set to 1 if the indices describe triangle strips, set to 0 if they describe a triangles list.
+ * @param Vertices_Count How many vertices the mesh has.
+ * @param Indices_Count How many indices the mesh has.
+ * @param Minimum_Height The lowest vertex height.
+ * @param Maximum_Height The highest vertex height.
+ */
+static void MapWriteTerrainGLBHeader(TMapTerrainArea *Pointer_Area, TFileWriter *Pointer_Writer, int Is_Triangle_Strips_Enabled, int Vertices_Count, int Indices_Count, float Minimum_Height, float Maximum_Height)
+{
+	char String_JSON[2048];
+	int JSON_Size, Positions_Size, Indices_Size, Binary_Size, Double_Words[5];
+
+	Positions_Size = Vertices_Count * 3 * (int) sizeof(float);
+	Indices_Size = Indices_Count * (int) sizeof(unsigned int);
+	Binary_Size = Positions_Size + Indices_Size; // Both sizes are multiples of 4, so the binary chunk needs no padding
+
+	// Describe the mesh, mode 4 is a triangles list and mode 5 is a triangle strip
+	JSON_Size = snprintf(String_JSON, sizeof(String_JSON), "{\"asset\":{\"version\":\"2.0\",\"generator\":\"Stealth Combat Tools\"},\"scene\":0,\"scenes\":[{\"nodes\":[0]}],\"nodes\":[{\"mesh\":0,\"name\":\"terrain_geometry\"}],"
+		"\"meshes\":[{\"name\":\"terrain_geometry\",\"primitives\":[{\"attributes\":{\"POSITION\":0},\"indices\":1,\"mode\":%d}]}],"
+		"\"buffers\":[{\"byteLength\":%d}],"
+		"\"bufferViews\":[{\"buffer\":0,\"byteOffset\":0,\"byteLength\":%d,\"target\":34962},{\"buffer\":0,\"byteOffset\":%d,\"byteLength\":%d,\"target\":34963}],"
+		"\"accessors\":[{\"bufferView\":0,\"componentType\":5126,\"count\":%d,\"type\":\"VEC3\",\"min\":[%d,%d,%.9g],\"max\":[%d,%d,%.9g]},{\"bufferView\":1,\"componentType\":5125,\"count\":%d,\"type\":\"SCALAR\"}]}",
+		Is_Triangle_Strips_Enabled ? 5 : 4, Binary_Size, Positions_Size, Positions_Size, Indices_Size, Vertices_Count, Pointer_Area->First_X, Pointer_Area->First_Y, Minimum_Height, Pointer_Area->First_X + Pointer_Area->Width - 1, Pointer_Area->First_Y + Pointer_Area->Height - 1, Maximum_Height, Indices_Count);
+	// The chunks must be aligned on 4 bytes, the JSON chunk is padded with spaces
+	while ((JSON_Size % 4) != 0)
 	{
-		printf("Error : could not generate terrain.\n");
-		goto Exit;
+		String_JSON[JSON_Size] = ' ';
+		JSON_Size++;
 	}
 
-Exit:
-	if (Pointer_File_Map != NULL) fclose(Pointer_File_Map);
-	return Return_Value;
+	// File header ("glTF" signature, version 2 and file size) followed by the JSON chunk header
+	Double_Words[0] = 0x46546C67;
+	Double_Words[1] = 2;
+	Double_Words[2] = 12 + 8 + JSON_Size + 8 + Binary_Size;
+	Double_Words[3] = JSON_Size;
+	Double_Words[4] = 0x4E4F534A; // "JSON"
+	FileWriterWriteBuffer(Pointer_Writer, Double_Words, sizeof(Double_Words));
+	FileWriterWriteBuffer(Pointer_Writer, String_JSON, JSON_Size);
+
+	// Binary chunk header
+	Double_Words[0] = Binary_Size;
+	Double_Words[1] = 0x004E4942; // "BIN"
+	FileWriterWriteBuffer(Pointer_Writer, Double_Words, sizeof(int) * 2);
+}
+
+/** Find the lowest and highest heights of a terrain part.
+ * @param Pointer_Context The extraction context.
+ * @param Pointer_Area The terrain part.
+ * @param Pointer_Minimum_Height On output, contain the lowest height.
+ * @param Pointer_Maximum_Height On output, contain the highest height.
+ */
+static void MapComputeTerrainHeightsRange(TMapContext *Pointer_Context, TMapTerrainArea *Pointer_Area, float *Pointer_Minimum_Height, float *Pointer_Maximum_Height)
+{
+	int Vertex_X, Vertex_Y;
+	float Height, Minimum_Height, Maximum_Height;
+
+	Minimum_Height = Maximum_Height = Pointer_Context->Pointer_Terrain_Heights[Pointer_Area->First_Y * Pointer_Context->Vertices_Per_Side + Pointer_Area->First_X];
+	for (Vertex_Y = Pointer_Area->First_Y; Vertex_Y < Pointer_Area->First_Y + Pointer_Area->Height; Vertex_Y++)
+	{
+		for (Vertex_X = Pointer_Area->First_X; Vertex_X < Pointer_Area->First_X + Pointer_Area->Width; Vertex_X++)
+		{
+			Height = Pointer_Context->Pointer_Terrain_Heights[Vertex_Y * Pointer_Context->Vertices_Per_Side + Vertex_X];
+			if (Height < Minimum_Height) Minimum_Height = Height;
+			if (Height > Maximum_Height) Maximum_Height = Height;
+		}
+	}
+
+	*Pointer_Minimum_Height = Minimum_Height;
+	*Pointer_Maximum_Height = Maximum_Height;
+}
+
+/** Write the terrain geometry as a binary glTF 2.0 file, made of a JSON chunk describing the mesh followed by a binary chunk containing the vertices and the indices.
+ * @param Pointer_Context The extraction context.
+ * @param Pointer_Area The terrain part to write.
+ * @param Pointer_Writer The output file.
+ * @param Is_Triangle_Strips_Enabled Set to 1 to write triangle strips, set to 0 to write a triangles list.
+ */
+static void MapWriteTerrainGLB(TMapContext *Pointer_Context, TMapTerrainArea *Pointer_Area, TFileWriter *Pointer_Writer, int Is_Triangle_Strips_Enabled)
+{
+	float Minimum_Height, Maximum_Height;
+
+	// The positions accessor must provide the bounding box
+	MapComputeTerrainHeightsRange(Pointer_Context, Pointer_Area, &Minimum_Height, &Maximum_Height);
+
+	MapWriteTerrainGLBHeader(Pointer_Area, Pointer_Writer, Is_Triangle_Strips_Enabled, Pointer_Area->Width * Pointer_Area->Height, MapComputeTerrainIndicesCount(Pointer_Area, Is_Triangle_Strips_Enabled), Minimum_Height, Maximum_Height);
+	MapWriteTerrainPositions(Pointer_Context, Pointer_Area, Pointer_Writer);
+	MapWriteTerrainIndices(Pointer_Context, Pointer_Area, Pointer_Writer, Is_Triangle_Strips_Enabled);
+}
+
+/** Write the terrain geometry as a binary little-endian PLY file. The triangle strips use the "tristrips" element, where -1 separates the strips.
+ * @param Pointer_Context The extraction context.
+ * @param Pointer_Area The terrain part to write.
+ * @param Pointer_Writer The output file.
+ * @param Is_Triangle_Strips_Enabled Set to 1 to write triangle strips, set to 0 to write triangles.
+ */
+static void MapWriteTerrainPLY(TMapContext *Pointer_Context, TMapTerrainArea *Pointer_Area, TFileWriter *Pointer_Writer, int Is_Triangle_Strips_Enabled)
+{
+	unsigned char *Row_Faces = Pointer_Context->Pointer_Row_Buffer;
+	char String_Header[512];
+	int Vertex_X, Vertex_Y, Size, Indices_Count, Width = Pointer_Area->Width, Height = Pointer_Area->Height;
+	unsigned int Triangle_Indices[3], Index;
+
+	// The strips are stored in a single list, so the degenerate triangles are not needed
+	if (Is_Triangle_Strips_Enabled)
+	{
+		Indices_Count = (Height - 1) * (2 * Width + 1) - 1;
+		snprintf(String_Header, sizeof(String_Header), MAP_PLY_HEADER_VERTICES "element tristrips 1\nproperty list int int vertex_indices\nend_header\n", Width * Height);
+	}
+	else snprintf(String_Header, sizeof(String_Header), MAP_PLY_HEADER_VERTICES MAP_PLY_HEADER_TRIANGLES, Width * Height, 2 * (Width - 1) * (Height - 1));
+	FileWriterWriteString(Pointer_Writer, String_Header);
+
+	MapWriteTerrainPositions(Pointer_Context, Pointer_Area, Pointer_Writer);
+
+	if (Is_Triangle_Strips_Enabled)
+	{
+		FileWriterWriteBuffer(Pointer_Writer, &Indices_Count, sizeof(Indices_Count));
+		for (Vertex_Y = 0; Vertex_Y < Height - 1; Vertex_Y++)
+		{
+			Size = 0;
+			for (Vertex_X = 0; Vertex_X < Width; Vertex_X++)
+			{
+				Index = (Vertex_Y + 1) * Width + Vertex_X;
+				memcpy(&Row_Faces[Size], &Index, sizeof(Index));
+				Index = Vertex_Y * Width + Vertex_X;
+				memcpy(&Row_Faces[Size + 4], &Index, sizeof(Index));
+				Size += 8;
+			}
+			// Start a new strip
+			if (Vertex_Y < Height - 2)
+			{
+				Index = 0xFFFFFFFF;
+				memcpy(&Row_Faces[Size], &Index, sizeof(Index));
+				Size += 4;
+			}
+			FileWriterWriteBuffer(Pointer_Writer, Row_Faces, Size);
+		}
+	}
+	else
+	{
+		// Each face is the vertices count byte followed by the 3 vertex indices
+		for (Vertex_Y = 0; Vertex_Y < Height - 1; Vertex_Y++)
+		{
+			Size = 0;
+			for (Vertex_X = 0; Vertex_X < Width - 1; Vertex_X++)
+			{
+				Index = Vertex_Y * Width + Vertex_X;
+				Triangle_Indices[0] = Index;
+				Triangle_Indices[1] = Index + 1;
+				Triangle_Indices[2] = Index + Width + 1;
+				Row_Faces[Size] = 3;
+				memcpy(&Row_Faces[Size + 1], Triangle_Indices, sizeof(Triangle_Indices));
+				Size += 1 + sizeof(Triangle_Indices);
+
+				Triangle_Indices[1] = Index + Width + 1;
+				Triangle_Indices[2] = Index + Width;
+				Row_Faces[Size] = 3;
+				memcpy(&Row_Faces[Size + 1], Triangle_Indices, sizeof(Triangle_Indices));
+				Size += 1 + sizeof(Triangle_Indices);
+			}
+			FileWriterWriteBuffer(Pointer_Writer, Row_Faces, Size);
+		}
+	}
+}
+
+/** Write a simplified terrain as an OBJ file made of triangles, with the same coordinates as the full resolution OBJ file.
+ * @param Pointer_Context The extraction context.
+ * @param Pointer_Mesh The simplified terrain.
+ * @param Pointer_Writer The output file.
+ */
+static void MapWriteTerrainMeshOBJ(TMapContext *Pointer_Context, TTerrainMesh *Pointer_Mesh, TFileWriter *Pointer_Writer)
+{
+	int i, j;
+	unsigned int Index;
+
+	FileWriterWriteString(Pointer_Writer, "o terrain_geometry\n\n");
+
+	for (i = 0; i < Pointer_Mesh->Vertices_Count; i++)
+	{
+		Index = Pointer_Mesh->Pointer_Vertices[i];
+		FileWriterWriteString(Pointer_Writer, "v ");
+		FileWriterWriteInteger(Pointer_Writer, Index % Pointer_Context->Vertices_Per_Side);
+		FileWriterWriteCharacter(Pointer_Writer, ' ');
+		FileWriterWriteInteger(Pointer_Writer, Index / Pointer_Context->Vertices_Per_Side);
+		FileWriterWriteCharacter(Pointer_Writer, ' ');
+		FileWriterWriteFloat(Pointer_Writer, Pointer_Context->Pointer_Terrain_Heights[Index]);
+		FileWriterWriteCharacter(Pointer_Writer, '\n');
+	}
+
+	// The OBJ vertex indices start from 1
+	for (i = 0; i < Pointer_Mesh->Triangles_Count; i++)
+	{
+		FileWriterWriteCharacter(Pointer_Writer, 'f');
+		for (j = 0; j < 3; j++)
+		{
+			FileWriterWriteCharacter(Pointer_Writer, ' ');
+			FileWriterWriteInteger(Pointer_Writer, Pointer_Mesh->Pointer_Indices[i * 3 + j] + 1);
+		}
+		FileWriterWriteCharacter(Pointer_Writer, '\n');
+	}
+}
+
+/** Write the binary vertices of a simplified terrain, with the same coordinates as the OBJ file.
+ * @param Pointer_Context The extraction context.
+ * @param Pointer_Mesh The simplified terrain.
+ * @param Pointer_Writer The output file.
+ */
+static void MapWriteTerrainMeshPositions(TMapContext *Pointer_Context, TTerrainMesh *Pointer_Mesh, TFileWriter *Pointer_Writer)
+{
+	float *Positions = (float *) Pointer_Context->Pointer_Row_Buffer;
+	int i, Positions_Count = 0;
+	unsigned int Index;
+
+	// Write the vertices by groups of a heightmap row, which is what the row buffer can hold
+	for (i = 0; i < Pointer_Mesh->Vertices_Count; i++)
+	{
+		Index = Pointer_Mesh->Pointer_Vertices[i];
+		Positions[Positions_Count * 3] = (float) (Index % Pointer_Context->Vertices_Per_Side);
+		Positions[Positions_Count * 3 + 1] = (float) (Index / Pointer_Context->Vertices_Per_Side);
+		Positions[Positions_Count * 3 + 2] = Pointer_Context->Pointer_Terrain_Heights[Index];
+		Positions_Count++;
+
+		if ((Positions_Count == Pointer_Context->Vertices_Per_Side) || (i == Pointer_Mesh->Vertices_Count - 1))
+		{
+			FileWriterWriteBuffer(Pointer_Writer, Positions, sizeof(float) * 3 * Positions_Count);
+			Positions_Count = 0;
+		}
+	}
+}
+
+/** Write a simplified terrain as a binary glTF 2.0 file with a triangles list.
+ * @param Pointer_Context The extraction context.
+ * @param Pointer_Mesh The simplified terrain.
+ * @param Pointer_Writer The output file.
+ */
+static void MapWriteTerrainMeshGLB(TMapContext *Pointer_Context, TTerrainMesh *Pointer_Mesh, TFileWriter *Pointer_Writer)
+{
+	TMapTerrainArea Area;
+	int i;
+	float Height, Minimum_Height, Maximum_Height;
+
+	Minimum_Height = Maximum_Height = Pointer_Context->Pointer_Terrain_Heights[Pointer_Mesh->Pointer_Vertices[0]];
+	for (i = 1; i < Pointer_Mesh->Vertices_Count; i++)
+	{
+		Height = Pointer_Context->Pointer_Terrain_Heights[Pointer_Mesh->Pointer_Vertices[i]];
+		if (Height < Minimum_Height) Minimum_Height = Height;
+		if (Height > Maximum_Height) Maximum_Height = Height;
+	}
+
+	Area.First_X = 0;
+	Area.First_Y = 0;
+	Area.Width = Pointer_Context->Vertices_Per_Side;
+	Area.Height = Pointer_Context->Vertices_Per_Side;
+	MapWriteTerrainGLBHeader(&Area, Pointer_Writer, 0, Pointer_Mesh->Vertices_Count, Pointer_Mesh->Triangles_Count * 3, Minimum_Height, Maximum_Height);
+	MapWriteTerrainMeshPositions(Pointer_Context, Pointer_Mesh, Pointer_Writer);
+	FileWriterWriteBuffer(Pointer_Writer, Pointer_Mesh->Pointer_Indices, sizeof(unsigned int) * 3 * Pointer_Mesh->Triangles_Count);
+}
+
+/** Write a simplified terrain as a binary little-endian PLY file.
+ * @param Pointer_Context The extraction context.
+ * @param Pointer_Mesh The simplified terrain.
+ * @param Pointer_Writer The output file.
+ */
+static void MapWriteTerrainMeshPLY(TMapContext *Pointer_Context, TTerrainMesh *Pointer_Mesh, TFileWriter *Pointer_Writer)
+{
+	unsigned char *Faces = Pointer_Context->Pointer_Row_Buffer;
+	char String_Header[512];
+	int i, Size = 0;
+
+	snprintf(String_Header, sizeof(String_Header), MAP_PLY_HEADER_VERTICES MAP_PLY_HEADER_TRIANGLES, Pointer_Mesh->Vertices_Count, Pointer_Mesh->Triangles_Count);
+	FileWriterWriteString(Pointer_Writer, String_Header);
+
+	MapWriteTerrainMeshPositions(Pointer_Context, Pointer_Mesh, Pointer_Writer);
+
+	// Each face is the vertices count byte followed by the 3 vertex indices, the row buffer can hold twice a heightmap row of faces
+	for (i = 0; i < Pointer_Mesh->Triangles_Count; i++)
+	{
+		Faces[Size] = 3;
+		memcpy(&Faces[Size + 1], &Pointer_Mesh->Pointer_Indices[i * 3], 3 * sizeof(unsigned int));
+		Size += 1 + 3 * sizeof(unsigned int);
+
+		if ((Size == Pointer_Context->Vertices_Per_Side * 2 * (1 + 3 * (int) sizeof(unsigned int))) || (i == Pointer_Mesh->Triangles_Count - 1))
+		{
+			FileWriterWriteBuffer(Pointer_Writer, Faces, Size);
+			Size = 0;
+		}
+	}
+}
+
+/** Write a terrain file with the extraction file format.
+ * @param Pointer_Context The extraction context.
+ * @param Pointer_Area The terrain part to write with one vertex per height, it is ignored when a simplified terrain is provided.
+ * @param Pointer_Mesh The simplified terrain to write, or NULL to write one vertex per height.
+ * @param Pointer_String_File_Name The file to create.
+ * @return -1 if an error occurred,
+ * @return 0 on success.
+ */
+static int MapWriteTerrainFile(TMapContext *Pointer_Context, TMapTerrainArea *Pointer_Area, TTerrainMesh *Pointer_Mesh, const char *Pointer_String_File_Name)
+{
+	TMapExtractionOptions *Pointer_Options = Pointer_Context->Pointer_Options;
+	TFileWriter Writer;
+	double Start_Time;
+
+	// Try to open output file, the OBJ file is a text file
+	Start_Time = StatisticsGetTime();
+	if (FileWriterOpen(Pointer_String_File_Name, Pointer_Options->Terrain_Format == MAP_TERRAIN_FORMAT_OBJ ? "w" : "wb", &Writer) != 0) return -1;
+
+	switch (Pointer_Options->Terrain_Format)
+	{
+		case MAP_TERRAIN_FORMAT_GLB:
+			if (Pointer_Mesh == NULL) MapWriteTerrainGLB(Pointer_Context, Pointer_Area, &Writer, Pointer_Options->Is_Triangle_Strips_Enabled);
+			else MapWriteTerrainMeshGLB(Pointer_Context, Pointer_Mesh, &Writer);
+			break;
+
+		case MAP_TERRAIN_FORMAT_PLY:
+			if (Pointer_Mesh == NULL) MapWriteTerrainPLY(Pointer_Context, Pointer_Area, &Writer, Pointer_Options->Is_Triangle_Strips_Enabled);
+			else MapWriteTerrainMeshPLY(Pointer_Context, Pointer_Mesh, &Writer);
+			break;
+
+		default:
+			if (Pointer_Mesh == NULL) MapWriteTerrainOBJ(Pointer_Context, Pointer_Area, &Writer);
+			else MapWriteTerrainMeshOBJ(Pointer_Context, Pointer_Mesh, &Writer);
+			break;
+	}
+	
+	if (FileWriterClose(&Writer) != 0) return -1;
+	StatisticsAddPhaseTime(STATISTICS_PHASE_MAP_OBJ_WRITE, Start_Time);
+	return 0;
+}
+
+/** Write a terrain chunk from a chunk writing worker.
+ * @param Pointer_Context The chunks context.
+ * @param Chunk_Index The chunk to write.
+ * @param Worker_Index The worker index, it selects the extraction context copy to use.
+ * @return -1 if an error occurred,
+ * @return 0 on success.
+ */
+static int MapWriteTerrainChunk(void *Pointer_Context, int Chunk_Index, int Worker_Index)
+{
+	TMapTerrainChunksContext *Pointer_Chunks_Context = Pointer_Context;
+	TMapContext *Pointer_Worker_Context = &Pointer_Chunks_Context->Pointer_Worker_Contexts[Worker_Index];
+	TMapTerrainChunk *Pointer_Chunk = &Pointer_Chunks_Context->Pointer_Chunks[Chunk_Index];
+	char String_Output_File_Name[2048];
+	static const char *Pointer_Strings_File_Extensions[] = {"obj", "glb", "ply"};
+
+	MapComputeTerrainHeightsRange(Pointer_Worker_Context, &Pointer_Chunk->Area, &Pointer_Chunk->Minimum_Height, &Pointer_Chunk->Maximum_Height);
+
+	snprintf(String_Output_File_Name, sizeof(String_Output_File_Name), "%s/" MAP_DIRECTORY_NAME_TERRAIN_CHUNKS "/Chunk_%d_%d.%s", Pointer_Worker_Context->Pointer_String_Output_Path, Chunk_Index % Pointer_Chunks_Context->Chunks_Per_Side, Chunk_Index / Pointer_Chunks_Context->Chunks_Per_Side, Pointer_Strings_File_Extensions[Pointer_Worker_Context->Pointer_Options->Terrain_Format]);
+	LogPrint(LOG_LEVEL_DEBUG, "Saving terrain chunk to \"%s\" file.\n", String_Output_File_Name);
+	return MapWriteTerrainFile(Pointer_Worker_Context, &Pointer_Chunk->Area, NULL, String_Output_File_Name);
+}
+
+/** Split the terrain in square chunks of tiles and write each chunk to its own file, using several threads. The chunks are listed in an index file telling their bounding box.
+ * @param Pointer_Context The extraction context.
+ * @return -1 if an error occurred,
+ * @return 0 on success.
+ */
+static int MapGenerateTerrainChunks(TMapContext *Pointer_Context)
+{
+	TMapExtractionOptions *Pointer_Options = Pointer_Context->Pointer_Options;
+	TMapTerrainChunksContext Chunks_Context;
+	TMapTerrainChunk *Pointer_Chunk;
+	TMapContext *Pointer_Worker_Contexts;
+	FILE *Pointer_File;
+	char String_Path[2048];
+	int i, Chunk_Vertices_Count, Chunks_Per_Side, Chunks_Count, Workers_Count, Return_Value = -1;
+	static const char *Pointer_Strings_File_Extensions[] = {"obj", "glb", "ply"};
+
+	// A chunk shares its last row and column with the next chunks, so the chunks can be joined without holes
+	Chunk_Vertices_Count = Pointer_Options->Terrain_Chunk_Tiles_Count * MAP_TERRAIN_GEOMETRY_VERTICES_PER_TILE_SIDE;
+	Chunks_Per_Side = (Pointer_Context->Vertices_Per_Side - 1 + Chunk_Vertices_Count - 1) / Chunk_Vertices_Count;
+	Chunks_Count = Chunks_Per_Side * Chunks_Per_Side;
+	Workers_Count = Pointer_Options->Jobs_Count;
+	if (Workers_Count > Chunks_Count) Workers_Count = Chunks_Count;
+
+	Chunks_Context.Chunks_Per_Side = Chunks_Per_Side;
+	Chunks_Context.Pointer_Chunks = calloc(Chunks_Count, sizeof(TMapTerrainChunk));
+	Chunks_Context.Pointer_Worker_Contexts = Pointer_Worker_Contexts = calloc(Workers_Count, sizeof(TMapContext));
+	if ((Chunks_Context.Pointer_Chunks == NULL) || (Pointer_Worker_Contexts == NULL))
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to allocate the terrain chunks (%s).\n", strerror(errno));
+		goto Exit;
+	}
+
+	for (i = 0; i < Chunks_Count; i++)
+	{
+		Pointer_Chunk = &Chunks_Context.Pointer_Chunks[i];
+		Pointer_Chunk->Area.First_X = (i % Chunks_Per_Side) * Chunk_Vertices_Count;
+		Pointer_Chunk->Area.First_Y = (i / Chunks_Per_Side) * Chunk_Vertices_Count;
+		Pointer_Chunk->Area.Width = Pointer_Context->Vertices_Per_Side - Pointer_Chunk->Area.First_X;
+		if (Pointer_Chunk->Area.Width > Chunk_Vertices_Count + 1) Pointer_Chunk->Area.Width = Chunk_Vertices_Count + 1;
+		Pointer_Chunk->Area.Height = Pointer_Context->Vertices_Per_Side - Pointer_Chunk->Area.First_Y;
+		if (Pointer_Chunk->Area.Height > Chunk_Vertices_Count + 1) Pointer_Chunk->Area.Height = Chunk_Vertices_Count + 1;
+	}
+
+	// Each worker needs its own row buffer
+	for (i = 0; i < Workers_Count; i++)
+	{
+		Pointer_Worker_Contexts[i] = *Pointer_Context;
+		Pointer_Worker_Contexts[i].Pointer_Row_Buffer = NULL;
+		if (Pointer_Options->Terrain_Format == MAP_TERRAIN_FORMAT_OBJ) continue;
+
+		Pointer_Worker_Contexts[i].Pointer_Row_Buffer = malloc(Pointer_Context->Vertices_Per_Side * 2 * (1 + 3 * sizeof(unsigned int)));
+		if (Pointer_Worker_Contexts[i].Pointer_Row_Buffer == NULL)
+		{
+			LogPrint(LOG_LEVEL_ERROR, "Error : failed to allocate the terrain row buffer (%s).\n", strerror(errno));
+			goto Exit;
+		}
+	}
+
+	snprintf(String_Path, sizeof(String_Path), "%s/" MAP_DIRECTORY_NAME_TERRAIN_CHUNKS, Pointer_Context->Pointer_String_Output_Path);
+	if (FileSystemCreateDirectory(String_Path) != 0)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to create the terrain chunks directory \"%s\" (%s).\n", String_Path, strerror(errno));
+		goto Exit;
+	}
+	LogPrint(LOG_LEVEL_INFORMATION, "Saving %d terrain chunks of %dx%d tiles to \"%s\" directory.\n", Chunks_Count, Pointer_Options->Terrain_Chunk_Tiles_Count, Pointer_Options->Terrain_Chunk_Tiles_Count, String_Path);
+	if (ThreadParallelFor(Workers_Count, Chunks_Count, MapWriteTerrainChunk, &Chunks_Context) != 0) goto Exit;
+
+	// List the chunks, so a viewer can load only the visible ones without opening all files
+	Pointer_File = MapOpenFileWithPrefixPath(Pointer_Context->Pointer_String_Output_Path, MAP_DIRECTORY_NAME_TERRAIN_CHUNKS "/" MAP_FILE_NAME_TERRAIN_CHUNKS_INDEX, "w");
+	if (Pointer_File == NULL)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to create the terrain chunks index file (%s).\n", strerror(errno));
+		goto Exit;
+	}
+	fprintf(Pointer_File, "{\n\t\"format\": \"%s\",\n\t\"vertices_per_side\": %d,\n\t\"tiles_per_chunk_side\": %d,\n\t\"chunks_per_side\": %d,\n\t\"chunks\":\n\t[\n", Pointer_Strings_File_Extensions[Pointer_Options->Terrain_Format], Pointer_Context->Vertices_Per_Side, Pointer_Options->Terrain_Chunk_Tiles_Count, Chunks_Per_Side);
+	for (i = 0; i < Chunks_Count; i++)
+	{
+		Pointer_Chunk = &Chunks_Context.Pointer_Chunks[i];
+		fprintf(Pointer_File, "\t\t{\"file\": \"Chunk_%d_%d.%s\", \"chunk_x\": %d, \"chunk_y\": %d, \"minimum\": [%d, %d, %.9g], \"maximum\": [%d, %d, %.9g]}%s\n", i % Chunks_Per_Side, i / Chunks_Per_Side, Pointer_Strings_File_Extensions[Pointer_Options->Terrain_Format], i % Chunks_Per_Side, i / Chunks_Per_Side,
+			Pointer_Chunk->Area.First_X, Pointer_Chunk->Area.First_Y, Pointer_Chunk->Minimum_Height, Pointer_Chunk->Area.First_X + Pointer_Chunk->Area.Width - 1, Pointer_Chunk->Area.First_Y + Pointer_Chunk->Area.Height - 1, Pointer_Chunk->Maximum_Height, i < Chunks_Count - 1 ? "," : "");
+	}
+	fprintf(Pointer_File, "\t]\n}\n");
+	if (fclose(Pointer_File) != 0)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to write the terrain chunks index file (%s).\n", strerror(errno));
+		goto Exit;
+	}
+	Return_Value = 0;
+
+Exit:
+	if (Pointer_Worker_Contexts != NULL)
+	{
+		for (i = 0; i < Workers_Count; i++) free(Pointer_Worker_Contexts[i].Pointer_Row_Buffer);
+	}
+	free(Pointer_Worker_Contexts);
+	free(Chunks_Context.Pointer_Chunks);
+	return Return_Value;
+}
+
+/** Write all unit groups to the units file, each group is an INI section.
+ * @param Pointer_Context The extraction context.
+ * @return -1 if an error occurred,
+ * @return 0 on success.
+ */
+static int MapWriteUnits(TMapContext *Pointer_Context)
+{
+	TMapUnits *Pointer_Units = &Pointer_Context->Units;
+	TMapUnitGroupInformation *Pointer_Unit_Group;
+	FILE *Pointer_File;
+	int Group_Index, Unit_Index = 0, Group_Unit_Index;
+	long long Written_Bytes_Count = 0;
+
+	// Always create the file, so the units of a previous extraction can't mix with this map ones
+	Pointer_File = MapOpenFileWithPrefixPath(Pointer_Context->Pointer_String_Output_Path, MAP_FILE_NAME_UNITS, "w");
+	if (Pointer_File == NULL)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to open the units file (%s).\n", strerror(errno));
+		return -1;
+	}
+
+	for (Group_Index = 0; Group_Index < Pointer_Units->Unit_Groups_Count; Group_Index++)
+	{
+		// The section name is the unit group name
+		Pointer_Unit_Group = &Pointer_Units->Pointer_Unit_Groups[Group_Index];
+		Written_Bytes_Count += fprintf(Pointer_File, "; The section name matches with a single name in the units section of the map script file\n[%s]\n", Pointer_Unit_Group->String_Name);
+		Written_Bytes_Count += fprintf(Pointer_File, "RecordType=%u\n", Pointer_Unit_Group->Record_Type);
+		if (Pointer_Unit_Group->Units_List_Indices_Count >= 1) Written_Bytes_Count += fprintf(Pointer_File, "UnitsListIndex=%u\n", Pointer_Unit_Group->Units_List_Indices[0]);
+		if (Pointer_Unit_Group->Units_List_Indices_Count >= 2) Written_Bytes_Count += fprintf(Pointer_File, "UnitsListIndex2=%u\n", Pointer_Unit_Group->Units_List_Indices[1]);
+		Written_Bytes_Count += fprintf(Pointer_File, "UnitsCount=%u\n", Pointer_Unit_Group->Units_Count);
+
+		// The group units follow each other, a truncated group has less units than its units count
+		for (Group_Unit_Index = 0; (Unit_Index < Pointer_Units->Units_Count) && (Pointer_Units->Pointer_Group_Indices[Unit_Index] == Group_Index); Group_Unit_Index++)
+		{
+			Written_Bytes_Count += fprintf(Pointer_File, "; This type is declared in the app/units file\nUnit%dType=\"%s\"\n", Group_Unit_Index, Pointer_Units->Pointer_Strings_Types[Unit_Index]);
+			Written_Bytes_Count += fprintf(Pointer_File, "Unit%dCoordinateX=%u\nUnit%dCoordinateY=%u\nUnit%dCoordinateZ=%u\n", Group_Unit_Index, Pointer_Units->Pointer_Coordinates_X[Unit_Index], Group_Unit_Index, Pointer_Units->Pointer_Coordinates_Y[Unit_Index], Group_Unit_Index, Pointer_Units->Pointer_Coordinates_Z[Unit_Index]);
+			Unit_Index++;
+		}
+
+		// Separate each section by an empty line
+		Written_Bytes_Count += fprintf(Pointer_File, "\n");
+	}
+	StatisticsAddCounter(STATISTICS_COUNTER_WRITTEN_BYTES, Written_Bytes_Count);
+
+	if (fclose(Pointer_File) != 0)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to write the units file (%s).\n", strerror(errno));
+		return -1;
+	}
+	return 0;
+}
+
+/** Use the data extracted from various records to create a file containing the terrain geometry.
+ * @param Pointer_Context The extraction context, it tells where to store the file and which file format to use.
+ * @return -1 if an error occurred,
+ * @return 0 on success.
+ */
+static int MapGenerateTerrain(TMapContext *Pointer_Context)
+{
+	TMapExtractionOptions *Pointer_Options = Pointer_Context->Pointer_Options;
+	TTerrainSimplifier Simplifier;
+	TTerrainMesh Mesh;
+	TMapTerrainArea Area;
+	char String_Output_File_Name[2048];
+	static const char *Pointer_Strings_File_Extensions[] = {"obj", "glb", "ply"};
+	int Level, Return_Value = -1, Full_Resolution_Triangles_Count;
+	float Maximum_Error;
+	double Start_Time;
+
+	if (Pointer_Options->Terrain_Format == MAP_TERRAIN_FORMAT_NONE) return 0;
+	
+	// Make sure the map size is known
+	if ((Pointer_Context->Tiles_Per_Side == -1) || (Pointer_Context->Vertices_Per_Side == -1))
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : map coordinates have not been found. The map file is malformed and is missing a record of type 1 at the file beginning.\n");
+		return -1;
+	}
+	// The binary formats, the simplified terrain and the chunks need at least one face
+	if (((Pointer_Options->Terrain_Format != MAP_TERRAIN_FORMAT_OBJ) || (Pointer_Options->Terrain_Maximum_Error >= 0) || (Pointer_Options->Terrain_Chunk_Tiles_Count > 0)) && (Pointer_Context->Vertices_Per_Side < 2))
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : the map has no terrain.\n");
+		return -1;
+	}
+	// The chunks of a simplified terrain would have cracks between them, because each chunk would be simplified separately
+	if ((Pointer_Options->Terrain_Maximum_Error >= 0) && (Pointer_Options->Terrain_Chunk_Tiles_Count > 0))
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : a simplified terrain can't be split in chunks.\n");
+		return -1;
+	}
+	
+	// The binary formats are written one row at a time, a row of PLY faces is the largest one
+	if (Pointer_Options->Terrain_Format != MAP_TERRAIN_FORMAT_OBJ)
+	{
+		Pointer_Context->Pointer_Row_Buffer = malloc(Pointer_Context->Vertices_Per_Side * 2 * (1 + 3 * sizeof(unsigned int)));
+		if (Pointer_Context->Pointer_Row_Buffer == NULL)
+		{
+			LogPrint(LOG_LEVEL_ERROR, "Error : failed to allocate the terrain row buffer (%s).\n", strerror(errno));
+			return -1;
+		}
+	}
+
+	// Write all heights when no simplification is requested
+	if (Pointer_Options->Terrain_Maximum_Error < 0)
+	{
+		if (Pointer_Options->Terrain_Chunk_Tiles_Count > 0)
+		{
+			if (MapGenerateTerrainChunks(Pointer_Context) != 0) return -1;
+			LogPrint(LOG_LEVEL_INFORMATION, "Terrain was successfully generated.\n");
+			return 0;
+		}
+
+		Area.First_X = 0;
+		Area.First_Y = 0;
+		Area.Width = Pointer_Context->Vertices_Per_Side;
+		Area.Height = Pointer_Context->Vertices_Per_Side;
+		snprintf(String_Output_File_Name, sizeof(String_Output_File_Name), "%s/Terrain_Geometry.%s", Pointer_Context->Pointer_String_Output_Path, Pointer_Strings_File_Extensions[Pointer_Options->Terrain_Format]);
+		LogPrint(LOG_LEVEL_INFORMATION, "Saving terrain geometry to \"%s\" file.\n", String_Output_File_Name);
+		if (MapWriteTerrainFile(Pointer_Context, &Area, NULL, String_Output_File_Name) != 0) return -1;
+		LogPrint(LOG_LEVEL_INFORMATION, "Terrain was successfully generated.\n");
+		return 0;
+	}
+
+	if ((Pointer_Options->Terrain_Format != MAP_TERRAIN_FORMAT_OBJ) && Pointer_Options->Is_Triangle_Strips_Enabled) LogPrint(LOG_LEVEL_WARNING, "Warning : the simplified terrain is always written as a triangles list.\n");
+
+	// The heightmap errors are computed once for all levels of detail
+	Start_Time = StatisticsGetTime();
+	if (TerrainSimplifierInitialize(&Simplifier, Pointer_Context->Pointer_Terrain_Heights, Pointer_Context->Vertices_Per_Side) != 0) goto Exit;
+	StatisticsAddPhaseTime(STATISTICS_PHASE_MAP_TERRAIN_SIMPLIFICATION, Start_Time);
+	Full_Resolution_Triangles_Count = 2 * (Pointer_Context->Vertices_Per_Side - 1) * (Pointer_Context->Vertices_Per_Side - 1);
+
+	// The first level uses the requested error, each next level allows twice the previous error
+	Maximum_Error = Pointer_Options->Terrain_Maximum_Error;
+	for (Level = 0; Level < Pointer_Options->Terrain_Levels_Of_Detail_Count; Level++)
+	{
+		Start_Time = StatisticsGetTime();
+		if (TerrainSimplifierBuildMesh(&Simplifier, Maximum_Error, &Mesh) != 0) goto Exit;
+		StatisticsAddPhaseTime(STATISTICS_PHASE_MAP_TERRAIN_SIMPLIFICATION, Start_Time);
+		LogPrint(LOG_LEVEL_INFORMATION, "Terrain level of detail %d with a maximum error of %g : %d vertices and %d triangles (%.1f times fewer triangles than the full resolution terrain).\n", Level, Maximum_Error, Mesh.Vertices_Count, Mesh.Triangles_Count, (double) Full_Resolution_Triangles_Count / Mesh.Triangles_Count);
+
+		if (Level == 0) snprintf(String_Output_File_Name, sizeof(String_Output_File_Name), "%s/Terrain_Geometry.%s", Pointer_Context->Pointer_String_Output_Path, Pointer_Strings_File_Extensions[Pointer_Options->Terrain_Format]);
+		else snprintf(String_Output_File_Name, sizeof(String_Output_File_Name), "%s/Terrain_Geometry_LOD%d.%s", Pointer_Context->Pointer_String_Output_Path, Level, Pointer_Strings_File_Extensions[Pointer_Options->Terrain_Format]);
+		LogPrint(LOG_LEVEL_INFORMATION, "Saving terrain geometry to \"%s\" file.\n", String_Output_File_Name);
+		if (MapWriteTerrainFile(Pointer_Context, NULL, &Mesh, String_Output_File_Name) != 0)
+		{
+			TerrainSimplifierFreeMesh(&Mesh);
+			goto Exit;
+		}
+		TerrainSimplifierFreeMesh(&Mesh);
+		Maximum_Error *= 2;
+	}
+	LogPrint(LOG_LEVEL_INFORMATION, "Terrain was successfully generated.\n");
+	Return_Value = 0;
+
+Exit:
+	TerrainSimplifierFree(&Simplifier);
+	return Return_Value;
+}
+
+/** Write the TIFF header and image file directory describing a single strip of signed 16-bit samples. The samples must be written right after.
+ * @param Pointer_Writer The output file.
+ * @param Vertices_Per_Side The heightmap width and height.
+ */
+static void MapWriteHeightmapTIFFHeader(TFileWriter *Pointer_Writer, int Vertices_Per_Side)
+{
+	// Each entry is a tag, a type (3 for 16-bit values, 4 for 32-bit values, 5 for rationals), a values count and a value or an offset. The entries must be sorted by tag
+	unsigned int Entries[MAP_HEIGHTMAP_TIFF_ENTRIES_COUNT][4] =
+	{
+		{256, 4, 1, 0}, // Image width
+		{257, 4, 1, 0}, // Image length
+		{258, 3, 1, 16}, // Bits per sample
+		{259, 3, 1, 1}, // No compression
+		{262, 3, 1, 1}, // Black is the lowest value
+		{273, 4, 1, 0}, // Strip offset
+		{277, 3, 1, 1}, // Samples per pixel
+		{278, 4, 1, 0}, // Rows per strip
+		{279, 4, 1, 0}, // Strip size
+		{282, 5, 1, 0}, // X resolution
+		{283, 5, 1, 0}, // Y resolution
+		{284, 3, 1, 1}, // Samples are contiguous
+		{296, 3, 1, 1}, // No resolution unit
+		{339, 3, 1, 2} // Signed integer samples
+	};
+	unsigned int Directory_Size, Rationals_Offset, Rationals[4] = {1, 1, 1, 1};
+	unsigned short Words[2];
+	int i;
+
+	// The file is made of the header, the image file directory, the resolution rationals and the samples
+	Directory_Size = 2 + MAP_HEIGHTMAP_TIFF_ENTRIES_COUNT * 12 + 4;
+	Rationals_Offset = 8 + Directory_Size;
+	Entries[0][3] = Vertices_Per_Side;
+	Entries[1][3] = Vertices_Per_Side;
+	Entries[5][3] = Rationals_Offset + sizeof(Rationals);
+	Entries[7][3] = Vertices_Per_Side;
+	Entries[8][3] = Vertices_Per_Side * Vertices_Per_Side * sizeof(short);
+	Entries[9][3] = Rationals_Offset;
+	Entries[10][3] = Rationals_Offset + 2 * sizeof(unsigned int);
+
+	// "II" byte order mark, magic number, and the image file directory offset
+	FileWriterWriteBuffer(Pointer_Writer, "II*\0\x08\0\0\0", 8);
+
+	Words[0] = MAP_HEIGHTMAP_TIFF_ENTRIES_COUNT;
+	FileWriterWriteBuffer(Pointer_Writer, Words, sizeof(unsigned short));
+	for (i = 0; i < MAP_HEIGHTMAP_TIFF_ENTRIES_COUNT; i++)
+	{
+		Words[0] = (unsigned short) Entries[i][0];
+		Words[1] = (unsigned short) Entries[i][1];
+		FileWriterWriteBuffer(Pointer_Writer, Words, sizeof(Words));
+		// The 16-bit values are stored in the first bytes of the value field, which is what a little-endian 32-bit value does
+		FileWriterWriteBuffer(Pointer_Writer, &Entries[i][2], 2 * sizeof(unsigned int));
+	}
+	// There is no next image file directory
+	i = 0;
+	FileWriterWriteBuffer(Pointer_Writer, &i, sizeof(i));
+	FileWriterWriteBuffer(Pointer_Writer, Rationals, sizeof(Rationals));
+}
+
+/** Write the terrain heights as a raster with the original 16-bit values, followed by a JSON file telling how to convert the samples to heights.
+ * @param Pointer_Context The extraction context, it tells where to store the files and which raster format to use.
+ * @return -1 if an error occurred,
+ * @return 0 on success.
+ */
+static int MapGenerateHeightmap(TMapContext *Pointer_Context)
+{
+	TMapHeightmapFormat Format = Pointer_Context->Pointer_Options->Heightmap_Format;
+	TFileWriter Writer;
+	FILE *Pointer_File;
+	short *Pointer_Samples = NULL;
+	char String_File_Name[32], String_Output_File_Name[2048], String_Header[64];
+	int i, Samples_Count, Sample, Minimum_Sample = 0, Maximum_Sample = 0, Return_Value = -1;
+	float Height;
+	double Start_Time;
+	static const char *Pointer_Strings_File_Extensions[] = {NULL, "raw", "pgm", "tif"};
+
+	if (Format == MAP_HEIGHTMAP_FORMAT_NONE) return 0;
+
+	// Make sure the map size is known
+	if ((Pointer_Context->Tiles_Per_Side == -1) || (Pointer_Context->Vertices_Per_Side == -1))
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : map coordinates have not been found. The map file is malformed and is missing a record of type 1 at the file beginning.\n");
+		return -1;
+	}
+	if (Pointer_Context->Vertices_Per_Side < 1)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : the map has no terrain.\n");
+		return -1;
+	}
+
+	Start_Time = StatisticsGetTime();
+	Samples_Count = Pointer_Context->Vertices_Per_Side * Pointer_Context->Vertices_Per_Side;
+	Pointer_Samples = malloc(Samples_Count * sizeof(short));
+	if (Pointer_Samples == NULL)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to allocate the heightmap samples (%s).\n", strerror(errno));
+		return -1;
+	}
+
+	// Recover the original record values, a height is the value divided by the scale so multiplying it back is always within 0.01 of the value
+	for (i = 0; i < Samples_Count; i++)
+	{
+		Height = Pointer_Context->Pointer_Terrain_Heights[i] * MAP_TERRAIN_GEOMETRY_HEIGHT_SCALE;
+		Sample = (int) (Height >= 0 ? Height + 0.5f : Height - 0.5f);
+		if ((i == 0) || (Sample < Minimum_Sample)) Minimum_Sample = Sample;
+		if ((i == 0) || (Sample > Maximum_Sample)) Maximum_Sample = Sample;
+
+		// PGM samples are unsigned and big-endian
+		if (Format == MAP_HEIGHTMAP_FORMAT_PGM)
+		{
+			Sample += MAP_HEIGHTMAP_PGM_SAMPLE_OFFSET;
+			Sample = ((Sample & 0xFF) << 8) | ((Sample >> 8) & 0xFF);
+		}
+		Pointer_Samples[i] = (short) Sample;
+	}
+
+	// Write the raster
+	snprintf(String_File_Name, sizeof(String_File_Name), "Terrain_Heightmap.%s", Pointer_Strings_File_Extensions[Format]);
+	snprintf(String_Output_File_Name, sizeof(String_Output_File_Name), "%s/%s", Pointer_Context->Pointer_String_Output_Path, String_File_Name);
+	LogPrint(LOG_LEVEL_INFORMATION, "Saving terrain heightmap to \"%s\" file.\n", String_Output_File_Name);
+	if (FileWriterOpen(String_Output_File_Name, "wb", &Writer) != 0) goto Exit;
+	if (Format == MAP_HEIGHTMAP_FORMAT_PGM)
+	{
+		snprintf(String_Header, sizeof(String_Header), "P5\n%d %d\n65535\n", Pointer_Context->Vertices_Per_Side, Pointer_Context->Vertices_Per_Side);
+		FileWriterWriteString(&Writer, String_Header);
+	}
+	else if (Format == MAP_HEIGHTMAP_FORMAT_TIFF16) MapWriteHeightmapTIFFHeader(&Writer, Pointer_Context->Vertices_Per_Side);
+	FileWriterWriteBuffer(&Writer, Pointer_Samples, Samples_Count * sizeof(short));
+	if (FileWriterClose(&Writer) != 0) goto Exit;
+
+	// Describe the raster
+	Pointer_File = MapOpenFileWithPrefixPath(Pointer_Context->Pointer_String_Output_Path, MAP_FILE_NAME_HEIGHTMAP_METADATA, "w");
+	if (Pointer_File == NULL)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to create the heightmap description file (%s).\n", strerror(errno));
+		goto Exit;
+	}
+	fprintf(Pointer_File, "{\n\t\"file\": \"%s\",\n\t\"width\": %d,\n\t\"height\": %d,\n", String_File_Name, Pointer_Context->Vertices_Per_Side, Pointer_Context->Vertices_Per_Side);
+	fprintf(Pointer_File, "\t\"sample_type\": \"%s\",\n\t\"byte_order\": \"%s\",\n", Format == MAP_HEIGHTMAP_FORMAT_PGM ? "uint16" : "int16", Format == MAP_HEIGHTMAP_FORMAT_PGM ? "big_endian" : "little_endian");
+	fprintf(Pointer_File, "\t\"sample_offset\": %d,\n\t\"height_scale\": %g,\n", Format == MAP_HEIGHTMAP_FORMAT_PGM ? MAP_HEIGHTMAP_PGM_SAMPLE_OFFSET : 0, MAP_TERRAIN_GEOMETRY_HEIGHT_SCALE);
+	fprintf(Pointer_File, "\t\"height_formula\": \"(sample - sample_offset) / height_scale\",\n\t\"minimum_height\": %.9g,\n\t\"maximum_height\": %.9g,\n", Minimum_Sample / MAP_TERRAIN_GEOMETRY_HEIGHT_SCALE, Maximum_Sample / MAP_TERRAIN_GEOMETRY_HEIGHT_SCALE);
+	fprintf(Pointer_File, "\t\"row_order\": \"the first row has Y = 0, like the terrain geometry vertices\"\n}\n");
+	if (fclose(Pointer_File) != 0)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to write the heightmap description file (%s).\n", strerror(errno));
+		goto Exit;
+	}
+
+	StatisticsAddPhaseTime(STATISTICS_PHASE_MAP_HEIGHTMAP_WRITE, Start_Time);
+	LogPrint(LOG_LEVEL_INFORMATION, "Heightmap was successfully generated.\n");
+	Return_Value = 0;
+
+Exit:
+	free(Pointer_Samples);
+	return Return_Value;
+}
+
+/** Release the resources allocated by MapOpenSource().
+ * @param Pointer_Source The map content to release.
+ */
+static void MapCloseSource(TMapSource *Pointer_Source)
+{
+	if (Pointer_Source->Is_Archive_Tag) IDPArchiveClose(&Pointer_Source->Archive);
+	else MappedFileClose(&Pointer_Source->Mapped_File);
+}
+
+/** Map a map file in memory and check its header. The map can also be a tag of an IDP archive, it is then parsed straight from the mapped archive without being extracted first.
+ * @param Pointer_String_Map_File_Name The map file to open, or the archive file followed by ':' and the map tag name (like "SCom.idp:app\\maps\\ema1").
+ * @param Pointer_Source On output, contain the map content. Call MapCloseSource() to release it.
+ * @return -1 if an error occurred (nothing needs to be released),
+ * @return 0 on success.
+ */
+static int MapOpenSource(const char *Pointer_String_Map_File_Name, TMapSource *Pointer_Source)
+{
+	const char *Pointer_String_Separator;
+	char *Pointer_String_Archive_File;
+	int Version, Tag_Index, Result;
+	size_t Archive_File_Name_Length;
+
+	memset(Pointer_Source, 0, sizeof(TMapSource));
+
+	// Do not mistake a Windows drive letter for the archive separator
+	Pointer_String_Separator = Pointer_String_Map_File_Name;
+	if ((Pointer_String_Map_File_Name[0] != 0) && (Pointer_String_Map_File_Name[1] == ':')) Pointer_String_Separator += 2;
+	Pointer_String_Separator = strchr(Pointer_String_Separator, MAP_SOURCE_ARCHIVE_SEPARATOR);
+
+	if (Pointer_String_Separator == NULL)
+	{
+		// Map the whole file in memory, so the records are parsed in place without being copied
+		if (MappedFileOpen(Pointer_String_Map_File_Name, &Pointer_Source->Mapped_File) != 0) return -1;
+		Pointer_Source->Pointer_Data = Pointer_Source->Mapped_File.Pointer_Data;
+		Pointer_Source->Size = Pointer_Source->Mapped_File.Size;
+	}
+	else
+	{
+		// Only the archive tags directory is parsed, the map tag data pages are read by the system when the records are parsed
+		Archive_File_Name_Length = Pointer_String_Separator - Pointer_String_Map_File_Name;
+		Pointer_String_Archive_File = malloc(Archive_File_Name_Length + 1);
+		if (Pointer_String_Archive_File == NULL)
+		{
+			LogPrint(LOG_LEVEL_ERROR, "Error : failed to allocate the archive file name (%s).\n", strerror(errno));
+			return -1;
+		}
+		memcpy(Pointer_String_Archive_File, Pointer_String_Map_File_Name, Archive_File_Name_Length);
+		Pointer_String_Archive_File[Archive_File_Name_Length] = 0;
+		Result = IDPArchiveOpen(Pointer_String_Archive_File, IDP_ARCHIVE_ACCESS_MODE_MAPPED, &Pointer_Source->Archive);
+		free(Pointer_String_Archive_File);
+		if (Result != 0) return -1;
+		Pointer_Source->Is_Archive_Tag = 1;
+
+		Tag_Index = IDPArchiveFindTag(&Pointer_Source->Archive, Pointer_String_Separator + 1);
+		if (Tag_Index < 0)
+		{
+			LogPrint(LOG_LEVEL_ERROR, "Error : the archive contains no tag named '%s'.\n", Pointer_String_Separator + 1);
+			goto Exit_Error;
+		}
+		Pointer_Source->Pointer_Data = Pointer_Source->Archive.Pointer_Tags[Tag_Index].Pointer_Data;
+		Pointer_Source->Size = (size_t) Pointer_Source->Archive.Pointer_Tags[Tag_Index].Data_Size;
+		LogPrint(LOG_LEVEL_DEBUG, "Reading map from archive tag %d ('%s', %d bytes).\n", Tag_Index, Pointer_Source->Archive.Pointer_Tags[Tag_Index].Pointer_String_Name, Pointer_Source->Archive.Pointer_Tags[Tag_Index].Data_Size);
+	}
+
+	// Check file signature
+	if ((Pointer_Source->Size < 8) || (strncmp((char *) Pointer_Source->Pointer_Data, "IDWD", 4) != 0))
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : invalid map file signature. File must start with \"IDWD\" header identifier.\n");
+		goto Exit_Error;
+	}
+
+	// Check file version
+	memcpy(&Version, Pointer_Source->Pointer_Data + 4, 4);
+	if (Version != MAP_FILE_VERSION)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : invalid map file version. Supported version is 0x66.\n");
+		goto Exit_Error;
+	}
+
+	return 0;
+
+Exit_Error:
+	MapCloseSource(Pointer_Source);
+	return -1;
+}
+
+/** Call the handler of each map record, until the end-of-file record or the first error.
+ * @param Pointer_Context The extraction context, the handlers store the records data to it.
+ * @param Pointer_Source The map content, its header must have been checked.
+ * @return -1 if an error occurred (the records parsed before the error are still available in the context),
+ * @return 0 on success.
+ */
+static int MapParseRecords(TMapContext *Pointer_Context, TMapSource *Pointer_Source)
+{
+	int Return_Value = -1, Record_Identifier, Records_Count = 1, Record_Payload_Size, Result;
+	size_t Record_Offset = 8; // Take the file signature and version into account
+	double Start_Time;
+	TMapPayloadView Payload;
+	MapRecordHandler Record_Handler_Functions[] =
+	{
+		MapRecordHandlerIdentifier0,
+		MapRecordHandlerIdentifier1,
+		MapRecordHandlerIdentifier2,
+		MapRecordHandlerIdentifier3,
+		MapRecordHandlerIdentifier4,
+		MapRecordHandlerIdentifier5,
+		MapRecordHandlerIdentifier6,
+		MapRecordHandlerIdentifier7,
+		MapRecordHandlerIdentifier8,
+		MapRecordHandlerIdentifier9,
+		MapRecordHandlerIdentifier10,
+		MapRecordHandlerIdentifier11,
+		MapRecordHandlerIdentifier12,
+		MapRecordHandlerIdentifier13,
+		MapRecordHandlerIdentifier14,
+		MapRecordHandlerIdentifier15,
+		MapRecordHandlerIdentifier16,
+		MapRecordHandlerIdentifier17,
+		MapRecordHandlerIdentifier18
+	};
+
+	// Parse all file records
+	while (1)
+	{
+		Start_Time = StatisticsGetTime();
+
+		// Read record identifier and size
+		if (Pointer_Source->Size - Record_Offset < 8) // The offset is always checked against the file size, so it can't be greater than the size
+		{
+			LogPrint(LOG_LEVEL_ERROR, "Error : failed to read record %d header (the file is truncated).\n", Records_Count);
+			break;
+		}
+		memcpy(&Record_Identifier, Pointer_Source->Pointer_Data + Record_Offset, 4);
+		memcpy(&Record_Payload_Size, Pointer_Source->Pointer_Data + Record_Offset + 4, 4);
+		// Adjust size to take only payload into account
+		Record_Payload_Size -= 8; // Record identifier and size tags are included into the record size field value
+
+		// Make sure the payload is fully stored in the file
+		if ((Record_Payload_Size < 0) || ((size_t) Record_Payload_Size > Pointer_Source->Size - Record_Offset - 8))
+		{
+			LogPrint(LOG_LEVEL_ERROR, "Error : record %d payload size %d is invalid (the file is truncated or corrupted).\n", Records_Count, Record_Payload_Size);
+			break;
+		}
+		Payload.Pointer_Data = Pointer_Source->Pointer_Data + Record_Offset + 8;
+		Payload.Size = Record_Payload_Size;
+		Payload.Offset = 0;
+
+		// Call the corresponding record handler if the record is valid
+		LogPrint(LOG_LEVEL_DEBUG, "Found record %d at offset 0x%08X. ID : %d, payload size : %d.\n", Records_Count, (unsigned int) Record_Offset, Record_Identifier, Record_Payload_Size);
+		StatisticsAddMapRecord(Record_Identifier);
+		// Exit when the last record is detected
+		if (Record_Identifier == MAP_RECORD_IDENTIFIER_END_OF_FILE)
+		{
+			LogPrint(LOG_LEVEL_DEBUG, "End-of-file record has been found, exiting.\n\n");
+			StatisticsAddPhaseTime(STATISTICS_PHASE_MAP_RECORD_PARSE, Start_Time);
+			Return_Value = 0;
+			break;
+		}
+		// Make sure the record identifier is valid
+		if ((Record_Identifier < 0) || (Record_Identifier >= MAP_MAXIMUM_RECORD_IDENTIFIER)) LogPrint(LOG_LEVEL_DEBUG, "This record is not supported, bypassing it.\n");
+		else
+		{
+			// Try to extract the record content, the terrain decoding time is measured apart because it is much longer than the other records handling
+			if (Record_Identifier == 2)
+			{
+				StatisticsAddPhaseTime(STATISTICS_PHASE_MAP_RECORD_PARSE, Start_Time);
+				Start_Time = StatisticsGetTime();
+			}
+			Result = Record_Handler_Functions[Record_Identifier](Pointer_Context, &Payload);
+			if (Record_Identifier == 2)
+			{
+				StatisticsAddPhaseTime(STATISTICS_PHASE_MAP_TERRAIN_DECODE, Start_Time);
+				Start_Time = StatisticsGetTime();
+			}
+			if (Result != 0)
+			{
+				LogPrint(LOG_LEVEL_ERROR, "Error : failed to handle a record payload, aborting program.\n");
+				break;
+			}
+		}
+		
+		// Adjust offset to next record beginning
+		Record_Offset += 4 + 4 + Record_Payload_Size; // Take into account record ID field, record size field and record payload field
+
+		LogPrint(LOG_LEVEL_DEBUG, "\n");
+		Records_Count++;
+		StatisticsAddPhaseTime(STATISTICS_PHASE_MAP_RECORD_PARSE, Start_Time);
+	}
+	
+	return Return_Value;
+}
+
+//-------------------------------------------------------------------------------------------------
+// Public functions
+//-------------------------------------------------------------------------------------------------
+void MapInitializeExtractionOptions(TMapExtractionOptions *Pointer_Options)
+{
+	memset(Pointer_Options, 0, sizeof(TMapExtractionOptions));
+	Pointer_Options->Terrain_Format = MAP_TERRAIN_FORMAT_OBJ;
+	Pointer_Options->Terrain_Maximum_Error = -1;
+	Pointer_Options->Terrain_Levels_Of_Detail_Count = 1;
+	Pointer_Options->Jobs_Count = 1;
+}
+
+int MapExtract(char *Pointer_String_Map_File_Name, char *Pointer_String_Output_Path, TMapExtractionOptions *Pointer_Options)
+{
+	TMapSource Source;
+	int Return_Value;
+	TMapContext Context;
+
+	// Each extraction has its own state, so several maps can be extracted at the same time
+	memset(&Context, 0, sizeof(Context));
+	Context.Pointer_String_Output_Path = Pointer_String_Output_Path;
+	Context.Pointer_Options = Pointer_Options;
+	Context.Progress_Log_Level = LOG_LEVEL_INFORMATION;
+	Context.Tiles_Per_Side = -1;
+	Context.Vertices_Per_Side = -1;
+
+	if (MapOpenSource(Pointer_String_Map_File_Name, &Source) != 0) return -1;
+	Return_Value = MapParseRecords(&Context, &Source);
+	
+	// All relevant data have been extracted to be able to generate the units file and the terrain
+	if (MapWriteUnits(&Context) != 0)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : could not generate units file.\n");
+		Return_Value = -1;
+		goto Exit;
+	}
+	if (MapGenerateTerrain(&Context) != 0)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : could not generate terrain.\n");
+		Return_Value = -1;
+		goto Exit;
+	}
+	if (MapGenerateHeightmap(&Context) != 0)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : could not generate heightmap.\n");
+		Return_Value = -1;
+		goto Exit;
+	}
+
+Exit:
+	MapCloseSource(&Source);
+	MapFreeUnits(&Context.Units);
+	free(Context.Pointer_Terrain_Heights);
+	free(Context.Pointer_Row_Buffer);
+	return Return_Value;
+}
+
+int MapReadUnits(const char *Pointer_String_Map_File_Name, TMapUnits *Pointer_Units)
+{
+	TMapSource Source;
+	TMapContext Context;
+	int Return_Value = -1;
+
+	memset(Pointer_Units, 0, sizeof(TMapUnits));
+	Pointer_Units->Vertices_Per_Side = -1;
+
+	// Parse the records without writing any file
+	memset(&Context, 0, sizeof(Context));
+	Context.Progress_Log_Level = LOG_LEVEL_DEBUG;
+	Context.Tiles_Per_Side = -1;
+	Context.Vertices_Per_Side = -1;
+	if (MapOpenSource(Pointer_String_Map_File_Name, &Source) != 0) return -1;
+	if (MapParseRecords(&Context, &Source) != 0) goto Exit;
+
+	// The heights are needed to tell the ground height below the units
+	*Pointer_Units = Context.Units;
+	memset(&Context.Units, 0, sizeof(Context.Units));
+	Pointer_Units->Vertices_Per_Side = Context.Vertices_Per_Side;
+	Pointer_Units->Coordinates_Per_Terrain_Vertex = MAP_UNIT_COORDINATES_PER_TERRAIN_VERTEX;
+	Pointer_Units->Pointer_Terrain_Heights = Context.Pointer_Terrain_Heights;
+	Context.Pointer_Terrain_Heights = NULL;
+
+	if (UnitIndexInitialize(&Pointer_Units->Index, Pointer_Units->Pointer_Coordinates_X, Pointer_Units->Pointer_Coordinates_Y, Pointer_Units->Units_Count) != 0)
+	{
+		MapFreeUnits(Pointer_Units);
+		goto Exit;
+	}
+	Return_Value = 0;
+
+Exit:
+	MapCloseSource(&Source);
+	MapFreeUnits(&Context.Units);
+	free(Context.Pointer_Terrain_Heights);
+	return Return_Value;
+}
+
+int MapGetTerrainHeight(TMapUnits *Pointer_Units, double X, double Y, float *Pointer_Height)
+{
+	int Vertices_Per_Side = Pointer_Units->Vertices_Per_Side, Vertex_X, Vertex_Y, Next_Vertex_X, Next_Vertex_Y;
+	double Terrain_X, Terrain_Y, Fraction_X, Fraction_Y, Top_Height, Bottom_Height;
+	float *Pointer_Heights = Pointer_Units->Pointer_Terrain_Heights;
+
+	if ((Pointer_Heights == NULL) || (Vertices_Per_Side < 1) || !(Pointer_Units->Coordinates_Per_Terrain_Vertex > 0)) return -1;
+
+	// Convert the location to terrain vertex coordinates
+	Terrain_X = X / Pointer_Units->Coordinates_Per_Terrain_Vertex;
+	Terrain_Y = Y / Pointer_Units->Coordinates_Per_Terrain_Vertex;
+	if (!(Terrain_X >= 0) || !(Terrain_Y >= 0) || (Terrain_X > Vertices_Per_Side - 1) || (Terrain_Y > Vertices_Per_Side - 1)) return -1;
+
+	// Bilinear interpolation of the four vertices around the location, the last row and column have no next vertex
+	Vertex_X = (int) Terrain_X;
+	Vertex_Y = (int) Terrain_Y;
+	Fraction_X = Terrain_X - Vertex_X;
+	Fraction_Y = Terrain_Y - Vertex_Y;
+	Next_Vertex_X = Vertex_X < Vertices_Per_Side - 1 ? Vertex_X + 1 : Vertex_X;
+	Next_Vertex_Y = Vertex_Y < Vertices_Per_Side - 1 ? Vertex_Y + 1 : Vertex_Y;
+	Top_Height = Pointer_Heights[Vertex_Y * Vertices_Per_Side + Vertex_X] * (1 - Fraction_X) + Pointer_Heights[Vertex_Y * Vertices_Per_Side + Next_Vertex_X] * Fraction_X;
+	Bottom_Height = Pointer_Heights[Next_Vertex_Y * Vertices_Per_Side + Vertex_X] * (1 - Fraction_X) + Pointer_Heights[Next_Vertex_Y * Vertices_Per_Side + Next_Vertex_X] * Fraction_X;
+	*Pointer_Height = (float) (Top_Height * (1 - Fraction_Y) + Bottom_Height * Fraction_Y);
+
+	return 0;
+}
+
+void MapFreeUnits(TMapUnits *Pointer_Units)
+{
+	UnitIndexFree(&Pointer_Units->Index);
+	free(Pointer_Units->Pointer_Coordinates_X);
+	free(Pointer_Units->Pointer_Coordinates_Y);
+	free(Pointer_Units->Pointer_Coordinates_Z);
+	free(Pointer_Units->Pointer_Group_Indices);
+	free(Pointer_Units->Pointer_Strings_Types);
+	free(Pointer_Units->Pointer_Unit_Groups);
+	free(Pointer_Units->Pointer_Terrain_Heights);
+	memset(Pointer_Units, 0, sizeof(TMapUnits));
+	Pointer_Units->Vertices_Per_Side = -1;
+}
+
+int MapIsMapFile(const char *Pointer_String_File_Name)
+{
+	FILE *Pointer_File;
+	unsigned char Header[8];
+	int Version, Is_Map_File = 0;
+
+	Pointer_File = FileSystemOpenFile(Pointer_String_File_Name, "rb");
+	if (Pointer_File == NULL) return 0;
+
+	if (FileSystemReadFile(Header, sizeof(Header), Pointer_File) == sizeof(Header))
+	{
+		memcpy(&Version, Header + 4, 4);
+		if ((memcmp(Header, "IDWD", 4) == 0) && (Version == MAP_FILE_VERSION)) Is_Map_File = 1;
+	}
+
+	fclose(Pointer_File);
+	return Is_Map_File;
+}
+
+int MapReadInformation(const char *Pointer_String_Map_File_Name, TMapInformation *Pointer_Information)
+{
+	FILE *Pointer_File;
+	int Return_Value = -1, Record_Identifier, Record_Payload_Size, Read_Size, Allocated_Records_Count = 0, Allocated_Unit_Groups_Count = 0;
+	long long File_Size, Modification_Time, Record_Offset;
+	unsigned char Buffer[MAP_UNIT_GROUP_HEADER_MAXIMUM_SIZE];
+	TMapPayloadView Payload;
+	TMapRecordInformation *Pointer_Record;
+	void *Pointer_New_Array;
+
+	memset(Pointer_Information, 0, sizeof(TMapInformation));
+	Pointer_Information->Width = -1;
+	Pointer_Information->Height = -1;
+
+	// The file size is needed to check the records sizes, because the payloads are not read
+	if (FileSystemGetFileInformation(Pointer_String_Map_File_Name, &File_Size, &Modification_Time) != 0) return -1;
+	Pointer_File = FileSystemOpenFile(Pointer_String_Map_File_Name, "rb");
+	if (Pointer_File == NULL)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to open map file \"%s\" (%s).\n", Pointer_String_Map_File_Name, strerror(errno));
+		return -1;
+	}
+
+	// Check file signature and version
+	if (FileSystemReadFile(Buffer, 8, Pointer_File) != 8)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to read map file \"%s\" header.\n", Pointer_String_Map_File_Name);
+		goto Exit;
+	}
+	memcpy(&Record_Identifier, Buffer + 4, 4);
+	if ((memcmp(Buffer, "IDWD", 4) != 0) || (Record_Identifier != MAP_FILE_VERSION))
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : file \"%s\" is not a version 0x%X map file.\n", Pointer_String_Map_File_Name, MAP_FILE_VERSION);
+		goto Exit;
+	}
+	Record_Offset = 8;
+
+	// Walk the records headers
+	while (1)
+	{
+		if ((File_Size - Record_Offset < 8) || (FileSystemReadFile(Buffer, 8, Pointer_File) != 8))
+		{
+			LogPrint(LOG_LEVEL_ERROR, "Error : failed to read map file \"%s\" record %d header (the file is truncated).\n", Pointer_String_Map_File_Name, Pointer_Information->Records_Count + 1);
+			goto Exit;
+		}
+		memcpy(&Record_Identifier, Buffer, 4);
+		memcpy(&Record_Payload_Size, Buffer + 4, 4);
+		Record_Payload_Size -= 8; // Record identifier and size tags are included into the record size field value
+		if ((Record_Payload_Size < 0) || (Record_Payload_Size > File_Size - Record_Offset - 8))
+		{
+			LogPrint(LOG_LEVEL_ERROR, "Error : map file \"%s\" record %d payload size %d is invalid (the file is truncated or corrupted).\n", Pointer_String_Map_File_Name, Pointer_Information->Records_Count + 1, Record_Payload_Size);
+			goto Exit;
+		}
+
+		// Store the record location
+		if (Pointer_Information->Records_Count == Allocated_Records_Count)
+		{
+			Allocated_Records_Count = Allocated_Records_Count == 0 ? 64 : Allocated_Records_Count * 2;
+			Pointer_New_Array = realloc(Pointer_Information->Pointer_Records, Allocated_Records_Count * sizeof(TMapRecordInformation));
+			if (Pointer_New_Array == NULL)
+			{
+				LogPrint(LOG_LEVEL_ERROR, "Error : failed to allocate the records list (%s).\n", strerror(errno));
+				goto Exit;
+			}
+			Pointer_Information->Pointer_Records = Pointer_New_Array;
+		}
+		Pointer_Record = &Pointer_Information->Pointer_Records[Pointer_Information->Records_Count];
+		Pointer_Record->Identifier = Record_Identifier;
+		Pointer_Record->Offset = Record_Offset;
+		Pointer_Record->Payload_Size = Record_Payload_Size;
+		Pointer_Information->Records_Count++;
+		StatisticsAddMapRecord(Record_Identifier);
+		if (Record_Identifier == MAP_RECORD_IDENTIFIER_END_OF_FILE) break;
+
+		// Only the beginning of the map size and units records is needed
+		if (Record_Identifier == 1) Read_Size = 8;
+		else if (Record_Identifier == 7) Read_Size = MAP_UNIT_GROUP_HEADER_MAXIMUM_SIZE;
+		else Read_Size = 0;
+		if (Read_Size > Record_Payload_Size) Read_Size = Record_Payload_Size;
+		if (FileSystemReadFile(Buffer, Read_Size, Pointer_File) != (size_t) Read_Size)
+		{
+			LogPrint(LOG_LEVEL_ERROR, "Error : failed to read map file \"%s\" record %d payload (%s).\n", Pointer_String_Map_File_Name, Pointer_Information->Records_Count, strerror(errno));
+			goto Exit;
+		}
+		Payload.Pointer_Data = Buffer;
+		Payload.Size = Read_Size;
+		Payload.Offset = 0;
+
+		if (Record_Identifier == 1)
+		{
+			if ((MapPayloadViewReadDoubleWord(&Payload, (unsigned int *) &Pointer_Information->Width) != 0) || (MapPayloadViewReadDoubleWord(&Payload, (unsigned int *) &Pointer_Information->Height) != 0))
+			{
+				LogPrint(LOG_LEVEL_ERROR, "Error : map file \"%s\" size record is malformed.\n", Pointer_String_Map_File_Name);
+				goto Exit;
+			}
+		}
+		else if (Record_Identifier == 7)
+		{
+			if (Pointer_Information->Unit_Groups_Count == Allocated_Unit_Groups_Count)
+			{
+				Allocated_Unit_Groups_Count = Allocated_Unit_Groups_Count == 0 ? 32 : Allocated_Unit_Groups_Count * 2;
+				Pointer_New_Array = realloc(Pointer_Information->Pointer_Unit_Groups, Allocated_Unit_Groups_Count * sizeof(TMapUnitGroupInformation));
+				if (Pointer_New_Array == NULL)
+				{
+					LogPrint(LOG_LEVEL_ERROR, "Error : failed to allocate the unit groups list (%s).\n", strerror(errno));
+					goto Exit;
+				}
+				Pointer_Information->Pointer_Unit_Groups = Pointer_New_Array;
+			}
+			if (MapReadUnitGroupHeader(&Payload, &Pointer_Information->Pointer_Unit_Groups[Pointer_Information->Unit_Groups_Count]) != 0)
+			{
+				LogPrint(LOG_LEVEL_ERROR, "Error : map file \"%s\" record %d (units) is malformed.\n", Pointer_String_Map_File_Name, Pointer_Information->Records_Count);
+				goto Exit;
+			}
+			Pointer_Information->Unit_Groups_Count++;
+		}
+
+		// Skip the remaining payload without reading it
+		if (fseek(Pointer_File, Record_Payload_Size - Read_Size, SEEK_CUR) != 0)
+		{
+			LogPrint(LOG_LEVEL_ERROR, "Error : failed to skip map file \"%s\" record %d payload (%s).\n", Pointer_String_Map_File_Name, Pointer_Information->Records_Count, strerror(errno));
+			goto Exit;
+		}
+		Record_Offset += 8 + Record_Payload_Size;
+	}
+
+	Return_Value = 0;
+
+Exit:
+	fclose(Pointer_File);
+	if (Return_Value != 0) MapFreeInformation(Pointer_Information);
+	return Return_Value;
+}
+
+void MapFreeInformation(TMapInformation *Pointer_Information)
+{
+	free(Pointer_Information->Pointer_Records);
+	Pointer_Information->Pointer_Records = NULL;
+	Pointer_Information->Records_Count = 0;
+	free(Pointer_Information->Pointer_Unit_Groups);
+	Pointer_Information->Pointer_Unit_Groups = NULL;
+	Pointer_Information->Unit_Groups_Count = 0;
 }
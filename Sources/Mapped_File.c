@@ -0,0 +1,165 @@
+/** @file Mapped_File.c
+ * See Mapped_File.h for description.
+ * @author Adrien RICCIARDI
+ */
+#include <errno.h>
+#include <Log.h>
+#include <Mapped_File.h>
+#include <Statistics.h>
+#include <string.h>
+#ifdef _WIN32
+	#include <Windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+//-------------------------------------------------------------------------------------------------
+// Public functions
+//-------------------------------------------------------------------------------------------------
+#ifdef _WIN32
+int MappedFileOpen(const char *Pointer_String_File_Name, TMappedFile *Pointer_Mapped_File)
+{
+	HANDLE File_Handle, Mapping_Handle = NULL;
+	LARGE_INTEGER File_Size;
+	void *Pointer_Data = NULL;
+
+	// Make the mapped file safe to close whatever happens
+	memset(Pointer_Mapped_File, 0, sizeof(TMappedFile));
+
+	// Try to open the file, the data are usually read once from the beginning to the end
+	File_Handle = CreateFileA(Pointer_String_File_Name, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (File_Handle == INVALID_HANDLE_VALUE)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to open file '%s' (Windows error %lu).\n", Pointer_String_File_Name, GetLastError());
+		return -1;
+	}
+
+	// Retrieve the file size
+	if (!GetFileSizeEx(File_Handle, &File_Size))
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to retrieve file '%s' size (Windows error %lu).\n", Pointer_String_File_Name, GetLastError());
+		goto Exit_Error;
+	}
+	if ((unsigned long long) File_Size.QuadPart > (size_t) -1)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : file '%s' is too large to be mapped in memory.\n", Pointer_String_File_Name);
+		goto Exit_Error;
+	}
+
+	// An empty file can't be mapped
+	if (File_Size.QuadPart > 0)
+	{
+		Mapping_Handle = CreateFileMappingA(File_Handle, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (Mapping_Handle == NULL)
+		{
+			LogPrint(LOG_LEVEL_ERROR, "Error : failed to create file '%s' mapping (Windows error %lu).\n", Pointer_String_File_Name, GetLastError());
+			goto Exit_Error;
+		}
+
+		Pointer_Data = MapViewOfFile(Mapping_Handle, FILE_MAP_READ, 0, 0, 0);
+		if (Pointer_Data == NULL)
+		{
+			LogPrint(LOG_LEVEL_ERROR, "Error : failed to map file '%s' in memory (Windows error %lu).\n", Pointer_String_File_Name, GetLastError());
+			goto Exit_Error;
+		}
+	}
+
+	Pointer_Mapped_File->Pointer_Data = Pointer_Data;
+	Pointer_Mapped_File->Size = (size_t) File_Size.QuadPart;
+	Pointer_Mapped_File->File_Handle = File_Handle;
+	Pointer_Mapped_File->Mapping_Handle = Mapping_Handle;
+	StatisticsAddCounter(STATISTICS_COUNTER_FILE_MAPPINGS, 1);
+	return 0;
+
+Exit_Error:
+	if (Mapping_Handle != NULL) CloseHandle(Mapping_Handle);
+	CloseHandle(File_Handle);
+	return -1;
+}
+
+void MappedFileClose(TMappedFile *Pointer_Mapped_File)
+{
+	if (Pointer_Mapped_File->Pointer_Data != NULL)
+	{
+		UnmapViewOfFile(Pointer_Mapped_File->Pointer_Data);
+		Pointer_Mapped_File->Pointer_Data = NULL;
+	}
+	if (Pointer_Mapped_File->Mapping_Handle != NULL)
+	{
+		CloseHandle(Pointer_Mapped_File->Mapping_Handle);
+		Pointer_Mapped_File->Mapping_Handle = NULL;
+	}
+	if (Pointer_Mapped_File->File_Handle != NULL)
+	{
+		CloseHandle(Pointer_Mapped_File->File_Handle);
+		Pointer_Mapped_File->File_Handle = NULL;
+	}
+	Pointer_Mapped_File->Size = 0;
+}
+#else
+int MappedFileOpen(const char *Pointer_String_File_Name, TMappedFile *Pointer_Mapped_File)
+{
+	int File_Descriptor;
+	struct stat File_Status;
+	void *Pointer_Data = NULL;
+
+	// Make the mapped file safe to close whatever happens
+	memset(Pointer_Mapped_File, 0, sizeof(TMappedFile));
+	Pointer_Mapped_File->File_Descriptor = -1;
+
+	// Try to open the file
+	File_Descriptor = open(Pointer_String_File_Name, O_RDONLY);
+	if (File_Descriptor == -1)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to open file '%s' (%s).\n", Pointer_String_File_Name, strerror(errno));
+		return -1;
+	}
+
+	// Retrieve the file size
+	if (fstat(File_Descriptor, &File_Status) != 0)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to retrieve file '%s' size (%s).\n", Pointer_String_File_Name, strerror(errno));
+		close(File_Descriptor);
+		return -1;
+	}
+
+	// An empty file can't be mapped
+	if (File_Status.st_size > 0)
+	{
+		Pointer_Data = mmap(NULL, (size_t) File_Status.st_size, PROT_READ, MAP_PRIVATE, File_Descriptor, 0);
+		if (Pointer_Data == MAP_FAILED)
+		{
+			LogPrint(LOG_LEVEL_ERROR, "Error : failed to map file '%s' in memory (%s).\n", Pointer_String_File_Name, strerror(errno));
+			close(File_Descriptor);
+			return -1;
+		}
+
+		// The data are usually read once from the beginning to the end, this is only a hint so do not care about the result
+		madvise(Pointer_Data, (size_t) File_Status.st_size, MADV_SEQUENTIAL);
+	}
+
+	Pointer_Mapped_File->Pointer_Data = Pointer_Data;
+	Pointer_Mapped_File->Size = (size_t) File_Status.st_size;
+	Pointer_Mapped_File->File_Descriptor = File_Descriptor;
+	StatisticsAddCounter(STATISTICS_COUNTER_FILE_MAPPINGS, 1);
+	return 0;
+}
+
+void MappedFileClose(TMappedFile *Pointer_Mapped_File)
+{
+	if (Pointer_Mapped_File->Pointer_Data != NULL)
+	{
+		munmap(Pointer_Mapped_File->Pointer_Data, Pointer_Mapped_File->Size);
+		Pointer_Mapped_File->Pointer_Data = NULL;
+	}
+	if (Pointer_Mapped_File->File_Descriptor != -1)
+	{
+		close(Pointer_Mapped_File->File_Descriptor);
+		Pointer_Mapped_File->File_Descriptor = -1;
+	}
+	Pointer_Mapped_File->Size = 0;
+}
+#endif
@@ -0,0 +1,220 @@
+/** @file Statistics.c
+ * See Statistics.h for description.
+ * @author Adrien RICCIARDI
+ */
+#include <errno.h>
+#include <Log.h>
+#include <Statistics.h>
+#include <stdio.h>
+#include <string.h>
+#include <Thread.h>
+#ifdef _WIN32
+	#include <Windows.h>
+	#include <Psapi.h>
+#else
+	#include <sys/resource.h>
+	#include <time.h>
+#endif
+
+//-------------------------------------------------------------------------------------------------
+// Private constants
+//-------------------------------------------------------------------------------------------------
+/** How many different map record identifiers can be counted. The game maps use much less identifiers. */
+#define STATISTICS_MAXIMUM_MAP_RECORD_IDENTIFIERS_COUNT 64
+
+//-------------------------------------------------------------------------------------------------
+// Private types
+//-------------------------------------------------------------------------------------------------
+/** A map records histogram entry. */
+typedef struct
+{
+	int Record_Identifier; //!< The record identifier.
+	int Records_Count; //!< How many records with this identifier were found.
+} TStatisticsMapRecordEntry;
+
+//-------------------------------------------------------------------------------------------------
+// Private variables
+//-------------------------------------------------------------------------------------------------
+/** Set to 1 when the measures are enabled. */
+static int Statistics_Is_Enabled = 0;
+/** Serialize the measures updates. */
+static TThreadMutex Statistics_Mutex;
+/** When the statistics were enabled, in seconds. */
+static double Statistics_Start_Time;
+
+/** The total time spent in each phase, in seconds. */
+static double Statistics_Phase_Times[STATISTICS_PHASES_COUNT];
+/** The counters values. */
+static long long Statistics_Counters[STATISTICS_COUNTERS_COUNT];
+
+/** The map records identifier histogram. */
+static TStatisticsMapRecordEntry Statistics_Map_Records[STATISTICS_MAXIMUM_MAP_RECORD_IDENTIFIERS_COUNT];
+/** How many histogram entries are used. */
+static int Statistics_Map_Records_Count = 0;
+/** How many records could not be stored in the histogram because it is full. */
+static int Statistics_Map_Records_Overflow_Count = 0;
+
+/** The names of the phases in the report. */
+static const char *Pointer_Strings_Statistics_Phase_Names[STATISTICS_PHASES_COUNT] =
+{
+	"idp_directory_parse",
+	"idp_payload_read",
+	"idp_directory_creation",
+	"idp_file_write",
+	"idp_payload_hash",
+	"map_record_parse",
+	"map_terrain_decode",
+	"map_terrain_simplification",
+	"map_obj_write",
+	"map_heightmap_write",
+	"map_units_query"
+};
+
+/** The names of the counters in the report. */
+static const char *Pointer_Strings_Statistics_Counter_Names[STATISTICS_COUNTERS_COUNT] =
+{
+	"read_bytes",
+	"written_bytes",
+	"read_calls",
+	"write_calls",
+	"file_openings",
+	"file_mappings",
+	"directory_creations",
+	"process_launches"
+};
+
+//-------------------------------------------------------------------------------------------------
+// Private functions
+//-------------------------------------------------------------------------------------------------
+/** Get the largest amount of physical memory used by the process since it started.
+ * @return The peak memory size in bytes, or -1 if it could not be retrieved.
+ */
+static long long StatisticsGetPeakMemorySize(void)
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS Counters;
+
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &Counters, sizeof(Counters))) return -1;
+	return (long long) Counters.PeakWorkingSetSize;
+#else
+	struct rusage Usage;
+
+	if (getrusage(RUSAGE_SELF, &Usage) != 0) return -1;
+	#ifdef __APPLE__
+		return (long long) Usage.ru_maxrss; // macOS reports bytes
+	#else
+		return (long long) Usage.ru_maxrss * 1024; // Linux reports kilobytes
+	#endif
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------
+// Public functions
+//-------------------------------------------------------------------------------------------------
+void StatisticsEnable(void)
+{
+	if (Statistics_Is_Enabled) return;
+
+	ThreadMutexInitialize(&Statistics_Mutex);
+	Statistics_Start_Time = StatisticsGetTime();
+	Statistics_Is_Enabled = 1;
+}
+
+double StatisticsGetTime(void)
+{
+#ifdef _WIN32
+	LARGE_INTEGER Counter, Frequency;
+
+	QueryPerformanceCounter(&Counter);
+	QueryPerformanceFrequency(&Frequency);
+	return (double) Counter.QuadPart / Frequency.QuadPart;
+#else
+	struct timespec Time;
+
+	clock_gettime(CLOCK_MONOTONIC, &Time);
+	return Time.tv_sec + Time.tv_nsec / 1000000000.0;
+#endif
+}
+
+void StatisticsAddPhaseTime(TStatisticsPhase Phase, double Start_Time)
+{
+	double Time;
+
+	if (!Statistics_Is_Enabled) return;
+
+	Time = StatisticsGetTime() - Start_Time;
+	ThreadMutexLock(&Statistics_Mutex);
+	Statistics_Phase_Times[Phase] += Time;
+	ThreadMutexUnlock(&Statistics_Mutex);
+}
+
+void StatisticsAddCounter(TStatisticsCounter Counter, long long Value)
+{
+	if (!Statistics_Is_Enabled) return;
+
+	ThreadMutexLock(&Statistics_Mutex);
+	Statistics_Counters[Counter] += Value;
+	ThreadMutexUnlock(&Statistics_Mutex);
+}
+
+void StatisticsAddMapRecord(int Record_Identifier)
+{
+	int i;
+
+	if (!Statistics_Is_Enabled) return;
+
+	ThreadMutexLock(&Statistics_Mutex);
+	for (i = 0; i < Statistics_Map_Records_Count; i++)
+	{
+		if (Statistics_Map_Records[i].Record_Identifier == Record_Identifier) break;
+	}
+	if (i < Statistics_Map_Records_Count) Statistics_Map_Records[i].Records_Count++;
+	else if (Statistics_Map_Records_Count < STATISTICS_MAXIMUM_MAP_RECORD_IDENTIFIERS_COUNT)
+	{
+		Statistics_Map_Records[i].Record_Identifier = Record_Identifier;
+		Statistics_Map_Records[i].Records_Count = 1;
+		Statistics_Map_Records_Count++;
+	}
+	else Statistics_Map_Records_Overflow_Count++;
+	ThreadMutexUnlock(&Statistics_Mutex);
+}
+
+int StatisticsWriteReport(const char *Pointer_String_File, const char *Pointer_String_Command, int Exit_Status)
+{
+	FILE *Pointer_File;
+	int i;
+
+	if (!Statistics_Is_Enabled) return 0;
+
+	Pointer_File = fopen(Pointer_String_File, "w");
+	if (Pointer_File == NULL)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to create the statistics file '%s' (%s).\n", Pointer_String_File, strerror(errno));
+		return -1;
+	}
+
+	ThreadMutexLock(&Statistics_Mutex);
+	fprintf(Pointer_File, "{\n\t\"command\": \"%s\",\n\t\"exit_status\": %d,\n\t\"wall_seconds\": %.6f,\n\t\"peak_memory_bytes\": %lld,\n", Pointer_String_Command, Exit_Status, StatisticsGetTime() - Statistics_Start_Time, StatisticsGetPeakMemorySize());
+
+	// The phases run by several threads at the same time report the sum of the threads time
+	fprintf(Pointer_File, "\t\"phase_seconds\":\n\t{\n");
+	for (i = 0; i < STATISTICS_PHASES_COUNT; i++) fprintf(Pointer_File, "\t\t\"%s\": %.6f%s\n", Pointer_Strings_Statistics_Phase_Names[i], Statistics_Phase_Times[i], i < STATISTICS_PHASES_COUNT - 1 ? "," : "");
+	fprintf(Pointer_File, "\t},\n");
+
+	fprintf(Pointer_File, "\t\"counters\":\n\t{\n");
+	for (i = 0; i < STATISTICS_COUNTERS_COUNT; i++) fprintf(Pointer_File, "\t\t\"%s\": %lld%s\n", Pointer_Strings_Statistics_Counter_Names[i], Statistics_Counters[i], i < STATISTICS_COUNTERS_COUNT - 1 ? "," : "");
+	fprintf(Pointer_File, "\t},\n");
+
+	fprintf(Pointer_File, "\t\"map_record_identifiers\":\n\t{\n");
+	for (i = 0; i < Statistics_Map_Records_Count; i++) fprintf(Pointer_File, "\t\t\"%d\": %d%s\n", Statistics_Map_Records[i].Record_Identifier, Statistics_Map_Records[i].Records_Count, (i < Statistics_Map_Records_Count - 1) || (Statistics_Map_Records_Overflow_Count > 0) ? "," : "");
+	if (Statistics_Map_Records_Overflow_Count > 0) fprintf(Pointer_File, "\t\t\"other\": %d\n", Statistics_Map_Records_Overflow_Count);
+	fprintf(Pointer_File, "\t}\n}\n");
+	ThreadMutexUnlock(&Statistics_Mutex);
+
+	if (fclose(Pointer_File) != 0)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to write the statistics file '%s' (%s).\n", Pointer_String_File, strerror(errno));
+		return -1;
+	}
+	return 0;
+}
@@ -0,0 +1,311 @@
+/** @file Terrain_Simplifier.c
+ * See Terrain_Simplifier.h for description.
+ * @author Adrien RICCIARDI
+ */
+#include <errno.h>
+#include <float.h>
+#include <Log.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <Terrain_Simplifier.h>
+
+//-------------------------------------------------------------------------------------------------
+// Private constants
+//-------------------------------------------------------------------------------------------------
+/** How many vertices and triangles a mesh can store before its arrays are enlarged. */
+#define TERRAIN_SIMPLIFIER_MESH_INITIAL_CAPACITY 4096
+
+//-------------------------------------------------------------------------------------------------
+// Private types
+//-------------------------------------------------------------------------------------------------
+/** Everything needed while a mesh is built. */
+typedef struct
+{
+	TTerrainSimplifier *Pointer_Simplifier; //!< The heightmap errors.
+	float Maximum_Error; //!< The largest allowed error.
+	unsigned int *Pointer_Vertex_Indices; //!< The mesh index + 1 of each heightmap vertex, or 0 if the vertex is not used by the mesh yet.
+	TTerrainMesh *Pointer_Mesh; //!< The mesh being built.
+	int Vertices_Capacity; //!< How many vertices the mesh vertices array can store.
+	int Triangles_Capacity; //!< How many triangles the mesh indices array can store.
+	int Is_Error; //!< Set to 1 when an allocation failed.
+} TTerrainSimplifierMeshBuilder;
+
+//-------------------------------------------------------------------------------------------------
+// Private functions
+//-------------------------------------------------------------------------------------------------
+/** Tell whether a triangle is outside of the heightmap, the grid can be larger than the heightmap.
+ * @param Pointer_Simplifier The simplifier.
+ * @param Minimum_X The triangle smallest X coordinate.
+ * @param Minimum_Y The triangle smallest Y coordinate.
+ * @return 1 if the triangle is outside of the heightmap (it can touch the heightmap border),
+ * @return 0 if the triangle covers at least a part of the heightmap.
+ */
+static inline int TerrainSimplifierIsTriangleOutside(TTerrainSimplifier *Pointer_Simplifier, int Minimum_X, int Minimum_Y)
+{
+	return (Minimum_X >= Pointer_Simplifier->Vertices_Per_Side - 1) || (Minimum_Y >= Pointer_Simplifier->Vertices_Per_Side - 1);
+}
+
+/** Get the smallest of three numbers.
+ * @param A The first number.
+ * @param B The second number.
+ * @param C The third number.
+ * @return The smallest number.
+ */
+static inline int TerrainSimplifierMinimum(int A, int B, int C)
+{
+	if (B < A) A = B;
+	if (C < A) A = C;
+	return A;
+}
+
+/** Get the largest of three numbers.
+ * @param A The first number.
+ * @param B The second number.
+ * @param C The third number.
+ * @return The largest number.
+ */
+static inline int TerrainSimplifierMaximum(int A, int B, int C)
+{
+	if (B > A) A = B;
+	if (C > A) A = C;
+	return A;
+}
+
+/** Compute the error a triangle adds to its hypotenuse middle vertex.
+ * @param Pointer_Simplifier The simplifier.
+ * @param A_X The first hypotenuse vertex X coordinate.
+ * @param A_Y The first hypotenuse vertex Y coordinate.
+ * @param B_X The second hypotenuse vertex X coordinate.
+ * @param B_Y The second hypotenuse vertex Y coordinate.
+ * @param C_X The right angle vertex X coordinate.
+ * @param C_Y The right angle vertex Y coordinate.
+ * @param Is_Parent Set to 1 if the triangle children errors are already known and must be taken into account, set to 0 for the smallest triangles.
+ */
+static void TerrainSimplifierUpdateError(TTerrainSimplifier *Pointer_Simplifier, int A_X, int A_Y, int B_X, int B_Y, int C_X, int C_Y, int Is_Parent)
+{
+	int Middle_X, Middle_Y, Limit = Pointer_Simplifier->Vertices_Per_Side - 1, Grid_Side = Pointer_Simplifier->Grid_Size + 1, Child_Index;
+	float Error, *Pointer_Errors = Pointer_Simplifier->Pointer_Errors;
+	const float *Pointer_Heights = Pointer_Simplifier->Pointer_Heights;
+
+	if (TerrainSimplifierIsTriangleOutside(Pointer_Simplifier, TerrainSimplifierMinimum(A_X, B_X, C_X), TerrainSimplifierMinimum(A_Y, B_Y, C_Y))) return;
+	Middle_X = (A_X + B_X) / 2;
+	Middle_Y = (A_Y + B_Y) / 2;
+
+	// A triangle crossing the heightmap border must always be split, so the mesh border is exactly the heightmap one
+	if ((TerrainSimplifierMaximum(A_X, B_X, C_X) > Limit) || (TerrainSimplifierMaximum(A_Y, B_Y, C_Y) > Limit)) Error = FLT_MAX;
+	else
+	{
+		Error = fabsf((Pointer_Heights[A_Y * Pointer_Simplifier->Vertices_Per_Side + A_X] + Pointer_Heights[B_Y * Pointer_Simplifier->Vertices_Per_Side + B_X]) / 2 - Pointer_Heights[Middle_Y * Pointer_Simplifier->Vertices_Per_Side + Middle_X]);
+
+		// The triangle can be kept only if its children can be merged too
+		if (Is_Parent)
+		{
+			Child_Index = ((A_Y + C_Y) / 2) * Grid_Side + (A_X + C_X) / 2;
+			if (Pointer_Errors[Child_Index] > Error) Error = Pointer_Errors[Child_Index];
+			Child_Index = ((B_Y + C_Y) / 2) * Grid_Side + (B_X + C_X) / 2;
+			if (Pointer_Errors[Child_Index] > Error) Error = Pointer_Errors[Child_Index];
+		}
+	}
+
+	// The vertex is shared by the two triangles on each side of the hypotenuse
+	if (Error > Pointer_Errors[Middle_Y * Grid_Side + Middle_X]) Pointer_Errors[Middle_Y * Grid_Side + Middle_X] = Error;
+}
+
+/** Get the mesh index of a heightmap vertex, add the vertex to the mesh if it is not used yet.
+ * @param Pointer_Builder The mesh builder.
+ * @param X The vertex X coordinate.
+ * @param Y The vertex Y coordinate.
+ * @return The mesh vertex index.
+ */
+static unsigned int TerrainSimplifierGetVertexIndex(TTerrainSimplifierMeshBuilder *Pointer_Builder, int X, int Y)
+{
+	TTerrainMesh *Pointer_Mesh = Pointer_Builder->Pointer_Mesh;
+	unsigned int Heightmap_Index = (unsigned int) (Y * Pointer_Builder->Pointer_Simplifier->Vertices_Per_Side + X), *Pointer_Vertices;
+
+	if (Pointer_Builder->Pointer_Vertex_Indices[Heightmap_Index] != 0) return Pointer_Builder->Pointer_Vertex_Indices[Heightmap_Index] - 1;
+
+	if (Pointer_Mesh->Vertices_Count >= Pointer_Builder->Vertices_Capacity)
+	{
+		Pointer_Vertices = realloc(Pointer_Mesh->Pointer_Vertices, sizeof(unsigned int) * Pointer_Builder->Vertices_Capacity * 2);
+		if (Pointer_Vertices == NULL)
+		{
+			Pointer_Builder->Is_Error = 1;
+			return 0;
+		}
+		Pointer_Mesh->Pointer_Vertices = Pointer_Vertices;
+		Pointer_Builder->Vertices_Capacity *= 2;
+	}
+
+	Pointer_Mesh->Pointer_Vertices[Pointer_Mesh->Vertices_Count] = Heightmap_Index;
+	Pointer_Mesh->Vertices_Count++;
+	Pointer_Builder->Pointer_Vertex_Indices[Heightmap_Index] = (unsigned int) Pointer_Mesh->Vertices_Count;
+	return (unsigned int) Pointer_Mesh->Vertices_Count - 1;
+}
+
+/** Add a triangle to the mesh, or split it if it is not precise enough.
+ * @param Pointer_Builder The mesh builder.
+ * @param A_X The first hypotenuse vertex X coordinate.
+ * @param A_Y The first hypotenuse vertex Y coordinate.
+ * @param B_X The second hypotenuse vertex X coordinate.
+ * @param B_Y The second hypotenuse vertex Y coordinate.
+ * @param C_X The right angle vertex X coordinate.
+ * @param C_Y The right angle vertex Y coordinate.
+ */
+static void TerrainSimplifierAddTriangle(TTerrainSimplifierMeshBuilder *Pointer_Builder, int A_X, int A_Y, int B_X, int B_Y, int C_X, int C_Y)
+{
+	TTerrainSimplifier *Pointer_Simplifier = Pointer_Builder->Pointer_Simplifier;
+	TTerrainMesh *Pointer_Mesh = Pointer_Builder->Pointer_Mesh;
+	int Middle_X, Middle_Y;
+	unsigned int *Pointer_Indices, *Pointer_Triangle;
+
+	if (Pointer_Builder->Is_Error) return;
+	if (TerrainSimplifierIsTriangleOutside(Pointer_Simplifier, TerrainSimplifierMinimum(A_X, B_X, C_X), TerrainSimplifierMinimum(A_Y, B_Y, C_Y))) return;
+
+	// The smallest triangles, which have legs of 1, can't be split
+	Middle_X = (A_X + B_X) / 2;
+	Middle_Y = (A_Y + B_Y) / 2;
+	if ((abs(A_X - C_X) + abs(A_Y - C_Y) > 1) && (Pointer_Simplifier->Pointer_Errors[Middle_Y * (Pointer_Simplifier->Grid_Size + 1) + Middle_X] > Pointer_Builder->Maximum_Error))
+	{
+		TerrainSimplifierAddTriangle(Pointer_Builder, C_X, C_Y, A_X, A_Y, Middle_X, Middle_Y);
+		TerrainSimplifierAddTriangle(Pointer_Builder, B_X, B_Y, C_X, C_Y, Middle_X, Middle_Y);
+		return;
+	}
+
+	if (Pointer_Mesh->Triangles_Count >= Pointer_Builder->Triangles_Capacity)
+	{
+		Pointer_Indices = realloc(Pointer_Mesh->Pointer_Indices, sizeof(unsigned int) * 3 * Pointer_Builder->Triangles_Capacity * 2);
+		if (Pointer_Indices == NULL)
+		{
+			Pointer_Builder->Is_Error = 1;
+			return;
+		}
+		Pointer_Mesh->Pointer_Indices = Pointer_Indices;
+		Pointer_Builder->Triangles_Capacity *= 2;
+	}
+
+	// The grid faces are counterclockwise when X goes right and Y goes up, swap two vertices if needed
+	Pointer_Triangle = &Pointer_Mesh->Pointer_Indices[Pointer_Mesh->Triangles_Count * 3];
+	Pointer_Triangle[0] = TerrainSimplifierGetVertexIndex(Pointer_Builder, A_X, A_Y);
+	if ((B_X - A_X) * (C_Y - A_Y) - (B_Y - A_Y) * (C_X - A_X) > 0)
+	{
+		Pointer_Triangle[1] = TerrainSimplifierGetVertexIndex(Pointer_Builder, B_X, B_Y);
+		Pointer_Triangle[2] = TerrainSimplifierGetVertexIndex(Pointer_Builder, C_X, C_Y);
+	}
+	else
+	{
+		Pointer_Triangle[1] = TerrainSimplifierGetVertexIndex(Pointer_Builder, C_X, C_Y);
+		Pointer_Triangle[2] = TerrainSimplifierGetVertexIndex(Pointer_Builder, B_X, B_Y);
+	}
+	Pointer_Mesh->Triangles_Count++;
+}
+
+//-------------------------------------------------------------------------------------------------
+// Public functions
+//-------------------------------------------------------------------------------------------------
+int TerrainSimplifierInitialize(TTerrainSimplifier *Pointer_Simplifier, const float *Pointer_Heights, int Vertices_Per_Side)
+{
+	int Step, Double_Step, Grid_Size, X, Y;
+
+	// The triangles hierarchy needs a power of two square
+	Grid_Size = 1;
+	while (Grid_Size < Vertices_Per_Side - 1) Grid_Size *= 2;
+
+	Pointer_Simplifier->Pointer_Heights = Pointer_Heights;
+	Pointer_Simplifier->Vertices_Per_Side = Vertices_Per_Side;
+	Pointer_Simplifier->Grid_Size = Grid_Size;
+	Pointer_Simplifier->Pointer_Errors = calloc((size_t) (Grid_Size + 1) * (Grid_Size + 1), sizeof(float));
+	if (Pointer_Simplifier->Pointer_Errors == NULL)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to allocate the terrain errors (%s).\n", strerror(errno));
+		return -1;
+	}
+
+	// Process the triangles from the smallest to the largest ones, so the children errors are complete when a parent is processed. At each step, the triangles with an horizontal or vertical hypotenuse come first, then the triangles with a diagonal hypotenuse
+	for (Step = 1; Step < Grid_Size; Step *= 2)
+	{
+		Double_Step = Step * 2;
+
+		// Horizontal hypotenuses, the triangles point up and down
+		for (Y = 0; Y <= Grid_Size; Y += Double_Step)
+		{
+			for (X = Step; X < Grid_Size; X += Double_Step)
+			{
+				if (Y >= Step) TerrainSimplifierUpdateError(Pointer_Simplifier, X - Step, Y, X + Step, Y, X, Y - Step, Step > 1);
+				if (Y + Step <= Grid_Size) TerrainSimplifierUpdateError(Pointer_Simplifier, X - Step, Y, X + Step, Y, X, Y + Step, Step > 1);
+			}
+		}
+		// Vertical hypotenuses, the triangles point left and right
+		for (Y = Step; Y < Grid_Size; Y += Double_Step)
+		{
+			for (X = 0; X <= Grid_Size; X += Double_Step)
+			{
+				if (X >= Step) TerrainSimplifierUpdateError(Pointer_Simplifier, X, Y - Step, X, Y + Step, X - Step, Y, Step > 1);
+				if (X + Step <= Grid_Size) TerrainSimplifierUpdateError(Pointer_Simplifier, X, Y - Step, X, Y + Step, X + Step, Y, Step > 1);
+			}
+		}
+		// Diagonal hypotenuses, the squares diagonal direction alternates like a checkerboard
+		for (Y = Step; Y < Grid_Size; Y += Double_Step)
+		{
+			for (X = Step; X < Grid_Size; X += Double_Step)
+			{
+				if ((((X - Step) / Double_Step + (Y - Step) / Double_Step) & 1) == 0)
+				{
+					TerrainSimplifierUpdateError(Pointer_Simplifier, X - Step, Y - Step, X + Step, Y + Step, X - Step, Y + Step, 1);
+					TerrainSimplifierUpdateError(Pointer_Simplifier, X - Step, Y - Step, X + Step, Y + Step, X + Step, Y - Step, 1);
+				}
+				else
+				{
+					TerrainSimplifierUpdateError(Pointer_Simplifier, X - Step, Y + Step, X + Step, Y - Step, X - Step, Y - Step, 1);
+					TerrainSimplifierUpdateError(Pointer_Simplifier, X - Step, Y + Step, X + Step, Y - Step, X + Step, Y + Step, 1);
+				}
+			}
+		}
+	}
+
+	return 0;
+}
+
+int TerrainSimplifierBuildMesh(TTerrainSimplifier *Pointer_Simplifier, float Maximum_Error, TTerrainMesh *Pointer_Mesh)
+{
+	TTerrainSimplifierMeshBuilder Builder;
+	int Grid_Size = Pointer_Simplifier->Grid_Size;
+
+	memset(Pointer_Mesh, 0, sizeof(TTerrainMesh));
+	memset(&Builder, 0, sizeof(Builder));
+	Builder.Pointer_Simplifier = Pointer_Simplifier;
+	Builder.Maximum_Error = Maximum_Error;
+	Builder.Pointer_Mesh = Pointer_Mesh;
+	Builder.Vertices_Capacity = TERRAIN_SIMPLIFIER_MESH_INITIAL_CAPACITY;
+	Builder.Triangles_Capacity = TERRAIN_SIMPLIFIER_MESH_INITIAL_CAPACITY;
+	Builder.Pointer_Vertex_Indices = calloc((size_t) Pointer_Simplifier->Vertices_Per_Side * Pointer_Simplifier->Vertices_Per_Side, sizeof(unsigned int));
+	Pointer_Mesh->Pointer_Vertices = malloc(sizeof(unsigned int) * Builder.Vertices_Capacity);
+	Pointer_Mesh->Pointer_Indices = malloc(sizeof(unsigned int) * 3 * Builder.Triangles_Capacity);
+	if ((Builder.Pointer_Vertex_Indices == NULL) || (Pointer_Mesh->Pointer_Vertices == NULL) || (Pointer_Mesh->Pointer_Indices == NULL)) Builder.Is_Error = 1;
+
+	// The square is made of two triangles sharing a diagonal
+	TerrainSimplifierAddTriangle(&Builder, 0, 0, Grid_Size, Grid_Size, Grid_Size, 0);
+	TerrainSimplifierAddTriangle(&Builder, Grid_Size, Grid_Size, 0, 0, 0, Grid_Size);
+
+	free(Builder.Pointer_Vertex_Indices);
+	if (Builder.Is_Error)
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to allocate the simplified terrain mesh (%s).\n", strerror(errno));
+		TerrainSimplifierFreeMesh(Pointer_Mesh);
+		return -1;
+	}
+	return 0;
+}
+
+void TerrainSimplifierFreeMesh(TTerrainMesh *Pointer_Mesh)
+{
+	free(Pointer_Mesh->Pointer_Vertices);
+	free(Pointer_Mesh->Pointer_Indices);
+	memset(Pointer_Mesh, 0, sizeof(TTerrainMesh));
+}
+
+void TerrainSimplifierFree(TTerrainSimplifier *Pointer_Simplifier)
+{
+	free(Pointer_Simplifier->Pointer_Errors);
+	Pointer_Simplifier->Pointer_Errors = NULL;
+}
@@ -0,0 +1,182 @@
+/** @file Thread.c
+ * See Thread.h for description.
+ * @author Adrien RICCIARDI
+ */
+#include <Log.h>
+#include <Thread.h>
+
+//-------------------------------------------------------------------------------------------------
+// Private types
+//-------------------------------------------------------------------------------------------------
+/** Everything shared by the workers of a ThreadParallelFor() call. */
+typedef struct
+{
+	int Items_Count; //!< How many items to process.
+	volatile int Next_Item_Index; //!< The next item to give to a worker.
+	volatile int Is_Error_Detected; //!< Set to 1 when an item processing failed, so the workers stop taking new items.
+	TThreadParallelForFunction Function; //!< The function to call for each item.
+	void *Pointer_Context; //!< The function context.
+} TThreadParallelForShared;
+
+/** A single worker parameters. */
+typedef struct
+{
+	TThreadParallelForShared *Pointer_Shared; //!< The data shared by all workers.
+	int Worker_Index; //!< The worker index, starting from 0.
+} TThreadParallelForWorker;
+
+//-------------------------------------------------------------------------------------------------
+// Private functions
+//-------------------------------------------------------------------------------------------------
+/** Process items until there is no more item to process or an error occurred.
+ * @param Pointer_Worker The worker parameters.
+ */
+static void ThreadParallelForProcessItems(TThreadParallelForWorker *Pointer_Worker)
+{
+	TThreadParallelForShared *Pointer_Shared = Pointer_Worker->Pointer_Shared;
+	int Item_Index;
+
+	while (!Pointer_Shared->Is_Error_Detected)
+	{
+		// Take the next item
+		Item_Index = ThreadAtomicAdd(&Pointer_Shared->Next_Item_Index, 1);
+		if (Item_Index >= Pointer_Shared->Items_Count) break;
+
+		if (Pointer_Shared->Function(Pointer_Shared->Pointer_Context, Item_Index, Pointer_Worker->Worker_Index) != 0) Pointer_Shared->Is_Error_Detected = 1;
+	}
+}
+
+#ifdef _WIN32
+/** The worker thread entry point.
+ * @param Pointer_Parameters The worker parameters.
+ * @return Always 0.
+ */
+static DWORD WINAPI ThreadParallelForWorkerThread(LPVOID Pointer_Parameters)
+{
+	ThreadParallelForProcessItems(Pointer_Parameters);
+	return 0;
+}
+#else
+/** The worker thread entry point.
+ * @param Pointer_Parameters The worker parameters.
+ * @return Always NULL.
+ */
+static void *ThreadParallelForWorkerThread(void *Pointer_Parameters)
+{
+	ThreadParallelForProcessItems(Pointer_Parameters);
+	return NULL;
+}
+#endif
+
+//-------------------------------------------------------------------------------------------------
+// Public functions
+//-------------------------------------------------------------------------------------------------
+int ThreadParallelFor(int Workers_Count, int Items_Count, TThreadParallelForFunction Function, void *Pointer_Context)
+{
+	TThreadParallelForShared Shared;
+	TThreadParallelForWorker Workers[THREAD_MAXIMUM_WORKERS_COUNT];
+	int i, Started_Workers_Count, Return_Value = 0;
+#ifdef _WIN32
+	HANDLE Thread_Handles[THREAD_MAXIMUM_WORKERS_COUNT];
+#else
+	pthread_t Threads[THREAD_MAXIMUM_WORKERS_COUNT];
+#endif
+
+	// There is no need for more workers than items
+	if (Workers_Count > Items_Count) Workers_Count = Items_Count;
+	if (Workers_Count > THREAD_MAXIMUM_WORKERS_COUNT) Workers_Count = THREAD_MAXIMUM_WORKERS_COUNT;
+	if (Workers_Count < 1) Workers_Count = 1;
+
+	Shared.Items_Count = Items_Count;
+	Shared.Next_Item_Index = 0;
+	Shared.Is_Error_Detected = 0;
+	Shared.Function = Function;
+	Shared.Pointer_Context = Pointer_Context;
+	for (i = 0; i < Workers_Count; i++)
+	{
+		Workers[i].Pointer_Shared = &Shared;
+		Workers[i].Worker_Index = i;
+	}
+
+	// The calling thread is the first worker, so start only the other ones
+	for (Started_Workers_Count = 1; Started_Workers_Count < Workers_Count; Started_Workers_Count++)
+	{
+#ifdef _WIN32
+		Thread_Handles[Started_Workers_Count] = CreateThread(NULL, 0, ThreadParallelForWorkerThread, &Workers[Started_Workers_Count], 0, NULL);
+		if (Thread_Handles[Started_Workers_Count] == NULL)
+		{
+			LogPrint(LOG_LEVEL_ERROR, "Error : failed to start worker thread %d (Windows error %lu).\n", Started_Workers_Count, GetLastError());
+#else
+		if (pthread_create(&Threads[Started_Workers_Count], NULL, ThreadParallelForWorkerThread, &Workers[Started_Workers_Count]) != 0)
+		{
+			LogPrint(LOG_LEVEL_ERROR, "Error : failed to start worker thread %d.\n", Started_Workers_Count);
+#endif
+			// Make the already started workers stop as soon as possible
+			Shared.Is_Error_Detected = 1;
+			Return_Value = -1;
+			break;
+		}
+	}
+
+	// Work until all items are taken
+	ThreadParallelForProcessItems(&Workers[0]);
+
+	// Wait for all workers to terminate
+	for (i = 1; i < Started_Workers_Count; i++)
+	{
+#ifdef _WIN32
+		WaitForSingleObject(Thread_Handles[i], INFINITE);
+		CloseHandle(Thread_Handles[i]);
+#else
+		pthread_join(Threads[i], NULL);
+#endif
+	}
+
+	if (Shared.Is_Error_Detected) Return_Value = -1;
+	return Return_Value;
+}
+
+int ThreadAtomicAdd(volatile int *Pointer_Value, int Increment)
+{
+#ifdef _WIN32
+	return InterlockedExchangeAdd((volatile LONG *) Pointer_Value, Increment);
+#else
+	return __atomic_fetch_add(Pointer_Value, Increment, __ATOMIC_SEQ_CST);
+#endif
+}
+
+void ThreadMutexInitialize(TThreadMutex *Pointer_Mutex)
+{
+#ifdef _WIN32
+	InitializeCriticalSection(&Pointer_Mutex->Critical_Section);
+#else
+	pthread_mutex_init(&Pointer_Mutex->Mutex, NULL);
+#endif
+}
+
+void ThreadMutexLock(TThreadMutex *Pointer_Mutex)
+{
+#ifdef _WIN32
+	EnterCriticalSection(&Pointer_Mutex->Critical_Section);
+#else
+	pthread_mutex_lock(&Pointer_Mutex->Mutex);
+#endif
+}
+
+void ThreadMutexUnlock(TThreadMutex *Pointer_Mutex)
+{
+#ifdef _WIN32
+	LeaveCriticalSection(&Pointer_Mutex->Critical_Section);
+#else
+	pthread_mutex_unlock(&Pointer_Mutex->Mutex);
+#endif
+}
+
+void ThreadMutexDestroy(TThreadMutex *Pointer_Mutex)
+{
+#ifdef _WIN32
+	DeleteCriticalSection(&Pointer_Mutex->Critical_Section);
+#else
+	pthread_mutex_destroy(&Pointer_Mutex->Mutex);
+#endif
+}
@@ -0,0 +1,169 @@
+/** @file Unit_Index.c
+ * See Unit_Index.h for description.
+ * @author Adrien RICCIARDI
+ */
+#include <errno.h>
+#include <Log.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <Unit_Index.h>
+
+//-------------------------------------------------------------------------------------------------
+// Private constants
+//-------------------------------------------------------------------------------------------------
+/** How many units a cell should contain on average, the cells are sized to get close to this value when the units are evenly spread. */
+#define UNIT_INDEX_UNITS_PER_CELL 4
+/** The largest grid side in cells, it bounds the grid memory when the units are spread over a very large area. */
+#define UNIT_INDEX_MAXIMUM_CELLS_PER_SIDE 1024
+
+//-------------------------------------------------------------------------------------------------
+// Private functions
+//-------------------------------------------------------------------------------------------------
+/** Sort the query results by increasing distance, then by increasing unit index.
+ * @param Pointer_Result_1 The first result.
+ * @param Pointer_Result_2 The second result.
+ * @return A negative number if the first result is closer, a positive number if the second result is closer.
+ */
+static int UnitIndexCompareResults(const void *Pointer_Result_1, const void *Pointer_Result_2)
+{
+	const TUnitIndexResult *Pointer_Result_A = Pointer_Result_1, *Pointer_Result_B = Pointer_Result_2;
+
+	if (Pointer_Result_A->Distance < Pointer_Result_B->Distance) return -1;
+	if (Pointer_Result_A->Distance > Pointer_Result_B->Distance) return 1;
+	return Pointer_Result_A->Unit_Index - Pointer_Result_B->Unit_Index;
+}
+
+/** Convert a coordinate to a cell column or row, clamping it to the grid.
+ * @param Coordinate The coordinate to convert.
+ * @param Minimum_Coordinate The grid border coordinate.
+ * @param Cell_Size A cell side length.
+ * @param Cells_Count How many cells the grid has on this axis.
+ * @return The cell column or row.
+ */
+static int UnitIndexGetCell(double Coordinate, unsigned int Minimum_Coordinate, unsigned int Cell_Size, int Cells_Count)
+{
+	double Cell;
+
+	Cell = floor((Coordinate - Minimum_Coordinate) / Cell_Size);
+	if (Cell < 0) return 0;
+	if (Cell >= Cells_Count) return Cells_Count - 1;
+	return (int) Cell;
+}
+
+//-------------------------------------------------------------------------------------------------
+// Public functions
+//-------------------------------------------------------------------------------------------------
+int UnitIndexInitialize(TUnitIndex *Pointer_Index, const unsigned int *Pointer_Coordinates_X, const unsigned int *Pointer_Coordinates_Y, int Units_Count)
+{
+	unsigned int Maximum_X = 0, Maximum_Y = 0, Range;
+	int i, Cells_Per_Side, Cells_Count, Cell;
+
+	memset(Pointer_Index, 0, sizeof(TUnitIndex));
+	Pointer_Index->Pointer_Coordinates_X = Pointer_Coordinates_X;
+	Pointer_Index->Pointer_Coordinates_Y = Pointer_Coordinates_Y;
+	Pointer_Index->Units_Count = Units_Count;
+
+	// The grid only covers the units bounding box
+	if (Units_Count > 0)
+	{
+		Pointer_Index->Minimum_X = Maximum_X = Pointer_Coordinates_X[0];
+		Pointer_Index->Minimum_Y = Maximum_Y = Pointer_Coordinates_Y[0];
+	}
+	for (i = 1; i < Units_Count; i++)
+	{
+		if (Pointer_Coordinates_X[i] < Pointer_Index->Minimum_X) Pointer_Index->Minimum_X = Pointer_Coordinates_X[i];
+		if (Pointer_Coordinates_X[i] > Maximum_X) Maximum_X = Pointer_Coordinates_X[i];
+		if (Pointer_Coordinates_Y[i] < Pointer_Index->Minimum_Y) Pointer_Index->Minimum_Y = Pointer_Coordinates_Y[i];
+		if (Pointer_Coordinates_Y[i] > Maximum_Y) Maximum_Y = Pointer_Coordinates_Y[i];
+	}
+
+	// Use square cells sized from the largest bounding box side
+	Cells_Per_Side = (int) ceil(sqrt((double) Units_Count / UNIT_INDEX_UNITS_PER_CELL));
+	if (Cells_Per_Side < 1) Cells_Per_Side = 1;
+	if (Cells_Per_Side > UNIT_INDEX_MAXIMUM_CELLS_PER_SIDE) Cells_Per_Side = UNIT_INDEX_MAXIMUM_CELLS_PER_SIDE;
+	Range = Maximum_X - Pointer_Index->Minimum_X;
+	if (Maximum_Y - Pointer_Index->Minimum_Y > Range) Range = Maximum_Y - Pointer_Index->Minimum_Y;
+	Pointer_Index->Cell_Size = (unsigned int) (((unsigned long long) Range + Cells_Per_Side) / Cells_Per_Side); // Round up, so the largest coordinate is in the last cell
+	Pointer_Index->Columns_Count = (Maximum_X - Pointer_Index->Minimum_X) / Pointer_Index->Cell_Size + 1;
+	Pointer_Index->Rows_Count = (Maximum_Y - Pointer_Index->Minimum_Y) / Pointer_Index->Cell_Size + 1;
+	Cells_Count = Pointer_Index->Columns_Count * Pointer_Index->Rows_Count;
+
+	Pointer_Index->Pointer_Cells_First_Indices = calloc(Cells_Count + 1, sizeof(int));
+	Pointer_Index->Pointer_Units_Indices = malloc((Units_Count + 1) * sizeof(int)); // Always allocate something, even without units
+	if ((Pointer_Index->Pointer_Cells_First_Indices == NULL) || (Pointer_Index->Pointer_Units_Indices == NULL))
+	{
+		LogPrint(LOG_LEVEL_ERROR, "Error : failed to allocate the units index (%s).\n", strerror(errno));
+		UnitIndexFree(Pointer_Index);
+		return -1;
+	}
+
+	// Sort the units by cell with a counting sort, the units of a cell keep their order
+	for (i = 0; i < Units_Count; i++)
+	{
+		Cell = (Pointer_Coordinates_Y[i] - Pointer_Index->Minimum_Y) / Pointer_Index->Cell_Size * Pointer_Index->Columns_Count + (Pointer_Coordinates_X[i] - Pointer_Index->Minimum_X) / Pointer_Index->Cell_Size;
+		Pointer_Index->Pointer_Cells_First_Indices[Cell + 1]++;
+	}
+	for (i = 0; i < Cells_Count; i++) Pointer_Index->Pointer_Cells_First_Indices[i + 1] += Pointer_Index->Pointer_Cells_First_Indices[i];
+	for (i = 0; i < Units_Count; i++)
+	{
+		Cell = (Pointer_Coordinates_Y[i] - Pointer_Index->Minimum_Y) / Pointer_Index->Cell_Size * Pointer_Index->Columns_Count + (Pointer_Coordinates_X[i] - Pointer_Index->Minimum_X) / Pointer_Index->Cell_Size;
+		Pointer_Index->Pointer_Units_Indices[Pointer_Index->Pointer_Cells_First_Indices[Cell]] = i;
+		Pointer_Index->Pointer_Cells_First_Indices[Cell]++;
+	}
+	// The filling moved each cell first index to the next cell first index, so shift them back
+	for (i = Cells_Count; i > 0; i--) Pointer_Index->Pointer_Cells_First_Indices[i] = Pointer_Index->Pointer_Cells_First_Indices[i - 1];
+	Pointer_Index->Pointer_Cells_First_Indices[0] = 0;
+
+	LogPrint(LOG_LEVEL_DEBUG, "Indexed %d units in a grid of %dx%d cells of %u coordinates.\n", Units_Count, Pointer_Index->Columns_Count, Pointer_Index->Rows_Count, Pointer_Index->Cell_Size);
+	return 0;
+}
+
+int UnitIndexFind(TUnitIndex *Pointer_Index, double X, double Y, double Radius, TUnitIndexResult *Pointer_Results)
+{
+	int First_Column, Last_Column, First_Row, Last_Row, Column, Row, i, Cell, Unit_Index, Results_Count = 0;
+	double Delta_X, Delta_Y, Squared_Distance;
+
+	if ((Pointer_Index->Units_Count == 0) || !(Radius >= 0)) return 0;
+
+	// Nothing can be found if the search circle does not overlap the grid
+	if ((X + Radius < Pointer_Index->Minimum_X) || (Y + Radius < Pointer_Index->Minimum_Y)) return 0;
+	if ((X - Radius >= Pointer_Index->Minimum_X + (double) Pointer_Index->Cell_Size * Pointer_Index->Columns_Count) || (Y - Radius >= Pointer_Index->Minimum_Y + (double) Pointer_Index->Cell_Size * Pointer_Index->Rows_Count)) return 0;
+
+	// Test only the units of the cells overlapped by the search circle bounding box
+	First_Column = UnitIndexGetCell(X - Radius, Pointer_Index->Minimum_X, Pointer_Index->Cell_Size, Pointer_Index->Columns_Count);
+	Last_Column = UnitIndexGetCell(X + Radius, Pointer_Index->Minimum_X, Pointer_Index->Cell_Size, Pointer_Index->Columns_Count);
+	First_Row = UnitIndexGetCell(Y - Radius, Pointer_Index->Minimum_Y, Pointer_Index->Cell_Size, Pointer_Index->Rows_Count);
+	Last_Row = UnitIndexGetCell(Y + Radius, Pointer_Index->Minimum_Y, Pointer_Index->Cell_Size, Pointer_Index->Rows_Count);
+	for (Row = First_Row; Row <= Last_Row; Row++)
+	{
+		for (Column = First_Column; Column <= Last_Column; Column++)
+		{
+			Cell = Row * Pointer_Index->Columns_Count + Column;
+			for (i = Pointer_Index->Pointer_Cells_First_Indices[Cell]; i < Pointer_Index->Pointer_Cells_First_Indices[Cell + 1]; i++)
+			{
+				Unit_Index = Pointer_Index->Pointer_Units_Indices[i];
+				Delta_X = Pointer_Index->Pointer_Coordinates_X[Unit_Index] - X;
+				Delta_Y = Pointer_Index->Pointer_Coordinates_Y[Unit_Index] - Y;
+				Squared_Distance = Delta_X * Delta_X + Delta_Y * Delta_Y;
+				if (Squared_Distance > Radius * Radius) continue;
+
+				Pointer_Results[Results_Count].Unit_Index = Unit_Index;
+				Pointer_Results[Results_Count].Distance = sqrt(Squared_Distance);
+				Results_Count++;
+			}
+		}
+	}
+
+	qsort(Pointer_Results, Results_Count, sizeof(TUnitIndexResult), UnitIndexCompareResults);
+	return Results_Count;
+}
+
+void UnitIndexFree(TUnitIndex *Pointer_Index)
+{
+	free(Pointer_Index->Pointer_Cells_First_Indices);
+	Pointer_Index->Pointer_Cells_First_Indices = NULL;
+	free(Pointer_Index->Pointer_Units_Indices);
+	Pointer_Index->Pointer_Units_Indices = NULL;
+	Pointer_Index->Units_Count = 0;
+}